@@ -11,6 +11,7 @@
 #include <ndn-cpp/security/identity/memory-private-key-storage.hpp>
 #include <ndn-cpp/security/identity/memory-identity-storage.hpp>
 #include <ndn-cpp/security/policy/no-verify-policy-manager.hpp>
+#include <ndnrtc/consumer-runtime.hpp>
 
 #include "client.hpp"
 #include "config.hpp"
@@ -21,10 +22,12 @@ using namespace ndn;
 
 //******************************************************************************
 void Client::run(unsigned int runTimeSec, unsigned int statSamplePeriodMs,
-                 const ClientParams &params, const std::string &instanceName)
+                 const ClientParams &params, const std::string &instanceName,
+                 unsigned int statRecordCapacity)
 {
     runTimeSec_ = runTimeSec;
     statSampleIntervalMs_ = statSamplePeriodMs;
+    statRecordCapacity_ = statRecordCapacity;
     params_ = params;
     instanceName_ = instanceName;
 
@@ -49,6 +52,13 @@ bool Client::setupConsumer()
 
     ConsumerClientParams ccp = params_.getConsumerParams();
 
+    if (ccp.nShards_)
+    {
+        consumerRuntime_ = std::make_shared<ndnrtc::ConsumerRuntime>(ccp.nShards_,
+                                                                     params_.getGeneralParameters().host_);
+        LogInfo("") << "Fetching on " << consumerRuntime_->getShardsNum() << " shards" << endl;
+    }
+
     for (auto p : ccp.fetchedStreams_)
     {
         ndnrtc::GeneralConsumerParams gp = (p.type_ == ClientMediaStreamParams::MediaStreamType::MediaStreamTypeAudio ? ccp.generalAudioParams_ : ccp.generalVideoParams_);
@@ -96,22 +106,25 @@ bool Client::setupProducer()
 
 void Client::setupStatGathering()
 {
-    if (!params_.isGatheringStats())
+    if (!params_.isGatheringStats() && !statRecordCapacity_)
         return;
 
     statCollector_.reset(new StatCollector(io_));
 
     for (auto &rs : remoteStreams_)
         statCollector_->addStream(rs.getStream(), params_.getGeneralParameters().logPath_,
-                                  params_.getConsumerParams().statGatheringParams_);
+                                  params_.getConsumerParams().statGatheringParams_,
+                                  statRecordCapacity_);
     for (auto &ls : localStreams_)
         statCollector_->addStream(ls.getStream(), params_.getGeneralParameters().logPath_,
-                                  params_.getProducerParams().statGatheringParams_);
+                                  params_.getProducerParams().statGatheringParams_,
+                                  statRecordCapacity_);
 
     statCollector_->startCollecting(statSampleIntervalMs_);
 
     LogInfo("") << "Gathering statistics into "
-                << statCollector_->getWritersNumber() << " files" << std::endl;
+                << statCollector_->getWritersNumber() << " files, recording "
+                << statCollector_->getRecordersNumber() << " .nstat files" << std::endl;
 }
 
 void Client::runProcessLoop()
@@ -123,7 +136,7 @@ void Client::runProcessLoop()
 
 void Client::tearDownStatGathering()
 {
-    if (!params_.isGatheringStats())
+    if (!statCollector_)
         return;
 
     statCollector_->stop();
@@ -162,7 +175,25 @@ void Client::tearDownConsumer()
         std::dynamic_pointer_cast<ndnrtc::RemoteStream>(rs.getStream())->stop();
         LogInfo("") << "...stopped fetching from " << rs.getStream()->getPrefix() << std::endl;
     }
+
+    if (consumerRuntime_)
+        logShardStats();
+
     remoteStreams_.clear();
+
+    if (consumerRuntime_)
+    {
+        consumerRuntime_->stop();
+        consumerRuntime_.reset();
+    }
+}
+
+void Client::logShardStats()
+{
+    for (auto &s : consumerRuntime_->getShardStats())
+        LogInfo("") << "shard " << s.shardNo_ << ": " << s.nStreams_ << " streams, cpu "
+                    << s.cpuUsage_ << ", io delay " << s.ioDelayUsec_ << " usec (max "
+                    << s.maxIoDelayUsec_ << " usec)" << std::endl;
 }
 
 RemoteStream Client::initRemoteStream(const ConsumerStreamParams &p,
@@ -173,17 +204,22 @@ RemoteStream Client::initRemoteStream(const ConsumerStreamParams &p,
     if (p.type_ == ConsumerStreamParams::MediaStreamTypeVideo)
     {
         std::shared_ptr<ndnrtc::RemoteVideoStream>
-            remoteStream(std::make_shared<ndnrtc::RemoteVideoStream>(io_, face_, keyChain_,
-                                                                       p.sessionPrefix_, p.streamName_, gcp.interestLifetime_, gcp.jitterSizeMs_));
+            remoteStream(consumerRuntime_ ? consumerRuntime_->createVideoStream(keyChain_, p.sessionPrefix_, p.streamName_,
+                                                                                gcp.interestLifetime_, gcp.jitterSizeMs_, p.shard_)
+                                          : std::make_shared<ndnrtc::RemoteVideoStream>(io_, face_, keyChain_,
+                                                                                        p.sessionPrefix_, p.streamName_, gcp.interestLifetime_, gcp.jitterSizeMs_));
         remoteStream->setLogger(consumerLogger(p.sessionPrefix_, p.streamName_));
-        remoteStream->start(p.threadToFetch_, renderer);
+        // renderer converts frames into sink's format itself
+        remoteStream->start(p.threadToFetch_, static_cast<ndnrtc::IExternalPlanarRenderer*>(renderer));
         return RemoteStream(remoteStream, std::shared_ptr<RendererInternal>(renderer));
     }
     else
     {
         std::shared_ptr<ndnrtc::RemoteAudioStream>
-            remoteStream(std::make_shared<ndnrtc::RemoteAudioStream>(io_, face_, keyChain_,
-                                                                       p.sessionPrefix_, p.streamName_, gcp.interestLifetime_, gcp.jitterSizeMs_));
+            remoteStream(consumerRuntime_ ? consumerRuntime_->createAudioStream(keyChain_, p.sessionPrefix_, p.streamName_,
+                                                                                gcp.interestLifetime_, gcp.jitterSizeMs_, p.shard_)
+                                          : std::make_shared<ndnrtc::RemoteAudioStream>(io_, face_, keyChain_,
+                                                                                        p.sessionPrefix_, p.streamName_, gcp.interestLifetime_, gcp.jitterSizeMs_));
         remoteStream->setLogger(consumerLogger(p.sessionPrefix_, p.streamName_));
         remoteStream->start(p.threadToFetch_);
         return RemoteStream(remoteStream, std::shared_ptr<RendererInternal>(renderer));
@@ -305,7 +341,7 @@ RendererInternal *Client::setupRenderer(const ConsumerStreamParams &p)
                                             std::shared_ptr<IFrameSink> sink = std::make_shared<PipeSink>(s);
                                             if (p.sink_.writeFrameInfo_) sink->setWriteFrameInfo(true);
                                             return sink;
-                                        }, rendererIo_);
+                                        }, rendererIo_, false, sinkFormatFromString(p.sink_.format_));
         else if (p.sink_.type_ == "nano")
         {
 #ifdef HAVE_LIBNANOMSG
@@ -321,7 +357,7 @@ RendererInternal *Client::setupRenderer(const ConsumerStreamParams &p)
                                                 LogError("") << "Error when creating nanomsg sink: " << e.what() << std::endl;
                                                 throw;
                                             }
-                                        }, rendererIo_);
+                                        }, rendererIo_, false, sinkFormatFromString(p.sink_.format_));
 #else
             throw std::runtime_error("Requested nano type sink, but code was not built with nanomsg library support");
 #endif
@@ -332,7 +368,7 @@ RendererInternal *Client::setupRenderer(const ConsumerStreamParams &p)
                                             std::shared_ptr<IFrameSink> sink = std::make_shared<FileSink>(s);
                                             if (p.sink_.writeFrameInfo_) sink->setWriteFrameInfo(true);
                                             return sink;
-                                        }, rendererIo_);
+                                        }, rendererIo_, false, sinkFormatFromString(p.sink_.format_));
     }
     else
         return nullptr;
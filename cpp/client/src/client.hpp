@@ -21,6 +21,11 @@ namespace ndn
 class KeyChain;
 }
 
+namespace ndnrtc
+{
+class ConsumerRuntime;
+}
+
 class Client
 {
   public:
@@ -31,17 +36,22 @@ class Client
     ~Client() {}
 
     // blocking call. will return after runTimeSec seconds
+    // if statRecordCapacity is non-zero, all statistics of each stream are
+    // recorded into .nstat files keeping this many latest samples
     void run(unsigned int runTimeSec, unsigned int statSamplePeriodMs,
-             const ClientParams &params, const std::string &instanceName);
+             const ClientParams &params, const std::string &instanceName,
+             unsigned int statRecordCapacity = 0);
 
   private:
     boost::asio::io_service &io_, &rendererIo_;
-    unsigned int runTimeSec_, statSampleIntervalMs_;
+    unsigned int runTimeSec_, statSampleIntervalMs_, statRecordCapacity_;
     ClientParams params_;
 
     std::shared_ptr<StatCollector> statCollector_;
     std::shared_ptr<ndn::Face> face_;
     std::shared_ptr<ndn::KeyChain> keyChain_;
+    // runs remote streams on multiple io threads, if configured
+    std::shared_ptr<ndnrtc::ConsumerRuntime> consumerRuntime_;
 
     std::vector<RemoteStream> remoteStreams_;
     std::vector<LocalStream> localStreams_;
@@ -62,6 +72,7 @@ class Client
 
     RemoteStream initRemoteStream(const ConsumerStreamParams &p,
                                   const ndnrtc::GeneralConsumerParams &generalParams);
+    void logShardStats();
     LocalStream initLocalStream(const ProducerStreamParams &p);
     std::shared_ptr<RawFrame> sampleFrameForStream(const ProducerStreamParams &p);
 
@@ -148,6 +148,8 @@ int loadConsumerSettings(const Setting &root, ConsumerClientParams &params)
         {
             loadBasicStatSettings(consumerBasicSettings[BASIC_STAT_KEY], params.statGatheringParams_);
         }
+
+        consumerBasicSettings.lookupValue("shards", params.nShards_);
     }
     catch (const SettingNotFoundException &e)
     {
@@ -333,6 +335,7 @@ int loadStreamParams(const Setting &s, ConsumerStreamParams &params)
     if (EXIT_SUCCESS == loadStreamParams(s, (ClientMediaStreamParams &)params))
     {
         s.lookupValue("thread_to_fetch", params.threadToFetch_);
+        s.lookupValue("shard", params.shard_);
 
         const Setting &sinkSettings = s["sink"];
 
@@ -344,6 +347,9 @@ int loadStreamParams(const Setting &s, ConsumerStreamParams &params)
         params.sink_.type_ = "file";
         sinkSettings.lookupValue("type", params.sink_.type_);
 
+        params.sink_.format_ = "argb";
+        sinkSettings.lookupValue("format", params.sink_.format_);
+
         return EXIT_SUCCESS;
     }
 
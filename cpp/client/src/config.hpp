@@ -99,21 +99,26 @@ class ConsumerStreamParams : public ClientMediaStreamParams
     typedef struct _Sink {
         std::string name_, type_;
         bool writeFrameInfo_;
+        std::string format_;
     } Sink;
 
     std::string threadToFetch_;
     Sink sink_;
+    int shard_; // consumer runtime shard to fetch stream on; -1 - any
 
-    ConsumerStreamParams() : sink_({"", "file", false}) {}
+    ConsumerStreamParams() : sink_({"", "file", false, "argb"}), shard_(-1) {}
     ConsumerStreamParams(const ConsumerStreamParams &params) : ClientMediaStreamParams(params), sink_(params.sink_),
-                                                               threadToFetch_(params.threadToFetch_) {}
+                                                               threadToFetch_(params.threadToFetch_), shard_(params.shard_) {}
 
     void write(std::ostream &os) const
     {
         os
             << "stream sink: " << sink_.name_ << " (type: "
-            << sink_.type_ << ", write frame info: " << sink_.writeFrameInfo_
+            << sink_.type_ << ", format: " << sink_.format_
+            << ", write frame info: " << sink_.writeFrameInfo_
             << "); thread to fetch: " << threadToFetch_ << "; ";
+        if (shard_ >= 0)
+            os << "shard: " << shard_ << "; ";
         ClientMediaStreamParams::write(os);
     }
 };
@@ -124,12 +129,15 @@ class ConsumerClientParams : public ndnrtc::Params
     ndnrtc::GeneralConsumerParams generalAudioParams_, generalVideoParams_;
     std::vector<StatGatheringParams> statGatheringParams_;
     std::vector<ConsumerStreamParams> fetchedStreams_;
+    unsigned int nShards_; // number of consumer runtime shards; 0 - fetch on
+                           // client's io thread
 
-    ConsumerClientParams() {}
+    ConsumerClientParams() : nShards_(0) {}
     ConsumerClientParams(const ConsumerClientParams &params) : generalAudioParams_(params.generalAudioParams_),
                                                                generalVideoParams_(params.generalVideoParams_),
                                                                statGatheringParams_(params.statGatheringParams_),
-                                                               fetchedStreams_(params.fetchedStreams_) {}
+                                                               fetchedStreams_(params.fetchedStreams_),
+                                                               nShards_(params.nShards_) {}
 
     void write(std::ostream &os) const
     {
@@ -137,6 +145,9 @@ class ConsumerClientParams : public ndnrtc::Params
             << "general audio: " << generalAudioParams_ << std::endl
             << "general video: " << generalVideoParams_ << std::endl;
 
+        if (nShards_)
+            os << "shards: " << nShards_ << std::endl;
+
         if (statGatheringParams_.size())
         {
             os << "stat gathering:" << std::endl;
@@ -17,6 +17,7 @@
 #include <fcntl.h>
 
 #include "frame-io.hpp"
+#include "yuv-converter.hpp"
 
 #ifdef HAVE_NANOMSG
 #include "ipc-shim.h"
@@ -57,6 +58,24 @@ unsigned long ArgbFrame::getFrameSizeInBytes() const
     return width_ * height_ * 4;
 }
 
+//******************************************************************************
+I420Frame::I420Frame(unsigned int width, unsigned int height) : RawFrame(width, height)
+{
+    unsigned long bufSize = getFrameSizeInBytes();
+    setBuffer(bufSize, std::shared_ptr<uint8_t>(new uint8_t[bufSize]));
+}
+
+void I420Frame::getFrameResolution(unsigned int &width, unsigned int &height) const
+{
+    width = width_;
+    height = height_;
+}
+
+unsigned long I420Frame::getFrameSizeInBytes() const
+{
+    return yuv::i420Size(width_, height_);
+}
+
 //******************************************************************************
 void FileFrameStorage::openFile()
 {
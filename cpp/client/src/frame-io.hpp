@@ -54,6 +54,28 @@ class ArgbFrame : public RawFrame
     void getFrameResolution(unsigned int &width, unsigned int &height) const;
 };
 
+//******************************************************************************
+/**
+ * Planar 4:2:0 frame: Y plane followed by U and V planes.
+ */
+class I420Frame : public RawFrame
+{
+  public:
+    I420Frame(unsigned int width, unsigned int height);
+
+    virtual unsigned long getFrameSizeInBytes() const;
+    void getFrameResolution(unsigned int &width, unsigned int &height) const;
+};
+
+/**
+ * Semi-planar 4:2:0 frame: Y plane followed by interleaved UV plane.
+ */
+class Nv12Frame : public I420Frame
+{
+  public:
+    Nv12Frame(unsigned int width, unsigned int height) : I420Frame(width, height) {}
+};
+
 //******************************************************************************
 class FileFrameStorage
 {
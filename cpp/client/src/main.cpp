@@ -26,6 +26,7 @@
 #include "config.hpp"
 #include "client.hpp"
 #include "key-chain-manager.hpp"
+#include "event-trace.hpp"
 
 using namespace std;
 using namespace ndnrtc;
@@ -33,8 +34,8 @@ using namespace ndn;
 
 struct Args
 {
-    unsigned int runTimeSec_, samplePeriod_;
-    std::string configFile_, identity_, instance_, policy_;
+    unsigned int runTimeSec_, samplePeriod_, statRecordCapacity_;
+    std::string configFile_, identity_, instance_, policy_, traceFile_;
     ndnlog::NdnLoggerDetailLevel logLevel_;
 };
 
@@ -64,14 +65,15 @@ int main(int argc, char **argv)
     signal(SIGABRT, handler);
     signal(SIGSEGV, handler);
 
-    char *configFile = NULL, *identity = NULL, *instance = NULL, *policy = NULL;
+    char *configFile = NULL, *identity = NULL, *instance = NULL, *policy = NULL, *traceFile = NULL;
     int c;
     unsigned int runTimeSec = 0;           // default app run time (sec)
     unsigned int statSamplePeriodMs = 100; // default statistics sample interval (ms)
+    unsigned int statRecordCapacity = 0;   // samples kept in .nstat files (0 - don't record)
     ndnlog::NdnLoggerDetailLevel logLevel = ndnlog::NdnLoggerDetailLevelDefault;
 
     opterr = 0;
-    while ((c = getopt(argc, argv, "vn:i:t:c:s:p:")) != -1)
+    while ((c = getopt(argc, argv, "vn:i:t:c:s:p:e:r:")) != -1)
         switch (c)
         {
         case 'c':
@@ -95,6 +97,12 @@ int main(int argc, char **argv)
         case 'p':
             policy = optarg;
             break;
+        case 'e':
+            traceFile = optarg;
+            break;
+        case 'r':
+            statRecordCapacity = (unsigned int)atoi(optarg);
+            break;
         case '?':
             if (optopt == 'c')
                 fprintf(stderr, "Option -%c requires an argument.\n", optopt);
@@ -114,7 +122,8 @@ int main(int argc, char **argv)
         std::cout << "usage: " << argv[0] << " -c <config file> -s <signing identity> "
                                              "-p <verification policy file> "
                                              "-t <app run time in seconds> [-n <statistics sample interval in milliseconds> "
-                                             "-i <instance name> -v <verbose mode>]"
+                                             "-i <instance name> -e <event trace file> "
+                                             "-r <number of statistics samples to record into .nstat files> -v <verbose mode>]"
                   << std::endl;
         exit(1);
     }
@@ -123,10 +132,12 @@ int main(int argc, char **argv)
     args.runTimeSec_ = runTimeSec;
     args.logLevel_ = logLevel;
     args.samplePeriod_ = statSamplePeriodMs;
+    args.statRecordCapacity_ = statRecordCapacity;
     args.configFile_ = std::string(configFile);
     args.identity_ = std::string(identity);
     args.policy_ = std::string(policy);
     args.instance_ = (instance ? std::string(instance) : "client0");
+    args.traceFile_ = (traceFile ? std::string(traceFile) : "");
 
     return run(args);
 }
@@ -147,6 +158,7 @@ int run(const struct Args &args)
                 << "\n\tpolicy file: " << args.policy_
                 << "\n\tstatistics sampling: " << args.samplePeriod_
                 << "\n\tinstance name: " << args.instance_
+                << "\n\tevent trace file: " << args.traceFile_
                 << std::endl;
 
     boost::asio::io_service io;
@@ -204,7 +216,8 @@ int run(const struct Args &args)
             publishCertificate(face, keyChainManager);
         }
 
-        client.run(args.runTimeSec_, args.samplePeriod_, params, args.instance_);
+        client.run(args.runTimeSec_, args.samplePeriod_, params, args.instance_,
+                   args.statRecordCapacity_);
 
         face->shutdown();
         face.reset();
@@ -220,6 +233,15 @@ int run(const struct Args &args)
 
     LogInfo("") << "Client run completed" << std::endl;
 
+    if (args.traceFile_ != "")
+    {
+        int nRecords = trace::Tracer::dump(args.traceFile_);
+        if (nRecords < 0)
+            LogError("") << "failed to write event trace to " << args.traceFile_ << std::endl;
+        else
+            LogInfo("") << "written " << nRecords << " trace records to " << args.traceFile_ << std::endl;
+    }
+
     rendererWork.reset();
     rendererThread.join();
     rendererIo.stop();
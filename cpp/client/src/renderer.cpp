@@ -10,14 +10,27 @@
 #include <ndnrtc/simple-log.hpp>
 
 #include "renderer.hpp"
+#include "yuv-converter.hpp"
 
 using namespace std;
 
+SinkFormat sinkFormatFromString(const std::string& format)
+{
+    if (format == "argb")
+        return SinkFormat::Argb;
+    if (format == "i420")
+        return SinkFormat::I420;
+    if (format == "nv12")
+        return SinkFormat::Nv12;
+
+    throw runtime_error("unknown sink format: " + format);
+}
+
 RendererInternal::RendererInternal(const std::string sinkName, SinkFactoryCreate sinkFactoryCreate, 
-        boost::asio::io_service& io, bool suppressBadSink)
+        boost::asio::io_service& io, bool suppressBadSink, SinkFormat format)
     : sinkName_(sinkName), createSink_(sinkFactoryCreate), io_(io),
       frameCount_(0), isDumping_(true), suppressBadSink_(suppressBadSink),
-      frame_(new ArgbFrame(0, 0))
+      frame_(new ArgbFrame(0, 0)), format_(format), frameFormat_(SinkFormat::Argb)
 {
 }
 
@@ -35,17 +48,7 @@ uint8_t *RendererInternal::getFrameBuffer(int width, int height)
         return nullptr;
     }
 
-    if (frame_->getFrameSizeInBytes() != ArgbFrame(width, height).getFrameSizeInBytes())
-    {
-        frame_.reset(new ArgbFrame(width, height));
-        closeSink();
-        openSink(width, height);
-
-        LogInfo("") << "receiving frame of resolution " << width << "x" << height
-                    << "(" << frame_->getFrameSizeInBytes() << " bytes per frame)."
-                    << (isDumping_ ? string(" writing to ") + sink_->getName() : "")
-                    << " writing frame info: " << sink_->isWritingFrameInfo() << std::endl;
-    }
+    setupFrame(width, height, SinkFormat::Argb);
 
     return frame_->getBuffer().get();
 }
@@ -72,7 +75,76 @@ void RendererInternal::renderBGRAFrame(const ndnrtc::FrameInfo& frameInfo, int w
     frameCount_++;
 }
 
-string RendererInternal::openSink(unsigned int width, unsigned int height)
+void RendererInternal::renderI420Frame(const ndnrtc::FrameInfo& frameInfo,
+                                       const unsigned int width,
+                                       const unsigned int height,
+                                       const unsigned int strideY,
+                                       const unsigned int strideU,
+                                       const unsigned int strideV,
+                                       const uint8_t* yBuffer,
+                                       const uint8_t* uBuffer,
+                                       const uint8_t* vBuffer)
+{
+    if (sink_ && sink_->isBusy())
+    {
+        LogWarn("") << "Frame sink is busy. Writing frames is too slow?..." << std::endl;
+        return;
+    }
+
+    setupFrame(width, height, format_);
+
+    // decoder's planes are valid only during this call, so they are
+    // converted (or copied) into the frame which is written asynchronously
+    uint8_t *buffer = frame_->getBuffer().get();
+    switch (format_)
+    {
+    case SinkFormat::I420:
+        yuv::i420ToI420(width, height, yBuffer, strideY, uBuffer, strideU, vBuffer, strideV, buffer);
+        break;
+    case SinkFormat::Nv12:
+        yuv::i420ToNv12(width, height, yBuffer, strideY, uBuffer, strideU, vBuffer, strideV, buffer);
+        break;
+    default:
+        yuv::i420ToBgra(width, height, yBuffer, strideY, uBuffer, strideU, vBuffer, strideV, buffer);
+        break;
+    }
+
+    LogDebug("") << "received I420 frame " << frameInfo.playbackNo_ 
+                 << " (" << width << "x" << height << ") at "
+                 << frameInfo.timestamp_ << " ms"
+                 << ", frame count: " << frameCount_ 
+                 << ", NDN name: " << frameInfo.ndnName_
+                 << std::endl;
+
+    frame_->setFrameInfo(frameInfo);
+    dumpFrame();
+    frameCount_++;
+}
+
+void RendererInternal::setupFrame(unsigned int width, unsigned int height, SinkFormat format)
+{
+    if (frame_->getWidth() == width && frame_->getHeight() == height &&
+        frameFormat_ == format)
+        return;
+
+    if (format == SinkFormat::I420)
+        frame_.reset(new I420Frame(width, height));
+    else if (format == SinkFormat::Nv12)
+        frame_.reset(new Nv12Frame(width, height));
+    else
+        frame_.reset(new ArgbFrame(width, height));
+    frameFormat_ = format;
+
+    closeSink();
+    openSink(width, height, format);
+
+    LogInfo("") << "receiving frame of resolution " << width << "x" << height
+                << "(" << frame_->getFrameSizeInBytes() << " bytes per frame)."
+                << (isDumping_ ? string(" writing to ") + sink_->getName() : "")
+                << " writing frame info: " << (sink_ ? sink_->isWritingFrameInfo() : false) << std::endl;
+}
+
+string RendererInternal::openSink(unsigned int width, unsigned int height, SinkFormat format)
 {
     if (sinkName_ == "")
     {
@@ -84,6 +156,10 @@ string RendererInternal::openSink(unsigned int width, unsigned int height)
 
     stringstream sinkPath;
     sinkPath << sinkName_ << "." << width << "x" << height;
+    if (format == SinkFormat::I420)
+        sinkPath << ".i420";
+    else if (format == SinkFormat::Nv12)
+        sinkPath << ".nv12";
 
     try
     {
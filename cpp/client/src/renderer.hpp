@@ -36,32 +36,64 @@
 
 typedef std::function<std::shared_ptr<IFrameSink>(const std::string&)> SinkFactoryCreate;
 
-class RendererInternal : public ndnrtc::IExternalRenderer{
+/**
+ * Pixel format of frames written into the sink. For I420 and NV12 sinks,
+ * frames are written in the format they come out of the decoder (NV12 
+ * only interleaves chroma planes), for ARGB sinks frames are converted
+ * into packed BGRA.
+ */
+enum class SinkFormat {
+    Argb,
+    I420,
+    Nv12
+};
+
+/**
+ * Parses sink format name ("argb", "i420" or "nv12"). Throws on unknown
+ * format.
+ */
+SinkFormat sinkFormatFromString(const std::string& format);
+
+class RendererInternal : public ndnrtc::IExternalRenderer, 
+                         public ndnrtc::IExternalPlanarRenderer {
 public:
     /**
      * @param sinkName Base name which will be used to derive new sink names
      * @param sinkFactoryCreate Function that creates new sink
      * @param suppressBadSink If there is a problem creating new sink, renderer will
      *                          throw is this is false or ignore otherwise.  
+     * @param format Format of frames written into the sink by renderI420Frame
      */ 
     RendererInternal(const std::string sinkName, SinkFactoryCreate sinkFactoryCreate, 
-        boost::asio::io_service& io, bool suppressBadSink = false);
+        boost::asio::io_service& io, bool suppressBadSink = false,
+        SinkFormat format = SinkFormat::Argb);
     ~RendererInternal();
     
     virtual uint8_t* getFrameBuffer(int width, int height);
     virtual void renderBGRAFrame(const ndnrtc::FrameInfo&, int width, int height,
                          const uint8_t* buffer);
+    virtual void renderI420Frame(const ndnrtc::FrameInfo& frameInfo,
+                                 const unsigned int width,
+                                 const unsigned int height,
+                                 const unsigned int strideY,
+                                 const unsigned int strideU,
+                                 const unsigned int strideV,
+                                 const uint8_t* yBuffer,
+                                 const uint8_t* uBuffer,
+                                 const uint8_t* vBuffer);
     
 private:
     boost::asio::io_service &io_;
     SinkFactoryCreate createSink_;
     std::shared_ptr<IFrameSink> sink_;
-    std::shared_ptr<ArgbFrame> frame_;
+    std::shared_ptr<RawFrame> frame_;
+    SinkFormat format_, frameFormat_;
     std::string sinkName_;
     bool isDumping_, suppressBadSink_;
     unsigned int frameCount_;
     
-    std::string openSink(unsigned int width, unsigned int height);
+    void setupFrame(unsigned int width, unsigned int height, SinkFormat format);
+    std::string openSink(unsigned int width, unsigned int height, SinkFormat format);
     void closeSink();
     void dumpFrame();
 };
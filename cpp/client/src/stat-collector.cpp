@@ -29,6 +29,17 @@ stats_(p), ostream_(ostream), formatter_(formatter), nWrites_(0)
 }
 
 void StatWriter::writeStats(const StatisticsStorage::StatRepo& statRepo)
+{
+    StatisticsStorage::Snapshot snapshot;
+
+    snapshot.fill(0);
+    for (auto it:statRepo)
+        snapshot[(size_t)it.first] = it.second;
+
+    writeStats(snapshot);
+}
+
+void StatWriter::writeStats(const StatisticsStorage::Snapshot& snapshot)
 {
     if (nWrites_ == 0)
     {
@@ -36,7 +47,7 @@ void StatWriter::writeStats(const StatisticsStorage::StatRepo& statRepo)
         writeHeader(metricsToWrite_);
     }
 
-    populateMetrics(statRepo);
+    populateMetrics(snapshot);
     writeMetrics(metricsToWrite_);
     flush();
 
@@ -61,18 +72,14 @@ void StatWriter::setupMetrics()
         metricsToWrite_[keyword] = 0.;
 }
 
-void StatWriter::populateMetrics(const StatisticsStorage::StatRepo& statRepo)
+void StatWriter::populateMetrics(const StatisticsStorage::Snapshot& snapshot)
 {
-    metricsToWrite_["timestamp"] = statRepo.at(Indicator::Timestamp);
+    metricsToWrite_["timestamp"] = snapshot[(size_t)Indicator::Timestamp];
 
     for (auto keyword:stats_.getStats())
     {
         if (IndicatorLookupTable.find(keyword) != IndicatorLookupTable.end())
-        {
-            Indicator ind = IndicatorLookupTable[keyword];
-            if (statRepo.find(ind) != statRepo.end())
-                metricsToWrite_[keyword] = statRepo.at(ind);
-        }
+            metricsToWrite_[keyword] = snapshot[(size_t)IndicatorLookupTable[keyword]];
     }
 }
 
@@ -196,6 +203,19 @@ void StatCollector::StreamStatCollector::addStatsToCollect(string filePath,
     }
 }
 
+void StatCollector::StreamStatCollector::addRecorder(string filePath, unsigned int capacity)
+{
+    StatisticsStorage storage = stream_->getStatistics();
+    vector<Indicator> columns;
+
+    for (size_t i = 0; i < IndicatorsNum; ++i)
+        if (storage.hasIndicator((Indicator)i))
+            columns.push_back((Indicator)i);
+
+    recorder_ = std::make_shared<StatRecorder>(fullFilePath(filePath, "", 
+        stream_->getBasePrefix(), stream_->getStreamName(), ".nstat"), columns, capacity);
+}
+
 void StatCollector::StreamStatCollector::flushData()
 {
     for (auto w:statWriters_)
@@ -204,17 +224,20 @@ void StatCollector::StreamStatCollector::flushData()
 
 void StatCollector::StreamStatCollector::writeStats()
 {
-    StatisticsStorage::StatRepo repo = stream_->getStatistics().getIndicators();
+    StatisticsStorage::Snapshot snapshot;
+    stream_->getStatistics().snapshot(snapshot);
 
+    if (recorder_)
+        recorder_->record(snapshot);
     for (auto w:statWriters_)
-        w->writeStats(repo);
+        w->writeStats(snapshot);
 }
 
 string StatCollector::StreamStatCollector::fullFilePath(string path, string fname, 
-      string basePrefix, string stream)
+      string basePrefix, string stream, string ext)
 {
     std::replace(basePrefix.begin(), basePrefix.end(), '/', '-');
-    string fpath = path + "/" + fname + basePrefix + "-" + stream + ".stat";
+    string fpath = path + "/" + fname + basePrefix + "-" + stream + ext;
     return fpath;
 }
 
@@ -238,12 +261,15 @@ StatCollector::~StatCollector()
 }
 
 void StatCollector::addStream(const std::shared_ptr<const IStream>& stream,
-                              string path, vector<StatGatheringParams> stats)
+                              string path, vector<StatGatheringParams> stats,
+                              unsigned int recordCapacity)
 {
     if (streamStatCollectors_.find(stream->getPrefix()) == streamStatCollectors_.end())
     {
         streamStatCollectors_[stream->getPrefix()] = new StreamStatCollector(stream);
         streamStatCollectors_[stream->getPrefix()]->addStatsToCollect(path, stats);
+        if (recordCapacity)
+            streamStatCollectors_[stream->getPrefix()]->addRecorder(path, recordCapacity);
     }
     else
         throw runtime_error("stream has been already added for stat gathering");
@@ -279,6 +305,15 @@ size_t StatCollector::getWritersNumber()
     return n;
 }
 
+size_t StatCollector::getRecordersNumber()
+{
+    size_t n = 0;
+    for (auto it:streamStatCollectors_)
+        if (it.second->isRecording()) n++;
+
+    return n;
+}
+
 void StatCollector::startCollecting(unsigned int queryInterval)
 {
     double rate = 1000./(double)queryInterval;
@@ -24,6 +24,7 @@
 #include <ndnrtc/stream.hpp>
 #include "config.hpp"
 #include "precise-generator.hpp"
+#include "stat-recorder.hpp"
 
 namespace ndnrtc {
    class IStream;
@@ -67,6 +68,13 @@ class StatWriter {
        */
       void writeStats(const ndnrtc::statistics::StatisticsStorage::StatRepo& statRepo);
 
+      /**
+       * Extracts statistics from snapshot according to stats_ objects and writes them into ostream_
+       * @param snapshot Statistics storage snapshot
+       * @see StatisticsStorage::snapshot
+       */
+      void writeStats(const ndnrtc::statistics::StatisticsStorage::Snapshot& snapshot);
+
       /**
        * Flushes all unwritten data into output stream
        */
@@ -85,7 +93,7 @@ class StatWriter {
       std::map<std::string, double> metricsToWrite_;
    
       void setupMetrics();
-      void populateMetrics(const ndnrtc::statistics::StatisticsStorage::StatRepo& statRepo);
+      void populateMetrics(const ndnrtc::statistics::StatisticsStorage::Snapshot& snapshot);
       std::vector<std::string> statOrder();
 
       static void initLookupTable();
@@ -158,6 +166,9 @@ class JsonFormatter : public StatWriter::IMetricFormatter
  * to which file. Filename is copmosed of stream name, base file name from 
  * StatGatheringParams object and information from stream prefix (to 
  * differentiate between streams with identical names but different prefixes).
+ * Additionally, all stream's metrics can be recorded into binary .nstat
+ * ring file (see StatRecorder) which is cheap enough for high-frequency
+ * sampling.
  * Statistics are gathered asynchronously into a folder.
  */
 class StatCollector {
@@ -168,9 +179,12 @@ public:
    /**
     * Add stream to gather metrics from
     * @param stream Pointer to a stream (local or remote)
+    * @param recordCapacity If non-zero, all stream's metrics are recorded
+    *          into .nstat file which keeps this many latest samples
     */
    void addStream(const std::shared_ptr<const ndnrtc::IStream>& stream,
-                  std::string path, std::vector<StatGatheringParams> stats);
+                  std::string path, std::vector<StatGatheringParams> stats,
+                  unsigned int recordCapacity = 0);
    
    /**
     * Remove stream previously added
@@ -195,6 +209,11 @@ public:
     */
    size_t getWritersNumber();
 
+   /**
+    * Returns total number of .nstat files being recorded.
+    */
+   size_t getRecordersNumber();
+
    /**
     * Initiates collecting statistics from previously added streams.
     * @param queryIntervalMs Defines time interval (in milliseconds) between 
@@ -224,7 +243,9 @@ private:
 
       void addStatsToCollect(std::string filePath,
          const std::vector<StatGatheringParams>& statGatheringParams);
+      void addRecorder(std::string filePath, unsigned int capacity);
       size_t getWritersNumber() { return statWriters_.size(); }
+      bool isRecording() { return recorder_.get() != nullptr; }
       void flushData();
       void writeStats();
       std::string getStreamPrefix() { return stream_->getPrefix(); }
@@ -232,10 +253,11 @@ private:
       private:
          std::shared_ptr<const ndnrtc::IStream> stream_;
          std::vector<StatWriter*> statWriters_;
+         std::shared_ptr<ndnrtc::statistics::StatRecorder> recorder_;
 
          void prepareWriters();
          std::string fullFilePath(std::string path, std::string fname, 
-            std::string basePrefix, std::string stream);
+            std::string basePrefix, std::string stream, std::string ext = ".stat");
    };
 
    boost::asio::io_service& io_;
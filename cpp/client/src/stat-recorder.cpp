@@ -0,0 +1,196 @@
+//
+// stat-recorder.cpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include "stat-recorder.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <map>
+#include <stdexcept>
+
+using namespace ndnrtc::statistics;
+
+namespace {
+    const char Magic[4] = {'N', 'S', 'T', 'R'};
+    const uint16_t Version = 2;
+
+    static_assert(sizeof(StatRecordHeader) == 32, "unexpected .nstat header size");
+    static_assert(sizeof(StatRecordColumn) == 32, "unexpected .nstat column size");
+
+    // data starts at 64-byte boundary after column descriptions
+    uint32_t dataOffset(size_t nColumns)
+    {
+        size_t offset = sizeof(StatRecordHeader) + nColumns*sizeof(StatRecordColumn);
+        return (uint32_t)((offset + 63) & ~(size_t)63);
+    }
+
+    std::string errorString(const std::string& msg, const std::string& fname)
+    {
+        return msg + " " + fname + ": " + strerror(errno);
+    }
+}
+
+//******************************************************************************
+StatRecorder::StatRecorder(const std::string& fname,
+                           const std::vector<Indicator>& columns,
+                           unsigned int capacity):
+columns_(columns), fileSize_(0), header_(nullptr), data_(nullptr)
+{
+    if (capacity == 0 || columns.size() == 0 || columns.size() > UINT16_MAX)
+        throw std::runtime_error("bad .nstat file parameters");
+
+    int fd = open(fname.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        throw std::runtime_error(errorString("can't create", fname));
+
+    fileSize_ = dataOffset(columns.size()) + columns.size()*capacity*sizeof(double);
+
+    void *addr = MAP_FAILED;
+    if (ftruncate(fd, fileSize_) == 0)
+        addr = mmap(nullptr, fileSize_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (addr == MAP_FAILED)
+        throw std::runtime_error(errorString("can't map", fname));
+
+    header_ = (StatRecordHeader*)addr;
+    memcpy(header_->magic_, Magic, sizeof(Magic));
+    header_->version_ = Version;
+    header_->nColumns_ = (uint16_t)columns.size();
+    header_->capacity_ = capacity;
+    header_->dataOffset_ = dataOffset(columns.size());
+    header_->nRecorded_ = 0;
+    header_->nStarted_ = 0;
+
+    StatRecordColumn *column = (StatRecordColumn*)(header_+1);
+    for (auto indicator:columns_)
+    {
+        column->indicator_ = (uint16_t)indicator;
+
+        std::map<Indicator, std::string>::const_iterator it =
+            StatisticsStorage::IndicatorKeywords.find(indicator);
+        std::string keyword = (it == StatisticsStorage::IndicatorKeywords.end() ?
+            "indicator" + std::to_string((int)indicator) : it->second);
+        strncpy(column->keyword_, keyword.c_str(), sizeof(column->keyword_)-1);
+        column++;
+    }
+
+    data_ = (double*)((uint8_t*)addr + header_->dataOffset_);
+}
+
+StatRecorder::~StatRecorder()
+{
+    munmap(header_, fileSize_);
+}
+
+void
+StatRecorder::record(const StatisticsStorage::Snapshot& snapshot)
+{
+    uint64_t n = header_->nRecorded_;
+    size_t capacity = header_->capacity_;
+    double *value = data_ + n%capacity;
+
+    // readers must see that the oldest sample is being overwritten before
+    // any of its values change
+    __atomic_store_n(&header_->nStarted_, n+1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    for (auto indicator:columns_)
+    {
+        *value = snapshot[(size_t)indicator];
+        value += capacity;
+    }
+
+    // readers must not see sample counter ahead of sample values
+    __atomic_store_n(&header_->nRecorded_, n+1, __ATOMIC_RELEASE);
+}
+
+//******************************************************************************
+StatRecordReader::StatRecordReader(const std::string& fname):
+fileSize_(0), header_(nullptr), data_(nullptr)
+{
+    int fd = open(fname.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error(errorString("can't open", fname));
+
+    struct stat st;
+    void *addr = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(StatRecordHeader))
+    {
+        fileSize_ = st.st_size;
+        addr = mmap(nullptr, fileSize_, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+
+    if (addr == MAP_FAILED)
+        throw std::runtime_error(errorString("can't map", fname));
+
+    header_ = (const StatRecordHeader*)addr;
+
+    if (memcmp(header_->magic_, Magic, sizeof(Magic)) != 0 ||
+        header_->version_ != Version ||
+        header_->dataOffset_ < dataOffset(header_->nColumns_) ||
+        fileSize_ < header_->dataOffset_ + (size_t)header_->nColumns_*header_->capacity_*sizeof(double))
+    {
+        munmap((void*)header_, fileSize_);
+        throw std::runtime_error("not a .nstat file: " + fname);
+    }
+
+    const StatRecordColumn *column = (const StatRecordColumn*)(header_+1);
+    for (int i = 0; i < header_->nColumns_; ++i, ++column)
+        keywords_.push_back(std::string(column->keyword_,
+            strnlen(column->keyword_, sizeof(column->keyword_))));
+
+    data_ = (const double*)((const uint8_t*)addr + header_->dataOffset_);
+}
+
+StatRecordReader::~StatRecordReader()
+{
+    munmap((void*)header_, fileSize_);
+}
+
+size_t
+StatRecordReader::getSamplesNum() const
+{
+    uint64_t n = getRecordedNum();
+    return (n < header_->capacity_ ? n : header_->capacity_);
+}
+
+bool
+StatRecordReader::getSample(size_t idx, std::vector<double>& values) const
+{
+    uint64_t n = getRecordedNum();
+    size_t capacity = header_->capacity_;
+
+    if (idx >= (n < capacity ? n : capacity))
+        throw std::out_of_range("no such sample");
+
+    uint64_t sampleNo = (n > capacity ? n-capacity : 0) + idx;
+    const double *value = data_ + sampleNo%capacity;
+
+    values.resize(header_->nColumns_);
+    for (auto& v:values)
+    {
+        v = *value;
+        value += capacity;
+    }
+
+    // sample is torn if writer has started sample that reuses its slot
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return (__atomic_load_n(&header_->nStarted_, __ATOMIC_RELAXED) <= sampleNo+capacity);
+}
+
+#pragma mark - private
+uint64_t
+StatRecordReader::getRecordedNum() const
+{
+    return __atomic_load_n(&header_->nRecorded_, __ATOMIC_ACQUIRE);
+}
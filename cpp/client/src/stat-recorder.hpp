@@ -0,0 +1,131 @@
+//
+// stat-recorder.hpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#ifndef __stat_recorder_h__
+#define __stat_recorder_h__
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include <ndnrtc/statistics.hpp>
+
+/**
+ * Binary statistics recording (.nstat files).
+ * A file holds a fixed number of the most recent statistics samples of one
+ * stream. Columns are statistics indicators, fixed upon file creation;
+ * each value is a double. File is a ring: once it is full, new samples
+ * overwrite the oldest ones. File layout (host byte order):
+ *
+ *   header      magic "NSTR", version (uint16), number of columns (uint16),
+ *               capacity in samples (uint32), data offset (uint32),
+ *               number of samples ever recorded (uint64), number of
+ *               samples writer started to record (uint64)
+ *   columns     per column: indicator id (uint16) and NUL-padded keyword
+ *               (char[30]), see StatisticsStorage::IndicatorKeywords
+ *   data        per column: array of capacity values; sample N is stored
+ *               at index N % capacity of each array
+ *
+ * Number of started samples is updated before sample values are written
+ * and number of recorded samples - after, so a reader may read the file
+ * while it is being written to: after copying a sample, reader checks
+ * number of started samples again and discards the copy if the writer has
+ * wrapped around and started overwriting the sample meanwhile.
+ * See resources/nstat.py for Python reader.
+ */
+namespace ndnrtc {
+    namespace statistics {
+        typedef struct _StatRecordHeader {
+            char magic_[4];
+            uint16_t version_;
+            uint16_t nColumns_;
+            uint32_t capacity_;
+            uint32_t dataOffset_;
+            uint64_t nRecorded_;
+            uint64_t nStarted_;
+        } StatRecordHeader;
+
+        typedef struct _StatRecordColumn {
+            uint16_t indicator_;
+            char keyword_[30];
+        } StatRecordColumn;
+
+        /**
+         * Records statistics snapshots into memory-mapped .nstat file.
+         * Recording a sample is a copy of snapshot values into the mapped
+         * memory - no formatting, no allocations and no system calls.
+         */
+        class StatRecorder {
+        public:
+            /**
+             * Creates (truncates) file and maps it into memory.
+             * Throws if the file can not be created.
+             * @param fname File name
+             * @param columns Indicators to record
+             * @param capacity Number of samples file keeps
+             */
+            StatRecorder(const std::string& fname,
+                         const std::vector<Indicator>& columns,
+                         unsigned int capacity);
+            ~StatRecorder();
+
+            void record(const StatisticsStorage::Snapshot& snapshot);
+            uint64_t getRecordedNum() const { return header_->nRecorded_; }
+
+        private:
+            StatRecorder(const StatRecorder&) = delete;
+            void operator=(const StatRecorder&) = delete;
+
+            std::vector<Indicator> columns_;
+            size_t fileSize_;
+            StatRecordHeader *header_;
+            double *data_;
+        };
+
+        /**
+         * Reads .nstat file written by StatRecorder.
+         */
+        class StatRecordReader {
+        public:
+            /**
+             * Maps file into memory. Throws if the file can not be opened
+             * or it is not a valid .nstat file.
+             */
+            StatRecordReader(const std::string& fname);
+            ~StatRecordReader();
+
+            const std::vector<std::string>& getColumns() const { return keywords_; }
+
+            /**
+             * Number of samples available for reading, i.e. at most file
+             * capacity
+             */
+            size_t getSamplesNum() const;
+
+            /**
+             * Reads sample values; samples are indexed from the oldest
+             * available one.
+             * @return false if the sample was overwritten by the writer
+             *         while it was read, values are not valid then
+             */
+            bool getSample(size_t idx, std::vector<double>& values) const;
+
+        private:
+            StatRecordReader(const StatRecordReader&) = delete;
+            void operator=(const StatRecordReader&) = delete;
+
+            std::vector<std::string> keywords_;
+            size_t fileSize_;
+            const StatRecordHeader *header_;
+            const double *data_;
+
+            uint64_t getRecordedNum() const;
+        };
+    }
+}
+
+#endif
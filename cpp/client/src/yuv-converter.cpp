@@ -0,0 +1,197 @@
+//
+// yuv-converter.cpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include <string.h>
+
+#include "yuv-converter.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define YUV_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace
+{
+// BT.601 limited range, 8-bit fixed point:
+//  R = 1.164(Y-16) + 1.596(V-128)
+//  G = 1.164(Y-16) - 0.391(U-128) - 0.813(V-128)
+//  B = 1.164(Y-16) + 2.018(U-128)
+const int kY = 298, kVR = 409, kUG = 100, kVG = 208, kUB = 516;
+
+typedef unsigned int (*BgraRow)(const uint8_t *y, const uint8_t *u, const uint8_t *v,
+                                uint8_t *dst, unsigned int width);
+
+inline uint8_t clamp(int v)
+{
+    return (uint8_t)(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+// converts pixels [from, width) of a row
+void bgraRowScalar(const uint8_t *y, const uint8_t *u, const uint8_t *v,
+                   uint8_t *dst, unsigned int from, unsigned int width)
+{
+    for (unsigned int x = from; x < width; ++x)
+    {
+        int c = ((int)y[x] - 16) * kY;
+        int d = (int)u[x / 2] - 128;
+        int e = (int)v[x / 2] - 128;
+
+        dst[4 * x] = clamp((c + kUB * d + 128) >> 8);
+        dst[4 * x + 1] = clamp((c - kUG * d - kVG * e + 128) >> 8);
+        dst[4 * x + 2] = clamp((c + kVR * e + 128) >> 8);
+        dst[4 * x + 3] = 255;
+    }
+}
+
+unsigned int bgraRowNone(const uint8_t *, const uint8_t *, const uint8_t *,
+                         uint8_t *, unsigned int)
+{
+    return 0;
+}
+
+#ifdef YUV_X86_KERNELS
+// converts 8 pixels per iteration in 32-bit lanes, so that each lane
+// ends up holding one BGRA pixel; returns number of pixels converted
+__attribute__((target("avx2")))
+unsigned int bgraRowAvx2(const uint8_t *y, const uint8_t *u, const uint8_t *v,
+                         uint8_t *dst, unsigned int width)
+{
+    const __m256i c16 = _mm256_set1_epi32(16), c128 = _mm256_set1_epi32(128);
+    const __m256i zero = _mm256_setzero_si256(), c255 = _mm256_set1_epi32(255);
+    const __m256i alpha = _mm256_set1_epi32((int)0xff000000);
+    const __m256i ky = _mm256_set1_epi32(kY), kvr = _mm256_set1_epi32(kVR),
+                  kug = _mm256_set1_epi32(kUG), kvg = _mm256_set1_epi32(kVG),
+                  kub = _mm256_set1_epi32(kUB);
+    unsigned int x = 0;
+
+    for (; x + 8 <= width; x += 8)
+    {
+        int32_t u4, v4;
+        memcpy(&u4, u + x / 2, 4);
+        memcpy(&v4, v + x / 2, 4);
+
+        // each chroma sample covers two horizontal pixels
+        __m128i u8 = _mm_cvtsi32_si128(u4), v8 = _mm_cvtsi32_si128(v4);
+        __m256i uu = _mm256_sub_epi32(_mm256_cvtepu8_epi32(_mm_unpacklo_epi8(u8, u8)), c128);
+        __m256i vv = _mm256_sub_epi32(_mm256_cvtepu8_epi32(_mm_unpacklo_epi8(v8, v8)), c128);
+        __m256i yy = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(y + x)));
+        __m256i c = _mm256_add_epi32(_mm256_mullo_epi32(_mm256_sub_epi32(yy, c16), ky), c128);
+
+        __m256i b = _mm256_srai_epi32(_mm256_add_epi32(c, _mm256_mullo_epi32(uu, kub)), 8);
+        __m256i g = _mm256_srai_epi32(_mm256_sub_epi32(_mm256_sub_epi32(c, _mm256_mullo_epi32(uu, kug)),
+                                                       _mm256_mullo_epi32(vv, kvg)), 8);
+        __m256i r = _mm256_srai_epi32(_mm256_add_epi32(c, _mm256_mullo_epi32(vv, kvr)), 8);
+
+        b = _mm256_min_epi32(_mm256_max_epi32(b, zero), c255);
+        g = _mm256_min_epi32(_mm256_max_epi32(g, zero), c255);
+        r = _mm256_min_epi32(_mm256_max_epi32(r, zero), c255);
+
+        __m256i bgra = _mm256_or_si256(_mm256_or_si256(b, _mm256_slli_epi32(g, 8)),
+                                       _mm256_or_si256(_mm256_slli_epi32(r, 16), alpha));
+        _mm256_storeu_si256((__m256i *)(dst + 4 * x), bgra);
+    }
+
+    return x;
+}
+#endif
+
+class BgraKernel
+{
+  public:
+    BgraRow row_;
+    const char *name_;
+
+    BgraKernel() : row_(&bgraRowNone), name_("scalar")
+    {
+#ifdef YUV_X86_KERNELS
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+        {
+            row_ = &bgraRowAvx2;
+            name_ = "avx2";
+        }
+#endif
+    }
+};
+
+const BgraKernel &kernel()
+{
+    static BgraKernel k;
+    return k;
+}
+}
+
+//******************************************************************************
+void yuv::i420ToBgra(unsigned int width, unsigned int height,
+                     const uint8_t *y, unsigned int strideY,
+                     const uint8_t *u, unsigned int strideU,
+                     const uint8_t *v, unsigned int strideV,
+                     uint8_t *dst)
+{
+    BgraRow row = kernel().row_;
+
+    for (unsigned int line = 0; line < height; ++line)
+    {
+        const uint8_t *yRow = y + line * strideY;
+        const uint8_t *uRow = u + (line / 2) * strideU;
+        const uint8_t *vRow = v + (line / 2) * strideV;
+        uint8_t *dstRow = dst + (unsigned long)line * width * 4;
+
+        unsigned int done = row(yRow, uRow, vRow, dstRow, width);
+        bgraRowScalar(yRow, uRow, vRow, dstRow, done, width);
+    }
+}
+
+void yuv::i420ToI420(unsigned int width, unsigned int height,
+                     const uint8_t *y, unsigned int strideY,
+                     const uint8_t *u, unsigned int strideU,
+                     const uint8_t *v, unsigned int strideV,
+                     uint8_t *dst)
+{
+    unsigned int chromaWidth = (width + 1) / 2, chromaHeight = (height + 1) / 2;
+    uint8_t *dstU = dst + (unsigned long)width * height;
+    uint8_t *dstV = dstU + (unsigned long)chromaWidth * chromaHeight;
+
+    for (unsigned int line = 0; line < height; ++line)
+        memcpy(dst + (unsigned long)line * width, y + line * strideY, width);
+
+    for (unsigned int line = 0; line < chromaHeight; ++line)
+    {
+        memcpy(dstU + (unsigned long)line * chromaWidth, u + line * strideU, chromaWidth);
+        memcpy(dstV + (unsigned long)line * chromaWidth, v + line * strideV, chromaWidth);
+    }
+}
+
+void yuv::i420ToNv12(unsigned int width, unsigned int height,
+                     const uint8_t *y, unsigned int strideY,
+                     const uint8_t *u, unsigned int strideU,
+                     const uint8_t *v, unsigned int strideV,
+                     uint8_t *dst)
+{
+    unsigned int chromaWidth = (width + 1) / 2, chromaHeight = (height + 1) / 2;
+    uint8_t *dstUV = dst + (unsigned long)width * height;
+
+    for (unsigned int line = 0; line < height; ++line)
+        memcpy(dst + (unsigned long)line * width, y + line * strideY, width);
+
+    for (unsigned int line = 0; line < chromaHeight; ++line)
+    {
+        const uint8_t *uRow = u + line * strideU, *vRow = v + line * strideV;
+        uint8_t *uvRow = dstUV + (unsigned long)line * chromaWidth * 2;
+
+        for (unsigned int x = 0; x < chromaWidth; ++x)
+        {
+            uvRow[2 * x] = uRow[x];
+            uvRow[2 * x + 1] = vRow[x];
+        }
+    }
+}
+
+const char *yuv::getBgraKernelName()
+{
+    return kernel().name_;
+}
@@ -0,0 +1,68 @@
+//
+// yuv-converter.hpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#ifndef __yuv_converter_h__
+#define __yuv_converter_h__
+
+#include <stdint.h>
+
+/**
+ * Converters of decoded I420 frames into formats accepted by frame sinks.
+ * Source planes are passed as they come from the decoder (i.e. with
+ * arbitrary strides), destination buffers are tightly packed.
+ */
+namespace yuv
+{
+/**
+ * Converts I420 frame into packed 32-bit BGRA (bytes in memory are B, G, R, A,
+ * which is the same layout ConvertFromI420(..., kBGRA, ...) produces) using
+ * BT.601 limited range coefficients. Uses AVX2 if it's supported by the CPU.
+ * @param dst Destination buffer of width*height*4 bytes
+ */
+void i420ToBgra(unsigned int width, unsigned int height,
+                const uint8_t *y, unsigned int strideY,
+                const uint8_t *u, unsigned int strideU,
+                const uint8_t *v, unsigned int strideV,
+                uint8_t *dst);
+
+/**
+ * Copies I420 planes into tightly packed I420 buffer (Y plane followed by U
+ * and V planes).
+ * @param dst Destination buffer of i420Size(width, height) bytes
+ */
+void i420ToI420(unsigned int width, unsigned int height,
+                const uint8_t *y, unsigned int strideY,
+                const uint8_t *u, unsigned int strideU,
+                const uint8_t *v, unsigned int strideV,
+                uint8_t *dst);
+
+/**
+ * Converts I420 frame into NV12 (Y plane followed by interleaved UV plane).
+ * @param dst Destination buffer of i420Size(width, height) bytes
+ */
+void i420ToNv12(unsigned int width, unsigned int height,
+                const uint8_t *y, unsigned int strideY,
+                const uint8_t *u, unsigned int strideU,
+                const uint8_t *v, unsigned int strideV,
+                uint8_t *dst);
+
+/**
+ * Size of a tightly packed 4:2:0 frame (either I420 or NV12).
+ */
+inline unsigned long i420Size(unsigned int width, unsigned int height)
+{
+    return (unsigned long)width * height + 2 * (unsigned long)((width + 1) / 2) * ((height + 1) / 2);
+}
+
+/**
+ * Returns the name of the BGRA conversion kernel used on this machine
+ * ("avx2" or "scalar").
+ */
+const char *getBgraKernelName();
+}
+
+#endif
@@ -0,0 +1,657 @@
+//
+// benchmark-loopback.cc
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+// Self-contained end-to-end benchmark: publishes video stream with
+// LocalVideoStream and fetches it with RemoteVideoStream in the same
+// process, through in-process forwarder stand-in (see LoopbackForwarder)
+// with configurable loss, delay and jitter. Needs no NFD.
+//
+// Source video is deterministic: frames of resources/encoded.nrtc (or a
+// single frame of resources/vp8_640x480.frame) are decoded once upon start
+// and then fed to the producer in a loop at given frame rate.
+//
+// Results are written as JSON (to stdout unless -o is given):
+//   - end-to-end latency (capture to render) percentiles, ms;
+//   - captured and rendered frame rates;
+//   - CPU time per stage: capture thread, producer face thread, forwarder,
+//     consumer face thread and the rest of the process (encoders, decoders,
+//     signing), microseconds per frame; per-stage delays as reported by
+//     library statistics;
+//   - bytes per frame: published payload, published wire and received wire.
+// All metrics are collected during measurement period only, which starts
+// after the first frame is rendered and warm-up period passes.
+//
+// usage: benchmark-loopback [-t <measurement time, s>] [-w <warm-up time, s>]
+//          [-f <fps>] [-g <gop>] [-b <bitrate, Kbit/s>] [-l <loss ratio>]
+//          [-d <one-way delay, ms>] [-j <one-way jitter, ms>] [-s <seed>]
+//          [-i <source file>] [-c (BGRA rendering)] [-u (unsigned data)]
+//          [-a (with audio)] [-o <output file>] [-v <log file>]
+//          [-P <max p95 latency, ms>] [-F <min rendered fps>]
+//
+// Exit code is 0 on success, 1 if no frames were rendered and 2 if -P or -F
+// thresholds were not met, so the benchmark can be used for regression
+// checks. Audio (-a) requires capture and playout devices.
+//
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <map>
+#include <boost/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/lock_guard.hpp>
+#include <boost/atomic.hpp>
+#include <ndn-cpp/face.hpp>
+#include <ndn-cpp/security/key-chain.hpp>
+#include <ndn-cpp/security/identity/memory-identity-storage.hpp>
+#include <ndn-cpp/security/identity/memory-private-key-storage.hpp>
+#include <ndn-cpp/security/policy/self-verify-policy-manager.hpp>
+
+#include "include/local-stream.hpp"
+#include "include/remote-stream.hpp"
+#include "include/interfaces.hpp"
+#include "include/statistics.hpp"
+#include "include/simple-log.hpp"
+#include "src/video-decoder.hpp"
+#include "src/clock.hpp"
+#include "loopback-forwarder.hpp"
+
+using namespace ndn;
+using namespace ndnrtc;
+using namespace ndnrtc::statistics;
+using namespace ndnrtc::benchmark;
+
+namespace {
+    const std::string BasePrefix = "/ndnrtc/benchmark";
+    const std::string VideoStreamName = "camera";
+    const std::string VideoThreadName = "hd";
+    const std::string AudioStreamName = "mic";
+    const std::string AudioThreadName = "hd";
+
+    // header of a frame in *.frame file: buffer size, frame length
+    const size_t FrameHeaderSize = 8;
+    // header of each frame in *.nrtc file; frame length is at the same offset
+    const size_t NrtcHeaderSize = 49;
+    const size_t LengthOffset = 4;
+
+    typedef struct _Args {
+        unsigned int runTimeSec_, warmUpSec_;
+        unsigned int fps_, gop_, bitrate_;
+        LoopbackForwarder::LinkParams link_;
+        unsigned int seed_;
+        std::string source_, output_, logFile_;
+        bool bgra_, sign_, audio_;
+        double maxP95Ms_, minFps_;
+    } Args;
+
+    typedef struct _RawFrame {
+        unsigned int width_, height_;
+        std::vector<uint8_t> data_;     // I420, no padding
+    } RawFrame;
+
+    typedef struct _Measurement {
+        int64_t wallUsec_;
+        int64_t captureCpuUsec_, producerCpuUsec_, consumerCpuUsec_,
+            forwarderCpuUsec_, processCpuUsec_;
+        uint64_t nCaptured_, nRendered_;
+        StatisticsStorage::Snapshot producer_, consumer_;
+        LoopbackForwarder::Counters network_;
+    } Measurement;
+
+    int64_t cpuUsec(clockid_t cid)
+    {
+        struct timespec ts;
+        if (clock_gettime(cid, &ts) != 0)
+            return 0;
+        return (int64_t)ts.tv_sec*1000000 + ts.tv_nsec/1000;
+    }
+
+    int64_t threadCpuUsec(boost::thread& t)
+    {
+        clockid_t cid;
+        if (pthread_getcpuclockid(t.native_handle(), &cid) != 0)
+            return 0;
+        return cpuUsec(cid);
+    }
+
+    uint32_t readUint32(const std::vector<uint8_t>& buf, size_t offset)
+    {
+        return (uint32_t)buf[offset] | (uint32_t)buf[offset+1] << 8 |
+               (uint32_t)buf[offset+2] << 16 | (uint32_t)buf[offset+3] << 24;
+    }
+
+    // returns VP8 frames stored in *.frame or *.nrtc file
+    std::vector<std::vector<uint8_t>> readEncodedFrames(const std::string& path)
+    {
+        std::vector<std::vector<uint8_t>> frames;
+        std::ifstream f(path, std::ios::binary);
+        std::vector<uint8_t> buf((std::istreambuf_iterator<char>(f)),
+                                 std::istreambuf_iterator<char>());
+        bool isNrtc = (path.size() > 5 && path.substr(path.size()-5) == ".nrtc");
+        size_t headerSize = (isNrtc ? NrtcHeaderSize : FrameHeaderSize);
+
+        for (size_t offset = 0; offset + headerSize <= buf.size();)
+        {
+            uint32_t length = readUint32(buf, offset + LengthOffset);
+            if (offset + headerSize + length > buf.size())
+                break;
+
+            frames.push_back(std::vector<uint8_t>(buf.begin() + offset + headerSize,
+                                                  buf.begin() + offset + headerSize + length));
+            if (!isNrtc) break; // *.frame holds one frame followed by padding
+            offset += headerSize + length;
+        }
+
+        return frames;
+    }
+
+    // decodes source file into raw frames which are fed to the producer
+    std::vector<RawFrame> loadSource(const std::string& path)
+    {
+        std::vector<RawFrame> rawFrames;
+        VideoCoderParams vcp;
+        vcp.encodeWidth_ = 640;
+        vcp.encodeHeight_ = 480;
+
+        VideoDecoder decoder(vcp, [&rawFrames](const FrameInfo&, const WebRtcVideoFrame& frame){
+            WebRtcSmartPtr<webrtc::VideoFrameBuffer> b = frame.video_frame_buffer();
+            RawFrame raw;
+            int cw = (b->width()+1)/2, ch = (b->height()+1)/2;
+
+            raw.width_ = b->width();
+            raw.height_ = b->height();
+            raw.data_.reserve(b->width()*b->height() + 2*cw*ch);
+            for (int r = 0; r < b->height(); ++r)
+                raw.data_.insert(raw.data_.end(), b->DataY() + r*b->StrideY(),
+                                 b->DataY() + r*b->StrideY() + b->width());
+            for (int r = 0; r < ch; ++r)
+                raw.data_.insert(raw.data_.end(), b->DataU() + r*b->StrideU(),
+                                 b->DataU() + r*b->StrideU() + cw);
+            for (int r = 0; r < ch; ++r)
+                raw.data_.insert(raw.data_.end(), b->DataV() + r*b->StrideV(),
+                                 b->DataV() + r*b->StrideV() + cw);
+            rawFrames.push_back(std::move(raw));
+        });
+
+        std::vector<std::vector<uint8_t>> encoded = readEncodedFrames(path);
+        for (size_t i = 0; i < encoded.size(); ++i)
+        {
+            webrtc::EncodedImage image(encoded[i].data(), encoded[i].size(), encoded[i].size());
+            image._encodedWidth = vcp.encodeWidth_;
+            image._encodedHeight = vcp.encodeHeight_;
+            // VP8 frame tag: the lowest bit of the first byte is 0 for key frames
+            image._frameType = (encoded[i][0] & 1 ? webrtc::kVideoFrameDelta : webrtc::kVideoFrameKey);
+            image._completeFrame = true;
+            decoder.processFrame({0, (int)i, ""}, image);
+        }
+
+        return rawFrames;
+    }
+
+    std::shared_ptr<KeyChain> memoryKeyChain(const std::string& identity)
+    {
+        std::shared_ptr<MemoryIdentityStorage> identityStorage = std::make_shared<MemoryIdentityStorage>();
+        std::shared_ptr<MemoryPrivateKeyStorage> privateKeyStorage = std::make_shared<MemoryPrivateKeyStorage>();
+        std::shared_ptr<KeyChain> keyChain =
+            std::make_shared<KeyChain>(std::make_shared<IdentityManager>(identityStorage, privateKeyStorage),
+                                       std::make_shared<SelfVerifyPolicyManager>(identityStorage.get()));
+
+        keyChain->createIdentityAndCertificate(Name(identity));
+        keyChain->getIdentityManager()->setDefaultIdentity(Name(identity));
+
+        return keyChain;
+    }
+
+    /**
+     * Renderer, which measures capture-to-render latency of every frame
+     * rendered during measurement period.
+     */
+    class Renderer : public IExternalRenderer, public IExternalPlanarRenderer
+    {
+    public:
+        Renderer():nRendered_(0), firstRenderUsec_(0), isMeasuring_(false){}
+
+        void captured(int playbackNo, int64_t captureUsec)
+        {
+            boost::lock_guard<boost::mutex> scopedLock(mutex_);
+            captureUsec_[playbackNo] = captureUsec;
+        }
+
+        void setMeasuring(bool isMeasuring) { isMeasuring_ = isMeasuring; }
+        uint64_t getRenderedNum() const { return nRendered_; }
+        int64_t getFirstRenderUsec() const { return firstRenderUsec_; }
+
+        std::vector<double> getLatencies()
+        {
+            boost::lock_guard<boost::mutex> scopedLock(mutex_);
+            return latenciesMs_;
+        }
+
+        uint8_t* getFrameBuffer(int width, int height) override
+        {
+            bgraBuffer_.resize(width*height*4);
+            return bgraBuffer_.data();
+        }
+
+        void renderBGRAFrame(const FrameInfo& frameInfo, int, int, const uint8_t*) override
+        {
+            rendered(frameInfo);
+        }
+
+        void renderI420Frame(const FrameInfo& frameInfo, const unsigned int,
+                             const unsigned int, const unsigned int,
+                             const unsigned int, const unsigned int,
+                             const uint8_t*, const uint8_t*, const uint8_t*) override
+        {
+            rendered(frameInfo);
+        }
+
+    private:
+        boost::mutex mutex_;
+        std::map<int, int64_t> captureUsec_;
+        std::vector<double> latenciesMs_;
+        std::vector<uint8_t> bgraBuffer_;
+        boost::atomic<uint64_t> nRendered_;
+        boost::atomic<int64_t> firstRenderUsec_;
+        boost::atomic<bool> isMeasuring_;
+
+        void rendered(const FrameInfo& frameInfo)
+        {
+            int64_t now = clock::microsecondTimestamp();
+            boost::lock_guard<boost::mutex> scopedLock(mutex_);
+
+            if (!firstRenderUsec_) firstRenderUsec_ = now;
+
+            std::map<int, int64_t>::iterator it = captureUsec_.find(frameInfo.playbackNo_);
+            if (it != captureUsec_.end())
+            {
+                if (isMeasuring_)
+                {
+                    nRendered_++;
+                    latenciesMs_.push_back((double)(now - it->second)/1000.);
+                }
+                // frames are rendered in order, earlier ones won't show up
+                captureUsec_.erase(captureUsec_.begin(), ++it);
+            }
+        }
+    };
+
+    double percentile(const std::vector<double>& sorted, double p)
+    {
+        if (sorted.empty()) return 0;
+        size_t rank = (size_t)(p/100.*sorted.size() + 0.5);
+        return sorted[std::min(sorted.size()-1, (rank ? rank-1 : 0))];
+    }
+
+    double value(const StatisticsStorage::Snapshot& s, const Indicator& i)
+    {
+        return s[(size_t)i];
+    }
+
+    double diff(const StatisticsStorage::Snapshot& end, const StatisticsStorage::Snapshot& start,
+                const Indicator& i)
+    {
+        return value(end, i) - value(start, i);
+    }
+
+    double ratio(double a, double b)
+    {
+        return (b ? a/b : 0);
+    }
+
+    void writeReport(std::ostream& os, const Args& args, const Measurement& start,
+                     const Measurement& end, std::vector<double> latencies,
+                     int64_t bootstrapMs)
+    {
+        double periodSec = (double)(end.wallUsec_ - start.wallUsec_)/1000000.;
+        double nCaptured = (double)(end.nCaptured_ - start.nCaptured_);
+        double nRendered = (double)(end.nRendered_ - start.nRendered_);
+        double captureCpu = (double)(end.captureCpuUsec_ - start.captureCpuUsec_);
+        double producerCpu = (double)(end.producerCpuUsec_ - start.producerCpuUsec_);
+        double consumerCpu = (double)(end.consumerCpuUsec_ - start.consumerCpuUsec_);
+        double forwarderCpu = (double)(end.forwarderCpuUsec_ - start.forwarderCpuUsec_);
+        double otherCpu = (double)(end.processCpuUsec_ - start.processCpuUsec_) -
+                          captureCpu - producerCpu - consumerCpu - forwarderCpu;
+        double mean = 0;
+
+        std::sort(latencies.begin(), latencies.end());
+        for (auto l : latencies) mean += l;
+        mean = ratio(mean, latencies.size());
+
+        os << std::fixed << std::setprecision(3)
+           << "{" << std::endl
+           << "  \"config\": {"
+           << "\"periodSec\": " << periodSec
+           << ", \"fps\": " << args.fps_
+           << ", \"gop\": " << args.gop_
+           << ", \"bitrateKbps\": " << args.bitrate_
+           << ", \"lossRatio\": " << args.link_.lossRatio_
+           << ", \"delayMs\": " << args.link_.delayMs_
+           << ", \"jitterMs\": " << args.link_.jitterMs_
+           << ", \"seed\": " << args.seed_
+           << ", \"source\": \"" << args.source_ << "\""
+           << ", \"renderer\": \"" << (args.bgra_ ? "bgra" : "i420") << "\""
+           << ", \"signed\": " << (args.sign_ ? "true" : "false")
+           << "}," << std::endl
+           << "  \"latencyMs\": {"
+           << "\"p50\": " << percentile(latencies, 50)
+           << ", \"p90\": " << percentile(latencies, 90)
+           << ", \"p95\": " << percentile(latencies, 95)
+           << ", \"p99\": " << percentile(latencies, 99)
+           << ", \"max\": " << (latencies.size() ? latencies.back() : 0)
+           << ", \"mean\": " << mean
+           << ", \"bootstrap\": " << bootstrapMs
+           << "}," << std::endl
+           << "  \"fps\": {"
+           << "\"captured\": " << ratio(nCaptured, periodSec)
+           << ", \"published\": " << ratio(diff(end.producer_, start.producer_, Indicator::PublishedNum), periodSec)
+           << ", \"rendered\": " << ratio(nRendered, periodSec)
+           << "}," << std::endl
+           << "  \"cpuUsecPerFrame\": {"
+           << "\"capture\": " << ratio(captureCpu, nCaptured)
+           << ", \"producerFace\": " << ratio(producerCpu, nCaptured)
+           << ", \"forwarder\": " << ratio(forwarderCpu, nCaptured)
+           << ", \"consumerFace\": " << ratio(consumerCpu, nRendered)
+           << ", \"other\": " << ratio(otherCpu, nCaptured)
+           << "}," << std::endl
+           << "  \"stageDelayMs\": {"
+           << "\"scale\": " << value(end.producer_, Indicator::ScaleDelay)
+           << ", \"encode\": " << value(end.producer_, Indicator::EncodingDelay)
+           << ", \"parity\": " << value(end.producer_, Indicator::ParityDelay)
+           << ", \"publish\": " << value(end.producer_, Indicator::PublishDelay)
+           << ", \"sign\": " << value(end.producer_, Indicator::SignDelay)
+           << ", \"decodeQueue\": " << value(end.consumer_, Indicator::DecodeDelay)
+           << ", \"decode\": " << value(end.consumer_, Indicator::DecodingTime)
+           << "}," << std::endl
+           << "  \"bytesPerFrame\": {"
+           << "\"published\": " << ratio(diff(end.producer_, start.producer_, Indicator::BytesPublished),
+                                         diff(end.producer_, start.producer_, Indicator::PublishedNum))
+           << ", \"publishedWire\": " << ratio(diff(end.producer_, start.producer_, Indicator::RawBytesPublished),
+                                               diff(end.producer_, start.producer_, Indicator::PublishedNum))
+           << ", \"receivedWire\": " << ratio((double)(end.network_.dataBytes_ - start.network_.dataBytes_), nRendered)
+           << "}," << std::endl
+           << "  \"consumer\": {"
+           << "\"rebufferings\": " << (uint64_t)diff(end.consumer_, start.consumer_, Indicator::RebufferingsNum)
+           << ", \"skipped\": " << (uint64_t)diff(end.consumer_, start.consumer_, Indicator::SkippedNum)
+           << ", \"incomplete\": " << (uint64_t)diff(end.consumer_, start.consumer_, Indicator::IncompleteNum)
+           << ", \"recovered\": " << (uint64_t)diff(end.consumer_, start.consumer_, Indicator::RecoveredNum)
+           << ", \"timeouts\": " << (uint64_t)diff(end.consumer_, start.consumer_, Indicator::TimeoutsNum)
+           << ", \"interests\": " << (uint64_t)diff(end.consumer_, start.consumer_, Indicator::InterestsSentNum)
+           << "}," << std::endl
+           << "  \"network\": {"
+           << "\"interests\": " << end.network_.interestsNum_ - start.network_.interestsNum_
+           << ", \"interestsLost\": " << end.network_.interestsLostNum_ - start.network_.interestsLostNum_
+           << ", \"data\": " << end.network_.dataNum_ - start.network_.dataNum_
+           << ", \"dataLost\": " << end.network_.dataLostNum_ - start.network_.dataLostNum_
+           << ", \"unsolicited\": " << end.network_.unsolicitedNum_ - start.network_.unsolicitedNum_
+           << "}" << std::endl
+           << "}" << std::endl;
+    }
+
+    int run(const Args& args)
+    {
+        std::vector<RawFrame> frames = loadSource(args.source_);
+        if (frames.empty())
+        {
+            std::cerr << "can't decode source " << args.source_ << std::endl;
+            return 1;
+        }
+
+        std::shared_ptr<ndnlog::new_api::Logger> logger;
+        if (args.logFile_ != "")
+        {
+            ndnlog::new_api::Logger::initAsyncLogging();
+            logger = ndnlog::new_api::Logger::getLoggerPtr(args.logFile_);
+            logger->setLogLevel(ndnlog::NdnLoggerDetailLevelAll);
+        }
+
+        boost::asio::io_service producerIo, consumerIo;
+        std::shared_ptr<boost::asio::io_service::work>
+            producerWork(std::make_shared<boost::asio::io_service::work>(producerIo)),
+            consumerWork(std::make_shared<boost::asio::io_service::work>(consumerIo));
+        boost::thread producerThread([&producerIo](){ producerIo.run(); });
+        boost::thread consumerThread([&consumerIo](){ consumerIo.run(); });
+
+        LoopbackForwarder forwarder(args.link_, args.seed_);
+        std::shared_ptr<Face> producerFace = forwarder.createProducerFace(producerIo);
+        std::shared_ptr<Face> consumerFace = forwarder.createConsumerFace(consumerIo);
+        std::shared_ptr<KeyChain> keyChain = memoryKeyChain(BasePrefix);
+
+        Renderer renderer;
+        boost::atomic<uint64_t> nCaptured(0);
+        boost::atomic<bool> done(false);
+        Measurement start, end;
+        int64_t bootstrapMs = -1;
+
+        {
+            MediaStreamParams vp(VideoStreamName);
+            vp.type_ = MediaStreamParams::MediaStreamTypeVideo;
+            vp.producerParams_.segmentSize_ = 1000;
+
+            VideoThreadParams tp(VideoThreadName);
+            tp.coderParams_.codecFrameRate_ = args.fps_;
+            tp.coderParams_.gop_ = args.gop_;
+            tp.coderParams_.startBitrate_ = args.bitrate_;
+            tp.coderParams_.maxBitrate_ = args.bitrate_;
+            tp.coderParams_.encodeWidth_ = frames[0].width_;
+            tp.coderParams_.encodeHeight_ = frames[0].height_;
+            tp.coderParams_.dropFramesOn_ = false;
+            vp.addMediaThread(tp);
+
+            MediaStreamSettings vs(producerIo, vp);
+            vs.sign_ = args.sign_;
+            vs.face_ = producerFace.get();
+            vs.keyChain_ = keyChain.get();
+            LocalVideoStream localVideo(BasePrefix, vs);
+
+            std::shared_ptr<LocalAudioStream> localAudio;
+            std::shared_ptr<RemoteAudioStream> remoteAudio;
+            if (args.audio_)
+            {
+                MediaStreamParams ap(AudioStreamName);
+                ap.type_ = MediaStreamParams::MediaStreamTypeAudio;
+                ap.producerParams_.segmentSize_ = 1000;
+                ap.captureDevice_.deviceId_ = 0;
+                ap.addMediaThread(AudioThreadParams(AudioThreadName, "opus"));
+
+                MediaStreamSettings as(producerIo, ap);
+                as.sign_ = args.sign_;
+                as.face_ = producerFace.get();
+                as.keyChain_ = keyChain.get();
+                localAudio = std::make_shared<LocalAudioStream>(BasePrefix, as);
+                localAudio->start();
+            }
+
+            if (logger)
+            {
+                localVideo.setLogger(logger);
+                if (localAudio) localAudio->setLogger(logger);
+            }
+
+            boost::thread captureThread([&](){
+                boost::chrono::steady_clock::time_point next = boost::chrono::steady_clock::now();
+                boost::chrono::microseconds interval(1000000/args.fps_);
+
+                for (size_t i = 0; !done; ++i)
+                {
+                    const RawFrame& f = frames[i % frames.size()];
+                    unsigned int cw = (f.width_+1)/2, ch = (f.height_+1)/2;
+                    const uint8_t *y = f.data_.data();
+                    const uint8_t *u = y + f.width_*f.height_;
+                    const uint8_t *v = u + cw*ch;
+                    int64_t captureUsec = clock::microsecondTimestamp();
+
+                    int playbackNo = localVideo.incomingI420Frame(f.width_, f.height_, f.width_, cw, cw, y, u, v);
+                    if (playbackNo >= 0)
+                        renderer.captured(playbackNo, captureUsec);
+                    nCaptured++;
+
+                    next += interval;
+                    boost::this_thread::sleep_until(next);
+                }
+            });
+
+            RemoteVideoStream remoteVideo(consumerIo, consumerFace, keyChain, BasePrefix, VideoStreamName);
+            if (logger) remoteVideo.setLogger(logger);
+
+            // start fetching once stream meta is published and fetched
+            for (int i = 0; i < 100 && !remoteVideo.isMetaFetched(); ++i)
+                boost::this_thread::sleep_for(boost::chrono::milliseconds(100));
+
+            if (remoteVideo.isMetaFetched())
+            {
+                int64_t fetchStartUsec = clock::microsecondTimestamp();
+                if (args.bgra_)
+                    remoteVideo.start(VideoThreadName, static_cast<IExternalRenderer*>(&renderer));
+                else
+                    remoteVideo.start(VideoThreadName, static_cast<IExternalPlanarRenderer*>(&renderer));
+
+                if (args.audio_)
+                {
+                    remoteAudio = std::make_shared<RemoteAudioStream>(consumerIo, consumerFace, keyChain,
+                                                                      BasePrefix, AudioStreamName);
+                    if (logger) remoteAudio->setLogger(logger);
+                    remoteAudio->start(AudioThreadName);
+                }
+
+                for (int i = 0; i < 100 && !renderer.getFirstRenderUsec(); ++i)
+                    boost::this_thread::sleep_for(boost::chrono::milliseconds(100));
+                if (renderer.getFirstRenderUsec())
+                    bootstrapMs = (renderer.getFirstRenderUsec() - fetchStartUsec)/1000;
+            }
+
+            if (bootstrapMs >= 0)
+            {
+                boost::this_thread::sleep_for(boost::chrono::seconds(args.warmUpSec_));
+
+                std::function<void(Measurement&)> measure = [&](Measurement& s){
+                    s.wallUsec_ = clock::microsecondTimestamp();
+                    s.captureCpuUsec_ = threadCpuUsec(captureThread);
+                    s.producerCpuUsec_ = threadCpuUsec(producerThread);
+                    s.consumerCpuUsec_ = threadCpuUsec(consumerThread);
+                    s.forwarderCpuUsec_ = forwarder.getCpuUsec();
+                    s.processCpuUsec_ = cpuUsec(CLOCK_PROCESS_CPUTIME_ID);
+                    s.nCaptured_ = nCaptured;
+                    s.nRendered_ = renderer.getRenderedNum();
+                    localVideo.getStatistics().snapshot(s.producer_);
+                    remoteVideo.getStatistics().snapshot(s.consumer_);
+                    s.network_ = forwarder.getCounters();
+                };
+
+                measure(start);
+                renderer.setMeasuring(true);
+                boost::this_thread::sleep_for(boost::chrono::seconds(args.runTimeSec_));
+                renderer.setMeasuring(false);
+                measure(end);
+            }
+
+            done = true;
+            captureThread.join();
+
+            if (remoteAudio) remoteAudio->stop();
+            if (localAudio) localAudio->stop();
+            remoteVideo.stop();
+        }
+
+        producerIo.dispatch([producerFace]{ producerFace->shutdown(); });
+        consumerIo.dispatch([consumerFace]{ consumerFace->shutdown(); });
+        producerWork.reset();
+        consumerWork.reset();
+        producerIo.stop();
+        consumerIo.stop();
+        producerThread.join();
+        consumerThread.join();
+        forwarder.stop();
+
+        if (bootstrapMs < 0)
+        {
+            std::cerr << "no frames rendered" << std::endl;
+            return 1;
+        }
+
+        std::vector<double> latencies = renderer.getLatencies();
+        if (args.output_ != "")
+        {
+            std::ofstream f(args.output_);
+            writeReport(f, args, start, end, latencies, bootstrapMs);
+        }
+        else
+            writeReport(std::cout, args, start, end, latencies, bootstrapMs);
+
+        std::sort(latencies.begin(), latencies.end());
+        double fps = ratio((double)(end.nRendered_ - start.nRendered_),
+                           (double)(end.wallUsec_ - start.wallUsec_)/1000000.);
+
+        if ((args.maxP95Ms_ > 0 && percentile(latencies, 95) > args.maxP95Ms_) ||
+            (args.minFps_ > 0 && fps < args.minFps_))
+        {
+            std::cerr << "thresholds not met: p95 " << percentile(latencies, 95)
+                      << "ms, fps " << fps << std::endl;
+            return 2;
+        }
+
+        return 0;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    Args args = {10, 2, 30, 30, 1000, {0, 0, 0}, 0,
+                 "resources/encoded.nrtc", "", "", false, true, false, 0, 0};
+    int c;
+
+    opterr = 0;
+    while ((c = getopt(argc, argv, "t:w:f:g:b:l:d:j:s:i:o:v:P:F:cua")) != -1)
+        switch (c)
+        {
+        case 't': args.runTimeSec_ = (unsigned int)atoi(optarg); break;
+        case 'w': args.warmUpSec_ = (unsigned int)atoi(optarg); break;
+        case 'f': args.fps_ = (unsigned int)atoi(optarg); break;
+        case 'g': args.gop_ = (unsigned int)atoi(optarg); break;
+        case 'b': args.bitrate_ = (unsigned int)atoi(optarg); break;
+        case 'l': args.link_.lossRatio_ = atof(optarg); break;
+        case 'd': args.link_.delayMs_ = (unsigned int)atoi(optarg); break;
+        case 'j': args.link_.jitterMs_ = (unsigned int)atoi(optarg); break;
+        case 's': args.seed_ = (unsigned int)atoi(optarg); break;
+        case 'i': args.source_ = optarg; break;
+        case 'o': args.output_ = optarg; break;
+        case 'v': args.logFile_ = optarg; break;
+        case 'P': args.maxP95Ms_ = atof(optarg); break;
+        case 'F': args.minFps_ = atof(optarg); break;
+        case 'c': args.bgra_ = true; break;
+        case 'u': args.sign_ = false; break;
+        case 'a': args.audio_ = true; break;
+        case '?':
+            if (isprint(optopt))
+                fprintf(stderr, "Unknown option or missing argument `-%c'.\n", optopt);
+            else
+                fprintf(stderr, "Unknown option character `\\x%x'.\n", optopt);
+            return 1;
+        default:
+            abort();
+        }
+
+    if (!args.runTimeSec_ || !args.fps_ || !args.gop_)
+    {
+        std::cout << "usage: " << argv[0] << " [-t <measurement time, s>] [-w <warm-up time, s>] "
+                                             "[-f <fps>] [-g <gop>] [-b <bitrate, Kbit/s>] [-l <loss ratio>] "
+                                             "[-d <one-way delay, ms>] [-j <one-way jitter, ms>] [-s <seed>] "
+                                             "[-i <source file>] [-c (BGRA rendering)] [-u (unsigned data)] "
+                                             "[-a (with audio)] [-o <output file>] [-v <log file>] "
+                                             "[-P <max p95 latency, ms>] [-F <min rendered fps>]"
+                  << std::endl;
+        return 1;
+    }
+
+    return run(args);
+}
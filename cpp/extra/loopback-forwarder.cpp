@@ -0,0 +1,286 @@
+//
+// loopback-forwarder.cpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include "loopback-forwarder.hpp"
+
+#include <pthread.h>
+#include <time.h>
+#include <algorithm>
+#include <boost/asio/steady_timer.hpp>
+#include <ndn-cpp/threadsafe-face.hpp>
+#include <ndn-cpp/interest.hpp>
+#include <ndn-cpp/data.hpp>
+#include <ndn-cpp/transport/transport.hpp>
+#include <ndn-cpp/encoding/element-listener.hpp>
+
+#include "src/clock.hpp"
+
+using namespace ndn;
+using namespace ndnrtc;
+using namespace ndnrtc::benchmark;
+
+namespace {
+    // NDN TLV packet types
+    const uint8_t TlvInterest = 0x05;
+    const uint8_t TlvData = 0x06;
+
+    // used when Interest has no lifetime set
+    const int64_t DefaultInterestLifetimeMs = 4000;
+}
+
+namespace ndnrtc {
+    namespace benchmark {
+        /**
+         * Transport of a face, connected to loopback forwarder. Outgoing
+         * packets are handed to the forwarder, incoming packets are passed
+         * to the face on face's io_service thread, as asynchronous
+         * transports do.
+         */
+        class LoopbackTransport : public Transport,
+                                  public std::enable_shared_from_this<LoopbackTransport>
+        {
+        public:
+            LoopbackTransport(boost::asio::io_service& io,
+                              LoopbackForwarder& forwarder,
+                              bool isProducer):
+            io_(io), forwarder_(forwarder), isProducer_(isProducer),
+            isConnected_(false), elementListener_(nullptr){}
+
+            bool isProducer() const { return isProducer_; }
+
+            bool isLocal(const Transport::ConnectionInfo&) override { return true; }
+            bool isAsync() override { return true; }
+
+            void connect(const Transport::ConnectionInfo&,
+                         ElementListener& elementListener,
+                         const OnConnected& onConnected) override
+            {
+                elementListener_ = &elementListener;
+                isConnected_ = true;
+                if (onConnected) io_.post(onConnected);
+            }
+
+            void send(const uint8_t *data, size_t dataLength) override
+            {
+                if (isConnected_)
+                    forwarder_.send(shared_from_this(),
+                                    std::make_shared<const std::vector<uint8_t>>(data, data+dataLength));
+            }
+
+            void processEvents() override {}
+            bool getIsConnected() override { return isConnected_; }
+            void close() override { isConnected_ = false; }
+
+            void receive(const std::shared_ptr<const std::vector<uint8_t>>& packet)
+            {
+                std::weak_ptr<LoopbackTransport> me = shared_from_this();
+                io_.post([me, packet](){
+                    std::shared_ptr<LoopbackTransport> transport = me.lock();
+                    if (transport && transport->isConnected_ && transport->elementListener_)
+                        transport->elementListener_->onReceivedElement(packet->data(), packet->size());
+                });
+            }
+
+        private:
+            boost::asio::io_service& io_;
+            LoopbackForwarder& forwarder_;
+            bool isProducer_;
+            std::atomic<bool> isConnected_;
+            ElementListener *elementListener_;
+        };
+    }
+}
+
+//******************************************************************************
+LoopbackForwarder::LoopbackForwarder(const LinkParams& params, unsigned int seed):
+params_(params),
+work_(std::make_shared<boost::asio::io_service::work>(io_)),
+rng_(seed),
+interestsNum_(0), interestsLostNum_(0), dataNum_(0),
+dataLostNum_(0), dataBytes_(0), unsolicitedNum_(0)
+{
+    thread_ = boost::thread([this](){
+        io_.run();
+    });
+}
+
+LoopbackForwarder::~LoopbackForwarder()
+{
+    stop();
+}
+
+std::shared_ptr<Face>
+LoopbackForwarder::createProducerFace(boost::asio::io_service& io)
+{
+    return createFace(io, true);
+}
+
+std::shared_ptr<Face>
+LoopbackForwarder::createConsumerFace(boost::asio::io_service& io)
+{
+    return createFace(io, false);
+}
+
+LoopbackForwarder::Counters
+LoopbackForwarder::getCounters() const
+{
+    return { interestsNum_, interestsLostNum_, dataNum_,
+             dataLostNum_, dataBytes_, unsolicitedNum_ };
+}
+
+int64_t
+LoopbackForwarder::getCpuUsec()
+{
+    clockid_t cid;
+    struct timespec ts;
+
+    if (!thread_.joinable() ||
+        pthread_getcpuclockid(thread_.native_handle(), &cid) != 0 ||
+        clock_gettime(cid, &ts) != 0)
+        return 0;
+
+    return (int64_t)ts.tv_sec*1000000 + ts.tv_nsec/1000;
+}
+
+void
+LoopbackForwarder::stop()
+{
+    if (thread_.joinable())
+    {
+        work_.reset();
+        io_.stop();
+        thread_.join();
+    }
+}
+
+#pragma mark - private
+std::shared_ptr<Face>
+LoopbackForwarder::createFace(boost::asio::io_service& io, bool isProducer)
+{
+    std::shared_ptr<LoopbackTransport> transport =
+        std::make_shared<LoopbackTransport>(io, *this, isProducer);
+
+    if (isProducer)
+        io_.post([this, transport](){
+            producers_.push_back(transport);
+        });
+
+    return std::make_shared<ThreadsafeFace>(io, transport,
+                                            std::make_shared<Transport::ConnectionInfo>());
+}
+
+void
+LoopbackForwarder::send(const std::shared_ptr<LoopbackTransport>& from, const Packet& packet)
+{
+    if (packet->empty())
+        return;
+
+    io_.post([this, from, packet](){
+        // anything else (e.g. NDNLPv2 Nacks) is not forwarded
+        if ((*packet)[0] == TlvInterest && !from->isProducer())
+            onInterest(from, packet);
+        else if ((*packet)[0] == TlvData && from->isProducer())
+            onData(packet);
+    });
+}
+
+void
+LoopbackForwarder::onInterest(const std::shared_ptr<LoopbackTransport>& from, const Packet& packet)
+{
+    std::shared_ptr<Interest> interest = std::make_shared<Interest>();
+    interest->wireDecode(packet->data(), packet->size());
+
+    interestsNum_++;
+    if (isLost())
+    {
+        interestsLostNum_++;
+        return;
+    }
+
+    int64_t lifetimeMs = (interest->getInterestLifetimeMilliseconds() >= 0 ?
+                          (int64_t)interest->getInterestLifetimeMilliseconds() :
+                          DefaultInterestLifetimeMs);
+    pit_.push_back({ interest, from, clock::millisecondTimestamp() + lifetimeMs });
+
+    for (auto& p : producers_)
+        deliver(p, packet);
+}
+
+void
+LoopbackForwarder::onData(const Packet& packet)
+{
+    Data data;
+    data.wireDecode(packet->data(), packet->size());
+
+    int64_t now = clock::millisecondTimestamp();
+    std::vector<std::shared_ptr<LoopbackTransport>> downstreams;
+
+    for (std::vector<PitEntry>::iterator it = pit_.begin(); it != pit_.end();)
+    {
+        if (it->expirationMs_ < now)
+            it = pit_.erase(it);
+        else if (it->interest_->matchesData(data))
+        {
+            std::shared_ptr<LoopbackTransport> downstream = it->downstream_.lock();
+            if (downstream &&
+                std::find(downstreams.begin(), downstreams.end(), downstream) == downstreams.end())
+                downstreams.push_back(downstream);
+            it = pit_.erase(it);
+        }
+        else
+            ++it;
+    }
+
+    if (downstreams.empty())
+    {
+        unsolicitedNum_++;
+        return;
+    }
+
+    for (auto& d : downstreams)
+    {
+        dataNum_++;
+        if (isLost())
+            dataLostNum_++;
+        else
+        {
+            dataBytes_ += packet->size();
+            deliver(d, packet);
+        }
+    }
+}
+
+bool
+LoopbackForwarder::isLost()
+{
+    return (params_.lossRatio_ > 0 &&
+            std::uniform_real_distribution<double>(0, 1)(rng_) < params_.lossRatio_);
+}
+
+void
+LoopbackForwarder::deliver(const std::weak_ptr<LoopbackTransport>& to, const Packet& packet)
+{
+    int delayMs = params_.delayMs_;
+    if (params_.jitterMs_)
+        delayMs += std::uniform_int_distribution<int>(-(int)params_.jitterMs_,
+                                                      params_.jitterMs_)(rng_);
+
+    if (delayMs <= 0)
+    {
+        std::shared_ptr<LoopbackTransport> transport = to.lock();
+        if (transport) transport->receive(packet);
+        return;
+    }
+
+    std::shared_ptr<boost::asio::steady_timer> timer =
+        std::make_shared<boost::asio::steady_timer>(io_);
+    timer->expires_from_now(std::chrono::milliseconds(delayMs));
+    timer->async_wait([timer, to, packet](const boost::system::error_code& e){
+        std::shared_ptr<LoopbackTransport> transport = to.lock();
+        if (!e && transport) transport->receive(packet);
+    });
+}
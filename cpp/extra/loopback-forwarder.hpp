@@ -0,0 +1,120 @@
+//
+// loopback-forwarder.hpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#ifndef __loopback_forwarder_hpp__
+#define __loopback_forwarder_hpp__
+
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <random>
+#include <vector>
+#include <boost/asio.hpp>
+#include <boost/thread.hpp>
+
+namespace ndn {
+    class Face;
+    class Interest;
+}
+
+namespace ndnrtc {
+    namespace benchmark {
+        class LoopbackTransport;
+
+        /**
+         * In-process stand-in for an NDN forwarder. Connects producer and
+         * consumer faces (ndn::ThreadsafeFace objects running on caller's
+         * io_services) through a link with configurable loss, delay and
+         * jitter. Packets are passed in wire format, so faces encode and
+         * decode them as they would do with a real forwarder.
+         * Forwarding is trivial: consumers' Interests go to all producer
+         * faces and are kept in PIT; producers' Data goes to consumer faces
+         * that have matching Interests in PIT. Each Interest and Data
+         * packet is lost independently with given probability; delivered
+         * packets are delayed by delayMs_ +/- jitterMs_ (uniformly), hence
+         * may be reordered. Random generator is seeded explicitly, so runs
+         * with the same parameters and the same seed lose the same packets.
+         * Forwarder runs on its own thread.
+         */
+        class LoopbackForwarder {
+        public:
+            typedef struct _LinkParams {
+                double lossRatio_;          // probability of a packet loss
+                unsigned int delayMs_;      // one-way delay
+                unsigned int jitterMs_;     // one-way delay deviation
+            } LinkParams;
+
+            typedef struct _Counters {
+                uint64_t interestsNum_, interestsLostNum_;
+                uint64_t dataNum_, dataLostNum_, dataBytes_;
+                uint64_t unsolicitedNum_;   // Data without pending Interests
+            } Counters;
+
+            LoopbackForwarder(const LinkParams& params, unsigned int seed = 0);
+            ~LoopbackForwarder();
+
+            /**
+             * Creates face which receives consumers' Interests. Face
+             * callbacks are called on provided io_service's thread.
+             */
+            std::shared_ptr<ndn::Face> createProducerFace(boost::asio::io_service& io);
+
+            /**
+             * Creates face which expresses Interests to producer faces.
+             */
+            std::shared_ptr<ndn::Face> createConsumerFace(boost::asio::io_service& io);
+
+            Counters getCounters() const;
+
+            /**
+             * CPU time spent by forwarder's thread so far, microseconds
+             */
+            int64_t getCpuUsec();
+
+            /**
+             * Stops forwarder's thread; packets in flight are discarded.
+             * Called upon destruction.
+             */
+            void stop();
+
+        private:
+            friend class LoopbackTransport;
+
+            typedef std::shared_ptr<const std::vector<uint8_t>> Packet;
+            typedef struct _PitEntry {
+                std::shared_ptr<ndn::Interest> interest_;
+                std::weak_ptr<LoopbackTransport> downstream_;
+                int64_t expirationMs_;
+            } PitEntry;
+
+            LinkParams params_;
+            boost::asio::io_service io_;
+            std::shared_ptr<boost::asio::io_service::work> work_;
+            boost::thread thread_;
+            std::mt19937 rng_;
+            std::vector<std::weak_ptr<LoopbackTransport>> producers_;
+            std::vector<PitEntry> pit_;
+            std::atomic<uint64_t> interestsNum_, interestsLostNum_, dataNum_,
+                dataLostNum_, dataBytes_, unsolicitedNum_;
+
+            LoopbackForwarder(const LoopbackForwarder&) = delete;
+            void operator=(const LoopbackForwarder&) = delete;
+
+            std::shared_ptr<ndn::Face> createFace(boost::asio::io_service& io, bool isProducer);
+
+            // called by transports on faces' threads
+            void send(const std::shared_ptr<LoopbackTransport>& from, const Packet& packet);
+
+            void onInterest(const std::shared_ptr<LoopbackTransport>& from, const Packet& packet);
+            void onData(const Packet& packet);
+            bool isLost();
+            void deliver(const std::weak_ptr<LoopbackTransport>& to, const Packet& packet);
+        };
+    }
+}
+
+#endif
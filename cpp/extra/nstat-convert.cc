@@ -0,0 +1,113 @@
+//
+// nstat-convert.cc
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+// Converts binary statistics file recorded by ndnrtc-client (-r option) into
+// the same text format as .stat files, one sample per line, from the oldest
+// sample to the latest:
+//
+//   CSV (default)  tab-separated, with header line
+//   JSON (-j)      one compact JSON object per line
+//
+// usage: nstat-convert [-j] [-p <precision>] <.nstat file> [<keyword> ...]
+//
+// If keywords are given, only these statistics (and timestamp) are output.
+//
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <algorithm>
+#include <iostream>
+#include <map>
+
+#include "client/src/stat-collector.hpp"
+#include "client/src/stat-recorder.hpp"
+
+using namespace ndnrtc::statistics;
+
+int main(int argc, char **argv)
+{
+    bool json = false;
+    unsigned int precision = 2;
+    int c;
+
+    while ((c = getopt(argc, argv, "jp:")) != -1)
+        switch (c)
+        {
+        case 'j':
+            json = true;
+            break;
+        case 'p':
+            precision = (unsigned int)atoi(optarg);
+            break;
+        default:
+            std::cout << "usage: " << argv[0]
+                      << " [-j] [-p <precision>] <.nstat file> [<keyword> ...]" << std::endl;
+            return 1;
+        }
+
+    if (optind >= argc)
+    {
+        std::cout << "usage: " << argv[0]
+                  << " [-j] [-p <precision>] <.nstat file> [<keyword> ...]" << std::endl;
+        return 1;
+    }
+
+    try
+    {
+        StatRecordReader reader(argv[optind]);
+        const std::vector<std::string>& columns = reader.getColumns();
+        std::vector<std::string> order;
+        std::vector<size_t> columnIdx;
+
+        if (optind+1 < argc && std::find(argv+optind+1, argv+argc, std::string("timestamp")) == argv+argc)
+            order.push_back("timestamp");
+        for (int i = optind+1; i < argc; ++i)
+            order.push_back(argv[i]);
+        if (order.empty())
+            order = columns;
+
+        for (auto& kw:order)
+        {
+            std::vector<std::string>::const_iterator it = std::find(columns.begin(), columns.end(), kw);
+            if (it == columns.end())
+            {
+                std::cerr << "no " << kw << " statistics in " << argv[optind] << std::endl;
+                return 1;
+            }
+            columnIdx.push_back(it-columns.begin());
+        }
+
+        std::shared_ptr<StatWriter::IMetricFormatter> formatter;
+        if (json)
+            formatter = std::make_shared<JsonFormatter>(precision);
+        else
+            formatter = std::make_shared<CsvFormatter>(precision);
+
+        std::map<std::string, double> metrics;
+        std::vector<double> sample;
+
+        for (auto& kw:order)
+            metrics[kw] = 0;
+        std::cout << formatter->getHeader(metrics, order);
+
+        for (size_t i = 0; i < reader.getSamplesNum(); ++i)
+        {
+            // skip samples overwritten while being read
+            if (!reader.getSample(i, sample))
+                continue;
+            for (size_t k = 0; k < order.size(); ++k)
+                metrics[order[k]] = sample[columnIdx[k]];
+            std::cout << (*formatter)(metrics, order) << std::endl;
+        }
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,75 @@
+//
+// trace-decode.cc
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+// Decodes binary event trace written by ndnrtc::trace::Tracer::dump() into
+// tab-separated text, one event per line, ordered by time:
+//
+//   <unix time, ms> <thread> <event> <sample no> <segment no> <flags> <arg>
+//
+// usage: trace-decode <trace file> [<sample number>]
+//
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <inttypes.h>
+#include <algorithm>
+#include <iostream>
+
+#include "include/event-trace.hpp"
+
+using namespace ndnrtc::trace;
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::cout << "usage: " << argv[0] << " <trace file> [<sample number>]" << std::endl;
+        return 1;
+    }
+
+    std::vector<ThreadTrace> traces;
+    int64_t unixOffsetUsec;
+
+    if (!Tracer::read(argv[1], traces, unixOffsetUsec))
+    {
+        std::cerr << "can't read trace file " << argv[1] << std::endl;
+        return 1;
+    }
+
+    bool filterSample = (argc > 2);
+    int32_t sampleNo = (filterSample ? atoi(argv[2]) : 0);
+
+    // (record, thread index)
+    std::vector<std::pair<Record, size_t>> records;
+    for (size_t i = 0; i < traces.size(); ++i)
+        for (auto& r:traces[i].records_)
+            if (!filterSample || r.sampleNo_ == sampleNo)
+                records.push_back(std::make_pair(r, i));
+
+    std::stable_sort(records.begin(), records.end(),
+        [](const std::pair<Record, size_t>& a, const std::pair<Record, size_t>& b){
+            return a.first.timestampUsec_ < b.first.timestampUsec_;
+        });
+
+    for (auto& p:records)
+    {
+        const Record& r = p.first;
+        printf("%.3f\t%zu\t%s\t%d\t%d\t%s%s\t%u\n",
+               (double)(r.timestampUsec_ + unixOffsetUsec)/1000.,
+               p.second,
+               Tracer::toString((Event)r.event_).c_str(),
+               r.sampleNo_, r.segNo_,
+               (r.flags_ & FlagKey ? "K" : "D"),
+               (r.flags_ & FlagParity ? "P" : ""),
+               r.arg_);
+    }
+
+    for (size_t i = 0; i < traces.size(); ++i)
+        fprintf(stderr, "thread %zu (%" PRIx64 "): %zu records\n", i,
+                traces[i].threadId_, traces[i].records_.size());
+
+    return 0;
+}
@@ -0,0 +1,142 @@
+//
+// consumer-runtime.hpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#ifndef __consumer_runtime_hpp__
+#define __consumer_runtime_hpp__
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include <boost/asio.hpp>
+
+namespace ndn {
+    class Face;
+    class KeyChain;
+}
+
+namespace ndnlog {
+    namespace new_api {
+        class Logger;
+    }
+}
+
+namespace ndnrtc {
+    class ConsumerRuntimeImpl;
+    class RemoteStream;
+    class RemoteVideoStream;
+    class RemoteAudioStream;
+
+    /**
+     * Consumer runtime runs remote streams on a pool of io threads -
+     * "shards". Each shard has its own io_service, thread that runs it and
+     * ndn::Face, thus streams placed on different shards fetch, assemble and
+     * play out samples in parallel. All processing of a stream (and all
+     * callbacks of its observers) happen on its shard's thread.
+     * Streams are placed on the least loaded shard, unless a shard is given
+     * explicitly upon stream creation.
+     * Streams on different shards may share one key chain; as key chains
+     * are not thread-safe, data verification with a shared key chain is
+     * serialized. Give streams separate key chains to verify in parallel.
+     * Remote streams created by the runtime are regular RemoteVideoStream
+     * and RemoteAudioStream objects; however, they must be stopped and
+     * released before the runtime is destroyed.
+     */
+    class ConsumerRuntime {
+    public:
+        static const int AnyShard = -1;
+
+        typedef struct _ShardStats {
+            unsigned int shardNo_;
+            size_t nStreams_;           // streams, currently placed on shard
+            double cpuUsage_;           // CPU time of shard's thread during last
+                                        // stats period, share of one core
+            int64_t ioDelayUsec_;       // how late shard's thread picked up
+                                        // last stats timer (or how overdue
+                                        // it is now), i.e. how long handlers
+                                        // wait in shard's queue
+            int64_t maxIoDelayUsec_;    // the worst ioDelayUsec_ observed
+        } ShardStats;
+
+        /**
+         * Creates runtime and starts shards' threads.
+         * @param nShards Number of shards; if 0 - number of hardware threads
+         * @param host NDN forwarder host for shards' faces
+         * @param statsPeriodMs How often shards' stats are updated
+         */
+        ConsumerRuntime(unsigned int nShards = 0,
+                        const std::string& host = "localhost",
+                        unsigned int statsPeriodMs = 1000);
+        ~ConsumerRuntime();
+
+        /**
+         * Creates remote video stream on a shard.
+         * @param shard Shard number or AnyShard
+         * @see RemoteVideoStream
+         */
+        std::shared_ptr<RemoteVideoStream>
+        createVideoStream(const std::shared_ptr<ndn::KeyChain>& keyChain,
+                          const std::string& basePrefix,
+                          const std::string& streamName,
+                          const int interestLifeTime = 2000,
+                          const int jitterSizeMs = 150,
+                          int shard = AnyShard);
+
+        /**
+         * Creates remote audio stream on a shard.
+         * @param shard Shard number or AnyShard
+         * @see RemoteAudioStream
+         */
+        std::shared_ptr<RemoteAudioStream>
+        createAudioStream(const std::shared_ptr<ndn::KeyChain>& keyChain,
+                          const std::string& basePrefix,
+                          const std::string& streamName,
+                          const int interestLifeTime = 2000,
+                          const int jitterSizeMs = 150,
+                          int shard = AnyShard);
+
+        unsigned int getShardsNum() const;
+
+        /**
+         * Returns shard the stream was placed on or AnyShard if stream was
+         * not created by this runtime.
+         */
+        int getShard(const std::shared_ptr<RemoteStream>& stream) const;
+
+        /**
+         * Returns shard where the next stream, created with AnyShard, will be
+         * placed: the one with fewest streams; among those - the one with
+         * the lowest CPU usage and io delay.
+         */
+        unsigned int selectShard() const;
+
+        /**
+         * Shard's io_service and face. Can be used to run other objects on
+         * the same thread as shard's streams.
+         */
+        boost::asio::io_service& getIo(unsigned int shard);
+        std::shared_ptr<ndn::Face> getFace(unsigned int shard);
+
+        std::vector<ShardStats> getShardStats() const;
+
+        /**
+         * Shuts down shards' faces and stops their threads. Called upon
+         * destruction.
+         */
+        void stop();
+
+        void setLogger(std::shared_ptr<ndnlog::new_api::Logger> logger);
+
+    private:
+        ConsumerRuntime(const ConsumerRuntime&) = delete;
+        void operator=(const ConsumerRuntime&) = delete;
+
+        std::shared_ptr<ConsumerRuntimeImpl> pimpl_;
+    };
+}
+
+#endif
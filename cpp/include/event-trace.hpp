@@ -0,0 +1,132 @@
+//
+// event-trace.hpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#ifndef __event_trace_hpp__
+#define __event_trace_hpp__
+
+#include <stdint.h>
+#include <atomic>
+#include <string>
+#include <vector>
+
+namespace ndnrtc {
+    namespace trace {
+        /**
+         * Events recorded on the consumer's hot path.
+         * Values are stored in trace files, thus existing values must not
+         * be changed; new events are added at the end.
+         */
+        enum class Event : uint16_t {
+            SegmentRequested = 1,   // Interest for a segment was issued
+            SegmentReceived = 2,    // segment Data arrived (arg - content size)
+            SegmentTimeout = 3,     // Interest for a segment timed out
+            SegmentNack = 4,        // network Nack received (arg - reason)
+            SampleAssembling = 5,   // first segment of a sample arrived
+            SampleReady = 6,        // sample assembled (arg - assembling time, usec)
+            SampleInvalidated = 7,  // sample dropped from buffer (arg - slot state)
+            SamplePlayed = 8,       // sample extracted for playback (arg - delay, ms)
+            SampleSkipped = 9       // sample extracted but not valid for playback
+        };
+
+        enum Flags : uint16_t {
+            FlagParity = 1<<0,  // segment is a parity segment
+            FlagKey = 1<<1      // sample is a key frame
+        };
+
+        /**
+         * Fixed-size trace record. Records are stored in trace files as is.
+         */
+        typedef struct _Record {
+            int64_t timestampUsec_;  // monotonic clock
+            int32_t sampleNo_;
+            int32_t segNo_;
+            uint16_t event_;
+            uint16_t flags_;
+            uint32_t arg_;
+        } Record;
+
+        /**
+         * Trace of one thread, as read from a trace file.
+         */
+        typedef struct _ThreadTrace {
+            uint64_t threadId_;
+            std::vector<Record> records_;
+        } ThreadTrace;
+
+        /**
+         * Low-overhead binary event tracer.
+         * Each thread records into its own lock-free ring buffer of
+         * RingSize records, allocated upon the first record made by this
+         * thread and freed when the thread exits (records of exited threads
+         * are not dumped). Old records are overwritten once ring is full,
+         * thus up to RingSize-1 most recent records of each thread can be
+         * dumped. No
+         * formatting is done while recording, thus tracing can be left on in
+         * production; traces are dumped into a binary file and decoded
+         * offline (see extra/trace-decode.cc).
+         * Tracing is enabled by default.
+         */
+        class Tracer {
+        public:
+            static const size_t RingSize = 1<<13;
+
+            static void setEnabled(bool enabled)
+            { enabled_.store(enabled, std::memory_order_relaxed); }
+
+            static bool isEnabled()
+            { return enabled_.load(std::memory_order_relaxed); }
+
+            /**
+             * Records an event. Thread-safe and wait-free.
+             */
+            static void record(Event event, int32_t sampleNo, int32_t segNo,
+                               uint16_t flags = 0, uint32_t arg = 0)
+            {
+                if (isEnabled())
+                    doRecord(event, sampleNo, segNo, flags, arg);
+            }
+
+            /**
+             * Writes records of all threads into a binary file. Threads may
+             * continue recording while the dump is in progress - records,
+             * overwritten during the dump, are omitted.
+             * @return Number of records written or -1 if file can't be
+             * written
+             */
+            static int dump(const std::string& path);
+
+            /**
+             * Discards all records made so far.
+             */
+            static void clear();
+
+            /**
+             * Reads trace file written by dump().
+             * @param traces Records of each traced thread, oldest first
+             * @param unixOffsetUsec Offset that converts record timestamps
+             * into microseconds since epoch
+             * @return false if file can't be read or has wrong format
+             */
+            static bool read(const std::string& path,
+                             std::vector<ThreadTrace>& traces,
+                             int64_t& unixOffsetUsec);
+
+            static std::string toString(Event event);
+
+            static uint16_t flags(bool isParity, bool isKey)
+            { return (isParity ? FlagParity : 0) | (isKey ? FlagKey : 0); }
+
+        private:
+            static std::atomic<bool> enabled_;
+
+            static void doRecord(Event event, int32_t sampleNo, int32_t segNo,
+                                 uint16_t flags, uint32_t arg);
+        };
+    }
+}
+
+#endif
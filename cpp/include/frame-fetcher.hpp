@@ -26,6 +26,7 @@ namespace ndnrtc {
     class IFetchMethod;
 
     class FrameFetcherImpl;
+    class FrameFetcherCacheImpl;
     class IFrameFetcher;
 
     typedef std::function<uint8_t*(const std::shared_ptr<IFrameFetcher>&, 
@@ -46,6 +47,34 @@ namespace ndnrtc {
         virtual ~IFrameFetcher(){}
     };
 
+    /**
+     * Cache of decoded frames and decoder states, which can be shared by 
+     * frame fetchers of the same storage. Scrubbing through a recording 
+     * usually requests frames of the same GOP one after another. Frames 
+     * that were decoded already are returned from the cache, and decoders 
+     * that stopped at some frame of a GOP continue decoding from where they 
+     * stopped, thus only frames that were not decoded yet are fetched and 
+     * decoded.
+     * Both decoded frames and decoders are evicted in LRU order.
+     * The class is thread-safe.
+     */
+    class FrameFetcherCache {
+    public:
+        /**
+         * @param maxFrames Maximum number of decoded frames to keep
+         * @param maxGops Maximum number of GOP decoders to keep
+         */
+        FrameFetcherCache(size_t maxFrames = 90, size_t maxGops = 4);
+        ~FrameFetcherCache(){}
+
+        size_t getFramesNum() const;
+        size_t getGopsNum() const;
+
+    private:
+        friend class FrameFetcherImpl;
+        std::shared_ptr<FrameFetcherCacheImpl> pimpl_;
+    };
+
     /**
      * Fetches frames from provided persistent storage by names. Once frame is 
      * fetched, returns ARGB buffer for this frame through provided callbacks.
@@ -60,6 +89,10 @@ namespace ndnrtc {
      * frames and 1 key frame must be fetched before decoding of #20 can be 
      * started.
      * If requested frame is a Key frame, no additional frames will be fetched.
+     * If storage's key frame index has requested frame's GOP, all frames 
+     * needed are prefetched from the storage in batches at once. Decoded 
+     * frames and decoders are kept in the cache (see FrameFetcherCache), 
+     * thus only frames that were not decoded before are fetched and decoded.
      */
     class FrameFetcher : public IFrameFetcher,
                          public ndnlog::new_api::ILoggingObject {
@@ -72,7 +105,14 @@ namespace ndnrtc {
             Completed
         };
 
-        FrameFetcher(const std::shared_ptr<StorageEngine>& storage);
+        /**
+         * @param storage Storage to fetch frames from
+         * @param cache Cache of decoded frames. Fetchers of the same storage 
+         *  may share one cache. If not provided, fetcher creates its' own
+         */
+        FrameFetcher(const std::shared_ptr<StorageEngine>& storage,
+                     const std::shared_ptr<FrameFetcherCache>& cache = 
+                        std::shared_ptr<FrameFetcherCache>());
         // FrameFetcher(const std::shared_ptr<LocalVideoStream>& localStream);
         // FrameFetcher(std::string streamPrefix);
         ~FrameFetcher(){}
@@ -85,7 +125,8 @@ namespace ndnrtc {
          *  decoded, client code needs to allocate a buffer for the deocded data
          *  by returning a byte pointer when this callback is called.
          * @param onFrameFetched Once frame has been decoded, this callback will 
-         *  be called to notify client code of successful fetching.
+         *  be called to notify client code of successful fetching. Number of 
+         *  frames fetched is 0 if frame was found in the cache.
          * @param onFetchFailure If frame fetching fails, client code will be 
          *  notified using this callback.
          */
@@ -49,6 +49,8 @@ namespace ndnrtc
         /**
          * This method is called every time new frame is available for rendering.
          * This method is called on the same thread as getFrameBuffer was called.
+         * Both methods are called on decoder threads, never on the thread that
+         * runs face's io_service.
          * @param timestamp Frame's timestamp
          * @param frameNo Frame's playback number as it was set by a publisher
          * @param width Frame's width (NOTE: width can change during run)
@@ -61,6 +63,43 @@ namespace ndnrtc
                                      const uint8_t* buffer) = 0;
     };
 
+    /**
+     * This interface defines external renderers which take decoded frames in
+     * planar YUV (I420) format, exactly as they come out of the decoder. Frame
+     * planes are passed by reference to the decoder's buffer, without copying
+     * or color conversion, thus renderers that don't need RGB (e.g. ones
+     * recording or relaying video) don't pay for the conversion.
+     * This interface is an alternative to IExternalRenderer.
+     */
+    class IExternalPlanarRenderer
+    {
+    public:
+        /**
+         * This method is called every time new frame is available for
+         * rendering. It is called on decoder threads, never on the thread that
+         * runs face's io_service.
+         * NOTE: plane buffers are valid only until this call returns.
+         * @param frameInfo Frame's info
+         * @param width Frame's width (NOTE: width can change during run)
+         * @param height Frame's height (NOTE: height can change during run)
+         * @param strideY Stride of Y plane
+         * @param strideU Stride of U plane
+         * @param strideV Stride of V plane
+         * @param yBuffer Y plane
+         * @param uBuffer U plane
+         * @param vBuffer V plane
+         */
+        virtual void renderI420Frame(const FrameInfo& frameInfo,
+                                     const unsigned int width,
+                                     const unsigned int height,
+                                     const unsigned int strideY,
+                                     const unsigned int strideU,
+                                     const unsigned int strideV,
+                                     const uint8_t* yBuffer,
+                                     const uint8_t* uBuffer,
+                                     const uint8_t* vBuffer) = 0;
+    };
+
     /**
      * This class is used for delivering raw ARGB frames to the library.
      * After calling initPublishing, library returns a pointer of object
@@ -27,6 +27,56 @@ namespace ndnlog {
 }
 
 namespace ndnrtc {
+	/**
+	 * Encoder worker settings. Each video thread is encoded on its own
+	 * persistent worker thread, which receives raw frames through a bounded
+	 * queue. When the queue is full, frames are dropped according to the drop
+	 * policy. The same queue size and policy apply to the scaling stage which
+	 * precedes encoders. Encoded frames are never dropped: if parity or
+	 * publishing stages fall behind by more than publishQueueSize_ frames,
+	 * encoders wait for them.
+	 */
+	class EncoderWorkerSettings
+	{
+	public:
+		typedef enum _DropPolicy {
+			DropNewest,	// incoming frame is dropped
+			DropOldest	// oldest queued frame is dropped in favor of incoming one
+		} DropPolicy;
+
+		EncoderWorkerSettings():queueSize_(2), dropPolicy_(DropOldest), pinToCores_(false),
+			publishQueueSize_(8){}
+
+		unsigned int queueSize_;
+		DropPolicy dropPolicy_;
+		bool pinToCores_; // pin each worker to a separate CPU core
+		unsigned int publishQueueSize_;
+	};
+
+	/**
+	 * Signing settings, used when signing is on (see MediaStreamSettings).
+	 * Streams may either sign every data and parity segment (SignAll),
+	 * or sign only manifests, which carry implicit digests of segments,
+	 * while segments get digest signatures (SignManifest). Video stream
+	 * publishes manifest for every frame, audio stream - for every window
+	 * of NameComponents::AudioManifestWindow bundles.
+	 * Segments of a packet are signed as one batch on a pool of poolSize_
+	 * threads (no pool is used if poolSize_ is 0).
+	 */
+	class SigningSettings
+	{
+	public:
+		typedef enum _Mode {
+			SignManifest,
+			SignAll
+		} Mode;
+
+		SigningSettings():mode_(SignManifest), poolSize_(0){}
+
+		Mode mode_;
+		unsigned int poolSize_;
+	};
+
 	/**
 	 * Media stream settings class unites objects, required for media streams
 	 * creation and operation
@@ -44,6 +94,8 @@ namespace ndnrtc {
 		ndn::Face* face_;
 		MediaStreamParams params_;
         std::string storagePath_; // do not use storage if this string is empty
+        EncoderWorkerSettings encoderWorkers_; // used by video streams only
+        SigningSettings signing_;
 	};
 
 	class VideoStreamImpl;
@@ -11,7 +11,9 @@
 #ifndef libndnrtc_ndnrtc_name_components_h
 #define libndnrtc_ndnrtc_name_components_h
 
+#include <stdint.h>
 #include <string>
+#include <memory>
 #include <ndn-cpp/name.hpp>
 
 #include "params.hpp"
@@ -20,6 +22,10 @@
 #define SAMPLE_SUFFIX(n)(n.getSubName(-3,3))
 #define PARITY_SUFFIX(n)(n.getSubName(-4,4))
 
+namespace ndn {
+    class Interest;
+}
+
 namespace ndnrtc {
     namespace prefix_filter {
         typedef enum _PrefixFilter {
@@ -84,6 +90,62 @@ namespace ndnrtc {
         ndn::Name getSuffix(int filter = (suffix_filter::Segment)) const;
     };
 
+    /**
+     * NameHandle is a compact, trivially copyable form of NamespaceInfo.
+     * Packet name is parsed into a handle once, when packet arrives from (or
+     * is handed to) the face, and the handle is passed along with the packet
+     * afterwards. Variable-length parts of the name - stream prefix and thread
+     * name - are interned in a process-wide registry and are referred to by
+     * integer ids, thus parsing names of a stream that was seen before does
+     * not allocate memory.
+     * Interned stream and thread names are kept for the lifetime of the
+     * process; names of untrusted origin are not interned (see
+     * NameComponents::extractHandle).
+     */
+    class NameHandle {
+    public:
+        NameHandle():streamId_(0), threadId_(0), streamKey_(0), threadKey_(0),
+            apiVersion_(0), streamType_(MediaStreamParams::MediaStreamType::MediaStreamTypeUnknown),
+            isMeta_(false), isParity_(false), isDelta_(false), hasSeqNo_(false), 
+            hasSegNo_(false), class_(SampleClass::Unknown), 
+            segmentClass_(SegmentClass::Unknown), sampleNo_(0), segNo_(0), metaVersion_(0){}
+
+        /**
+         * Interns stream and thread of the info, if needed.
+         */
+        explicit NameHandle(const NamespaceInfo& info);
+
+        uint32_t streamId_, threadId_;  // interned ids; 0 - none
+        uint64_t streamKey_;            // stream and thread hashes, as used 
+        uint32_t threadKey_;            // by SampleKey
+        unsigned int apiVersion_;
+        MediaStreamParams::MediaStreamType streamType_;
+        bool isMeta_, isParity_, isDelta_, hasSeqNo_, hasSegNo_;
+        SampleClass class_;
+        SegmentClass segmentClass_;
+        PacketNumber sampleNo_;
+        unsigned int segNo_;
+        unsigned int metaVersion_;
+
+        bool isValid() const { return streamId_ != 0; }
+
+        const ndn::Name& getBasePrefix() const;
+        const std::string& getStreamName() const;
+        const std::string& getThreadName() const;
+        uint64_t getStreamTimestamp() const;
+
+        /**
+         * Materializes full NamespaceInfo. Allocates, thus should be used
+         * off the hot path.
+         */
+        NamespaceInfo getInfo() const;
+
+        ndn::Name getPrefix(int filter = (prefix_filter::Segment)) const
+        { return getInfo().getPrefix(filter); }
+        ndn::Name getSuffix(int filter = (suffix_filter::Segment)) const
+        { return getInfo().getSuffix(filter); }
+    };
+
     class NameComponents {
     public:
         static const std::string NameComponentApp;
@@ -95,6 +157,11 @@ namespace ndnrtc {
         static const std::string NameComponentParity;
         static const std::string NameComponentManifest;
 
+        // number of audio bundles covered by one manifest
+        static const unsigned int AudioManifestWindow;
+        // first byte of nonce of retransmitted Interests
+        static const uint8_t RetransmissionNonceMarker;
+
         static std::string 
         fullVersion();
 
@@ -113,7 +180,43 @@ namespace ndnrtc {
         static ndn::Name
         videoStreamPrefix(std::string basePrefix);
 
+        /**
+         * Audio bundles are not signed individually; one signed manifest
+         * covers a window of consecutive bundles and is published under the
+         * name of the last bundle of the window:
+         *      <thread prefix>/<last bundle no>/_manifest
+         * @return number of the bundle which manifest covers given bundle
+         */
+        static PacketNumber
+        audioManifestBundleNo(PacketNumber bundleNo);
+
+        /**
+         * Consumers mark Interests they retransmit with a random nonce which
+         * first byte is RetransmissionNonceMarker. This lets producer tell a
+         * consumer's retransmission from Interests of other consumers pending
+         * for the same data.
+         * @return copy of the Interest with a new marked nonce
+         */
+        static std::shared_ptr<ndn::Interest>
+        retransmission(const ndn::Interest& interest);
+
+        static bool
+        isRetransmission(const ndn::Interest& interest);
+
         static bool extractInfo(const ndn::Name& name, NamespaceInfo& info);
+
+        /**
+         * Parses name into a handle. Unlike extractInfo, does not allocate
+         * memory once name's stream and thread were interned.
+         * Interned names are never released, thus names of untrusted origin
+         * (e.g. Interests received from network) must be parsed with intern
+         * set to false: if their stream or thread were not interned before,
+         * handle has zero ids and can't be materialized (see getInfo), but
+         * its keys are valid (see SampleKey).
+         * @return false if name is not a legitimate NDN-RTC name
+         */
+        static bool extractHandle(const ndn::Name& name, NameHandle& handle,
+                                  bool intern = true);
     };
 }
 
@@ -20,6 +20,7 @@ namespace ndnrtc {
 	class RemoteStreamImpl;
 	class IRemoteStreamObserver;
     class IExternalRenderer;
+    class IExternalPlanarRenderer;
     
     /**
      * Main class for handling remote streams - streams published by remote producers.
@@ -198,6 +199,25 @@ namespace ndnrtc {
          */
 		void start(const std::string& threadName, 
 			IExternalRenderer* renderer);
+
+        /**
+         * Starts fetching video frames from the remote producer
+         * @param threadName Thread name to fetch media from
+         * @param renderer Pointer to IExternalPlanarRenderer object which will
+         *                 receive decoded video frames in I420 format
+         */
+		void start(const std::string& threadName, 
+			IExternalPlanarRenderer* renderer);
+
+        /**
+         * Enables or disables rate adaptation. With rate adaptation enabled,
+         * stream estimates available throughput and switches between
+         * producer's threads (simulcast) at key frame boundaries: it steps
+         * down upon congestion and probes higher threads once the network
+         * is stable. Switches are reported with ThreadSwitched event.
+         * Disabled by default.
+         */
+        void setRateAdaptation(bool enabled);
 	};
     
     /**
@@ -37,67 +37,78 @@
 // following macros are used for NdnRtcObject logging
 // each macro checks, whether a logger, associated with object has been
 // initialized and use it instead of global logger
+// logging macros expand into statements: streamed arguments are evaluated 
+// only if logging level is enabled for the logger, so expressions like 
+// LogTraceC << slot->dump() cost nothing when tracing is off
+#define NDNLOG_IF_ENABLED(fname, lvl) if (!ndnlog::new_api::Logger::getLogger(fname).isLevelEnabled((ndnlog::NdnLogType)lvl)) {} else ndnlog::new_api::Logger::log(fname, (ndnlog::NdnLogType)lvl, __FUNCTION__, __LINE__)
+#define NDNLOG_IF_ENABLED_C(lvl) if (!LogIsEnabledC(lvl)) {} else this->logger_->log((ndnlog::NdnLogType)lvl, this, __FUNCTION__, __LINE__)
+#define NDNLOG_DISABLED if (true) {} else ndnlog::new_api::NilLogger::get()
+
+// checks whether object's logger will accept entries of given level; can be
+// used to guard preparation of logging data outside of logging statements
+#define LogIsEnabledC(lvl) (this->logger_ && this->logger_->isLevelEnabled((ndnlog::NdnLogType)lvl))
+
 #if defined (NDN_TRACE)
 
-#define LogTrace(fname, ...) ndnlog::new_api::Logger::log(fname, (ndnlog::NdnLogType)ndnlog::NdnLoggerLevelTrace, __FUNCTION__, __LINE__, ##__VA_ARGS__)
-#define LogTraceC ((this->logger_) ? this->logger_->log((ndnlog::NdnLogType)ndnlog::NdnLoggerLevelTrace, this, __FUNCTION__, __LINE__) : ndnlog::new_api::NilLogger::get())
+#define LogTrace(fname, ...) NDNLOG_IF_ENABLED(fname, ndnlog::NdnLoggerLevelTrace)
+#define LogTraceC NDNLOG_IF_ENABLED_C(ndnlog::NdnLoggerLevelTrace)
 
 #else
 
-#define LogTrace(fname, ...) ndnlog::new_api::NilLogger::get()
-#define LogTraceC ndnlog::new_api::NilLogger::get()
+#define LogTrace(fname, ...) NDNLOG_DISABLED
+#define LogTraceC NDNLOG_DISABLED
 
 #endif
 
 #if defined (NDN_DEBUG)
 
-#define LogDebug(fname, ...) ndnlog::new_api::Logger::log(fname, ndnlog::NdnLoggerLevelDebug, __FILE__, __LINE__, ##__VA_ARGS__)
-#define LogDebugC ((this->logger_) ? this->logger_->log((ndnlog::NdnLogType)ndnlog::NdnLoggerLevelDebug, this, __FUNCTION__, __LINE__) : ndnlog::new_api::NilLogger::get())
+#define LogDebug(fname, ...) NDNLOG_IF_ENABLED(fname, ndnlog::NdnLoggerLevelDebug)
+#define LogDebugC NDNLOG_IF_ENABLED_C(ndnlog::NdnLoggerLevelDebug)
 #else
 
-#define LogDebug(fmt, ...) ndnlog::new_api::NilLogger::get()
-#define LogDebugC ndnlog::new_api::NilLogger::get()
+#define LogDebug(fmt, ...) NDNLOG_DISABLED
+#define LogDebugC NDNLOG_DISABLED
 
 #endif
 
 #if defined (NDN_INFO)
 
-#define LogInfo(fname, ...) ndnlog::new_api::Logger::log(fname, ndnlog::NdnLoggerLevelInfo, __FILE__, __LINE__, ##__VA_ARGS__)
-#define LogInfoC ((this->logger_) ? this->logger_->log((ndnlog::NdnLogType)ndnlog::NdnLoggerLevelInfo, this, __FUNCTION__, __LINE__) : ndnlog::new_api::NilLogger::get())
+#define LogInfo(fname, ...) NDNLOG_IF_ENABLED(fname, ndnlog::NdnLoggerLevelInfo)
+#define LogInfoC NDNLOG_IF_ENABLED_C(ndnlog::NdnLoggerLevelInfo)
 
 #else
 
-#define LogInfo(fname, ...) ndnlog::new_api::NilLogger::get()
-#define LogInfoC ndnlog::new_api::NilLogger::get()
+#define LogInfo(fname, ...) NDNLOG_DISABLED
+#define LogInfoC NDNLOG_DISABLED
 
 #endif
 
 #if defined (NDN_WARN)
 
-#define LogWarn(fname, ...) ndnlog::new_api::Logger::log(fname, ndnlog::NdnLoggerLevelWarning   , __FILE__, __LINE__, ##__VA_ARGS__)
-#define LogWarnC ((this->logger_) ? this->logger_->log((ndnlog::NdnLogType)ndnlog::NdnLoggerLevelWarning, this, __FUNCTION__, __LINE__) : ndnlog::new_api::NilLogger::get())
+#define LogWarn(fname, ...) NDNLOG_IF_ENABLED(fname, ndnlog::NdnLoggerLevelWarning)
+#define LogWarnC NDNLOG_IF_ENABLED_C(ndnlog::NdnLoggerLevelWarning)
 
 #else
 
-#define LogWarn(fname, ...) ndnlog::new_api::NilLogger::get()
-#define LogWarnC ndnlog::new_api::NilLogger::get()
+#define LogWarn(fname, ...) NDNLOG_DISABLED
+#define LogWarnC NDNLOG_DISABLED
 
 #endif
 
 #if defined (NDN_ERROR)
 
-#define LogError(fname, ...) ndnlog::new_api::Logger::log(fname, ndnlog::NdnLoggerLevelError, __FILE__, __LINE__, ##__VA_ARGS__)
-#define LogErrorC ((this->logger_) ? this->logger_->log((ndnlog::NdnLogType)ndnlog::NdnLoggerLevelError, this, __FUNCTION__, __LINE__) : ndnlog::new_api::NilLogger::get())
+#define LogError(fname, ...) NDNLOG_IF_ENABLED(fname, ndnlog::NdnLoggerLevelError)
+#define LogErrorC NDNLOG_IF_ENABLED_C(ndnlog::NdnLoggerLevelError)
 
 #else
 
-#define LogError(fname, ...) ndnlog::new_api::NilLogger::get()
-#define LogErrorC ndnlog::new_api::NilLogger::get()
+#define LogError(fname, ...) NDNLOG_DISABLED
+#define LogErrorC NDNLOG_DISABLED
 
 #endif
 
-#define LogStat(fname, ...) ndnlog::new_api::Logger::log(fname, (NdnLogType)NdnLoggerLevelStat, __FUNCTION__, __LINE__, ##__VA_ARGS__)
-#define LogStatC ((this->logger_) ? this->logger_->log((ndnlog::NdnLogType)ndnlog::NdnLoggerLevelStat, this, __FUNCTION__, __LINE__) : ndnlog::new_api::NilLogger::get())
+#define LogStat(fname, ...) NDNLOG_IF_ENABLED(fname, ndnlog::NdnLoggerLevelStat)
+#define LogStatC NDNLOG_IF_ENABLED_C(ndnlog::NdnLoggerLevelStat)
 
 #define STAT_DIV "\t"
 
@@ -271,6 +282,10 @@ namespace ndnlog {
             NdnLoggerDetailLevel
             getLogLevel()
             { return logLevel_; }
+
+            bool
+            isLevelEnabled(const NdnLogType& logType) const
+            { return logType >= (NdnLogType)logLevel_; }
             
             static void
             initAsyncLogging();
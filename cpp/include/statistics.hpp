@@ -14,6 +14,9 @@
 
 #include <string>
 #include <map>
+#include <array>
+#include <bitset>
+#include <atomic>
 #include <stdexcept>
 #include <iostream>
 #include <iomanip>
@@ -106,15 +109,113 @@ namespace ndnrtc {
                 EncodedNum,
                 
                 // capturer
-                CapturedNum
+                CapturedNum,
+
+                // indicators added later go below, so that values of the
+                // ones above stay the same for API users
+
+                // producer
+                SignDelay,                      // PacketPublisher
+                MetaSignDelay,                  // PacketPublisher
+
+                // content store
+                FanOut,                         // ContentStore
+                AggregationRatio,               // ContentStore
+                GenerationDelay,                // ContentStore
+                GenerationDelayUnder5ms,        // ContentStore
+                GenerationDelayUnder20ms,       // ContentStore
+                GenerationDelayUnder100ms,      // ContentStore
+                GenerationDelayOver100ms,       // ContentStore
+
+                // encoder
+                EncodingDelay,                  // VideoStreamImpl
+                EncodeQueueSize,                // VideoStreamImpl
+
+                // producer pipeline stages
+                ScaleQueueSize,                 // VideoStreamImpl
+                ScaleDelay,                     // VideoStreamImpl
+                ParityQueueSize,                // VideoStreamImpl
+                ParityDelay,                    // VideoStreamImpl
+                PublishQueueSize,               // VideoStreamImpl
+                PublishDelay,                   // VideoStreamImpl
+
+                // interest queue
+                InterestsDroppedNum,            // InterestQueue
+                InterestIssueDelay,             // InterestQueue
+                IssueDelayUnder1ms,             // InterestQueue
+                IssueDelayUnder5ms,             // InterestQueue
+                IssueDelayUnder20ms,            // InterestQueue
+                IssueDelayOver20ms,             // InterestQueue
+
+                // persistent storage
+                StorageBacklogSize,             // StorageEngine
+                StorageWrittenNum,              // StorageEngine
+                StorageDroppedNum,              // StorageEngine
+                StorageWriteDelay,              // StorageEngine
+
+                // decoder
+                DecodeQueueSize,                // AsyncDecoder
+                DecodeDelay,                    // AsyncDecoder
+                DecodingTime,                   // AsyncDecoder
+                DecodeDroppedNum,               // AsyncDecoder
+
+                // rate adaptation
+                BandwidthEstimation,            // RateAdaptationControl
+                ThreadSwitchUpNum,              // RateAdaptationControl
+                ThreadSwitchDownNum,            // RateAdaptationControl
+                ThreadSwitchedNum,              // RemoteStreamImpl
+
+                // audio
+                AudioBundlePoolSize,            // AudioStreamImpl
+                AudioBundlePoolOccupancy,       // AudioStreamImpl
+                AudioBundlePoolExhausted        // AudioStreamImpl, must be the last one (see IndicatorsNum)
         };
+
+        static const size_t IndicatorsNum = (size_t)Indicator::AudioBundlePoolExhausted+1;
         
+        /**
+         * StatisticsStorage keeps values of statistics indicators. Indicators
+         * are stored in a fixed-size array of atomics, indexed by indicator
+         * and padded to cache line size, so they can be updated from any
+         * thread without locking.
+         * Increments (++, +=, --, -=) go to per-thread shards and are summed
+         * up on read, so hot counters updated from different threads do not
+         * contend for the same cache line. Assignment sets indicator value
+         * and resets its shards - an indicator is expected to be used either
+         * as a counter or as a gauge, not both at the same time.
+         */
         class StatisticsStorage {
         public:
                 typedef std::map<Indicator, double> StatRepo;
+                typedef std::array<double, IndicatorsNum> Snapshot;
                 static const std::map<Indicator, std::string> IndicatorNames;
                 static const std::map<Indicator, std::string> IndicatorKeywords;
                 
+                /**
+                 * Reference to an indicator value, returned by operator[].
+                 * Behaves like double& for reading and updating.
+                 */
+                class IndicatorRef {
+                public:
+                        operator double() const { return storage_.get(idx_); }
+                        
+                        IndicatorRef& operator=(double v) { storage_.set(idx_, v); return *this; }
+                        IndicatorRef& operator=(const IndicatorRef& r) { return (*this = (double)r); }
+                        IndicatorRef& operator+=(double v) { storage_.add(idx_, v); return *this; }
+                        IndicatorRef& operator-=(double v) { storage_.add(idx_, -v); return *this; }
+                        IndicatorRef& operator++() { storage_.add(idx_, 1); return *this; }
+                        IndicatorRef& operator--() { storage_.add(idx_, -1); return *this; }
+                        double operator++(int) { double v = *this; storage_.add(idx_, 1); return v; }
+                        double operator--(int) { double v = *this; storage_.add(idx_, -1); return v; }
+                        
+                private:
+                        friend StatisticsStorage;
+                        IndicatorRef(StatisticsStorage& storage, size_t idx):storage_(storage), idx_(idx){}
+                        
+                        StatisticsStorage& storage_;
+                        size_t idx_;
+                };
+                
                 static StatisticsStorage*
                 createConsumerStatistics()
                 { return new StatisticsStorage(StatisticsStorage::ConsumerStatRepo); }
@@ -123,9 +224,7 @@ namespace ndnrtc {
                 createProducerStatistics()
                 { return new StatisticsStorage(StatisticsStorage::ProducerStatRepo); }
                 
-                StatisticsStorage(const StatisticsStorage& statisticsStorage):
-                inidicatorNames_(StatisticsStorage::IndicatorNames),
-                indicators_(statisticsStorage.getIndicators()){}
+                StatisticsStorage(const StatisticsStorage& statisticsStorage);
                 ~StatisticsStorage(){}
                 
                 // may throw an exception if indicator is not present in the repo
@@ -136,40 +235,82 @@ namespace ndnrtc {
                 StatRepo
                 getIndicators() const;
                 
+                /**
+                 * Copies current values of all indicators into supplied array,
+                 * indexed by indicator. Indicators not present in this storage
+                 * are set to 0. This is wait-free and never blocks writers.
+                 */
+                void
+                snapshot(Snapshot& snapshot) const;
+                
+                bool
+                hasIndicator(const statistics::Indicator& indicator) const
+                { return present_[(size_t)indicator]; }
+                
                 StatisticsStorage&
-                operator=(const StatisticsStorage& other)
-                {
-                    indicators_ = other.getIndicators();
-                    return *this;
-                }
+                operator=(const StatisticsStorage& other);
                 
-                double&
+                // throws std::out_of_range if indicator is not present in the repo
+                IndicatorRef
                 operator[](const statistics::Indicator& indicator)
-                { return indicators_.at(indicator); }
+                { return IndicatorRef(*this, index(indicator)); }
+                
+                double
+                operator[](const statistics::Indicator& indicator) const
+                { return get(index(indicator)); }
                 
                 friend std::ostream& operator<<(std::ostream& os,
                                                 const StatisticsStorage& storage)
                 {
-                    for (auto& it:storage.indicators_)
-                    {
-                        try {
+                    Snapshot snapshot;
+                    storage.snapshot(snapshot);
+
+                    for (auto& it:StatisticsStorage::IndicatorNames)
+                        if (storage.hasIndicator(it.first))
                             os << std::fixed
-                            << storage.inidicatorNames_.at(it.first) << "\t"
-                            << std::setprecision(2) << it.second << std::endl;
-                        }
-                        catch (...) {
-                        }
-                    }
+                            << it.second << "\t"
+                            << std::setprecision(2) << snapshot[(size_t)it.first] << std::endl;
                     
                     return os;
                 }
         private:
-                StatisticsStorage(const StatRepo& indicators):indicators_(indicators){}
+                static const size_t ShardsNum = 8;
+                
+                // value padded to cache line size
+                struct Slot {
+                        Slot():value_(0){}
+                        std::atomic<double> value_;
+                        char padding_[64-sizeof(std::atomic<double>)];
+                };
+                
+                // per-thread increments of all indicators
+                struct Shard {
+                        Shard(){ for (auto& d:deltas_) d = 0; }
+                        std::atomic<double> deltas_[IndicatorsNum];
+                        char padding_[64];
+                };
+                
+                StatisticsStorage(const StatRepo& indicators);
                 
-                const std::map<Indicator, std::string> inidicatorNames_;
                 static const StatRepo ConsumerStatRepo;
                 static const StatRepo ProducerStatRepo;
-                StatRepo indicators_;
+                std::bitset<IndicatorsNum> present_;
+                Slot values_[IndicatorsNum];
+                Shard shards_[ShardsNum];
+                
+                size_t index(const statistics::Indicator& indicator) const
+                {
+                    if (!hasIndicator(indicator))
+                        throw std::out_of_range("statistics indicator is not present in the repo");
+                    return (size_t)indicator;
+                }
+                
+                double get(size_t idx) const;
+                void set(size_t idx, double value);
+                void add(size_t idx, double delta);
+                
+                // returns shard index of the calling thread
+                static size_t shardIndex();
         };
 
         class StatObject {
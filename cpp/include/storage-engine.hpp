@@ -8,8 +8,11 @@
 #ifndef __storage_engine_hpp__
 #define __storage_engine_hpp__
 
+#include <vector>
 #include <boost/shared_ptr.hpp>
 
+#include "ndnrtc-common.hpp"
+
 namespace ndn {
     class Data;
     class Name;
@@ -18,12 +21,38 @@ namespace ndn {
 namespace ndnrtc {
     class StorageEngineImpl;
 
+    namespace statistics {
+        class StatisticsStorage;
+    }
+
     /**
      * This is a wrapper for the persistent key-value storage of data packets.  
+     * Data packets are keyed by wire-encoded names. Writes are performed on
+     * a dedicated writer thread: batches are queued in a bounded backlog and 
+     * written with one DB write per wakeup of the writer, so put() never 
+     * blocks on disk I/O. If backlog is full, new batches are dropped.
+     * Alongside video frames, storage keeps a key frame index: for every 
+     * recorded GOP it remembers key frame number and the number of the first
+     * delta frame of the GOP. Index is written in the same DB write as key 
+     * frame segments and is loaded when storage is opened.
+     * Storage format version is kept in the DB. Storages recorded by earlier
+     * versions, which keyed data by name URIs, have no version: they are 
+     * detected when opened and are read and written in their format; frames
+     * they recorded are not in the key frame index. Storage of unknown 
+     * version is not opened.
      */
     class StorageEngine {
     public:
-        StorageEngine(std::string dpPath);
+        /**
+         * @param dbPath Path to the DB
+         * @param statStorage Optional statistics storage for reporting
+         *        backlog size, written and dropped packets and write delay
+         * @param maxBacklog Maximum number of batches waiting to be written
+         */
+        StorageEngine(std::string dbPath, 
+                      const std::shared_ptr<statistics::StatisticsStorage>& statStorage = 
+                        std::shared_ptr<statistics::StatisticsStorage>(),
+                      size_t maxBacklog = 256);
         ~StorageEngine();
 
         /**
@@ -33,14 +62,51 @@ namespace ndnrtc {
          */
         void put(const std::shared_ptr<const ndn::Data>& data);
 
+        /**
+         * Puts a batch of data packets (e.g. all segments of a frame) into
+         * the storage. Batch is written atomically.
+         * Data is saved asynchronously, so the call returns immediately.
+         * The call is thread-safe.
+         * @return false if batch was dropped due to the full backlog
+         */
+        bool put(const std::vector<std::shared_ptr<const ndn::Data>>& batch);
+
         /**
          * Tries to retrieve data from persistent storage. 
-         * The call is synchronous. 
+         * The call is synchronous and thread-safe. Data that has been put but
+         * not yet written is retrieved from the backlog.
          * If data is not present in the persistent storage, returned pointer
          * is invalid.
          */
         std::shared_ptr<ndn::Data> get(const ndn::Name& dataName);
 
+        /**
+         * Retrieves a batch of data packets. All packets are read through one
+         * DB iterator (i.e. from the same snapshot of the storage), which is 
+         * cheaper than retrieving them one by one.
+         * The call is synchronous and thread-safe.
+         * @return Data packets in the order of the names provided. If data is 
+         *         not present in the storage, corresponding pointer is invalid
+         */
+        std::vector<std::shared_ptr<ndn::Data>> 
+        get(const std::vector<ndn::Name>& dataNames);
+
+        /**
+         * Looks up GOP of a delta frame in the key frame index.
+         * @param threadPrefix Video thread prefix, without frame type component
+         * @param deltaNo Delta frame sequence number
+         * @param keyNo Sequence number of the GOP key frame
+         * @param firstDeltaNo Sequence number of the first delta frame of GOP
+         * @return false if frame's GOP is not in the index
+         */
+        bool getGop(const ndn::Name& threadPrefix, PacketNumber deltaNo,
+                    PacketNumber& keyNo, PacketNumber& firstDeltaNo);
+
+        /**
+         * Blocks until all batches queued so far are written.
+         */
+        void flush();
+
     private:
         std::shared_ptr<StorageEngineImpl> pimpl_;
     };
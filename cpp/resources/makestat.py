@@ -8,7 +8,7 @@ import os
 import sys
 
 if len(sys.argv) < 2:
-  print "usage: "+__file__+" <stat_file>"
+  print "usage: "+__file__+" <stat_file or .nstat file>"
   exit(1)
   
 statfile = sys.argv[1]
@@ -76,6 +76,11 @@ fullStat = OrderedDict([ ("Requested",SYMBOL_NREQUESTED), ("Requested KEY",SYMBO
 ("Interests sent",SYMBOL_NINTRST), ("Data received",SYMBOL_NDATA), ("Timeouts",SYMBOL_NTIMEOUT),
 ("Rebufferings",SYMBOL_NREBUFFER), ("Retransmissions",SYMBOL_NRTX )])
 
+# statistics keywords of .nstat files (see resources/nstat.py)
+nstatStat = OrderedDict([ ("Requested","framesReq"), ("Acquired","framesAcq"), ("Played","framesPlayed"),
+("Interests sent","isent"), ("Data received","segNumRcvd"), ("Timeouts","timeouts"),
+("Rebufferings","rebuf"), ("Retransmissions","rtxNum")])
+
 statPostProcRules = {"Acquired":["/%","Requested"], "Played":["/%","Acquired"], "Data received":["/%","Interests sent"], "Timeouts":["/%","Interests sent"],
 "Incomplete":["/%","Acquired"], "Skipped incomplete":["/%","Acquired"], "Skipped (no key)":["/%","Acquired"], "Skipped (invalid GOP)":["/%", "Acquired"],
 "Assembled":["/%","Requested"], "Rescued":["/%","Requested"], "Recovered":["/%","Requested"]}
@@ -171,9 +176,12 @@ def printStat(statFields, statVariables):
       sys.stdout.write(" ")
     sys.stdout.write('\t')
     sys.stdout.write(value)
+    arg2 = "n/a"
     if statPostProcRules.has_key(text):
+      arg2 = minedVariables.get(statPostProcRules[text][1], "n/a")
+    # fields may be missing (or zero) in .nstat files
+    if value != "n/a" and arg2 != "n/a" and float(arg2) != 0:
       arg1 = minedVariables[text]
-      arg2 = minedVariables[statPostProcRules[text][1]]
       op = statPostProcRules[text][0]
       print "\t"+str(binaryOp(float(arg1), float(arg2), op))
     else:
@@ -192,6 +200,29 @@ def statFunc(timestamp, match):
   printStat(fullStat, statVariables)
   return True
 
+def printNstat(file):
+  global headerPrefix
+  global nstatStat
+  columns, samples = nstat.read(file)
+  if len(samples) == 0:
+    print headerPrefix+"No samples recorded"
+    return
+  if "timestamp" in columns:
+    idx = columns.index("timestamp")
+    duration = int(samples[-1][idx]-samples[0][idx])
+    print headerPrefix+"Recorded "+str(len(samples))+" samples over "+str(duration)+"ms"
+  statVariables = []
+  for keyword, value in zip(columns, samples[-1]):
+    statVariables += [keyword, str(value)]
+  print headerPrefix+"Summary:"
+  printStat(OrderedDict(nstatStat), statVariables)
+
+if statfile.endswith(".nstat"):
+  sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+  import nstat
+  printNstat(statfile)
+  exit(0)
+
 token="STAT"
 component=".*"
 keyword=".*"
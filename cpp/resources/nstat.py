@@ -0,0 +1,85 @@
+# Reader for binary statistics files (.nstat) recorded by ndnrtc-client (-r
+# option). See client/src/stat-recorder.hpp for file layout.
+#
+# usage as a module:
+#   import nstat
+#   columns, samples = nstat.read("file.nstat")   # samples are oldest first
+#   latest = nstat.latest("file.nstat")           # {keyword: value}
+#
+# usage as a script (prints tab-separated values, as nstat-convert does):
+#   python nstat.py <file.nstat> [<keyword> ...]
+
+import mmap
+import struct
+import sys
+
+MAGIC = b"NSTR"
+VERSION = 2
+HEADER = struct.Struct("=4sHHIIQQ")
+COLUMN = struct.Struct("=H30s")
+
+def _parse(buf):
+  magic, version, nColumns, capacity, dataOffset, nRecorded, nStarted = HEADER.unpack_from(buf, 0)
+  if magic != MAGIC or version != VERSION:
+    raise ValueError("not a .nstat file")
+  columns = []
+  for i in range(0, nColumns):
+    indicator, keyword = COLUMN.unpack_from(buf, HEADER.size+i*COLUMN.size)
+    columns.append(keyword.split(b"\0", 1)[0].decode("ascii"))
+  if len(buf) < dataOffset+nColumns*capacity*8:
+    raise ValueError("truncated .nstat file")
+  return columns, capacity, dataOffset, nRecorded
+
+def _started(buf):
+  return HEADER.unpack_from(buf, 0)[6]
+
+def _sample(buf, nColumns, capacity, dataOffset, sampleNo):
+  idx = sampleNo%capacity
+  return [struct.unpack_from("=d", buf, dataOffset+(c*capacity+idx)*8)[0] for c in range(0, nColumns)]
+
+def read(fileName):
+  """Returns (columns, samples): list of keywords and list of samples, each
+  sample is a list of values in columns order, oldest sample first"""
+  with open(fileName, "rb") as f:
+    buf = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+    try:
+      columns, capacity, dataOffset, nRecorded = _parse(buf)
+      first = max(0, nRecorded-capacity)
+      samples = [_sample(buf, len(columns), capacity, dataOffset, n) for n in range(first, nRecorded)]
+      # writer may have wrapped around while samples were copied - drop
+      # the ones it has started overwriting
+      overwritten = max(0, _started(buf)-capacity-first)
+      samples = samples[overwritten:]
+    finally:
+      buf.close()
+  return columns, samples
+
+def latest(fileName):
+  """Returns dictionary of the latest recorded values or None if file has no
+  samples"""
+  with open(fileName, "rb") as f:
+    buf = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+    try:
+      columns, capacity, dataOffset, nRecorded = _parse(buf)
+      if nRecorded == 0:
+        return None
+      # the latest sample can only be overwritten if writer has recorded
+      # capacity more samples meanwhile, retry then
+      while True:
+        sample = _sample(buf, len(columns), capacity, dataOffset, nRecorded-1)
+        if _started(buf) <= nRecorded-1+capacity:
+          return dict(zip(columns, sample))
+        nRecorded = HEADER.unpack_from(buf, 0)[5]
+    finally:
+      buf.close()
+
+if __name__ == "__main__":
+  if len(sys.argv) < 2:
+    print("usage: "+__file__+" <file.nstat> [<keyword> ...]")
+    exit(1)
+  columns, samples = read(sys.argv[1])
+  keywords = sys.argv[2:] if len(sys.argv) > 2 else columns
+  idx = [columns.index(k) for k in keywords]
+  print("\t".join(keywords))
+  for s in samples:
+    print("\t".join(["%.2f" % s[i] for i in idx]))
@@ -0,0 +1,83 @@
+//
+// audio-bundle-ring.cpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include "audio-bundle-ring.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+using namespace ndnrtc;
+
+AudioBundleRing::AudioBundleRing(size_t bundleWireLength, size_t initialSize, size_t maxSize)
+    : bundleWireLength_(bundleWireLength),
+      maxSize_(std::max(initialSize, maxSize)),
+      size_(0), nFree_(0), nExhausted_(0),
+      filled_(maxSize_), free_(maxSize_)
+{
+    for (size_t i = 0; i < initialSize; ++i)
+    {
+        free_.push(std::make_shared<AudioBundlePacket>(bundleWireLength_));
+        size_++;
+        nFree_++;
+    }
+}
+
+std::shared_ptr<AudioBundlePacket>
+AudioBundleRing::acquire()
+{
+    std::shared_ptr<AudioBundlePacket> bundle;
+
+    if (free_.pop(bundle))
+        nFree_--;
+    else if (size_ < maxSize_)
+    {
+        bundle = std::make_shared<AudioBundlePacket>(bundleWireLength_);
+        size_++;
+    }
+    else
+        nExhausted_++;
+
+    return bundle;
+}
+
+void AudioBundleRing::push(uint64_t bundleNo, const std::shared_ptr<AudioBundlePacket> &bundle)
+{
+    Entry e;
+    e.bundleNo_ = bundleNo;
+    e.bundle_ = bundle;
+
+    // queue can hold every allocated bundle, thus push never fails
+    bool res = filled_.push(e);
+    assert(res);
+    (void)res;
+}
+
+bool AudioBundleRing::pop(uint64_t &bundleNo, std::shared_ptr<AudioBundlePacket> &bundle)
+{
+    Entry e;
+
+    if (filled_.pop(e))
+    {
+        bundleNo = e.bundleNo_;
+        bundle = e.bundle_;
+        return true;
+    }
+
+    return false;
+}
+
+void AudioBundleRing::release(const std::shared_ptr<AudioBundlePacket> &bundle)
+{
+    bundle->clear();
+
+    // counted before the push, otherwise producer may pop the bundle and
+    // decrement the counter first
+    nFree_++;
+    bool res = free_.push(bundle);
+    assert(res);
+    (void)res;
+}
@@ -0,0 +1,91 @@
+//
+// audio-bundle-ring.hpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#ifndef __audio_bundle_ring_h__
+#define __audio_bundle_ring_h__
+
+#include <boost/atomic.hpp>
+#include <boost/lockfree/spsc_queue.hpp>
+
+#include "frame-data.hpp"
+
+namespace ndnrtc
+{
+
+/**
+ * AudioBundleRing passes audio bundles from audio thread (producer) to face
+ * thread (consumer) without locking and, once warmed up, without memory
+ * allocations. Bundles circulate between two wait-free single-producer
+ * single-consumer queues: filled bundles go from producer to consumer and
+ * consumed bundles go back to producer to be filled again.
+ * If producer runs out of free bundles (i.e. consumer is lagging behind),
+ * pool grows by allocating new bundles, up to the maximum pool size. Only
+ * when pool is exhausted, producer has to drop samples.
+ */
+class AudioBundleRing
+{
+  public:
+    AudioBundleRing(size_t bundleWireLength, size_t initialSize, size_t maxSize);
+
+    /**
+     * Returns free bundle. If there are no free bundles, new bundle is
+     * allocated, unless pool has reached its maximum size.
+     * @return Free bundle or nullptr if pool is exhausted
+     * @note Called by producer only
+     */
+    std::shared_ptr<AudioBundlePacket> acquire();
+
+    /**
+     * Passes filled bundle to consumer.
+     * @note Called by producer only
+     */
+    void push(uint64_t bundleNo, const std::shared_ptr<AudioBundlePacket> &bundle);
+
+    /**
+     * Retrieves the oldest filled bundle.
+     * @return false if there are no filled bundles
+     * @note Called by consumer only
+     */
+    bool pop(uint64_t &bundleNo, std::shared_ptr<AudioBundlePacket> &bundle);
+
+    /**
+     * Returns consumed bundle back to the pool.
+     * @note Called by consumer only
+     */
+    void release(const std::shared_ptr<AudioBundlePacket> &bundle);
+
+    // number of bundles allocated
+    size_t getSize() const { return size_; }
+    size_t getMaxSize() const { return maxSize_; }
+    // number of bundles taken from the pool (being filled, queued or consumed)
+    size_t getOccupancy() const
+    {
+        // nFree_ never exceeds size_, as long as it is read first
+        size_t nFree = nFree_;
+        return size_ - nFree;
+    }
+    // number of times producer found pool exhausted
+    uint64_t getExhaustedNum() const { return nExhausted_; }
+
+  private:
+    AudioBundleRing(const AudioBundleRing &) = delete;
+
+    typedef struct _Entry
+    {
+        uint64_t bundleNo_;
+        std::shared_ptr<AudioBundlePacket> bundle_;
+    } Entry;
+
+    const size_t bundleWireLength_, maxSize_;
+    boost::atomic<size_t> size_, nFree_;
+    boost::atomic<uint64_t> nExhausted_;
+    boost::lockfree::spsc_queue<Entry> filled_;
+    boost::lockfree::spsc_queue<std::shared_ptr<AudioBundlePacket>> free_;
+};
+}
+
+#endif
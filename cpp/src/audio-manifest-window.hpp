@@ -0,0 +1,74 @@
+//
+// audio-manifest-window.hpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#ifndef __audio_manifest_window_hpp__
+#define __audio_manifest_window_hpp__
+
+#include <functional>
+
+#include "name-components.hpp"
+#include "packet-publisher.hpp"
+
+namespace ndnrtc
+{
+/**
+ * Collects published segments of audio bundles of one thread into windows
+ * of NameComponents::AudioManifestWindow bundles (see
+ * NameComponents::audioManifestBundleNo), so that one manifest is
+ * published per window.
+ */
+class AudioManifestWindow
+{
+  public:
+    typedef std::function<void(PacketNumber lastBundleNo, const PublishedDataPtrVector &segments)> OnWindow;
+
+    AudioManifestWindow() : lastBundleNo_(0) {}
+
+    /**
+     * Adds segments of a bundle. Calls onWindow once the last bundle of
+     * the window is added.
+     */
+    void add(PacketNumber bundleNo, const PublishedDataPtrVector &segments,
+             const OnWindow &onWindow)
+    {
+        PacketNumber lastBundleNo = NameComponents::audioManifestBundleNo(bundleNo);
+
+        // bundle numbers are consecutive, but they start over when thread
+        // is restarted - if the last bundle of previous window never came,
+        // publish what was collected
+        if (lastBundleNo != lastBundleNo_)
+            flush(onWindow);
+
+        lastBundleNo_ = lastBundleNo;
+        segments_.insert(segments_.end(), segments.begin(), segments.end());
+
+        if (bundleNo == lastBundleNo)
+            flush(onWindow);
+    }
+
+    /**
+     * Calls onWindow for the incomplete window, if it has any segments
+     * (e.g. when thread stops).
+     */
+    void flush(const OnWindow &onWindow)
+    {
+        if (segments_.empty())
+            return;
+
+        onWindow(lastBundleNo_, segments_);
+        segments_.clear();
+    }
+
+    size_t getSegmentsNum() const { return segments_.size(); }
+
+  private:
+    PacketNumber lastBundleNo_;
+    PublishedDataPtrVector segments_;
+};
+}
+
+#endif
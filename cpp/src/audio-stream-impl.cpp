@@ -11,8 +11,6 @@
 #include "name-components.hpp"
 #include "audio-controller.hpp"
 
-#define BUNDLES_POOL_SIZE 10
-
 using namespace std;
 using namespace ndnrtc;
 using namespace ndnrtc::statistics;
@@ -26,10 +24,13 @@ AudioStreamImpl::AudioStreamImpl(const std::string &basePrefix,
     if (settings_.params_.type_ == MediaStreamParams::MediaStreamType::MediaStreamTypeVideo)
         throw runtime_error("Wrong media stream parameters type supplied (video instead of audio)");
 
+    // bundles are signed by manifests (see publishManifest), unless every
+    // packet is required to be signed
     PublisherSettings ps;
-    ps.sign_ = true;
+    ps.sign_ = (settings_.sign_ && settings_.signing_.mode_ == SigningSettings::SignAll);
+    ps.signingPool_ = signingPool_.get();
     ps.keyChain_ = settings_.keyChain_;
-    ps.memoryCache_ = cache_.get();
+    ps.contentStore_ = contentStore_.get();
     ps.segmentWireLength_ = MAX_NDN_PACKET_SIZE;
     ps.freshnessPeriodMs_ = settings.params_.producerParams_.freshness_.sampleMs_;
     ps.statStorage_ = statStorage_.get();
@@ -41,16 +42,13 @@ AudioStreamImpl::AudioStreamImpl(const std::string &basePrefix,
     for (int i = 0; i < settings_.params_.getThreadNum(); ++i)
         if (settings_.params_.getAudioThread(i))
             add(settings_.params_.getAudioThread(i));
-
-    for (int i = 0; i < BUNDLES_POOL_SIZE; ++i)
-        bundlePool_.push_back(std::make_shared<AudioBundlePacket>(CommonSegment::payloadLength(settings_.params_.producerParams_.segmentSize_)));
 }
 
 AudioStreamImpl::~AudioStreamImpl()
 {
     // cleanup
     if (streamRunning_)
-        stop();
+        stopThreads();
 }
 
 void AudioStreamImpl::start()
@@ -73,11 +71,29 @@ void AudioStreamImpl::start()
 
 void AudioStreamImpl::stop()
 {
-    // here, lock should not be acquired as it may lead to deadlock
-    // if one of the threads already dispatched onSampleBundle callback
-    // BUT has not yet acquired internalMutex_ (see onSampleBundle method)
+    stopThreads();
+
+    // publish remaining bundles and manifests of the last, incomplete
+    // windows, unless stream was restarted meanwhile
+    std::shared_ptr<AudioStreamImpl> me = std::static_pointer_cast<AudioStreamImpl>(shared_from_this());
+    async::dispatchAsync(settings_.faceIo_, [me]() {
+        if (me->streamRunning_)
+            return;
+
+        for (auto &threadName : me->getThreads())
+        {
+            me->publishBundles(threadName);
+            me->flushManifest(threadName);
+        }
+    });
+}
+
+void AudioStreamImpl::stopThreads()
+{
+    // here, lock is not acquired: stopping a thread synchronously waits for
+    // audio thread and face thread (see publishBundles) should not be
+    // blocked meanwhile
     // boost::lock_guard<boost::mutex> scopedLock(internalMutex_);
-    // to avoid this, we need to dispatch call synchronously on audio thread
 
     for (auto it : threads_)
         it.second->stop();
@@ -154,6 +170,12 @@ void AudioStreamImpl::remove(const std::string &threadName)
         if (thread->isRunning())
             thread->stop();
 
+        std::shared_ptr<AudioStreamImpl> me = std::static_pointer_cast<AudioStreamImpl>(shared_from_this());
+        async::dispatchAsync(settings_.faceIo_, [me, threadName]() {
+            me->flushManifest(threadName);
+            me->manifestWindows_.erase(threadName);
+        });
+
         if (!threads_.size())
             streamRunning_ = false;
         LogDebugC << "removed thread " << threadName << std::endl;
@@ -164,48 +186,84 @@ void AudioStreamImpl::remove(const std::string &threadName)
 void AudioStreamImpl::onSampleBundle(std::string threadName, uint64_t bundleNo,
                                      std::shared_ptr<AudioBundlePacket> packet)
 {
-    if (!bundlePool_.size())
-    {
-        LogWarnC << "Audio bundle pool is drained. This may happen due to fast capturing "
-                    "and slow publishing or too small segment size"
-                 << std::endl;
-        return;
-    }
-
-    Name n(streamPrefix_);
-    n.append(threadName).appendSequenceNumber(bundleNo);
+    // bundle has been queued in thread's bundle ring and will be published
+    // on face thread, audio thread never waits for it
     std::shared_ptr<AudioStreamImpl> me = std::static_pointer_cast<AudioStreamImpl>(shared_from_this());
-    std::shared_ptr<AudioBundlePacket> bundle = bundlePool_.back();
+    async::dispatchAsync(settings_.faceIo_, [me, threadName]() {
+        me->publishBundles(threadName);
+    });
+}
 
+void AudioStreamImpl::publishBundles(const std::string &threadName)
+{
+    std::shared_ptr<AudioThread> thread;
     double packetRate = 0;
-    bool threadRemoved = false;
     {
         boost::lock_guard<boost::mutex> scopedLock(internalMutex_);
-        threadRemoved = (metaKeepers_.find(threadName) == metaKeepers_.end());
-        bundle->swap(*packet);
-        packetRate = metaKeepers_[threadName]->getMeta().getRate();
-        bundlePool_.pop_back();
+        std::map<std::string, std::shared_ptr<AudioThread>>::iterator it = threads_.find(threadName);
+
+        if (it == threads_.end())
+            return;
+
+        thread = it->second;
+        packetRate = metaKeepers_[threadName]->getRate();
     }
 
-    if (!threadRemoved)
-        async::dispatchAsync(settings_.faceIo_, [this, packetRate, n, bundle, me]() {
-            CommonHeader packetHdr;
+    AudioBundleRing &ring = thread->getBundleRing();
+    std::shared_ptr<AudioBundlePacket> bundle;
+    uint64_t bundleNo;
+
+    while (ring.pop(bundleNo, bundle))
+    {
+        Name n(streamPrefix_);
+        n.append(threadName).appendSequenceNumber(bundleNo);
+
+        CommonHeader packetHdr;
+        packetHdr.sampleRate_ = packetRate;
+        packetHdr.publishTimestampMs_ = clock::millisecondTimestamp();
+        packetHdr.publishUnixTimestamp_ = clock::unixTimestamp();
+        bundle->setHeader(packetHdr);
+
+        PublishedDataPtrVector segments = samplePublisher_->publish(n, *bundle);
+        (*statStorage_)[Indicator::PublishedNum]++;
+        addToManifest(threadName, bundleNo, segments);
 
-            packetHdr.sampleRate_ = packetRate;
-            packetHdr.publishTimestampMs_ = clock::millisecondTimestamp();
-            packetHdr.publishUnixTimestamp_ = clock::unixTimestamp();
-            bundle->setHeader(packetHdr);
+        ring.release(bundle);
+    }
+}
+
+void AudioStreamImpl::addToManifest(const std::string &threadName, PacketNumber bundleNo,
+                                    const PublishedDataPtrVector &segments)
+{
+    manifestWindows_[threadName].add(bundleNo, segments,
+                                     [this, &threadName](PacketNumber lastBundleNo, const PublishedDataPtrVector &ss) {
+                                         publishManifest(threadName, lastBundleNo, ss);
+                                     });
+}
 
-            me->samplePublisher_->publish(n, *bundle);
-            (*statStorage_)[Indicator::PublishedNum]++;
+void AudioStreamImpl::flushManifest(const std::string &threadName)
+{
+    std::map<std::string, AudioManifestWindow>::iterator it = manifestWindows_.find(threadName);
 
-            {
-                boost::lock_guard<boost::mutex> scopedLock(me->internalMutex_);
-                me->bundlePool_.push_back(bundle);
-            }
+    if (it != manifestWindows_.end())
+        it->second.flush([this, &threadName](PacketNumber lastBundleNo, const PublishedDataPtrVector &ss) {
+            publishManifest(threadName, lastBundleNo, ss);
         });
 }
 
+void AudioStreamImpl::publishManifest(const std::string &threadName, PacketNumber lastBundleNo,
+                                      const PublishedDataPtrVector &segments)
+{
+    Manifest m(segments);
+    Name manifestName(streamPrefix_);
+    manifestName.append(threadName).appendSequenceNumber(lastBundleNo)
+                .append(NameComponents::NameComponentManifest).appendVersion(0);
+    PublishedDataPtrVector ss = metadataPublisher_->publish(manifestName, m);
+
+    LogDebugC << "published manifest ☆ (" << manifestName.getSubName(-4, 4) << ") for "
+              << segments.size() << " segments x" << ss.size() << std::endl;
+}
+
 bool AudioStreamImpl::updateMeta()
 {
     if (streamRunning_)
@@ -222,6 +280,19 @@ bool AudioStreamImpl::updateMeta()
             metaName.append(it.first).append(NameComponents::NameComponentMeta).appendVersion(0);
             metadataPublisher_->publish(metaName, it.second->getMeta());
         }
+
+        size_t poolSize = 0, poolOccupancy = 0;
+        uint64_t nExhausted = 0;
+        for (auto it : threads_)
+        {
+            poolSize += it.second->getBundleRing().getSize();
+            poolOccupancy += it.second->getBundleRing().getOccupancy();
+            nExhausted += it.second->getBundleRing().getExhaustedNum();
+        }
+
+        (*statStorage_)[Indicator::AudioBundlePoolSize] = poolSize;
+        (*statStorage_)[Indicator::AudioBundlePoolOccupancy] = poolOccupancy;
+        (*statStorage_)[Indicator::AudioBundlePoolExhausted] = nExhausted;
     }
     return streamRunning_;
 }
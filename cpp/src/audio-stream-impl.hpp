@@ -10,6 +10,7 @@
 
 #include "media-stream-base.hpp"
 #include "audio-thread.hpp"
+#include "audio-manifest-window.hpp"
 
 namespace ndnrtc
 {
@@ -59,18 +60,28 @@ class AudioStreamImpl : public MediaStreamBase,
     std::shared_ptr<CommonPacketPublisher> samplePublisher_;
     std::map<std::string, std::shared_ptr<AudioThread>> threads_;
     std::map<std::string, std::shared_ptr<MetaKeeper>> metaKeepers_;
-    std::vector<std::shared_ptr<AudioBundlePacket>> bundlePool_;
+    // accessed on face thread only
+    std::map<std::string, AudioManifestWindow> manifestWindows_;
     boost::atomic<bool> streamRunning_;
 
     // may be called from main thread or face thread
     void add(const MediaThreadParams *params) override;
     void remove(const std::string &threadName) override;
+    void stopThreads();
 
     // called on audio thread. need to sync with Face thread and
     // on access to internal data, if any
     void onSampleBundle(std::string threadName, uint64_t bundleNo,
                         std::shared_ptr<AudioBundlePacket> packet) override;
     bool updateMeta() override;
+
+    // called on face thread
+    void publishBundles(const std::string &threadName);
+    void addToManifest(const std::string &threadName, PacketNumber bundleNo,
+                       const PublishedDataPtrVector &segments);
+    void flushManifest(const std::string &threadName);
+    void publishManifest(const std::string &threadName, PacketNumber lastBundleNo,
+                         const PublishedDataPtrVector &segments);
 };
 }
 
@@ -15,6 +15,9 @@
 #include "estimators.hpp"
 #include "frame-data.hpp"
 
+#define BUNDLE_POOL_SIZE 10
+#define BUNDLE_POOL_MAX_SIZE 500
+
 using namespace ndnrtc;
 using namespace webrtc;
 
@@ -29,7 +32,8 @@ AudioThread::AudioThread(const AudioThreadParams &params,
       threadName_(params.threadName_),
       codec_(params.codec_),
       callback_(callback),
-      bundle_(std::make_shared<AudioBundlePacket>(bundleWireLength)),
+      bundleRing_(bundleWireLength, BUNDLE_POOL_SIZE, BUNDLE_POOL_MAX_SIZE),
+      bundle_(bundleRing_.acquire()),
       capturer_(captureParams.deviceId_, this,
                 (params.codec_ == "opus" ? WebrtcAudioChannel::Codec::Opus : WebrtcAudioChannel::Codec::G722)),
       isRunning_(false)
@@ -81,9 +85,7 @@ void AudioThread::onDeliverRtpFrame(unsigned int len, uint8_t *data)
     if (isRunning_)
     {
         LogTraceC << "delivering rtp frame" << std::endl;
-        std::vector<uint8_t> adata(data, data + len);
-        AudioBundlePacket::AudioSampleBlob blob({false}, adata.begin(), adata.end());
-        deliver(blob);
+        deliver(false, len, data);
     }
 }
 
@@ -92,20 +94,30 @@ void AudioThread::onDeliverRtcpFrame(unsigned int len, uint8_t *data)
     if (isRunning_)
     {
         LogTraceC << "delivering rtcp frame" << std::endl;
-        std::vector<uint8_t> adata(data, data + len);
-        AudioBundlePacket::AudioSampleBlob blob({true}, adata.begin(), adata.end());
-        deliver(blob);
+        deliver(true, len, data);
     }
 }
 
-void AudioThread::deliver(const AudioBundlePacket::AudioSampleBlob &blob)
+void AudioThread::deliver(bool isRtcp, unsigned int len, const uint8_t *data)
 {
-    if (!bundle_->hasSpace(blob))
+    if (!bundle_->hasSpace(len))
     {
-        rateMeter_.newValue(0);
-        callback_->onSampleBundle(threadName_, bundleNo_++, bundle_);
-        bundle_->clear();
+        std::shared_ptr<AudioBundlePacket> nextBundle = bundleRing_.acquire();
+
+        if (nextBundle)
+        {
+            rateMeter_.newValue(0);
+            bundleRing_.push(bundleNo_, bundle_);
+            callback_->onSampleBundle(threadName_, bundleNo_++, bundle_);
+            bundle_ = nextBundle;
+        }
+        else
+        {
+            LogWarnC << "bundle pool is exhausted (" << bundleRing_.getSize()
+                     << " bundles), dropping " << bundle_->getSamplesNum() << " samples" << std::endl;
+            bundle_->clear();
+        }
     }
 
-    *bundle_ << blob;
+    bundle_->append({isRtcp}, data, len);
 }
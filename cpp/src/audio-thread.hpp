@@ -17,6 +17,7 @@
 #include "params.hpp"
 #include "ndnrtc-object.hpp"
 #include "audio-capturer.hpp"
+#include "audio-bundle-ring.hpp"
 #include "frame-data.hpp"
 #include "estimators.hpp"
 
@@ -32,7 +33,9 @@ class IAudioThreadCallback
   public:
     /**
      * This is called when audio bundle consisting of RTP/RTCP packets
-     * is ready.
+     * is ready. By this time, bundle has been queued in thread's bundle
+     * ring (see AudioThread::getBundleRing()), from which it should be
+     * retrieved and where it should be released to once it's processed.
      * @param threadName Name of the audio media thread
      * @param bundleNo Sequential bundle number
      * @param packet Shared pointer for bundle packet
@@ -61,6 +64,7 @@ class AudioThread : public NdnRtcComponent,
     std::string getCodec() const { return codec_; }
     double getRate() const;
     uint64_t getBundleNo() const { return bundleNo_; }
+    AudioBundleRing &getBundleRing() { return bundleRing_; }
     void setLogger(std::shared_ptr<ndnlog::new_api::Logger> logger);
 
   private:
@@ -70,6 +74,8 @@ class AudioThread : public NdnRtcComponent,
     estimators::FreqMeter rateMeter_;
     std::string threadName_, codec_;
     IAudioThreadCallback *callback_;
+    AudioBundleRing bundleRing_;
+    // bundle being filled
     std::shared_ptr<AudioBundlePacketT<Mutable>> bundle_;
     AudioCapturer capturer_;
     boost::atomic<bool> isRunning_;
@@ -81,7 +87,7 @@ class AudioThread : public NdnRtcComponent,
     onDeliverRtcpFrame(unsigned int len, uint8_t *data);
 
     void
-    deliver(const AudioBundlePacketT<Mutable>::AudioSampleBlob &blob);
+    deliver(bool isRtcp, unsigned int len, const uint8_t *data);
 };
 }
 
@@ -48,9 +48,9 @@ class BufferControl : public ISegmentControllerObserver, public NdnRtcComponent
     void detach(IBufferControlObserver *);
 
     void segmentArrived(const std::shared_ptr<WireSegment> &);
-    void segmentRequestTimeout(const NamespaceInfo &, 
+    void segmentRequestTimeout(const NameHandle &, 
                                const std::shared_ptr<const ndn::Interest> &) { /*ignored*/}
-    void segmentNack(const NamespaceInfo &, int, 
+    void segmentNack(const NameHandle &, int, 
                      const std::shared_ptr<const ndn::Interest> &) { /*ignored*/}
     void segmentStarvation() { /*ignored*/}
 
@@ -199,10 +199,17 @@ cFrameInfo ndnrtc_LocalVideoStream_getLastPublishedInfo(ndnrtc::LocalVideoStream
     return frameInfo;
 }
 
+// decoded frames are cached per stream, so that scrubbing through a 
+// recording doesn't decode the same GOP over and over again
+static std::map<ndnrtc::IStream*, std::shared_ptr<FrameFetcherCache>> FrameFetcherCaches;
+
 void ndnrtc_destroyLocalStream(ndnrtc::IStream* localStreamObject)
 {
 	if (localStreamObject)
+	{
+		FrameFetcherCaches.erase(localStreamObject);
 		delete localStreamObject;
+	}
 }
 
 const char* ndnrtc_LocalStream_getPrefix(IStream *stream)
@@ -260,7 +267,10 @@ void ndnrtc_FrameFetcher_fetch(ndnrtc::IStream *stream,
                                FrameFetched frameFetchedFunc)
 {
     std::shared_ptr<StorageEngine> storage = ((LocalVideoStream*)stream)->getStorage();
-    std::shared_ptr<FrameFetcher> ff = std::make_shared<FrameFetcher>(storage);
+    std::shared_ptr<FrameFetcherCache>& cache = FrameFetcherCaches[stream];
+    if (!cache)
+        cache = std::make_shared<FrameFetcherCache>();
+    std::shared_ptr<FrameFetcher> ff = std::make_shared<FrameFetcher>(storage, cache);
 
     std::string fkey(frameName);
     FrameFetchers[fkey] = ff;
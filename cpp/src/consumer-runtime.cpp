@@ -0,0 +1,426 @@
+//
+// consumer-runtime.cpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include "consumer-runtime.hpp"
+
+#include <time.h>
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <boost/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/lock_guard.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <ndn-cpp/threadsafe-face.hpp>
+
+#include "remote-stream.hpp"
+#include "ndnrtc-object.hpp"
+#include "clock.hpp"
+
+using namespace ndnrtc;
+
+namespace ndnrtc {
+    class ConsumerRuntimeImpl : public NdnRtcComponent {
+    public:
+        ConsumerRuntimeImpl(unsigned int nShards, const std::string& host,
+                            unsigned int statsPeriodMs);
+        ~ConsumerRuntimeImpl();
+
+        template<typename T>
+        std::shared_ptr<T> createStream(int shardNo,
+                                        const std::shared_ptr<ndn::KeyChain>& keyChain,
+                                        const std::string& basePrefix,
+                                        const std::string& streamName,
+                                        const int interestLifeTime,
+                                        const int jitterSizeMs);
+
+        unsigned int getShardsNum() const { return shards_.size(); }
+        int getShard(const std::shared_ptr<RemoteStream>& stream) const;
+        unsigned int selectShard() const;
+        boost::asio::io_service& getIo(unsigned int shard);
+        std::shared_ptr<ndn::Face> getFace(unsigned int shard);
+        std::vector<ConsumerRuntime::ShardStats> getShardStats() const;
+        void stop();
+
+    private:
+        struct Shard {
+            Shard(unsigned int no):no_(no), statsTimer_(io_), cpuUsage_(0),
+                ioDelayUsec_(0), maxIoDelayUsec_(0),
+                statsDueUsec_(std::numeric_limits<int64_t>::max()),
+                lastWallUsec_(0), lastCpuUsec_(0){}
+
+            // handlers may be stuck behind a long one, so overdue stats
+            // timer counts as io delay too
+            int64_t getIoDelay(int64_t now) const
+            {
+                return std::max(ioDelayUsec_.load(std::memory_order_relaxed),
+                                now - statsDueUsec_.load(std::memory_order_relaxed));
+            }
+
+            const unsigned int no_;
+            boost::asio::io_service io_;
+            std::shared_ptr<boost::asio::io_service::work> work_;
+            boost::thread thread_;
+            std::shared_ptr<ndn::Face> face_;
+            boost::asio::steady_timer statsTimer_;
+            // guarded by ConsumerRuntimeImpl::mutex_
+            std::vector<std::weak_ptr<RemoteStream>> streams_;
+
+            // written on shard's thread only
+            std::atomic<double> cpuUsage_;
+            std::atomic<int64_t> ioDelayUsec_, maxIoDelayUsec_, statsDueUsec_;
+            int64_t lastWallUsec_, lastCpuUsec_;
+        };
+
+        const unsigned int statsPeriodMs_;
+        bool isRunning_;
+        mutable boost::mutex mutex_;
+        std::vector<std::shared_ptr<Shard>> shards_;
+
+        unsigned int doSelectShard() const;
+        double getLoad(const Shard& shard, int64_t now) const;
+        static size_t countStreams(Shard& shard);
+        void scheduleStats(Shard* shard);
+        void updateStats(Shard* shard);
+    };
+}
+
+namespace {
+    int64_t threadCpuUsec()
+    {
+        struct timespec ts;
+        if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+            return 0;
+        return (int64_t)ts.tv_sec*1000000 + ts.tv_nsec/1000;
+    }
+}
+
+//******************************************************************************
+const int ConsumerRuntime::AnyShard;
+
+ConsumerRuntime::ConsumerRuntime(unsigned int nShards, const std::string& host,
+                                 unsigned int statsPeriodMs):
+pimpl_(std::make_shared<ConsumerRuntimeImpl>(nShards, host, statsPeriodMs))
+{
+}
+
+ConsumerRuntime::~ConsumerRuntime()
+{
+    pimpl_->stop();
+}
+
+std::shared_ptr<RemoteVideoStream>
+ConsumerRuntime::createVideoStream(const std::shared_ptr<ndn::KeyChain>& keyChain,
+                                   const std::string& basePrefix,
+                                   const std::string& streamName,
+                                   const int interestLifeTime,
+                                   const int jitterSizeMs,
+                                   int shard)
+{
+    return pimpl_->createStream<RemoteVideoStream>(shard, keyChain, basePrefix,
+        streamName, interestLifeTime, jitterSizeMs);
+}
+
+std::shared_ptr<RemoteAudioStream>
+ConsumerRuntime::createAudioStream(const std::shared_ptr<ndn::KeyChain>& keyChain,
+                                   const std::string& basePrefix,
+                                   const std::string& streamName,
+                                   const int interestLifeTime,
+                                   const int jitterSizeMs,
+                                   int shard)
+{
+    return pimpl_->createStream<RemoteAudioStream>(shard, keyChain, basePrefix,
+        streamName, interestLifeTime, jitterSizeMs);
+}
+
+unsigned int
+ConsumerRuntime::getShardsNum() const
+{
+    return pimpl_->getShardsNum();
+}
+
+int
+ConsumerRuntime::getShard(const std::shared_ptr<RemoteStream>& stream) const
+{
+    return pimpl_->getShard(stream);
+}
+
+unsigned int
+ConsumerRuntime::selectShard() const
+{
+    return pimpl_->selectShard();
+}
+
+boost::asio::io_service&
+ConsumerRuntime::getIo(unsigned int shard)
+{
+    return pimpl_->getIo(shard);
+}
+
+std::shared_ptr<ndn::Face>
+ConsumerRuntime::getFace(unsigned int shard)
+{
+    return pimpl_->getFace(shard);
+}
+
+std::vector<ConsumerRuntime::ShardStats>
+ConsumerRuntime::getShardStats() const
+{
+    return pimpl_->getShardStats();
+}
+
+void
+ConsumerRuntime::stop()
+{
+    pimpl_->stop();
+}
+
+void
+ConsumerRuntime::setLogger(std::shared_ptr<ndnlog::new_api::Logger> logger)
+{
+    pimpl_->setLogger(logger);
+}
+
+//******************************************************************************
+ConsumerRuntimeImpl::ConsumerRuntimeImpl(unsigned int nShards,
+                                         const std::string& host,
+                                         unsigned int statsPeriodMs):
+statsPeriodMs_(statsPeriodMs), isRunning_(true)
+{
+    description_ = "consumer-runtime";
+
+    if (nShards == 0)
+        nShards = std::max(1u, boost::thread::hardware_concurrency());
+
+    for (unsigned int i = 0; i < nShards; ++i)
+    {
+        std::shared_ptr<Shard> shard = std::make_shared<Shard>(i);
+        Shard* s = shard.get();
+
+        if (host == "localhost")
+            s->face_ = std::make_shared<ndn::ThreadsafeFace>(s->io_);
+        else
+            s->face_ = std::make_shared<ndn::ThreadsafeFace>(s->io_, host.c_str());
+
+        s->work_ = std::make_shared<boost::asio::io_service::work>(s->io_);
+        s->thread_ = boost::thread([this, s](){
+            try
+            {
+                s->io_.run();
+            }
+            catch (std::exception &e)
+            {
+                LogErrorC << "shard " << s->no_ << " caught exception: "
+                          << e.what() << std::endl;
+            }
+        });
+        s->io_.post([this, s](){ scheduleStats(s); });
+
+        shards_.push_back(shard);
+    }
+}
+
+ConsumerRuntimeImpl::~ConsumerRuntimeImpl()
+{
+    stop();
+}
+
+template<typename T>
+std::shared_ptr<T>
+ConsumerRuntimeImpl::createStream(int shardNo,
+                                  const std::shared_ptr<ndn::KeyChain>& keyChain,
+                                  const std::string& basePrefix,
+                                  const std::string& streamName,
+                                  const int interestLifeTime,
+                                  const int jitterSizeMs)
+{
+    boost::lock_guard<boost::mutex> scopedLock(mutex_);
+
+    if (!isRunning_)
+        throw std::runtime_error("consumer runtime is stopped");
+    if (shardNo >= (int)shards_.size())
+        throw std::runtime_error("bad shard number");
+
+    Shard& shard = *shards_[(shardNo == ConsumerRuntime::AnyShard ? doSelectShard() : shardNo)];
+    std::shared_ptr<T> stream = std::make_shared<T>(shard.io_, shard.face_, keyChain,
+        basePrefix, streamName, interestLifeTime, jitterSizeMs);
+    shard.streams_.push_back(stream);
+
+    LogInfoC << "placed stream " << stream->getPrefix() << " on shard "
+             << shard.no_ << " (" << countStreams(shard) << " streams)"
+             << std::endl;
+
+    return stream;
+}
+
+int
+ConsumerRuntimeImpl::getShard(const std::shared_ptr<RemoteStream>& stream) const
+{
+    boost::lock_guard<boost::mutex> scopedLock(mutex_);
+
+    for (auto& shard:shards_)
+        for (auto& s:shard->streams_)
+            if (s.lock() == stream)
+                return shard->no_;
+
+    return ConsumerRuntime::AnyShard;
+}
+
+unsigned int
+ConsumerRuntimeImpl::selectShard() const
+{
+    boost::lock_guard<boost::mutex> scopedLock(mutex_);
+    return doSelectShard();
+}
+
+boost::asio::io_service&
+ConsumerRuntimeImpl::getIo(unsigned int shard)
+{
+    return shards_.at(shard)->io_;
+}
+
+std::shared_ptr<ndn::Face>
+ConsumerRuntimeImpl::getFace(unsigned int shard)
+{
+    return shards_.at(shard)->face_;
+}
+
+std::vector<ConsumerRuntime::ShardStats>
+ConsumerRuntimeImpl::getShardStats() const
+{
+    boost::lock_guard<boost::mutex> scopedLock(mutex_);
+    std::vector<ConsumerRuntime::ShardStats> stats;
+    int64_t now = clock::microsecondTimestamp();
+
+    for (auto& shard:shards_)
+    {
+        ConsumerRuntime::ShardStats s;
+        s.shardNo_ = shard->no_;
+        s.nStreams_ = countStreams(*shard);
+        s.cpuUsage_ = shard->cpuUsage_.load(std::memory_order_relaxed);
+        s.ioDelayUsec_ = shard->getIoDelay(now);
+        s.maxIoDelayUsec_ = std::max(s.ioDelayUsec_,
+            shard->maxIoDelayUsec_.load(std::memory_order_relaxed));
+        stats.push_back(s);
+    }
+
+    return stats;
+}
+
+void
+ConsumerRuntimeImpl::stop()
+{
+    {
+        boost::lock_guard<boost::mutex> scopedLock(mutex_);
+        if (!isRunning_)
+            return;
+        isRunning_ = false;
+
+        for (auto& shard:shards_)
+        {
+            size_t nStreams = countStreams(*shard);
+            if (nStreams)
+            {
+                LogWarnC << "stopping shard " << shard->no_ << " with "
+                         << nStreams << " streams still placed on it" << std::endl;
+            }
+        }
+    }
+
+    for (auto& shard:shards_)
+    {
+        shard->face_->shutdown();
+        shard->work_.reset();
+        // pending handlers (stats timer, streams' timers) are abandoned
+        shard->io_.stop();
+        shard->thread_.join();
+    }
+
+    LogInfoC << "stopped " << shards_.size() << " shards" << std::endl;
+}
+
+//******************************************************************************
+unsigned int
+ConsumerRuntimeImpl::doSelectShard() const
+{
+    int64_t now = clock::microsecondTimestamp();
+    unsigned int selected = 0;
+    size_t minStreams = countStreams(*shards_[0]);
+    double minLoad = getLoad(*shards_[0], now);
+
+    for (unsigned int i = 1; i < shards_.size(); ++i)
+    {
+        size_t nStreams = countStreams(*shards_[i]);
+        double load = getLoad(*shards_[i], now);
+
+        if (nStreams < minStreams || (nStreams == minStreams && load < minLoad))
+        {
+            selected = i;
+            minStreams = nStreams;
+            minLoad = load;
+        }
+    }
+
+    return selected;
+}
+
+double
+ConsumerRuntimeImpl::getLoad(const Shard& shard, int64_t now) const
+{
+    // CPU usage is updated by shard's thread itself, thus it's stale when
+    // thread is stuck; io delay accounts for that
+    return shard.cpuUsage_.load(std::memory_order_relaxed) +
+        (double)std::max<int64_t>(0, shard.getIoDelay(now))/(double)(statsPeriodMs_*1000);
+}
+
+size_t
+ConsumerRuntimeImpl::countStreams(Shard& shard)
+{
+    shard.streams_.erase(std::remove_if(shard.streams_.begin(), shard.streams_.end(),
+                                        [](const std::weak_ptr<RemoteStream>& s){
+                                            return s.expired();
+                                        }),
+                         shard.streams_.end());
+    return shard.streams_.size();
+}
+
+void
+ConsumerRuntimeImpl::scheduleStats(Shard* shard)
+{
+    shard->statsDueUsec_.store(clock::microsecondTimestamp() + (int64_t)statsPeriodMs_*1000,
+                               std::memory_order_relaxed);
+    shard->statsTimer_.expires_from_now(std::chrono::milliseconds(statsPeriodMs_));
+    shard->statsTimer_.async_wait([this, shard](const boost::system::error_code& e){
+        if (e != boost::asio::error::operation_aborted)
+        {
+            updateStats(shard);
+            scheduleStats(shard);
+        }
+    });
+}
+
+void
+ConsumerRuntimeImpl::updateStats(Shard* shard)
+{
+    int64_t now = clock::microsecondTimestamp();
+    int64_t cpu = threadCpuUsec();
+    int64_t delay = std::max<int64_t>(0, now - shard->statsDueUsec_.load(std::memory_order_relaxed));
+
+    if (shard->lastWallUsec_ && now > shard->lastWallUsec_)
+        shard->cpuUsage_.store((double)(cpu - shard->lastCpuUsec_)/(double)(now - shard->lastWallUsec_),
+                               std::memory_order_relaxed);
+
+    shard->ioDelayUsec_.store(delay, std::memory_order_relaxed);
+    if (delay > shard->maxIoDelayUsec_.load(std::memory_order_relaxed))
+        shard->maxIoDelayUsec_.store(delay, std::memory_order_relaxed);
+
+    shard->lastWallUsec_ = now;
+    shard->lastCpuUsec_ = cpu;
+
+    LogTraceC << "shard " << shard->no_ << " cpu " << shard->cpuUsage_.load()
+              << " io delay " << delay << "usec" << std::endl;
+}
@@ -0,0 +1,521 @@
+//
+// content-store.cpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include "content-store.hpp"
+
+#include <algorithm>
+#include <ndn-cpp/c/common.h>
+#include <ndn-cpp/interest.hpp>
+#include <ndn-cpp/data.hpp>
+
+#include "name-components.hpp"
+
+using namespace ndnrtc;
+using namespace ndn;
+
+using std::placeholders::_1;
+using std::placeholders::_2;
+using std::placeholders::_3;
+using std::placeholders::_4;
+using std::placeholders::_5;
+
+// the ring holds ~4 seconds of 30 FPS video, which is longer than
+// default minimum cache lifetime
+const unsigned int ContentStore::DefaultRingSize = 128;
+const unsigned int ContentStore::TickMs = 10;
+
+namespace {
+    // wheel of 256 ticks covers 2.56 seconds; expirations further away go
+    // around the wheel until due
+    const size_t WheelSize = 256;
+    // lifetime of Interests that don't specify one
+    const int64_t DefaultInterestLifetimeMs = 4000;
+}
+
+//******************************************************************************
+ContentStore::PendingInterest::PendingInterest(const std::shared_ptr<const Interest> &interest,
+                                               Face &face)
+    : interest_(interest), face_(face),
+      timeoutPeriodStart_(ndn_getNowMilliseconds())
+{
+    Milliseconds lifetime = interest_->getInterestLifetimeMilliseconds();
+    timeoutTime_ = timeoutPeriodStart_ + (lifetime >= 0 ? lifetime : DefaultInterestLifetimeMs);
+}
+
+//******************************************************************************
+ContentStore::ContentStore(Face *face, boost::asio::io_service &io,
+                           const std::shared_ptr<statistics::StatisticsStorage> &statStorage,
+                           unsigned int ringSize)
+    : StatObject(statStorage),
+      Periodic(io),
+      face_(face),
+      ringSize_(ringSize),
+      minimumCacheLifetimeMs_(0),
+      nSamples_(0), nPending_(0),
+      rings_(8), pending_(2 * ringSize),
+      nSatisfied_(0), nSent_(0),
+      generationDelayHistogram_({5., 20., 100.}),
+      wheel_(WheelSize), wheelTick_(0), nScheduled_(0)
+{
+    assert(ringSize_);
+    description_ = "content-store";
+}
+
+ContentStore::~ContentStore()
+{
+    cancelInvocation();
+
+    if (face_)
+        for (auto id : filterIds_)
+            face_->unsetInterestFilter(id);
+}
+
+void ContentStore::setInterestFilter(const Name &prefix)
+{
+    assert(face_);
+    filterIds_.push_back(face_->setInterestFilter(prefix,
+                                                  std::bind(&ContentStore::onInterest, this, _1, _2, _3, _4, _5)));
+}
+
+void ContentStore::add(const Data &data)
+{
+    int64_t now = (int64_t)ndn_getNowMilliseconds();
+    Milliseconds freshness = data.getMetaInfo().getFreshnessPeriod();
+    // data without freshness period never becomes stale
+    int64_t staleMs = (freshness >= 0 ? now + (int64_t)freshness : INT64_MAX);
+    int64_t removeMs = now + std::max((int64_t)freshness, (int64_t)minimumCacheLifetimeMs_);
+
+    std::shared_ptr<const Data> d = std::make_shared<Data>(data);
+    NameHandle handle;
+
+    // encoding is cached by data and is shared by all faces it's sent to
+    d->wireEncode();
+
+    if (NameComponents::extractHandle(data.getName(), handle) && handle.hasSeqNo_)
+    {
+        addSample(handle, d, staleMs, removeMs);
+
+        SampleKey key(handle);
+        PendingInterests *pendingInterests = pending_.find(key);
+
+        if (pendingInterests)
+        {
+            satisfy(*pendingInterests, *d);
+            if (pendingInterests->empty())
+                pending_.erase(key);
+        }
+    }
+    else
+    {
+        addOther(d, staleMs, removeMs);
+        satisfy(otherPending_, *d);
+    }
+}
+
+std::shared_ptr<const Data>
+ContentStore::find(const Interest &interest) const
+{
+    int64_t now = (int64_t)ndn_getNowMilliseconds();
+    NameHandle handle;
+
+    if (NameComponents::extractHandle(interest.getName(), handle, false) && handle.hasSeqNo_)
+    {
+        const Sample *sample = findSample(handle);
+        return (sample ? findInSample(*sample, handle, interest, now) : std::shared_ptr<const Data>());
+    }
+
+    return findOther(interest, now);
+}
+
+void ContentStore::getPendingInterestsForName(const Name &name,
+                                              PendingInterests &pendingInterests) const
+{
+    NameHandle handle;
+    const PendingInterests *candidates = &otherPending_;
+
+    if (NameComponents::extractHandle(name, handle) && handle.hasSeqNo_)
+        candidates = pending_.find(SampleKey(handle));
+
+    if (candidates)
+        for (auto &pi : *candidates)
+            if (pi->getInterest()->matchesName(name))
+                pendingInterests.push_back(pi);
+}
+
+void ContentStore::getPendingInterestsWithPrefix(const Name &prefix,
+                                                 PendingInterests &pendingInterests) const
+{
+    NameHandle handle;
+
+    if (NameComponents::extractHandle(prefix, handle) && handle.hasSeqNo_)
+    {
+        const PendingInterests *bucket = pending_.find(SampleKey(handle));
+        if (bucket)
+            for (auto &pi : *bucket)
+                if (prefix.isPrefixOf(pi->getInterest()->getName()))
+                    pendingInterests.push_back(pi);
+        return;
+    }
+
+    pending_.forEach([&prefix, &pendingInterests](const SampleKey &, const PendingInterests &bucket) {
+        for (auto &pi : bucket)
+            if (prefix.isPrefixOf(pi->getInterest()->getName()))
+                pendingInterests.push_back(pi);
+    });
+
+    for (auto &pi : otherPending_)
+        if (prefix.isPrefixOf(pi->getInterest()->getName()))
+            pendingInterests.push_back(pi);
+}
+
+void ContentStore::onInterest(const std::shared_ptr<const Name> &prefix,
+                              const std::shared_ptr<const Interest> &interest,
+                              Face &face, uint64_t interestFilterId,
+                              const std::shared_ptr<const InterestFilter> &filter)
+{
+    int64_t now = (int64_t)ndn_getNowMilliseconds();
+    NameHandle handle;
+    std::shared_ptr<const Data> data;
+    bool isSample = NameComponents::extractHandle(interest->getName(), handle, false) && handle.hasSeqNo_;
+
+    if (isSample)
+    {
+        const Sample *sample = findSample(handle);
+        if (sample)
+            data = findInSample(*sample, handle, *interest, now);
+    }
+    else
+        data = findOther(*interest, now);
+
+    if (data)
+    {
+        face.putData(*data);
+        if (isSample && onSampleHit_)
+            onSampleHit_(handle, *interest);
+        return;
+    }
+
+    std::shared_ptr<PendingInterest> pi = std::make_shared<PendingInterest>(interest, face);
+    Expiration e(Expiration::ExpireInterest, (int64_t)pi->getTimeoutTime());
+    e.interest_ = pi;
+
+    if (isSample)
+    {
+        e.hasKey_ = true;
+        e.key_ = SampleKey(handle);
+
+        PendingInterests *bucket = pending_.find(e.key_);
+        if (!bucket)
+        {
+            pending_.insert(e.key_, PendingInterests());
+            bucket = pending_.find(e.key_);
+        }
+        bucket->push_back(pi);
+    }
+    else
+        otherPending_.push_back(pi);
+
+    nPending_++;
+    schedule(e);
+}
+
+#pragma mark - private
+SampleKey
+ContentStore::ringKey(const NameHandle &handle)
+{
+    NameHandle h(handle);
+    h.sampleNo_ = 0;
+    return SampleKey(h);
+}
+
+const ContentStore::Sample *
+ContentStore::findSample(const NameHandle &handle) const
+{
+    const std::shared_ptr<SampleRing> *ring = rings_.find(ringKey(handle));
+    if (!ring)
+        return nullptr;
+
+    const Sample &sample = (**ring)[handle.sampleNo_ % ringSize_];
+    return (sample.used_ && sample.sampleNo_ == handle.sampleNo_ ? &sample : nullptr);
+}
+
+std::shared_ptr<const Data>
+ContentStore::findInSample(const Sample &sample, const NameHandle &handle,
+                           const Interest &interest, int64_t now) const
+{
+    auto matches = [&interest, now](const Item &item) {
+        return item.data_ &&
+               (!interest.getMustBeFresh() || now < item.staleMs_) &&
+               interest.matchesName(item.data_->getName());
+    };
+
+    if (handle.hasSegNo_ && (handle.segmentClass_ == SegmentClass::Data ||
+                             handle.segmentClass_ == SegmentClass::Parity))
+    {
+        const std::vector<Item> &segments = (handle.segmentClass_ == SegmentClass::Data ? sample.data_ : sample.parity_);
+        if (handle.segNo_ < segments.size() && matches(segments[handle.segNo_]))
+            return segments[handle.segNo_].data_;
+        return std::shared_ptr<const Data>();
+    }
+
+    // Interest for sample prefix or manifest
+    for (auto segments : {&sample.data_, &sample.parity_, &sample.other_})
+        for (auto &item : *segments)
+            if (matches(item))
+                return item.data_;
+
+    return std::shared_ptr<const Data>();
+}
+
+std::shared_ptr<const Data>
+ContentStore::findOther(const Interest &interest, int64_t now) const
+{
+    const Name &name = interest.getName();
+    std::map<Name, Item>::const_iterator best = other_.end();
+
+    // names under Interest name form a contiguous range in canonical order;
+    // pick the first data of the rightmost child
+    for (auto it = other_.lower_bound(name); it != other_.end() && name.isPrefixOf(it->first); ++it)
+    {
+        if ((interest.getMustBeFresh() && now >= it->second.staleMs_) ||
+            !interest.matchesName(it->first))
+            continue;
+
+        if (it->first.size() == name.size())
+            return it->second.data_;
+
+        if (best == other_.end() ||
+            it->first.get(name.size()).compare(best->first.get(name.size())) > 0)
+            best = it;
+    }
+
+    return (best == other_.end() ? std::shared_ptr<const Data>() : best->second.data_);
+}
+
+void ContentStore::addSample(const NameHandle &handle, const std::shared_ptr<const Data> &data,
+                             int64_t staleMs, int64_t removeMs)
+{
+    SampleKey key = ringKey(handle);
+    std::shared_ptr<SampleRing> *ring = rings_.find(key);
+
+    if (!ring)
+    {
+        rings_.insert(key, std::make_shared<SampleRing>(ringSize_));
+        ring = rings_.find(key);
+    }
+
+    Sample &sample = (**ring)[handle.sampleNo_ % ringSize_];
+
+    if (!sample.used_ || sample.sampleNo_ != handle.sampleNo_)
+    {
+        // data for a sample that is older than the ring (e.g. NACK for a
+        // late Interest) is not stored, but still answers pending Interests
+        if (sample.used_ && sample.sampleNo_ > handle.sampleNo_)
+            return;
+
+        if (!sample.used_)
+            nSamples_++;
+
+        sample.clear();
+        sample.used_ = true;
+        sample.sampleNo_ = handle.sampleNo_;
+        sample.generation_++;
+        sample.removeMs_ = removeMs;
+
+        Expiration e(Expiration::ExpireSample, removeMs);
+        e.hasKey_ = true;
+        e.key_ = key;
+        e.sampleNo_ = handle.sampleNo_;
+        e.generation_ = sample.generation_;
+        schedule(e);
+    }
+    else
+        sample.removeMs_ = std::max(sample.removeMs_, removeMs);
+
+    std::vector<Item> *segments = &sample.other_;
+    if (handle.hasSegNo_ && handle.segmentClass_ == SegmentClass::Data)
+        segments = &sample.data_;
+    else if (handle.hasSegNo_ && handle.segmentClass_ == SegmentClass::Parity)
+        segments = &sample.parity_;
+
+    if (segments == &sample.other_)
+        segments->push_back({data, staleMs});
+    else
+    {
+        if (segments->size() <= handle.segNo_)
+            segments->resize(handle.segNo_ + 1, Item{std::shared_ptr<const Data>(), 0});
+        (*segments)[handle.segNo_] = {data, staleMs};
+    }
+}
+
+void ContentStore::addOther(const std::shared_ptr<const Data> &data, int64_t staleMs, int64_t removeMs)
+{
+    other_[data->getName()] = {data, staleMs};
+
+    Expiration e(Expiration::ExpireData, removeMs);
+    e.data_ = data;
+    schedule(e);
+}
+
+void ContentStore::satisfy(PendingInterests &pendingInterests, const Data &data)
+{
+    PendingInterests::iterator it = pendingInterests.begin();
+    ndn::MillisecondsSince1970 now = ndn_getNowMilliseconds();
+    unsigned int nSatisfied = 0;
+
+    faces_.clear();
+    while (it != pendingInterests.end())
+    {
+        if ((*it)->getInterest()->matchesName(data.getName()))
+        {
+            // one data satisfies all matching Interests pending on a face
+            Face *face = &(*it)->getFace();
+            if (std::find(faces_.begin(), faces_.end(), face) == faces_.end())
+            {
+                face->putData(data);
+                faces_.push_back(face);
+            }
+
+            double generationDelayMs = now - (*it)->getTimeoutPeriodStart();
+            generationDelay_.newValue(generationDelayMs);
+            generationDelayHistogram_.newValue(generationDelayMs);
+
+            nSatisfied++;
+            it = pendingInterests.erase(it);
+            nPending_--;
+        }
+        else
+            ++it;
+    }
+
+    if (nSatisfied)
+    {
+        nSatisfied_ += nSatisfied;
+        nSent_ += faces_.size();
+        fanOut_.newValue(nSatisfied);
+
+        if (nSatisfied > 1)
+            LogTraceC << "aggregated " << nSatisfied << " Interests for "
+                      << data.getName() << " into " << faces_.size() << " data" << std::endl;
+
+        if (statStorage_)
+        {
+            const std::vector<uint64_t> &counts = generationDelayHistogram_.getCounts();
+
+            (*statStorage_)[statistics::Indicator::FanOut] = fanOut_.value();
+            (*statStorage_)[statistics::Indicator::AggregationRatio] = (double)nSatisfied_ / (double)nSent_;
+            (*statStorage_)[statistics::Indicator::GenerationDelay] = generationDelay_.value();
+            (*statStorage_)[statistics::Indicator::GenerationDelayUnder5ms] = counts[0];
+            (*statStorage_)[statistics::Indicator::GenerationDelayUnder20ms] = counts[1];
+            (*statStorage_)[statistics::Indicator::GenerationDelayUnder100ms] = counts[2];
+            (*statStorage_)[statistics::Indicator::GenerationDelayOver100ms] = counts[3];
+        }
+    }
+}
+
+void ContentStore::schedule(const Expiration &e)
+{
+    if (nScheduled_ == 0)
+        wheelTick_ = (int64_t)ndn_getNowMilliseconds() / TickMs;
+
+    scheduleAt(e, std::max(e.expireMs_ / (int64_t)TickMs, wheelTick_ + 1));
+
+    if (!isPeriodicInvocationSet())
+        setupInvocation(TickMs, std::bind(&ContentStore::onTick, this));
+}
+
+void ContentStore::scheduleAt(const Expiration &e, int64_t tick)
+{
+    wheel_[tick % WheelSize].push_back(e);
+    nScheduled_++;
+}
+
+unsigned int ContentStore::onTick()
+{
+    int64_t now = (int64_t)ndn_getNowMilliseconds();
+    int64_t nowTick = now / TickMs;
+    // each slot is visited once at most, even if timer was late for more
+    // than a whole wheel turn
+    int64_t lastTick = std::min(nowTick, wheelTick_ + (int64_t)WheelSize);
+
+    while (wheelTick_ < lastTick)
+    {
+        ++wheelTick_;
+        due_.swap(wheel_[wheelTick_ % WheelSize]);
+        nScheduled_ -= due_.size();
+
+        for (auto &e : due_)
+            if (e.expireMs_ > now)
+                scheduleAt(e, std::max(e.expireMs_ / (int64_t)TickMs, nowTick + 1));
+            else
+                expire(e, now);
+
+        due_.clear();
+    }
+    wheelTick_ = nowTick;
+
+    return (nScheduled_ ? TickMs : 0);
+}
+
+void ContentStore::expire(const Expiration &e, int64_t now)
+{
+    switch (e.kind_)
+    {
+    case Expiration::ExpireSample:
+    {
+        std::shared_ptr<SampleRing> *ring = rings_.find(e.key_);
+        if (!ring)
+            break;
+
+        Sample &sample = (**ring)[e.sampleNo_ % ringSize_];
+        // slot may have been re-used for a newer sample already
+        if (!sample.used_ || sample.generation_ != e.generation_)
+            break;
+
+        if (sample.removeMs_ > now)
+        {
+            Expiration later(e);
+            later.expireMs_ = sample.removeMs_;
+            scheduleAt(later, std::max(later.expireMs_ / (int64_t)TickMs, wheelTick_ + 1));
+        }
+        else
+        {
+            sample.clear();
+            nSamples_--;
+        }
+    }
+    break;
+    case Expiration::ExpireData:
+    {
+        std::map<Name, Item>::iterator it = other_.find(e.data_->getName());
+        if (it != other_.end() && it->second.data_ == e.data_)
+            other_.erase(it);
+    }
+    break;
+    case Expiration::ExpireInterest:
+    {
+        PendingInterests *bucket = (e.hasKey_ ? pending_.find(e.key_) : &otherPending_);
+        if (!bucket)
+            break;
+
+        PendingInterests::iterator it = std::find(bucket->begin(), bucket->end(), e.interest_);
+        if (it != bucket->end())
+        {
+            bucket->erase(it);
+            nPending_--;
+
+            LogTraceC << "timeout " << e.interest_->getInterest()->getName() << std::endl;
+        }
+
+        if (e.hasKey_ && bucket->empty())
+            pending_.erase(e.key_);
+    }
+    break;
+    default:
+        break;
+    }
+}
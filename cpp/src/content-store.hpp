@@ -0,0 +1,241 @@
+//
+// content-store.hpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#ifndef __content_store_h__
+#define __content_store_h__
+
+#include <map>
+#include <functional>
+#include <boost/asio.hpp>
+#include <ndn-cpp/face.hpp>
+
+#include "estimators.hpp"
+#include "ndnrtc-object.hpp"
+#include "periodic.hpp"
+#include "sample-index.hpp"
+#include "statistics.hpp"
+
+namespace ndnrtc
+{
+
+/**
+ * ContentStore is producer-side in-memory store for published data. It is
+ * a replacement for ndn::MemoryContentCache, tailored for NDN-RTC
+ * namespace:
+ *  - samples' segments are kept in a ring of recent samples per thread and
+ *    sample class; Interest for a segment is matched by its thread, class,
+ *    sample and segment numbers, without scanning the store;
+ *  - Interests that can not be answered are kept pending, bucketed by
+ *    sample, thus looking up Interests pending for the segment that is
+ *    being published costs one hash lookup;
+ *  - data and pending Interests expire on a timer wheel - there are no
+ *    full sweeps of the store.
+ * Pending Interests are aggregated: data is wire-encoded once, when it is
+ * added, and this encoding is sent once per face, no matter how many
+ * Interests it satisfies on that face. Thus, the cost of serving many
+ * consumers scales with the number of unique segments rather than with
+ * the number of Interests. Store reports fan-out (Interests satisfied per
+ * segment), aggregation ratio (Interests satisfied per data sent) and
+ * distribution of generation delays (time Interests were pending) into
+ * statistics storage, if one is provided.
+ * Data that does not belong to a sample (stream and thread meta, for
+ * instance) is kept in an ordered map; Interest for such data is answered
+ * with the rightmost child (i.e. the latest version) under Interest name.
+ * Data is kept in the store for the longer of its freshness period and
+ * minimum cache lifetime; once freshness period is over, data is no longer
+ * returned for Interests with MustBeFresh flag.
+ * ContentStore is not thread-safe: all calls, as well as face callbacks,
+ * are expected on the face io_service thread.
+ */
+class ContentStore : public NdnRtcComponent,
+                     public statistics::StatObject,
+                     private Periodic
+{
+  public:
+    // number of samples kept per thread and sample class
+    static const unsigned int DefaultRingSize;
+    // resolution of data and Interests expiration
+    static const unsigned int TickMs;
+
+    class PendingInterest
+    {
+      public:
+        PendingInterest(const std::shared_ptr<const ndn::Interest> &interest,
+                        ndn::Face &face);
+
+        const std::shared_ptr<const ndn::Interest> &getInterest() const { return interest_; }
+        ndn::Face &getFace() const { return face_; }
+        // Interest arrival time
+        ndn::MillisecondsSince1970 getTimeoutPeriodStart() const { return timeoutPeriodStart_; }
+        ndn::MillisecondsSince1970 getTimeoutTime() const { return timeoutTime_; }
+
+      private:
+        std::shared_ptr<const ndn::Interest> interest_;
+        ndn::Face &face_;
+        ndn::MillisecondsSince1970 timeoutPeriodStart_, timeoutTime_;
+    };
+
+    typedef std::vector<std::shared_ptr<const PendingInterest>> PendingInterests;
+    typedef std::function<void(const NameHandle &handle, const ndn::Interest &interest)> OnSampleHit;
+
+    ContentStore(ndn::Face *face, boost::asio::io_service &io,
+                 const std::shared_ptr<statistics::StatisticsStorage> &statStorage = nullptr,
+                 unsigned int ringSize = DefaultRingSize);
+    ~ContentStore();
+
+    /**
+     * Sets interest filter on the face; Interests that can not be answered
+     * from the store are kept pending until matching data is added or
+     * Interest times out.
+     */
+    void setInterestFilter(const ndn::Name &prefix);
+
+    void setMinimumCacheLifetime(unsigned int lifetimeMs) { minimumCacheLifetimeMs_ = lifetimeMs; }
+
+    /**
+     * Sets callback called every time Interest for a sample's segment is
+     * answered from the store (e.g. retransmission of a segment that was
+     * lost after it was published).
+     */
+    void setOnSampleHit(const OnSampleHit &onSampleHit) { onSampleHit_ = onSampleHit; }
+    unsigned int getMinimumCacheLifetime() const { return minimumCacheLifetimeMs_; }
+
+    /**
+     * Adds data to the store and answers Interests pending for it.
+     */
+    void add(const ndn::Data &data);
+
+    /**
+     * Finds data that satisfies Interest.
+     * @return Data or nullptr if there's no such data in the store
+     */
+    std::shared_ptr<const ndn::Data> find(const ndn::Interest &interest) const;
+
+    /**
+     * Returns Interests pending for data with given name.
+     */
+    void getPendingInterestsForName(const ndn::Name &name,
+                                    PendingInterests &pendingInterests) const;
+
+    /**
+     * Returns pending Interests which names start with given prefix. Sample
+     * prefix is looked up in sample's bucket, other prefixes require
+     * iterating over all buckets.
+     */
+    void getPendingInterestsWithPrefix(const ndn::Name &prefix,
+                                       PendingInterests &pendingInterests) const;
+
+    /**
+     * Interest filter callback.
+     */
+    void onInterest(const std::shared_ptr<const ndn::Name> &prefix,
+                    const std::shared_ptr<const ndn::Interest> &interest,
+                    ndn::Face &face, uint64_t interestFilterId,
+                    const std::shared_ptr<const ndn::InterestFilter> &filter);
+
+    size_t getSamplesNum() const { return nSamples_; }
+    size_t getPendingNum() const { return nPending_; }
+
+  private:
+    ContentStore(const ContentStore &) = delete;
+
+    typedef struct _Item
+    {
+        std::shared_ptr<const ndn::Data> data_;
+        int64_t staleMs_;
+    } Item;
+
+    // segments of one sample; data and parity segments are indexed by
+    // segment number, anything else (manifest) is kept in a list
+    typedef struct _Sample
+    {
+        _Sample() : sampleNo_(0), generation_(0), removeMs_(0), used_(false) {}
+
+        PacketNumber sampleNo_;
+        uint32_t generation_;
+        int64_t removeMs_;
+        bool used_;
+        std::vector<Item> data_, parity_, other_;
+
+        void clear()
+        {
+            // vectors keep their capacity for the next sample
+            data_.clear();
+            parity_.clear();
+            other_.clear();
+            used_ = false;
+        }
+    } Sample;
+
+    typedef std::vector<Sample> SampleRing;
+
+    typedef struct _Expiration
+    {
+        typedef enum _Kind
+        {
+            ExpireSample,
+            ExpireData,
+            ExpireInterest
+        } Kind;
+
+        _Expiration(Kind kind, int64_t expireMs)
+            : kind_(kind), expireMs_(expireMs), hasKey_(false),
+              sampleNo_(0), generation_(0) {}
+
+        Kind kind_;
+        int64_t expireMs_;
+        // ring key for samples, bucket key for Interests
+        bool hasKey_;
+        SampleKey key_;
+        PacketNumber sampleNo_;
+        uint32_t generation_;
+        std::shared_ptr<const ndn::Data> data_;
+        std::shared_ptr<const PendingInterest> interest_;
+    } Expiration;
+
+    ndn::Face *face_;
+    unsigned int ringSize_, minimumCacheLifetimeMs_;
+    std::vector<uint64_t> filterIds_;
+    OnSampleHit onSampleHit_;
+    size_t nSamples_, nPending_;
+
+    // rings are keyed by sample key with zero sample number
+    SampleIndex<std::shared_ptr<SampleRing>> rings_;
+    std::map<ndn::Name, Item> other_;
+    SampleIndex<PendingInterests> pending_;
+    PendingInterests otherPending_;
+
+    // faces data was sent to while satisfying pending Interests
+    std::vector<ndn::Face *> faces_;
+    uint64_t nSatisfied_, nSent_;
+    estimators::Filter fanOut_, generationDelay_;
+    estimators::Histogram generationDelayHistogram_;
+
+    std::vector<std::vector<Expiration>> wheel_;
+    std::vector<Expiration> due_;
+    int64_t wheelTick_;
+    size_t nScheduled_;
+
+    static SampleKey ringKey(const NameHandle &handle);
+    const Sample *findSample(const NameHandle &handle) const;
+    std::shared_ptr<const ndn::Data> findInSample(const Sample &sample, const NameHandle &handle,
+                                                  const ndn::Interest &interest, int64_t now) const;
+    std::shared_ptr<const ndn::Data> findOther(const ndn::Interest &interest, int64_t now) const;
+
+    void addSample(const NameHandle &handle, const std::shared_ptr<const ndn::Data> &data,
+                   int64_t staleMs, int64_t removeMs);
+    void addOther(const std::shared_ptr<const ndn::Data> &data, int64_t staleMs, int64_t removeMs);
+    void satisfy(PendingInterests &pendingInterests, const ndn::Data &data);
+
+    void schedule(const Expiration &e);
+    void scheduleAt(const Expiration &e, int64_t tick);
+    unsigned int onTick();
+    void expire(const Expiration &e, int64_t now);
+};
+}
+
+#endif
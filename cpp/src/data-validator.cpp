@@ -11,6 +11,7 @@
 #include <ndn-cpp/security/key-chain.hpp>
 
 #include "slot-buffer.hpp"
+#include "key-chain-lock.hpp"
 
 using namespace ndnrtc;
 using namespace std;
@@ -32,7 +33,7 @@ template<typename KeyChainType>
 void DataValidator<KeyChainType>::validate(const std::shared_ptr<ndn::Data>& data)
 {
     LogDebugC << "verifying data " << data->getName().toUri() << std::endl;
-    keyChain_->verifyData(data,
+    verifyData(*keyChain_, data,
                           bind(&DataValidator::onVerifySuccess, this, _1),
                           (const OnDataValidationFailed)bind(&DataValidator::onVerifyFailure, this, _1, _2));
 
@@ -0,0 +1,108 @@
+//
+// encoder-worker.cpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include "encoder-worker.hpp"
+#include "video-thread.hpp"
+#include "frame-data.hpp"
+#include "clock.hpp"
+
+using namespace ndnrtc;
+
+static StageOverflow toStageOverflow(EncoderWorkerSettings::DropPolicy policy)
+{
+    return (policy == EncoderWorkerSettings::DropNewest ? StageOverflow::DropNewest
+                                                       : StageOverflow::DropOldest);
+}
+
+//******************************************************************************
+EncoderWorker::EncoderWorker(const VideoCoderParams &coderParams,
+                             const EncoderWorkerSettings &settings, unsigned int core)
+    : settings_(settings),
+      core_(core),
+      thread_(std::make_shared<VideoThread>(coderParams)),
+      stage_(std::max(1u, settings.queueSize_), toStageOverflow(settings.dropPolicy_))
+{
+    if (settings_.queueSize_ == 0)
+        settings_.queueSize_ = 1;
+    description_ = "encoder-worker";
+}
+
+EncoderWorker::~EncoderWorker()
+{
+    stop();
+}
+
+void EncoderWorker::start(OnFrameEncoded onEncoded, OnFrameDropped onDropped)
+{
+    if (stage_.isRunning())
+        return;
+
+    onEncoded_ = onEncoded;
+    onDropped_ = onDropped;
+    stage_.start(std::bind(&EncoderWorker::encode, this, std::placeholders::_1),
+                 std::bind(&EncoderWorker::onJobDropped, this, std::placeholders::_1));
+
+    if (settings_.pinToCores_ && !stage_.pinToCore(core_))
+        LogWarnC << "failed to pin worker to core " << core_ << std::endl;
+
+    LogDebugC << "started (queue " << settings_.queueSize_ << ", "
+              << (settings_.dropPolicy_ == EncoderWorkerSettings::DropOldest ? "drop oldest" : "drop newest")
+              << (settings_.pinToCores_ ? ", core " : "")
+              << (settings_.pinToCores_ ? std::to_string(core_) : "") << ")" << std::endl;
+}
+
+void EncoderWorker::stop()
+{
+    if (!stage_.isRunning())
+        return;
+
+    stage_.stop();
+    LogDebugC << "stopped" << std::endl;
+}
+
+bool EncoderWorker::enqueue(const WebRtcVideoFrame &frame, PacketNumber playbackNo)
+{
+    return stage_.push(std::make_shared<Job>(frame, playbackNo));
+}
+
+void EncoderWorker::setDescription(const std::string &desc)
+{
+    description_ = desc;
+    thread_->setDescription("thread-" + desc);
+}
+
+void EncoderWorker::setLogger(std::shared_ptr<ndnlog::new_api::Logger> logger)
+{
+    thread_->setLogger(logger);
+    ILoggingObject::setLogger(logger);
+}
+
+//******************************************************************************
+void EncoderWorker::encode(const JobPtr &job)
+{
+    int64_t encodeStartUsec = clock::microsecondTimestamp();
+    FramePacketPtr fp = thread_->encode(job->frame_);
+    double encodeMs = (double)(clock::microsecondTimestamp() - encodeStartUsec) / 1000.;
+
+    LogTraceC << "encoded " << job->playbackNo_ << "p in " << encodeMs << "ms" << std::endl;
+
+    if (fp.get())
+    {
+        if (onEncoded_)
+            onEncoded_(fp, job->playbackNo_, encodeMs,
+                       (unsigned char)thread_->getCoder().getGopCounter());
+    }
+    else if (onDropped_)
+        onDropped_(job->playbackNo_);
+}
+
+void EncoderWorker::onJobDropped(const JobPtr &job)
+{
+    LogWarnC << "queue is full, dropped " << job->playbackNo_ << "p" << std::endl;
+    if (onDropped_)
+        onDropped_(job->playbackNo_);
+}
@@ -0,0 +1,97 @@
+//
+// encoder-worker.hpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#ifndef __encoder_worker_h__
+#define __encoder_worker_h__
+
+#include "local-stream.hpp"
+#include "ndnrtc-common.hpp"
+#include "ndnrtc-object.hpp"
+#include "pipeline-stage.hpp"
+#include "webrtc.hpp"
+
+namespace ndnrtc
+{
+class VideoThread;
+struct Mutable;
+template <typename T>
+class VideoFramePacketT;
+
+/**
+ * EncoderWorker is the encoding stage of the producer pipeline. It is a
+ * long-lived thread that owns one VideoThread (encoder instance). Frames,
+ * already scaled to the encoder's resolution, are handed off to the worker
+ * through a bounded lock-free queue, so the scaling stage never waits for an
+ * encoder to finish. When the queue is full, a frame is dropped according
+ * to the drop policy set in EncoderWorkerSettings.
+ * Encoded frames are delivered using OnFrameEncoded callback which is invoked
+ * on the worker thread, right after encoding completes.
+ */
+class EncoderWorker : public NdnRtcComponent
+{
+  public:
+    typedef std::shared_ptr<VideoFramePacketT<Mutable>> FramePacketPtr;
+    typedef std::function<void(const FramePacketPtr &, PacketNumber playbackNo,
+                               double encodeMs, unsigned char gopPos)>
+        OnFrameEncoded;
+    typedef std::function<void(PacketNumber playbackNo)> OnFrameDropped;
+
+    /**
+     * @param coderParams Encoder parameters for the video thread
+     * @param settings Queue size, drop policy and core pinning settings
+     * @param core CPU core to pin worker thread to (ignored if pinning is
+     *             disabled in settings)
+     */
+    EncoderWorker(const VideoCoderParams &coderParams,
+                  const EncoderWorkerSettings &settings, unsigned int core = 0);
+    ~EncoderWorker();
+
+    void start(OnFrameEncoded onEncoded, OnFrameDropped onDropped);
+    void stop();
+    bool isRunning() const { return stage_.isRunning(); }
+
+    /**
+     * Hands off scaled frame to the worker. Never blocks on encoding.
+     * @return false if incoming frame was dropped (DropNewest policy and the
+     *         queue is full), true otherwise
+     */
+    bool enqueue(const WebRtcVideoFrame &frame, PacketNumber playbackNo);
+
+    size_t getQueueDepth() const { return stage_.getOccupancy(); }
+    // smoothed time (in ms) between frame hand-off and encoding completion
+    double getLatency() const { return stage_.getLatency(); }
+    const VideoThread &getThread() const { return *thread_; }
+
+    void setDescription(const std::string &desc);
+    void setLogger(std::shared_ptr<ndnlog::new_api::Logger> logger);
+
+  private:
+    EncoderWorker(const EncoderWorker &) = delete;
+
+    typedef struct _Job
+    {
+        _Job(const WebRtcVideoFrame &frame, PacketNumber playbackNo)
+            : frame_(frame), playbackNo_(playbackNo) {}
+
+        WebRtcVideoFrame frame_;
+        PacketNumber playbackNo_;
+    } Job;
+    typedef std::shared_ptr<Job> JobPtr;
+
+    EncoderWorkerSettings settings_;
+    unsigned int core_;
+    std::shared_ptr<VideoThread> thread_;
+    OnFrameEncoded onEncoded_;
+    OnFrameDropped onDropped_;
+    PipelineStage<JobPtr> stage_;
+
+    void encode(const JobPtr &job);
+    void onJobDropped(const JobPtr &job);
+};
+}
+
+#endif
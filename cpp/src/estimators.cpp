@@ -8,6 +8,7 @@
 #include <cstdlib>
 #include <vector>
 #include <cmath>
+#include <algorithm>
 
 #include "estimators.hpp"
 #include "clock.hpp"
@@ -124,3 +125,21 @@ Filter::newValue(double value)
 	else
 		value_ += (value-value_)*smoothing_;
 }
+
+Histogram::Histogram(const std::vector<double>& bounds):
+bounds_(bounds), counts_(bounds.size()+1, 0), total_(0)
+{}
+
+void
+Histogram::newValue(double value)
+{
+	counts_[std::upper_bound(bounds_.begin(), bounds_.end(), value) - bounds_.begin()]++;
+	total_++;
+}
+
+void
+Histogram::reset()
+{
+	std::fill(counts_.begin(), counts_.end(), 0);
+	total_ = 0;
+}
@@ -11,6 +11,8 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <deque>
+#include <vector>
+#include <stdint.h>
 #include <boost/shared_ptr.hpp>
 #include <boost/move/move.hpp>
 
@@ -135,6 +137,28 @@ namespace ndnrtc {
 		private:
 			double smoothing_,value_;
 		};
+
+		/**
+		 * Histogram counts values falling into buckets defined by bucket upper
+		 * bounds (exclusive, ascending). Last bucket collects values equal to
+		 * or over the largest bound, thus there is one more bucket than bounds.
+		 */
+		class Histogram {
+		public:
+			Histogram(const std::vector<double>& bounds);
+
+			void newValue(double value);
+			void reset();
+
+			const std::vector<double>& getBounds() const { return bounds_; }
+			const std::vector<uint64_t>& getCounts() const { return counts_; }
+			uint64_t getTotal() const { return total_; }
+
+		private:
+			std::vector<double> bounds_;
+			std::vector<uint64_t> counts_;
+			uint64_t total_;
+		};
 	}
 }
 
@@ -0,0 +1,248 @@
+//
+// event-trace.cpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include "event-trace.hpp"
+
+#include <string.h>
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/lock_guard.hpp>
+
+#include "clock.hpp"
+
+using namespace ndnrtc;
+using namespace ndnrtc::trace;
+
+static_assert(sizeof(Record) == 24, "trace record must be 24 bytes long");
+
+namespace {
+    const char TraceMagic[8] = { 'N', 'R', 'T', 'C', 'T', 'R', 'C', 0 };
+    const uint32_t TraceVersion = 1;
+
+    typedef struct _FileHeader {
+        char magic_[8];
+        uint32_t version_;
+        uint32_t recordSize_;
+        uint32_t nThreads_;
+        uint32_t reserved_;
+        int64_t unixOffsetUsec_;
+    } FileHeader;
+
+    typedef struct _ThreadHeader {
+        uint64_t threadId_;
+        uint64_t nRecords_;
+    } ThreadHeader;
+
+    // head_ is the total number of records made, written by owning thread
+    // only; start_ is the number of records discarded by clear(), written
+    // by clear() under registry mutex and only read by the owning thread
+    struct Ring {
+        Ring(uint64_t threadId):threadId_(threadId), head_(0), start_(0){}
+
+        const uint64_t threadId_;
+        std::atomic<uint64_t> head_, start_;
+        Record records_[Tracer::RingSize];
+    };
+
+    boost::mutex& registryMutex()
+    {
+        static boost::mutex mutex;
+        return mutex;
+    }
+
+    std::vector<std::shared_ptr<Ring>>& registry()
+    {
+        static std::vector<std::shared_ptr<Ring>> rings;
+        return rings;
+    }
+
+    // removes thread's ring from registry when thread exits; ring is freed
+    // once dump() in progress (if any) releases it
+    struct RingOwner {
+        ~RingOwner()
+        {
+            if (ring_)
+            {
+                boost::lock_guard<boost::mutex> scopedLock(registryMutex());
+                std::vector<std::shared_ptr<Ring>>& rings = registry();
+                rings.erase(std::remove(rings.begin(), rings.end(), ring_), rings.end());
+            }
+        }
+
+        std::shared_ptr<Ring> ring_;
+    };
+
+    thread_local Ring* threadRing = nullptr;
+
+    Ring* getThreadRing()
+    {
+        if (!threadRing)
+        {
+            // not accessed on hot path, as it has non-trivial destructor
+            static thread_local RingOwner owner;
+            owner.ring_ = std::make_shared<Ring>(
+                std::hash<std::thread::id>()(std::this_thread::get_id()));
+            boost::lock_guard<boost::mutex> scopedLock(registryMutex());
+            registry().push_back(owner.ring_);
+            threadRing = owner.ring_.get();
+        }
+
+        return threadRing;
+    }
+
+    // copies records that were not overwritten while copying
+    void snapshot(const Ring& ring, std::vector<Record>& records)
+    {
+        uint64_t head = ring.head_.load(std::memory_order_acquire);
+        uint64_t start = std::max(ring.start_.load(std::memory_order_relaxed),
+            (head > Tracer::RingSize ? head - Tracer::RingSize : 0));
+
+        records.resize(head - start);
+        for (uint64_t i = start; i < head; ++i)
+            memcpy(&records[i-start], &ring.records_[i%Tracer::RingSize], sizeof(Record));
+
+        // records are read before head_ is re-read (pairs with the release
+        // fence in Tracer::doRecord); writer may be writing record at index
+        // newHead right now
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t newHead = ring.head_.load(std::memory_order_relaxed);
+        if (newHead + 1 > start + Tracer::RingSize)
+        {
+            uint64_t nOverwritten = std::min<uint64_t>(records.size(),
+                newHead + 1 - Tracer::RingSize - start);
+            records.erase(records.begin(), records.begin()+nOverwritten);
+        }
+    }
+}
+
+const size_t Tracer::RingSize;
+std::atomic<bool> Tracer::enabled_(true);
+
+void
+Tracer::doRecord(Event event, int32_t sampleNo, int32_t segNo,
+                 uint16_t flags, uint32_t arg)
+{
+    Ring* ring = getThreadRing();
+    uint64_t head = ring->head_.load(std::memory_order_relaxed);
+    Record& r = ring->records_[head%RingSize];
+
+    // reader that sees any part of this record sees head_ value stored
+    // before it (see snapshot())
+    std::atomic_thread_fence(std::memory_order_release);
+
+    r.timestampUsec_ = clock::microsecondTimestamp();
+    r.sampleNo_ = sampleNo;
+    r.segNo_ = segNo;
+    r.event_ = (uint16_t)event;
+    r.flags_ = flags;
+    r.arg_ = arg;
+
+    ring->head_.store(head+1, std::memory_order_release);
+}
+
+int
+Tracer::dump(const std::string& path)
+{
+    std::vector<std::shared_ptr<Ring>> rings;
+    {
+        boost::lock_guard<boost::mutex> scopedLock(registryMutex());
+        rings = registry();
+    }
+
+    std::ofstream file(path, std::ios::binary|std::ios::trunc);
+    if (!file.good())
+        return -1;
+
+    FileHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic_, TraceMagic, sizeof(TraceMagic));
+    hdr.version_ = TraceVersion;
+    hdr.recordSize_ = sizeof(Record);
+    hdr.nThreads_ = rings.size();
+    hdr.unixOffsetUsec_ = clock::millisecSinceEpoch()*1000 - clock::microsecondTimestamp();
+    file.write((const char*)&hdr, sizeof(hdr));
+
+    int nRecords = 0;
+    std::vector<Record> records;
+    records.reserve(RingSize);
+
+    for (auto& ring:rings)
+    {
+        snapshot(*ring, records);
+
+        ThreadHeader thdr;
+        thdr.threadId_ = ring->threadId_;
+        thdr.nRecords_ = records.size();
+        file.write((const char*)&thdr, sizeof(thdr));
+        file.write((const char*)records.data(), records.size()*sizeof(Record));
+        nRecords += records.size();
+    }
+
+    return (file.good() ? nRecords : -1);
+}
+
+void
+Tracer::clear()
+{
+    boost::lock_guard<boost::mutex> scopedLock(registryMutex());
+    for (auto& ring:registry())
+        ring->start_.store(ring->head_.load(std::memory_order_acquire),
+            std::memory_order_relaxed);
+}
+
+bool
+Tracer::read(const std::string& path, std::vector<ThreadTrace>& traces,
+             int64_t& unixOffsetUsec)
+{
+    std::ifstream file(path, std::ios::binary);
+    FileHeader hdr;
+
+    if (!file.read((char*)&hdr, sizeof(hdr)) ||
+        memcmp(hdr.magic_, TraceMagic, sizeof(TraceMagic)) != 0 ||
+        hdr.version_ != TraceVersion || hdr.recordSize_ != sizeof(Record))
+        return false;
+
+    traces.clear();
+    unixOffsetUsec = hdr.unixOffsetUsec_;
+
+    for (uint32_t i = 0; i < hdr.nThreads_; ++i)
+    {
+        ThreadHeader thdr;
+        if (!file.read((char*)&thdr, sizeof(thdr)) || thdr.nRecords_ > RingSize)
+            return false;
+
+        traces.push_back(ThreadTrace());
+        traces.back().threadId_ = thdr.threadId_;
+        traces.back().records_.resize(thdr.nRecords_);
+
+        if (!file.read((char*)traces.back().records_.data(), thdr.nRecords_*sizeof(Record)))
+            return false;
+    }
+
+    return true;
+}
+
+std::string
+Tracer::toString(Event event)
+{
+    switch (event) {
+        case Event::SegmentRequested: return "seg-requested";
+        case Event::SegmentReceived: return "seg-received";
+        case Event::SegmentTimeout: return "seg-timeout";
+        case Event::SegmentNack: return "seg-nack";
+        case Event::SampleAssembling: return "sample-assembling";
+        case Event::SampleReady: return "sample-ready";
+        case Event::SampleInvalidated: return "sample-invalidated";
+        case Event::SamplePlayed: return "sample-played";
+        case Event::SampleSkipped: return "sample-skipped";
+        default: return "unknown";
+    }
+}
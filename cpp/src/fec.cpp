@@ -9,12 +9,22 @@
 //
 
 #include <iostream>
+#include <atomic>
+#include <algorithm>
 #include <string.h>
 #include "fec.hpp"
 
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define FEC_X86_KERNELS
+#include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define FEC_NEON_KERNEL
+#include <arm_neon.h>
+#endif
+
 using namespace fec;
 
-namespace fec 
+namespace fec
 {
     double parityWeight()
     {
@@ -24,96 +34,556 @@ namespace fec
 
 //******************************************************************************
 #pragma mark - construction/destruction
-Rs28Encoder::Rs28Encoder(unsigned int nSourceSymbols,
-                         unsigned int nRepairSymbols,
-                         unsigned int symbolLength):
-Rs28Coder(nSourceSymbols, nRepairSymbols, symbolLength)
+OpenFecRs28Coder::OpenFecRs28Coder(unsigned int nSourceSymbols,
+                                   unsigned int nRepairSymbols,
+                                   unsigned int symbolLength):
+FecCoder(nSourceSymbols, nRepairSymbols, symbolLength),
+encoderSession_(nullptr),
+symbolTable_(nSourceSymbols+nRepairSymbols)
 {
+    of_parameters_t* params = (of_parameters_t*)&rsParameters_;
+
+    memset(&rsParameters_, 0, sizeof(rsParameters_));
+    params->nb_source_symbols = nSourceSymbols_;
+    params->nb_repair_symbols = nRepairSymbols_;
+    params->encoding_symbol_length = symbolLength_;
+}
+
+OpenFecRs28Coder::~OpenFecRs28Coder()
+{
+    if (encoderSession_)
+        of_release_codec_instance(encoderSession_);
 }
 
 int
-Rs28Encoder::encode(unsigned char* data, unsigned char* parityData)
+OpenFecRs28Coder::encode(unsigned char* data, unsigned char* parityData)
 {
-    initCoder();
-    
-    if (!Rs28Coder<OF_ENCODER>::isCoderReady_)
+    if (!encoderSession_)
+        encoderSession_ = createSession(OF_ENCODER);
+
+    if (!encoderSession_)
         return -1;
-    
+
     int ret = 0;
-    unsigned char** encodingSymbolTable = buildSymbolTable(data, parityData);
-    of_parameters_t* params = Rs28Coder<OF_ENCODER>::coderParameters_;
-    of_session_t* session = Rs28Coder<OF_ENCODER>::coderSession_;
-    
-    for (UINT32 esi = params->nb_source_symbols;
-         esi < params->nb_source_symbols + params->nb_repair_symbols && ret >= 0;
+    buildSymbolTable(data, parityData);
+
+    for (UINT32 esi = nSourceSymbols_;
+         esi < nSourceSymbols_ + nRepairSymbols_ && ret >= 0;
          esi++)
     {
-				memset(encodingSymbolTable[esi], 0, params->encoding_symbol_length);
-        
-				if (of_build_repair_symbol(session, (void**)encodingSymbolTable, esi) != OF_STATUS_OK)
-				{
+        memset(symbolTable_[esi], 0, symbolLength_);
+
+        if (of_build_repair_symbol(encoderSession_, (void**)symbolTable_.data(), esi) != OF_STATUS_OK)
             ret = -1;
-				}
     }
-    
-    releaseSymbolTable(encodingSymbolTable);
-    
-    return ret;
-}
 
-//******************************************************************************
-#pragma mark - construction/destruction
-Rs28Decoder::Rs28Decoder(unsigned int nSourceSymbols,
-                         unsigned int nRepairSymbols,
-                         unsigned int symbolLength):
-Rs28Coder(nSourceSymbols, nRepairSymbols, symbolLength)
-{
+    return ret;
 }
 
 int
-Rs28Decoder::decode(unsigned char* data, unsigned char* parityData,
-                    unsigned char* rList)
+OpenFecRs28Coder::decode(unsigned char* data, unsigned char* parityData,
+                         unsigned char* rList)
 {
-    initCoder();
-    
-    if (!Rs28Coder<OF_DECODER>::isCoderReady_)
+    // decoding session accumulates state of the block, can't be reused
+    of_session_t* session = createSession(OF_DECODER);
+
+    if (!session)
         return -1;
-    
+
     int ret = 0;
-    unsigned char** decodingSymbolTable = buildSymbolTable(data, parityData, rList);
-    of_session_t* session = Rs28Coder<OF_DECODER>::coderSession_;
-    
+    buildSymbolTable(data, parityData, rList);
+
+    // only source symbols are recovered, flags of missing repair symbols
+    // are left as they are
     for (unsigned int i = 0; i < nSourceSymbols_+nRepairSymbols_; i++)
     {
         if (rList[i] == FEC_RLIST_SYMREADY)
-            of_decode_with_new_symbol(session, decodingSymbolTable[i], i);
-        else
+            of_decode_with_new_symbol(session, symbolTable_[i], i);
+        else if (i < nSourceSymbols_)
             rList[i] = FEC_RLIST_INPROCESS;
     }
-    
-    if (of_finish_decoding(coderSession_) != OF_STATUS_OK)
+
+    if (of_finish_decoding(session) != OF_STATUS_OK)
         ret = -1;
     else
     {
-        if(of_get_source_symbols_tab(session, (void**)decodingSymbolTable) != OF_STATUS_OK)
+        if(of_get_source_symbols_tab(session, (void**)symbolTable_.data()) != OF_STATUS_OK)
             ret = -1;
         else
         {
-            for (int i = 0; i < nSourceSymbols_+nRepairSymbols_; i++)
+            for (int i = 0; i < nSourceSymbols_; i++)
                 if (rList[i] == FEC_RLIST_INPROCESS)
                 {
                     rList[i] = FEC_RLIST_SYMREPAIRED;
                     ret++;
-                    if (i < nSourceSymbols_)
-                    {
-                        memcpy(&data[i*symbolLength_], decodingSymbolTable[i], symbolLength_);
-                        free(decodingSymbolTable[i]);
-                    }
+                    memcpy(&data[i*symbolLength_], symbolTable_[i], symbolLength_);
+                    free(symbolTable_[i]);
+                }
+        }
+    }
+
+    of_release_codec_instance(session);
+
+    return ret;
+}
+
+of_session_t*
+OpenFecRs28Coder::createSession(of_codec_type_t type)
+{
+    of_session_t* session = nullptr;
+
+    if (of_create_codec_instance(&session, OF_CODEC_REED_SOLOMON_GF_2_8_STABLE,
+                                 type, 0) != OF_STATUS_OK)
+        return nullptr;
+
+    if (of_set_fec_parameters(session, (of_parameters_t*)&rsParameters_) != OF_STATUS_OK)
+    {
+        of_release_codec_instance(session);
+        return nullptr;
+    }
+
+    return session;
+}
+
+void
+OpenFecRs28Coder::buildSymbolTable(unsigned char* data, unsigned char* parityData,
+                                   unsigned char* rList)
+{
+    for (int i = 0; i < nSourceSymbols_+nRepairSymbols_; i++)
+    {
+        if (i < nSourceSymbols_)
+            symbolTable_[i] = &data[i*symbolLength_];
+        else
+            symbolTable_[i] = &parityData[(i-nSourceSymbols_)*symbolLength_];
+
+        if (rList && rList[i] == FEC_RLIST_SYMEMPTY)
+            symbolTable_[i] = NULL;
+    }
+}
+
+//******************************************************************************
+namespace {
+    // GF(2^8) arithmetic tables, generator polynomial x^8+x^4+x^3+x^2+1
+    class GaloisField {
+    public:
+        uint8_t exp_[510];
+        uint8_t log_[256];
+        uint8_t mul_[256][256];
+
+        GaloisField()
+        {
+            unsigned int x = 1;
+
+            for (int i = 0; i < 255; ++i)
+            {
+                exp_[i] = exp_[i+255] = (uint8_t)x;
+                log_[x] = (uint8_t)i;
+                x <<= 1;
+                if (x & 0x100) x ^= 0x11D;
+            }
+            log_[0] = 0;
+
+            for (int a = 0; a < 256; ++a)
+                for (int b = 0; b < 256; ++b)
+                    mul_[a][b] = (a && b ? exp_[log_[a]+log_[b]] : 0);
+        }
+
+        uint8_t inv(uint8_t a) const { return exp_[255-log_[a]]; }
+    };
+
+    const GaloisField& gf()
+    {
+        static GaloisField field;
+        return field;
+    }
+
+    // dst ^= c*src
+    typedef void (*MulAddRegion)(uint8_t* dst, const uint8_t* src, uint8_t c, size_t len);
+
+    void mulAddScalar(uint8_t* dst, const uint8_t* src, uint8_t c, size_t len)
+    {
+        const uint8_t* row = gf().mul_[c];
+        for (size_t i = 0; i < len; ++i)
+            dst[i] ^= row[src[i]];
+    }
+
+    // split-nibble tables: c*x = lo[x & 0xf] ^ hi[x >> 4]
+    void nibbleTables(uint8_t c, uint8_t* lo, uint8_t* hi)
+    {
+        const uint8_t* row = gf().mul_[c];
+        for (int i = 0; i < 16; ++i)
+        {
+            lo[i] = row[i];
+            hi[i] = row[i << 4];
+        }
+    }
+
+#ifdef FEC_X86_KERNELS
+    __attribute__((target("ssse3")))
+    void mulAddSsse3(uint8_t* dst, const uint8_t* src, uint8_t c, size_t len)
+    {
+        uint8_t lo[16], hi[16];
+        nibbleTables(c, lo, hi);
+
+        __m128i tlo = _mm_loadu_si128((const __m128i*)lo);
+        __m128i thi = _mm_loadu_si128((const __m128i*)hi);
+        __m128i mask = _mm_set1_epi8(0x0f);
+        size_t i = 0;
+
+        for (; i + 16 <= len; i += 16)
+        {
+            __m128i s = _mm_loadu_si128((const __m128i*)(src+i));
+            __m128i l = _mm_and_si128(s, mask);
+            __m128i h = _mm_and_si128(_mm_srli_epi64(s, 4), mask);
+            __m128i p = _mm_xor_si128(_mm_shuffle_epi8(tlo, l), _mm_shuffle_epi8(thi, h));
+            __m128i d = _mm_loadu_si128((const __m128i*)(dst+i));
+            _mm_storeu_si128((__m128i*)(dst+i), _mm_xor_si128(d, p));
+        }
+
+        if (i < len)
+            mulAddScalar(dst+i, src+i, c, len-i);
+    }
+
+    __attribute__((target("avx2")))
+    void mulAddAvx2(uint8_t* dst, const uint8_t* src, uint8_t c, size_t len)
+    {
+        uint8_t lo[16], hi[16];
+        nibbleTables(c, lo, hi);
+
+        __m256i tlo = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)lo));
+        __m256i thi = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)hi));
+        __m256i mask = _mm256_set1_epi8(0x0f);
+        size_t i = 0;
+
+        for (; i + 32 <= len; i += 32)
+        {
+            __m256i s = _mm256_loadu_si256((const __m256i*)(src+i));
+            __m256i l = _mm256_and_si256(s, mask);
+            __m256i h = _mm256_and_si256(_mm256_srli_epi64(s, 4), mask);
+            __m256i p = _mm256_xor_si256(_mm256_shuffle_epi8(tlo, l), _mm256_shuffle_epi8(thi, h));
+            __m256i d = _mm256_loadu_si256((const __m256i*)(dst+i));
+            _mm256_storeu_si256((__m256i*)(dst+i), _mm256_xor_si256(d, p));
+        }
+
+        if (i < len)
+            mulAddScalar(dst+i, src+i, c, len-i);
+    }
+#endif
+
+#ifdef FEC_NEON_KERNEL
+    void mulAddNeon(uint8_t* dst, const uint8_t* src, uint8_t c, size_t len)
+    {
+        uint8_t lo[16], hi[16];
+        nibbleTables(c, lo, hi);
+
+        uint8x16_t tlo = vld1q_u8(lo);
+        uint8x16_t thi = vld1q_u8(hi);
+        uint8x16_t mask = vdupq_n_u8(0x0f);
+        size_t i = 0;
+
+        for (; i + 16 <= len; i += 16)
+        {
+            uint8x16_t s = vld1q_u8(src+i);
+            uint8x16_t p = veorq_u8(vqtbl1q_u8(tlo, vandq_u8(s, mask)),
+                                    vqtbl1q_u8(thi, vshrq_n_u8(s, 4)));
+            vst1q_u8(dst+i, veorq_u8(vld1q_u8(dst+i), p));
+        }
+
+        if (i < len)
+            mulAddScalar(dst+i, src+i, c, len-i);
+    }
+#endif
+
+    class RegionKernel {
+    public:
+        MulAddRegion mulAdd_;
+        const char* name_;
+
+        RegionKernel():mulAdd_(&mulAddScalar), name_("scalar")
+        {
+#if defined(FEC_X86_KERNELS)
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2"))
+            {
+                mulAdd_ = &mulAddAvx2;
+                name_ = "avx2";
+            }
+            else if (__builtin_cpu_supports("ssse3"))
+            {
+                mulAdd_ = &mulAddSsse3;
+                name_ = "ssse3";
+            }
+#elif defined(FEC_NEON_KERNEL)
+            mulAdd_ = &mulAddNeon;
+            name_ = "neon";
+#endif
+        }
+    };
+
+    const RegionKernel& kernel()
+    {
+        static RegionKernel k;
+        return k;
+    }
+
+    void mulAddRegion(uint8_t* dst, const uint8_t* src, uint8_t c, size_t len)
+    {
+        if (c == 0)
+            return;
+        if (c == 1)
+        {
+            for (size_t i = 0; i < len; ++i)
+                dst[i] ^= src[i];
+            return;
+        }
+
+        kernel().mulAdd_(dst, src, c, len);
+    }
+
+    // inverts n x n matrix in place (Gauss-Jordan), returns false if the
+    // matrix is singular
+    bool invertMatrix(uint8_t* m, unsigned int n)
+    {
+        const GaloisField& f = gf();
+        std::vector<uint8_t> inv(n*n, 0);
+
+        for (unsigned int i = 0; i < n; ++i)
+            inv[i*n+i] = 1;
+
+        for (unsigned int col = 0; col < n; ++col)
+        {
+            unsigned int pivot = col;
+            while (pivot < n && m[pivot*n+col] == 0) pivot++;
+            if (pivot == n)
+                return false;
+
+            if (pivot != col)
+                for (unsigned int j = 0; j < n; ++j)
+                {
+                    std::swap(m[pivot*n+j], m[col*n+j]);
+                    std::swap(inv[pivot*n+j], inv[col*n+j]);
+                }
+
+            uint8_t c = f.inv(m[col*n+col]);
+            for (unsigned int j = 0; j < n; ++j)
+            {
+                m[col*n+j] = f.mul_[c][m[col*n+j]];
+                inv[col*n+j] = f.mul_[c][inv[col*n+j]];
+            }
+
+            for (unsigned int row = 0; row < n; ++row)
+            {
+                uint8_t factor = m[row*n+col];
+                if (row == col || factor == 0)
+                    continue;
+
+                for (unsigned int j = 0; j < n; ++j)
+                {
+                    m[row*n+j] ^= f.mul_[factor][m[col*n+j]];
+                    inv[row*n+j] ^= f.mul_[factor][inv[col*n+j]];
                 }
+            }
         }
+
+        memcpy(m, inv.data(), n*n);
+        return true;
+    }
+}
+
+NativeRs28Coder::NativeRs28Coder(unsigned int nSourceSymbols,
+                                 unsigned int nRepairSymbols,
+                                 unsigned int symbolLength):
+FecCoder(nSourceSymbols, nRepairSymbols, symbolLength),
+isValid_(nSourceSymbols > 0 && nSourceSymbols+nRepairSymbols <= 255),
+rows_(nSourceSymbols),
+symbols_(nSourceSymbols)
+{
+    if (!isValid_)
+        return;
+
+    const GaloisField& f = gf();
+    unsigned int k = nSourceSymbols_, n = nSourceSymbols_+nRepairSymbols_;
+    std::vector<uint8_t> vdm(n*k, 0);
+
+    // Vandermonde matrix for points 0, 1, a, a^2, ... (a = 2)
+    vdm[0] = 1;
+    for (unsigned int row = 1; row < n; ++row)
+        for (unsigned int col = 0; col < k; ++col)
+            vdm[row*k+col] = f.exp_[((row-1)*col)%255];
+
+    // systematic form: multiply by inverse of the top k x k matrix
+    isValid_ = invertMatrix(vdm.data(), k);
+    if (!isValid_)
+        return;
+
+    encMatrix_.assign(n*k, 0);
+    for (unsigned int i = 0; i < k; ++i)
+        encMatrix_[i*k+i] = 1;
+
+    for (unsigned int row = k; row < n; ++row)
+        for (unsigned int col = 0; col < k; ++col)
+        {
+            uint8_t v = 0;
+            for (unsigned int i = 0; i < k; ++i)
+                v ^= f.mul_[vdm[row*k+i]][vdm[i*k+col]];
+            encMatrix_[row*k+col] = v;
+        }
+
+    decMatrix_.resize(k*k);
+}
+
+int
+NativeRs28Coder::encode(unsigned char* data, unsigned char* parityData)
+{
+    if (!isValid_)
+        return -1;
+
+    unsigned int k = nSourceSymbols_;
+
+    for (unsigned int r = 0; r < nRepairSymbols_; ++r)
+    {
+        unsigned char* parity = parityData + r*symbolLength_;
+        const uint8_t* coefs = &encMatrix_[(k+r)*k];
+
+        memset(parity, 0, symbolLength_);
+        for (unsigned int j = 0; j < k; ++j)
+            mulAddRegion(parity, data + j*symbolLength_, coefs[j], symbolLength_);
+    }
+
+    return 0;
+}
+
+int
+NativeRs28Coder::decode(unsigned char* data, unsigned char* parityData,
+                        unsigned char* rList)
+{
+    if (!isValid_)
+        return -1;
+
+    unsigned int k = nSourceSymbols_, n = nSourceSymbols_+nRepairSymbols_;
+    unsigned int nRows = 0, nMissing = 0;
+
+    // pick k available symbols: all received source symbols first, then
+    // as many repair symbols as needed
+    for (unsigned int i = 0; i < k; ++i)
+        if (rList[i] == FEC_RLIST_SYMREADY)
+            rows_[nRows++] = i;
+        else
+            nMissing++;
+
+    if (nMissing == 0)
+        return 0;
+
+    for (unsigned int i = k; i < n && nRows < k; ++i)
+        if (rList[i] == FEC_RLIST_SYMREADY)
+            rows_[nRows++] = i;
+
+    if (nRows < k)
+        return -1;
+
+    for (unsigned int t = 0; t < k; ++t)
+    {
+        memcpy(&decMatrix_[t*k], &encMatrix_[rows_[t]*k], k);
+        symbols_[t] = (rows_[t] < k ? data + rows_[t]*symbolLength_ :
+                        parityData + (rows_[t]-k)*symbolLength_);
     }
-    
-    releaseSymbolTable(decodingSymbolTable);
-    
+
+    if (!invertMatrix(decMatrix_.data(), k))
+        return -1;
+
+    // missing source symbols are not among the inputs, so they can be
+    // reconstructed in place
+    int ret = 0;
+    for (unsigned int i = 0; i < k; ++i)
+        if (rList[i] != FEC_RLIST_SYMREADY)
+        {
+            unsigned char* symbol = data + i*symbolLength_;
+
+            memset(symbol, 0, symbolLength_);
+            for (unsigned int t = 0; t < k; ++t)
+                mulAddRegion(symbol, symbols_[t], decMatrix_[i*k+t], symbolLength_);
+
+            rList[i] = FEC_RLIST_SYMREPAIRED;
+            ret++;
+        }
+
     return ret;
 }
+
+const char*
+NativeRs28Coder::getKernelName()
+{
+    return kernel().name_;
+}
+
+//******************************************************************************
+namespace {
+    std::atomic<int> CoderBackend((int)Backend::Native);
+    const size_t CoderCacheSize = 32;
+
+    struct CachedCoder {
+        Backend backend_;
+        unsigned int nSource_, nRepair_, symbolLength_;
+        std::shared_ptr<FecCoder> coder_;
+    };
+}
+
+namespace fec
+{
+    void setBackend(Backend backend)
+    {
+        CoderBackend = (int)backend;
+    }
+
+    Backend getBackend()
+    {
+        return (Backend)CoderBackend.load();
+    }
+
+    std::shared_ptr<FecCoder> getCoder(unsigned int nSourceSymbols,
+                                       unsigned int nRepairSymbols,
+                                       unsigned int symbolLength)
+    {
+        // most recently used coders are in front
+        static thread_local std::vector<CachedCoder> cache;
+        Backend backend = getBackend();
+
+        for (auto it = cache.begin(); it != cache.end(); ++it)
+            if (it->backend_ == backend && it->nSource_ == nSourceSymbols &&
+                it->nRepair_ == nRepairSymbols && it->symbolLength_ == symbolLength)
+            {
+                std::rotate(cache.begin(), it, it+1);
+                return cache.front().coder_;
+            }
+
+        CachedCoder entry = { backend, nSourceSymbols, nRepairSymbols, symbolLength,
+            std::shared_ptr<FecCoder>() };
+
+        if (backend == Backend::OpenFec)
+            entry.coder_ = std::make_shared<OpenFecRs28Coder>(nSourceSymbols, nRepairSymbols, symbolLength);
+        else
+            entry.coder_ = std::make_shared<NativeRs28Coder>(nSourceSymbols, nRepairSymbols, symbolLength);
+
+        cache.insert(cache.begin(), entry);
+        if (cache.size() > CoderCacheSize)
+            cache.pop_back();
+
+        return entry.coder_;
+    }
+}
+
+//******************************************************************************
+Rs28Encoder::Rs28Encoder(unsigned int nSourceSymbols,
+                         unsigned int nRepairSymbols,
+                         unsigned int symbolLength):
+coder_(getCoder(nSourceSymbols, nRepairSymbols, symbolLength))
+{
+}
+
+//******************************************************************************
+Rs28Decoder::Rs28Decoder(unsigned int nSourceSymbols,
+                         unsigned int nRepairSymbols,
+                         unsigned int symbolLength):
+coder_(getCoder(nSourceSymbols, nRepairSymbols, symbolLength))
+{
+}
@@ -12,6 +12,9 @@
 #define __ndnrtc__fec__
 
 #include <cstdlib>
+#include <stdint.h>
+#include <vector>
+#include <memory>
 
 #define FEC_RLIST_SYMREADY '1'
 #define FEC_RLIST_SYMEMPTY '0'
@@ -36,15 +39,16 @@ namespace fec
      * This returns a "weight" of parity segment in relation to normal
      * data segment. For example, if weight is 0.5, it means
      * that 1 data segment is equivalent to 2 parity segments, or, in other
-     * words, one need at least 2 parity segments to recover 1 missed data 
+     * words, one need at least 2 parity segments to recover 1 missed data
      * segment.
      */
     double parityWeight();
 
     /**
-     * This is the base class for Encoder/Decoder derived classes
+     * This is the base class for FEC coders. Coder is created for a fixed
+     * number of source and repair symbols of fixed length and can be used
+     * for encoding and decoding any number of blocks with these parameters.
      */
-    template <of_codec_id_t CoderID, of_codec_type_t CoderType>
     class FecCoder
     {
     public:
@@ -53,142 +57,178 @@ namespace fec
                  unsigned int symbolLength):
         nSourceSymbols_(nSourceSymbols),
         nRepairSymbols_(nRepairSymbols),
-        symbolLength_(symbolLength),
-        coderSession_(nullptr),
-        coderParameters_(nullptr),
-        isCoderCreated_(false),
-        coderId_(CoderID),
-        coderType_(CoderType)
-        {
-        }
-        
+        symbolLength_(symbolLength){}
+
         virtual
-        ~FecCoder()
-        {
-            if (isCoderCreated_)
-                releaseCoder();
-        }
-        
-        int
-        getCoderId() { return coderId_; }
-        
-        int
-        getCoderType() { return coderType_; }
-        
+        ~FecCoder(){}
+
+        /**
+         * Computes repair symbols.
+         * @param data Buffer of nSourceSymbols*symbolLength bytes
+         * @param parityData Buffer of nRepairSymbols*symbolLength bytes where
+         *                   repair symbols are written to
+         * @return 0 on success, -1 otherwise
+         */
+        virtual int
+        encode(unsigned char* data, unsigned char* parityData) = 0;
+
+        /**
+         * Recovers missing source symbols in place. Missing repair symbols
+         * are not recovered. All backends follow the same contract.
+         * @param data Buffer of source symbols
+         * @param parityData Buffer of repair symbols
+         * @param rList Array of nSourceSymbols+nRepairSymbols flags,
+         *              FEC_RLIST_SYMREADY marks symbols that are available;
+         *              repaired source symbols are marked with
+         *              FEC_RLIST_SYMREPAIRED, flags of missing repair symbols
+         *              are left unchanged
+         * @return number of repaired source symbols or -1 if decoding failed
+         */
+        virtual int
+        decode(unsigned char* data, unsigned char* parityData,
+               unsigned char* rList) = 0;
+
+        unsigned int getSourceSymbolsNum() const { return nSourceSymbols_; }
+        unsigned int getRepairSymbolsNum() const { return nRepairSymbols_; }
+        unsigned int getSymbolLength() const { return symbolLength_; }
+
     protected:
-        bool isCoderCreated_, isCoderReady_;
         uint32_t nSourceSymbols_, nRepairSymbols_, symbolLength_;
-        of_session_t* coderSession_ = NULL;
-        of_parameters_t* coderParameters_ = NULL;
-        
-        virtual void
-        initCoder()
-        {
-            
-            isCoderCreated_ = (of_create_codec_instance(&coderSession_, coderId_,
-                                                        coderType_, 0) == OF_STATUS_OK);
-            
-            if (coderParameters_)
-            {
-                coderParameters_->nb_source_symbols = nSourceSymbols_;
-                coderParameters_->nb_repair_symbols = nRepairSymbols_;
-                coderParameters_->encoding_symbol_length = symbolLength_;
-
-                isCoderReady_ = (of_set_fec_parameters(coderSession_, coderParameters_) == OF_STATUS_OK);
-            }
-        }
-        
-        virtual void
-        releaseCoder()
-        {
-            if (isCoderCreated_)
-            {
-                isCoderCreated_ = !(of_release_codec_instance(coderSession_) == OF_STATUS_OK);
-            }
-            
-            if (isCoderReady_)
-                free(coderParameters_);
-        }
-        
-        unsigned char**
-        buildSymbolTable(unsigned char* data, unsigned char* parityData,
-                         unsigned char* rList = nullptr)
-        {
-            unsigned char** encodingSymbolTable = (unsigned char**)malloc(sizeof(char*)*(nSourceSymbols_+nRepairSymbols_));
-            
-            for (int i = 0; i < nSourceSymbols_+nRepairSymbols_; i++)
-            {
-                if (i < nSourceSymbols_)
-                    encodingSymbolTable[i] = &data[i*symbolLength_];
-                else
-                    encodingSymbolTable[i] = &parityData[(i-nSourceSymbols_)*symbolLength_];
-
-                if (rList && rList[i] == FEC_RLIST_SYMEMPTY)
-                    encodingSymbolTable[i] = NULL;
-            }
-            
-            return encodingSymbolTable;
-        }
-        
-        void
-        releaseSymbolTable(unsigned char** encodingSymbolTable)
-        { free(encodingSymbolTable); }
-        
+
     private:
-        of_codec_id_t coderId_;
-        of_codec_type_t coderType_;
+        FecCoder(const FecCoder&) = delete;
     };
-    
-    template <of_codec_type_t CoderType>
-    class Rs28Coder : public FecCoder<OF_CODEC_REED_SOLOMON_GF_2_8_STABLE, CoderType>
+
+    /**
+     * Reed-Solomon GF(2^8) coder backed by OpenFEC library.
+     * Encoding session is created once and reused for all blocks. OpenFEC
+     * decoding session keeps state of the block being decoded, hence it is
+     * re-created for every decoded block.
+     */
+    class OpenFecRs28Coder : public FecCoder
     {
     public:
-        Rs28Coder(unsigned int nSourceSymbols,
-         unsigned int nRepairSymbols,
-                  unsigned int symbolLength):
-        FecCoder<OF_CODEC_REED_SOLOMON_GF_2_8_STABLE, CoderType>(nSourceSymbols, nRepairSymbols, symbolLength){}
-        
-    protected:
-        void
-        initCoder()
-        {
-            of_rs_parameters_t	*rsParameters;
-            
-            rsParameters = (of_rs_parameters_t *)calloc(1, sizeof(*rsParameters));
-            FecCoder<OF_CODEC_REED_SOLOMON_GF_2_8_STABLE, CoderType>::coderParameters_ = (of_parameters_t *)rsParameters;
-            
-            FecCoder<OF_CODEC_REED_SOLOMON_GF_2_8_STABLE, CoderType>::initCoder();
-        }
+        OpenFecRs28Coder(unsigned int nSourceSymbols,
+                         unsigned int nRepairSymbols,
+                         unsigned int symbolLength);
+        ~OpenFecRs28Coder();
+
+        int
+        encode(unsigned char* data, unsigned char* parityData);
+
+        int
+        decode(unsigned char* data, unsigned char* parityData,
+               unsigned char* rList);
+
+    private:
+        of_rs_parameters_t rsParameters_;
+        of_session_t *encoderSession_;
+        std::vector<unsigned char*> symbolTable_;
+
+        of_session_t* createSession(of_codec_type_t type);
+        void buildSymbolTable(unsigned char* data, unsigned char* parityData,
+                              unsigned char* rList = nullptr);
     };
-    
-    class Rs28Encoder : public Rs28Coder<OF_ENCODER>
+
+    /**
+     * Built-in Reed-Solomon GF(2^8) coder. Implements the same systematic
+     * Vandermonde-based code as OpenFEC's RS GF(2^8) codec (L. Rizzo's
+     * construction, generator polynomial 0x11D), so symbols produced by one
+     * backend can be decoded by another. Encoding matrix is computed once
+     * per coder. Region multiplication uses split-nibble table lookups with
+     * SSSE3/AVX2 (x86) or NEON (AArch64) when available.
+     * Number of source and repair symbols must not exceed 255.
+     */
+    class NativeRs28Coder : public FecCoder
+    {
+    public:
+        NativeRs28Coder(unsigned int nSourceSymbols,
+                        unsigned int nRepairSymbols,
+                        unsigned int symbolLength);
+
+        int
+        encode(unsigned char* data, unsigned char* parityData);
+
+        int
+        decode(unsigned char* data, unsigned char* parityData,
+               unsigned char* rList);
+
+        /**
+         * Returns name of the region multiplication kernel used on this CPU
+         * ("avx2", "ssse3", "neon" or "scalar")
+         */
+        static const char* getKernelName();
+
+    private:
+        bool isValid_;
+        // (k+m) x k encoding matrix, top k rows form identity matrix
+        std::vector<uint8_t> encMatrix_;
+        std::vector<uint8_t> decMatrix_;
+        std::vector<unsigned int> rows_;
+        std::vector<unsigned char*> symbols_;
+    };
+
+    enum class Backend {
+        Native,
+        OpenFec
+    };
+
+    /**
+     * Selects coder implementation returned by getCoder(). Default is
+     * Backend::Native.
+     */
+    void setBackend(Backend backend);
+    Backend getBackend();
+
+    /**
+     * Returns coder for given parameters. Coders are cached per thread and
+     * keyed by (backend, nSourceSymbols, nRepairSymbols, symbolLength), so
+     * coding sessions are reused across frames instead of being created for
+     * every frame. Least recently used coders are evicted once the cache
+     * grows over a few dozens of entries.
+     */
+    std::shared_ptr<FecCoder> getCoder(unsigned int nSourceSymbols,
+                                       unsigned int nRepairSymbols,
+                                       unsigned int symbolLength);
+
+    /**
+     * Reed-Solomon encoder. This is a lightweight handle to a cached coder
+     * (see getCoder()), thus it's cheap to create one for every frame.
+     */
+    class Rs28Encoder
     {
     public:
         Rs28Encoder(unsigned int nSourceSymbols,
                     unsigned int nRepairSymbols,
                     unsigned int symbolLength);
-        
+
         int
-        encode(unsigned char* data, unsigned char* parityData);
-        
+        encode(unsigned char* data, unsigned char* parityData)
+        { return coder_->encode(data, parityData); }
+
     private:
-        
+        std::shared_ptr<FecCoder> coder_;
     };
-    
-    class Rs28Decoder : public Rs28Coder<OF_DECODER>
+
+    /**
+     * Reed-Solomon decoder. This is a lightweight handle to a cached coder
+     * (see getCoder()), thus it's cheap to create one for every frame.
+     */
+    class Rs28Decoder
     {
     public:
         Rs28Decoder(unsigned int nSourceSymbols,
                     unsigned int nRepairSymbols,
                     unsigned int symbolLength);
-        
+
         int
         decode(unsigned char* data, unsigned char* parityData,
-               unsigned char* rList);
-        
+               unsigned char* rList)
+        { return coder_->decode(data, parityData, rList); }
+
     private:
+        std::shared_ptr<FecCoder> coder_;
     };
-    
 }
 
 #endif /* defined(__ndnrtc__fec__) */
@@ -10,11 +10,13 @@
 
 #include "frame-buffer.hpp"
 
+#include <algorithm>
 #include <ndn-cpp/interest.hpp>
 #include <ndn-cpp/data.hpp>
 
 #include "fec.hpp"
 #include "clock.hpp"
+#include "event-trace.hpp"
 #include "frame-data.hpp"
 #include "name-components.hpp"
 #include "simple-log.hpp"
@@ -33,7 +35,7 @@ arrivalTimeUsec_(0),
 requestNo_(1),
 isVerified_(false)
 {
-    if (!NameComponents::extractInfo(interest_->getName(), interestInfo_))
+    if (!NameComponents::extractHandle(interest_->getName(), interestInfo_))
     {
         stringstream ss;
         ss << "Failed to create slot segment: wrong Interest name: " << interest_->getName();
@@ -41,7 +43,18 @@ isVerified_(false)
     }
 }
 
-const NamespaceInfo&
+SlotSegment::SlotSegment(const std::shared_ptr<const ndn::Interest>& i,
+                         const NameHandle& handle):
+interest_(i),
+interestInfo_(handle),
+requestTimeUsec_(clock::microsecondTimestamp()),
+arrivalTimeUsec_(0),
+requestNo_(1),
+isVerified_(false)
+{
+}
+
+const NameHandle&
 SlotSegment::getInfo() const
 {
     if (isFetched()) return data_->getInfo();
@@ -107,17 +120,41 @@ toString(int consistency)
     return str.str();
 }
 
-BufferSlot::BufferSlot(){ clear(); }
+BufferSlot::BufferSlot():
+frameData_(std::make_shared<std::vector<uint8_t>>()),
+parityData_(std::make_shared<std::vector<uint8_t>>())
+{ 
+    clear(); 
+}
 
 void
 BufferSlot::segmentsRequested(const std::vector<std::shared_ptr<const ndn::Interest>>& interests)
+{
+    std::vector<NameHandle> handles(interests.size());
+
+    for (size_t idx = 0; idx < interests.size(); ++idx)
+        if (!NameComponents::extractHandle(interests[idx]->getName(), handles[idx]))
+        {
+            stringstream ss;
+            ss << "Failed to create slot segment: wrong Interest name: " << interests[idx]->getName();
+            throw std::runtime_error(ss.str());
+        }
+
+    segmentsRequested(interests, handles);
+}
+
+void
+BufferSlot::segmentsRequested(const std::vector<std::shared_ptr<const ndn::Interest>>& interests,
+                              const std::vector<NameHandle>& handles)
 {
     if (state_ == Ready || state_ == Locked) 
         throw std::runtime_error("Can't add more segments because slot is ready or locked");
 
-    for (auto i:interests)
+    assert(interests.size() == handles.size());
+
+    for (size_t idx = 0; idx < interests.size(); ++idx)
     {
-        std::shared_ptr<SlotSegment> segment(std::make_shared<SlotSegment>(i));
+        std::shared_ptr<SlotSegment> segment(std::make_shared<SlotSegment>(interests[idx], handles[idx]));
         
         if (!segment->getInfo().hasSeqNo_ || !segment->getInfo().hasSegNo_)
             throw std::runtime_error("No rightmost interests allowed: Interest should have segment-level info");
@@ -126,19 +163,24 @@ BufferSlot::segmentsRequested(const std::vector<std::shared_ptr<const ndn::Inter
         {
             nameInfo_ = segment->getInfo();
             name_ = nameInfo_.getPrefix(prefix_filter::Sample);
+            key_ = SampleKey(nameInfo_);
             requestTimeUsec_ = segment->getRequestTimeUsec();
         }
-        else if (!name_.match(i->getName()))
+        else if (key_ != SampleKey(segment->getInfo()))
             throw std::runtime_error("Interest names should differ only after sample sequence number");
 
-        Name segmentKey = segment->getInfo().getSuffix(suffix_filter::Segment);
-        
-        if (requested_.find(segmentKey) != requested_.end())
+        std::vector<std::shared_ptr<SlotSegment>>& slotSegments = segments(segment->getInfo().isParity_);
+        unsigned int segNo = segment->getInfo().segNo_;
+
+        if (segNo >= slotSegments.size())
+            slotSegments.resize(segNo+1);
+
+        if (slotSegments[segNo])
         {
             nRtx_++;
-            requested_[segmentKey]->incrementRequestNum();
+            slotSegments[segNo]->incrementRequestNum();
         }
-        else requested_[segmentKey] = segment;
+        else slotSegments[segNo] = segment;
 
         if (state_ == Free) state_ = New;
     }
@@ -148,9 +190,11 @@ void
 BufferSlot::clear()
 {
     name_.clear();
-    nameInfo_ = NamespaceInfo();
-    requested_.clear();
-    fetched_.clear();
+    key_ = SampleKey();
+    nameInfo_ = NameHandle();
+    dataSegments_.clear();
+    paritySegments_.clear();
+    nFetched_ = 0;
     consistency_ = Inconsistent;
     requestTimeUsec_ = 0;
     assembledSize_ = 0;
@@ -167,6 +211,15 @@ BufferSlot::clear()
     nParitySegments_ = 0;
     verified_ = Verification::Unknown;
     manifest_.reset();
+
+    // packet read from this slot may still be in use
+    if (frameData_.use_count() > 1)
+        frameData_ = std::make_shared<std::vector<uint8_t>>();
+    else
+        frameData_->clear();
+    parityData_->clear();
+    payloadSize_ = 0;
+    nDataAssembled_ = 0;
 }
 
 const std::shared_ptr<SlotSegment>
@@ -177,23 +230,86 @@ BufferSlot::segmentReceived(const std::shared_ptr<WireSegment>& segment)
     if (state_ == Locked)
         return std::shared_ptr<SlotSegment>();
     
-    if (!name_.match(segment->getData()->getName()))
+    if (key_ != SampleKey(segment->getInfo()))
         throw std::runtime_error("Attempt to add data segment with incorrect name");
 
-    Name segmentKey = segment->getInfo().getSuffix(suffix_filter::Segment);
+    std::shared_ptr<SlotSegment> slotSegment = findSegment(segment->getInfo());
 
-    if (!segment->getInfo().hasSeqNo_ || 
-        requested_.find(segmentKey) == requested_.end())
+    if (!segment->getInfo().hasSeqNo_ || !slotSegment)
         throw std::runtime_error("Adding segment that was not previously requested");
     
-    if (fetched_.find(segmentKey) == fetched_.end())
+    if (!slotSegment->isFetched())
     {
-        lastFetched_ = fetched_[segmentKey] = requested_[segmentKey];
-        fetched_[segmentKey]->setData(segment);
-        updateConsistencyState(fetched_[segmentKey]);
+        lastFetched_ = slotSegment;
+        slotSegment->setData(segment);
+        nFetched_++;
+        updateConsistencyState(slotSegment);
+        assemble(slotSegment);
     }
 
-    return fetched_[segmentKey];
+    return slotSegment;
+}
+
+std::shared_ptr<SlotSegment>
+BufferSlot::findSegment(const NameHandle& info) const
+{
+    const std::vector<std::shared_ptr<SlotSegment>>& slotSegments = 
+        (info.isParity_ ? paritySegments_ : dataSegments_);
+
+    if (info.segNo_ < slotSegments.size())
+        return slotSegments[info.segNo_];
+    return std::shared_ptr<SlotSegment>();
+}
+
+void
+BufferSlot::assemble(const std::shared_ptr<SlotSegment>& segment)
+{
+    if (payloadSize_)
+    {
+        copyPayload(segment);
+        return;
+    }
+
+    // all segments, except the last data segment, have the same payload 
+    // size; until it's known, segments stay in the slot only
+    const NameHandle& info = segment->getInfo();
+    if (info.isParity_ || nDataSegments_ == 1 || info.segNo_+1 < nDataSegments_)
+    {
+        payloadSize_ = ImmutableDataPacket(segment->getData()->getData()->getContent()).getPayload().size();
+
+        if (payloadSize_)
+        {
+            for (auto& s:dataSegments_)
+                if (s && s->isFetched()) copyPayload(s);
+            for (auto& s:paritySegments_)
+                if (s && s->isFetched()) copyPayload(s);
+        }
+    }
+}
+
+void
+BufferSlot::copyPayload(const std::shared_ptr<SlotSegment>& segment)
+{
+    const NameHandle& info = segment->getInfo();
+
+    if (!info.isParity_ && info.segNo_ >= nDataSegments_)
+        return;
+
+    std::vector<uint8_t>& buffer = (info.isParity_ ? *parityData_ : *frameData_);
+    size_t size = payloadSize_*(info.isParity_ ? 
+        std::max(nParitySegments_, info.segNo_+1) : nDataSegments_);
+
+    // buffer is pre-sized once per packet; new bytes are zeroed which 
+    // gives padding of the last segment for FEC
+    if (buffer.size() < size)
+        buffer.resize(size, 0);
+
+    ImmutableDataPacket packet(segment->getData()->getData()->getContent());
+    size_t length = std::min(payloadSize_, packet.getPayload().size());
+    std::copy(packet.getPayload().begin(), packet.getPayload().begin()+length, 
+        buffer.begin()+info.segNo_*payloadSize_);
+
+    if (!info.isParity_) nDataAssembled_++;
 }
 
 std::vector<ndn::Name>
@@ -204,17 +320,13 @@ BufferSlot::getMissingSegments() const
     if (getFetchedNum() > 0)
     {
         for (unsigned int segNo = 0; segNo < nDataSegments_; ++segNo)
-        {
-            Name segKey = Name().appendSegment(segNo);
-            if (requested_.find(segKey) == requested_.end())
-                missing.push_back(Name(getPrefix()).append(segKey));
-        }
+            if (segNo >= dataSegments_.size() || !dataSegments_[segNo])
+                missing.push_back(Name(getPrefix()).appendSegment(segNo));
+
         for (unsigned int segNo = 0; segNo < nParitySegments_; ++segNo)
-        {
-            Name segKey = Name(NameComponents::NameComponentParity).appendSegment(segNo);
-            if (requested_.find(segKey) == requested_.end())
-                missing.push_back(Name(getPrefix()).append(segKey));
-        }
+            if (segNo >= paritySegments_.size() || !paritySegments_[segNo])
+                missing.push_back(Name(getPrefix())
+                    .append(NameComponents::NameComponentParity).appendSegment(segNo));
     }
     
     return missing;
@@ -225,22 +337,53 @@ BufferSlot::getPendingInterests() const
 {
     std::vector<std::shared_ptr<const ndn::Interest>> pendingInterests;
 
-    for (auto it:requested_)
-        if (fetched_.find(it.first) == fetched_.end())
-            pendingInterests.push_back(it.second->getInterest());
+    for (auto& s:dataSegments_)
+        if (s && s->isPending())
+            pendingInterests.push_back(s->getInterest());
+    for (auto& s:paritySegments_)
+        if (s && s->isPending())
+            pendingInterests.push_back(s->getInterest());
 
     return pendingInterests;
 }
 
+std::vector<std::shared_ptr<const ndn::Interest>>
+BufferSlot::getRecoveryInterests(unsigned int maxRtxNum) const
+{
+    std::vector<std::shared_ptr<const ndn::Interest>> interests;
+    bool hasMeta = (consistency_&SegmentMeta);
+    // any nDataSegments_ segments, data or parity, are enough for recovery
+    size_t nMissing = (hasMeta ? 
+        (nFetched_ < nDataSegments_ ? nDataSegments_-nFetched_ : 0) : 
+        dataSegments_.size()+paritySegments_.size());
+
+    for (size_t segNo = 0; segNo < dataSegments_.size() && interests.size() < nMissing; ++segNo)
+    {
+        const std::shared_ptr<SlotSegment>& s = dataSegments_[segNo];
+        if (hasMeta && segNo >= nDataSegments_) break;
+        if (s && s->isPending() && s->getRequestNum() <= maxRtxNum)
+            interests.push_back(s->getInterest());
+    }
+    for (size_t segNo = 0; segNo < paritySegments_.size() && interests.size() < nMissing; ++segNo)
+    {
+        const std::shared_ptr<SlotSegment>& s = paritySegments_[segNo];
+        if (hasMeta && segNo >= nParitySegments_) break;
+        if (s && s->isPending() && s->getRequestNum() <= maxRtxNum)
+            interests.push_back(s->getInterest());
+    }
+
+    return interests;
+}
+
 int 
 BufferSlot::getRtxNum(const ndn::Name& segmentName)
 {
-    NamespaceInfo info;
-    if (NameComponents::extractInfo(segmentName, info))
+    NameHandle info;
+    if (NameComponents::extractHandle(segmentName, info))
     {
-        Name segmentKey = info.getSuffix(suffix_filter::Segment);
-        if (requested_.find(segmentKey) != requested_.end())
-           return requested_[segmentKey]->getRequestNum()-1;
+        std::shared_ptr<SlotSegment> segment = findSegment(info);
+        if (segment)
+           return segment->getRequestNum()-1;
     }
 
     return -1;
@@ -283,10 +426,11 @@ BufferSlot::dump(bool showLastSegment) const
 const CommonHeader
 BufferSlot::getHeader() const
 {
-    if (!consistency_&HeaderMeta)
+    if (!consistency_&HeaderMeta || !dataSegments_.size() || 
+        !dataSegments_[0] || !dataSegments_[0]->isFetched())
         throw std::runtime_error("Packet header is not available");
 
-    return fetched_.at(nameInfo_.getSuffix(suffix_filter::Segment))->getData()->packetHeader();
+    return dataSegments_[0]->getData()->packetHeader();
 }
 
 void
@@ -305,6 +449,16 @@ BufferSlot::updateConsistencyState(const std::shared_ptr<SlotSegment>& segment)
         nDataSegments_ = segment->getData()->getSlicesNum();
         if (segment->getInfo().segNo_ == 0)
             consistency_ |= HeaderMeta;
+
+        // video segments advertise number of parity segments of the frame,
+        // which varies with producer's parity ratio and may be zero
+        if (segment->getInfo().streamType_ == MediaStreamParams::MediaStreamType::MediaStreamTypeVideo)
+        {
+            std::shared_ptr<WireData<VideoFrameSegmentHeader>> videoSegment =
+                std::dynamic_pointer_cast<WireData<VideoFrameSegmentHeader>>(segment->getData());
+            if (videoSegment)
+                nParitySegments_ = videoSegment->segment().getHeader().paritySegmentsNum_;
+        }
     }
     else if (segment->getInfo().segmentClass_ == SegmentClass::Parity)
         nParitySegments_ = segment->getData()->getSlicesNum();
@@ -327,7 +481,10 @@ void BufferSlot::updateAssembledLevel()
     if (consistency_&SegmentMeta)
     {
         asmLevel_ = 0;
-        for (auto& it:fetched_) asmLevel_ += it.second->getData()->getShareSize(nDataSegments_);
+        for (auto& s:dataSegments_) 
+            if (s && s->isFetched()) asmLevel_ += s->getData()->getShareSize(nDataSegments_);
+        for (auto& s:paritySegments_) 
+            if (s && s->isFetched()) asmLevel_ += s->getData()->getShareSize(nDataSegments_);
     }
 }
 
@@ -345,10 +502,8 @@ BufferSlot::toggleLock()
 }
 
 //******************************************************************************
-VideoFrameSlot::VideoFrameSlot(const size_t storageSize):
-storage_(std::make_shared<std::vector<uint8_t>>())
+VideoFrameSlot::VideoFrameSlot()
 {
-    storage_->reserve(storageSize);
     fecList_.reserve(1000);
 }
 
@@ -360,91 +515,35 @@ VideoFrameSlot::readPacket(const BufferSlot& slot, bool& recovered)
         throw std::runtime_error("Wrong slot supplied: can not read video "
             "packet from audio slot");
 
-    // check if recovery is possible
-    Name parityKey(NameComponents::NameComponentParity);
-    std::map<ndn::Name, std::shared_ptr<SlotSegment>> 
-        dataSegments(slot.fetched_.begin(), slot.fetched_.lower_bound(parityKey));
-    std::map<ndn::Name, std::shared_ptr<SlotSegment>> 
-        paritySegments(slot.fetched_.upper_bound(parityKey), slot.fetched_.end());
+    recovered = false;
 
-    if ((!paritySegments.size() && 
-        dataSegments.size() < dataSegments.begin()->second->getData()->getSlicesNum()) ||
-        dataSegments.size() == 0)
-    {
-        recovered = false;
+    // segments' payloads are already in place
+    if (!slot.payloadSize_ || !slot.nDataAssembled_)
         return std::shared_ptr<ImmutableVideoFramePacket>();
-    }
 
-    std::shared_ptr<WireData<VideoFrameSegmentHeader>> firstSeg = 
-            std::dynamic_pointer_cast<WireData<VideoFrameSegmentHeader>>(dataSegments.begin()->second->getData());
-    std::shared_ptr<WireData<VideoFrameSegmentHeader>> firstParitySeg;
+    unsigned int nDataSegmentsExpected = slot.nDataSegments_;
+    if (slot.nDataAssembled_ >= nDataSegmentsExpected)
+        return std::make_shared<ImmutableVideoFramePacket>(slot.frameData_);
 
-    if (paritySegments.size()) 
-        firstParitySeg = std::dynamic_pointer_cast<WireData<VideoFrameSegmentHeader>>(paritySegments.begin()->second->getData());
-
-    size_t segmentSize = firstSeg->segment().getPayload().size();
-    size_t paritySegSize = (paritySegments.size() ? firstParitySeg->segment().getPayload().size() : 0);
-    unsigned int nDataSegmentsExpected = firstSeg->getSlicesNum();
-    unsigned int nParitySegmentsExpected = (paritySegments.size() ? paritySegments.begin()->second->getData()->getSlicesNum() : 0);
+    unsigned int nParitySegmentsExpected = slot.parityData_->size()/slot.payloadSize_;
+    if (!nParitySegmentsExpected)
+        return std::shared_ptr<ImmutableVideoFramePacket>();
 
+    // recover missing segments in place
     fecList_.assign(nDataSegmentsExpected+nParitySegmentsExpected, FEC_RLIST_SYMEMPTY);
-    storage_->resize(segmentSize*(nDataSegmentsExpected+nParitySegmentsExpected));
-
-    int segNo = 0;
-    for (auto it:dataSegments)
-    {
-        const std::shared_ptr<WireData<VideoFrameSegmentHeader>> wd = 
-            std::dynamic_pointer_cast<WireData<VideoFrameSegmentHeader>>(it.second->getData());
-        
-        while (segNo != wd->getSegNo() && segNo < nDataSegmentsExpected)
-            storage_->insert(storage_->begin()+segmentSize*segNo++, segmentSize, 0);
-        
-        if (segNo < nDataSegmentsExpected)
-        {
-            storage_->insert(storage_->begin()+segmentSize*segNo, 
-                wd->segment().getPayload().begin(),
-                wd->segment().getPayload().end());
+    for (unsigned int segNo = 0; segNo < slot.dataSegments_.size() && segNo < nDataSegmentsExpected; ++segNo)
+        if (slot.dataSegments_[segNo] && slot.dataSegments_[segNo]->isFetched())
             fecList_[segNo] = FEC_RLIST_SYMREADY;
-            segNo++;
-        }
-    }
-
-    bool frameExtracted = false;
-    if (dataSegments.size() < nDataSegmentsExpected)
-    {
-        segNo = 0;
-        for (auto it:paritySegments)
-        {
-            const std::shared_ptr<WireData<VideoFrameSegmentHeader>> wd =
-            std::dynamic_pointer_cast<WireData<VideoFrameSegmentHeader>>(it.second->getData());
-
-            while (segNo != wd->getSegNo() && segNo < nParitySegmentsExpected)
-                storage_->insert(storage_->begin()+nDataSegmentsExpected*segmentSize + paritySegSize*segNo++, segmentSize, 0);
-
-            if (segNo < nParitySegmentsExpected)
-            {
-                storage_->insert(storage_->begin()+nDataSegmentsExpected*segmentSize+paritySegSize*segNo, 
-                    wd->segment().getPayload().begin(),
-                    wd->segment().getPayload().end());            
-
-                fecList_[nDataSegmentsExpected+segNo] = FEC_RLIST_SYMREADY;
-                segNo++;
-            }
-        }
-        
-        fec::Rs28Decoder dec(nDataSegmentsExpected, nParitySegmentsExpected, segmentSize);
-        int nRecovered = dec.decode(storage_->data(),
-            storage_->data()+nDataSegmentsExpected*segmentSize,
-            fecList_.data());
-        recovered = (nRecovered+dataSegments.size() >= nDataSegmentsExpected);
-        frameExtracted = recovered;
-    }
-    else 
-        frameExtracted = true;
+    for (unsigned int segNo = 0; segNo < slot.paritySegments_.size() && segNo < nParitySegmentsExpected; ++segNo)
+        if (slot.paritySegments_[segNo] && slot.paritySegments_[segNo]->isFetched())
+            fecList_[nDataSegmentsExpected+segNo] = FEC_RLIST_SYMREADY;
 
-    storage_->resize(nDataSegmentsExpected*segmentSize);
+    fec::Rs28Decoder dec(nDataSegmentsExpected, nParitySegmentsExpected, slot.payloadSize_);
+    int nRecovered = dec.decode(slot.frameData_->data(), slot.parityData_->data(),
+        fecList_.data());
+    recovered = (nRecovered+slot.nDataAssembled_ >= nDataSegmentsExpected);
 
-    return (frameExtracted ? std::make_shared<ImmutableVideoFramePacket>(storage_) : 
+    return (recovered ? std::make_shared<ImmutableVideoFramePacket>(slot.frameData_) : 
                 std::shared_ptr<ImmutableVideoFramePacket>());
 }
 
@@ -456,25 +555,18 @@ VideoFrameSlot::readSegmentHeader(const BufferSlot& slot)
         throw std::runtime_error("Wrong slot supplied: can not read video "
             "packet from audio slot");
 
-    std::map<ndn::Name, std::shared_ptr<SlotSegment>> 
-        dataSegments(slot.fetched_.begin(), slot.fetched_.lower_bound(Name(NameComponents::NameComponentParity)));
-
-    if (!dataSegments.size())
-        return VideoFrameSegmentHeader();
-
-    std::shared_ptr<WireData<VideoFrameSegmentHeader>> seg = 
-            std::dynamic_pointer_cast<WireData<VideoFrameSegmentHeader>>(dataSegments.begin()->second->getData());
+    for (auto& s:slot.dataSegments_)
+        if (s && s->isFetched())
+        {
+            std::shared_ptr<WireData<VideoFrameSegmentHeader>> seg = 
+                std::dynamic_pointer_cast<WireData<VideoFrameSegmentHeader>>(s->getData());
+            return seg->segment().getHeader();
+        }
 
-    return seg->segment().getHeader();
+    return VideoFrameSegmentHeader();
 }
 
 //******************************************************************************
-AudioBundleSlot::AudioBundleSlot(const size_t storageSize):
-storage_(std::make_shared<std::vector<uint8_t>>())
-{
-    storage_->reserve(storageSize);
-}
-
 std::shared_ptr<ImmutableAudioBundlePacket> 
 AudioBundleSlot::readBundle(const BufferSlot& slot)
 {
@@ -483,26 +575,11 @@ AudioBundleSlot::readBundle(const BufferSlot& slot)
         throw std::runtime_error("Wrong slot supplied: can not read video "
             "packet from audio slot");
 
-    if (slot.getAssembledLevel() < 1.)
+    if (slot.getAssembledLevel() < 1. || 
+        slot.nDataAssembled_ < slot.nDataSegments_)
         return std::shared_ptr<ImmutableAudioBundlePacket>();
 
-    std::shared_ptr<WireData<DataSegmentHeader>> firstSeg = 
-            std::dynamic_pointer_cast<WireData<DataSegmentHeader>>(slot.fetched_.begin()->second->getData());
-    size_t segmentSize = firstSeg->segment().getPayload().size();
-    unsigned int nDataSegmentsExpected = firstSeg->getSlicesNum();
-
-    storage_->resize(segmentSize*nDataSegmentsExpected);
-
-    for (auto it:slot.fetched_)
-    {
-        const std::shared_ptr<WireData<DataSegmentHeader>> wd = 
-            std::dynamic_pointer_cast<WireData<DataSegmentHeader>>(it.second->getData());
-        storage_->insert(storage_->begin(), 
-                wd->segment().getPayload().begin(),
-                wd->segment().getPayload().end());
-    }
-
-    return std::make_shared<ImmutableAudioBundlePacket>(storage_);
+    return std::make_shared<ImmutableAudioBundlePacket>(slot.frameData_);
 }
 
 //******************************************************************************
@@ -539,9 +616,30 @@ SlotPool::push(const std::shared_ptr<BufferSlot>& slot)
 }
 
 //******************************************************************************
+// returns slots ordered by name, as index itself has no particular order
+static std::vector<std::shared_ptr<BufferSlot>>
+sortedSlots(const SampleIndex<std::shared_ptr<BufferSlot>>& index)
+{
+    std::vector<std::shared_ptr<BufferSlot>> slots;
+
+    slots.reserve(index.size());
+    index.forEach([&slots](const SampleKey&, const std::shared_ptr<BufferSlot>& slot){
+        slots.push_back(slot);
+    });
+    std::sort(slots.begin(), slots.end(), 
+        [](const std::shared_ptr<BufferSlot>& a, const std::shared_ptr<BufferSlot>& b){
+            return a->getPrefix().compare(b->getPrefix()) < 0;
+        });
+
+    return slots;
+}
+
 Buffer::Buffer(std::shared_ptr<StatisticsStorage> storage,
                std::shared_ptr<SlotPool> pool):pool_(pool),
-sstorage_(storage)
+activeSlots_(pool->capacity()),
+reservedSlots_(pool->capacity()),
+sstorage_(storage),
+nNotifying_(0)
 {
     assert(sstorage_.get());
     description_ = "buffer";
@@ -552,8 +650,9 @@ Buffer::reset()
 {   
     boost::lock_guard<boost::recursive_mutex> scopedLock(mutex_);
     
-    for (auto s:activeSlots_)
-        pool_->push(s.second);
+    activeSlots_.forEach([this](const SampleKey&, const std::shared_ptr<BufferSlot>& slot){
+        pool_->push(slot);
+    });
     activeSlots_.clear();
  
      LogDebugC << "slot pool capacity " << pool_->capacity()
@@ -566,26 +665,52 @@ Buffer::reset()
 bool
 Buffer::requested(const std::vector<std::shared_ptr<const ndn::Interest>>& interests)
 {
-    std::map<Name, std::vector<std::shared_ptr<const Interest>>> slotInterests;
+    // interests usually belong to one or few samples, hence linear search;
+    // each name is parsed once here and handed to the slot along with the
+    // Interest
+    struct SlotInterests {
+        SampleKey key_;
+        std::vector<std::shared_ptr<const Interest>> interests_;
+        std::vector<NameHandle> handles_;
+    };
+    std::vector<SlotInterests> slotInterests;
+
     for (auto i:interests)
     {
-        NamespaceInfo nameInfo;
+        NameHandle nameInfo;
 
-        if (!NameComponents::extractInfo(i->getName(), nameInfo)) 
+        if (!NameComponents::extractHandle(i->getName(), nameInfo)) 
         {
             stringstream ss;
             ss << "Incorrect Interest name supplied: " << i->getName();
             throw std::runtime_error(ss.str());
         }
 
-        slotInterests[nameInfo.getPrefix(prefix_filter::Sample)].push_back(i);
+        trace::Tracer::record(trace::Event::SegmentRequested, nameInfo.sampleNo_, 
+            nameInfo.segNo_, trace::Tracer::flags(nameInfo.isParity_, nameInfo.class_ == SampleClass::Key));
+
+        SampleKey key(nameInfo);
+        auto it = std::find_if(slotInterests.begin(), slotInterests.end(),
+            [&key](const SlotInterests& p){
+                return p.key_ == key;
+            });
+
+        if (it == slotInterests.end())
+            slotInterests.push_back({key, {i}, {nameInfo}});
+        else
+        {
+            it->interests_.push_back(i);
+            it->handles_.push_back(nameInfo);
+        }
     }
 
-    for (auto it:slotInterests)
+    for (auto& it:slotInterests)
     {
         bool newRequest = false;
         boost::lock_guard<boost::recursive_mutex> scopedLock(mutex_);
-        if (activeSlots_.find(it.first) == activeSlots_.end())
+        std::shared_ptr<BufferSlot>* slotPtr = activeSlots_.find(it.key_);
+
+        if (!slotPtr)
         {
             if (pool_->size() == 0)
             {
@@ -594,18 +719,20 @@ Buffer::requested(const std::vector<std::shared_ptr<const ndn::Interest>>& inter
             }
             else
             {
-                activeSlots_[it.first] = pool_->pop();
+                activeSlots_.insert(it.key_, pool_->pop());
+                slotPtr = activeSlots_.find(it.key_);
                 newRequest = true;
             }
         }
         
-        activeSlots_[it.first]->segmentsRequested(it.second);
+        std::shared_ptr<BufferSlot> slot = *slotPtr;
+        slot->segmentsRequested(it.interests_, it.handles_);
         
         if (newRequest) 
-            for (auto o:observers_) o->onNewRequest(activeSlots_[it.first]);
+            for (auto o:observers_) o->onNewRequest(slot);
 
-        LogTraceC << "▷▷▷" << activeSlots_[it.first]->dump()
-        << " x" << it.second.size() << std::endl;
+        LogTraceC << "▷▷▷" << slot->dump()
+        << " x" << it.interests_.size() << std::endl;
         //LogDebugC << shortdump() << std::endl;
         LogTraceC << dump() << std::endl;
     }
@@ -619,25 +746,34 @@ Buffer::received(const std::shared_ptr<WireSegment>& segment)
     boost::lock_guard<boost::recursive_mutex> scopedLock(mutex_);
     
     BufferReceipt receipt;
-    Name key = segment->getInfo().getPrefix(prefix_filter::Sample);
+    const std::shared_ptr<BufferSlot>* slotPtr = activeSlots_.find(SampleKey(segment->getInfo()));
     
-    if (activeSlots_.find(key) == activeSlots_.end())
+    if (!slotPtr)
     {
         stringstream ss;
         ss << "Received data that was not previously requested: "
-        << key;
+        << segment->getInfo().getPrefix(prefix_filter::Sample);
         throw std::runtime_error(ss.str());
     }
     
-    BufferSlot::State oldState = activeSlots_[key]->getState();
-    receipt.segment_ = activeSlots_[key]->segmentReceived(segment);
-    receipt.slot_ = activeSlots_[key];
+    std::shared_ptr<BufferSlot> slot = *slotPtr;
+    BufferSlot::State oldState = slot->getState();
+    receipt.segment_ = slot->segmentReceived(segment);
+    receipt.slot_ = slot;
     receipt.oldState_ = oldState;
     
+    const NameHandle& info = segment->getInfo();
+    uint16_t traceFlags = trace::Tracer::flags(info.isParity_, info.class_ == SampleClass::Key);
+
+    if (oldState == BufferSlot::New)
+        trace::Tracer::record(trace::Event::SampleAssembling, info.sampleNo_, info.segNo_, traceFlags);
+
     if (receipt.slot_->getState() == BufferSlot::Ready)
     {
         if (oldState != BufferSlot::Ready)
         {
+            trace::Tracer::record(trace::Event::SampleReady, info.sampleNo_, info.segNo_, 
+                traceFlags, (uint32_t)receipt.slot_->getAssemblingTime());
             LogTraceC << "►►►" << receipt.slot_->dump(true)
                 << " " << shortdump() << std::endl;
             
@@ -664,7 +800,16 @@ Buffer::received(const std::shared_ptr<WireSegment>& segment)
                   << receipt.segment_->getInfo().segNo_ << std::endl;
     }
     
+    nNotifying_++;
     for (auto o:observers_) o->onNewData(receipt);
+    nNotifying_--;
+
+    if (nNotifying_ == 0 && releasedWhileNotifying_.size())
+    {
+        std::vector<std::shared_ptr<const BufferSlot>> released;
+        released.swap(releasedWhileNotifying_);
+        for (auto& s:released) releaseSlot(s);
+    }
     
     return receipt;
 }
@@ -673,9 +818,7 @@ bool
 Buffer::isRequested(const std::shared_ptr<WireSegment>& segment) const
 {
     boost::lock_guard<boost::recursive_mutex> scopedLock(mutex_);
-    Name key = segment->getInfo().getPrefix(prefix_filter::Sample);
-
-    return (activeSlots_.find(key) != activeSlots_.end());
+    return (activeSlots_.find(SampleKey(segment->getInfo())) != nullptr);
 }
 
 unsigned int 
@@ -684,9 +827,10 @@ Buffer::getSlotsNum(const ndn::Name& prefix, int stateMask) const
     boost::lock_guard<boost::recursive_mutex> scopedLock(mutex_);
     unsigned int nSlots = 0;
 
-    for (auto it:activeSlots_)
-        if (prefix.match(it.first) && it.second->getState()&stateMask)
+    activeSlots_.forEach([&](const SampleKey&, const std::shared_ptr<BufferSlot>& slot){
+        if (slot->getState()&stateMask && prefix.match(slot->getPrefix()))
             nSlots++;
+    });
 
     return nSlots;
 }
@@ -713,13 +857,15 @@ Buffer::detach(IBufferObserver* observer)
 }
 
 void
-Buffer::invalidate(const Name& slotPrefix)
+Buffer::invalidate(const SampleKey& slotKey)
 {
     boost::lock_guard<boost::recursive_mutex> scopedLock(mutex_);
-    assert(activeSlots_.find(slotPrefix) != activeSlots_.end());
+    assert(activeSlots_.find(slotKey));
 
-    std::shared_ptr<BufferSlot> slot = activeSlots_.find(slotPrefix)->second;
-    activeSlots_.erase(activeSlots_.find(slotPrefix));
+    std::shared_ptr<BufferSlot> slot = *activeSlots_.find(slotKey);
+    activeSlots_.erase(slotKey);
+    trace::Tracer::record(trace::Event::SampleInvalidated, slot->getNameInfo().sampleNo_, -1,
+        trace::Tracer::flags(false, slot->getNameInfo().class_ == SampleClass::Key), slot->getState());
     
     (*sstorage_)[Indicator::DroppedNum]++;
     if (slot->getState() <= BufferSlot::Assembling)
@@ -738,13 +884,19 @@ void
 Buffer::invalidatePrevious(const Name& slotPrefix)
 {
     boost::lock_guard<boost::recursive_mutex> scopedLock(mutex_);
-    std::map<ndn::Name, std::shared_ptr<BufferSlot>>::iterator lower = 
-        activeSlots_.lower_bound(slotPrefix);
+    std::vector<std::shared_ptr<BufferSlot>> previous;
+
+    // invalidates slots that precede given prefix in canonical name order
+    activeSlots_.forEach([&](const SampleKey&, const std::shared_ptr<BufferSlot>& slot){
+        if (slot->getPrefix().compare(slotPrefix) < 0)
+            previous.push_back(slot);
+    });
 
-    while (activeSlots_.begin() != lower)
+    for (auto& slot:previous)
     {
-        LogDebugC << "invalidate " << activeSlots_.begin()->first << std::endl;
-        std::shared_ptr<BufferSlot> slot = activeSlots_.begin()->second;
+        LogDebugC << "invalidate " << slot->getPrefix() << std::endl;
+        trace::Tracer::record(trace::Event::SampleInvalidated, slot->getNameInfo().sampleNo_, -1,
+            trace::Tracer::flags(false, slot->getNameInfo().class_ == SampleClass::Key), slot->getState());
         
         (*sstorage_)[Indicator::DroppedNum]++;
         if (slot->getState() <= BufferSlot::Assembling)
@@ -756,8 +908,8 @@ Buffer::invalidatePrevious(const Name& slotPrefix)
                 (*sstorage_)[Indicator::IncompleteKeyNum]++;
         }
         
-        pool_->push(activeSlots_.begin()->second);
-        activeSlots_.erase(activeSlots_.begin());
+        activeSlots_.erase(slot->getKey());
+        pool_->push(slot);
     }
 }
 
@@ -773,14 +925,15 @@ void
 Buffer::reserveSlot(const std::shared_ptr<const BufferSlot>& slot)
 {
     boost::lock_guard<boost::recursive_mutex> scopedLock(mutex_);
-    std::map<ndn::Name, std::shared_ptr<BufferSlot>>::iterator it =
-    activeSlots_.find(slot->getPrefix());
+    std::shared_ptr<BufferSlot>* slotPtr = activeSlots_.find(slot->getKey());
     
-    if (it != activeSlots_.end())
+    if (slotPtr)
     {
-        reservedSlots_[slot->getPrefix()] = activeSlots_[slot->getPrefix()];
-        activeSlots_.erase(it);
-        reservedSlots_[slot->getPrefix()]->toggleLock();
+        std::shared_ptr<BufferSlot> reserved = *slotPtr;
+
+        activeSlots_.erase(slot->getKey());
+        reservedSlots_.insert(reserved->getKey(), reserved);
+        reserved->toggleLock();
     }
 }
 
@@ -788,13 +941,22 @@ void
 Buffer::releaseSlot(const std::shared_ptr<const BufferSlot>& slot)
 {
     boost::lock_guard<boost::recursive_mutex> scopedLock(mutex_);
-    std::map<ndn::Name, std::shared_ptr<BufferSlot>>::iterator it =
-    reservedSlots_.find(slot->getPrefix());
+
+    // other observers may still use the slot
+    if (nNotifying_)
+    {
+        releasedWhileNotifying_.push_back(slot);
+        return;
+    }
+
+    std::shared_ptr<BufferSlot>* slotPtr = reservedSlots_.find(slot->getKey());
     
-    if (it != reservedSlots_.end())
+    if (slotPtr)
     {
-        pool_->push(it->second);
-        reservedSlots_.erase(it);
+        std::shared_ptr<BufferSlot> reserved = *slotPtr;
+
+        reservedSlots_.erase(reserved->getKey());
+        pool_->push(reserved);
     }
 }
 
@@ -806,8 +968,8 @@ Buffer::dump() const
     stringstream ss;
     ss << "buffer dump:";
 
-    for (auto& s:activeSlots_)
-        ss << std::endl << ++i << " " << s.second->dump();
+    for (auto& s:sortedSlots(activeSlots_))
+        ss << std::endl << ++i << " " << s->dump();
 
     return ss.str();
 }
@@ -828,20 +990,19 @@ Buffer::shortdump() const
 }
 
 void
-Buffer::dumpSlotDictionary(stringstream& ss, 
-    const map<ndn::Name, std::shared_ptr<BufferSlot>> &slotDict) const
+Buffer::dumpSlotDictionary(stringstream& ss, const SlotIndex& slotDict) const
 {
     int i = 0;
-    for (auto& s:slotDict)
+    for (auto& s:sortedSlots(slotDict))
     {
-        if ((i++ % 10 == 0) || !s.second->getNameInfo().isDelta_ )
+        if ((i++ % 10 == 0) || !s->getNameInfo().isDelta_ )
         {
-            ss << s.second->getNameInfo().sampleNo_; 
-            ss << (s.second->getNameInfo().isDelta_ ? "" : "K");
+            ss << s->getNameInfo().sampleNo_; 
+            ss << (s->getNameInfo().isDelta_ ? "" : "K");
         }
 
-        ss << (s.second->getAssembledLevel() >= 1 ? "■" :
-            (s.second->getAssembledLevel() > 0 ? "◘" : "☐" ));
+        ss << (s->getAssembledLevel() >= 1 ? "■" :
+            (s->getAssembledLevel() > 0 ? "◘" : "☐" ));
     }
 }
 
@@ -857,7 +1018,8 @@ PlaybackQueue::PlaybackQueue(const ndn::Name& streamPrefix,
 streamPrefix_(streamPrefix),
 buffer_(buffer),
 packetRate_(0),
-sstorage_(buffer->sstorage_)
+sstorage_(buffer->sstorage_),
+switchPlaybackNo_(-1)
 {
     description_ = "pqueue";
     buffer_->attach(this);
@@ -938,6 +1100,28 @@ PlaybackQueue::detach(IPlaybackQueueObserver* observer)
     }
 }
 
+void
+PlaybackQueue::switchThread(const ndn::Name& threadPrefix, PacketNumber playbackNo)
+{
+    boost::lock_guard<boost::recursive_mutex> scopedLock(mutex_);
+    threadPrefix_ = threadPrefix;
+    switchPlaybackNo_ = playbackNo;
+
+    for (std::set<Sample>::iterator it = queue_.begin(); it != queue_.end();)
+        if (isSwitchedFrom(*it->slot()))
+        {
+            LogDebugC << "drop " << it->slot()->dump() << " (thread switched)" << std::endl;
+
+            buffer_->releaseSlot(it->slot());
+            it = queue_.erase(it);
+            (*sstorage_)[Indicator::DroppedNum]++;
+        }
+        else
+            ++it;
+
+    (*sstorage_)[Indicator::BufferPlayableSize] = size();
+}
+
 std::string
 PlaybackQueue::dump()
 {
@@ -975,6 +1159,18 @@ PlaybackQueue::onNewData(const BufferReceipt& receipt)
         streamPrefix_.match(receipt.slot_->getPrefix()))
     {
         boost::lock_guard<boost::recursive_mutex> scopedLock(mutex_);
+
+        if (isSwitchedFrom(*receipt.slot_))
+        {
+            LogDebugC << "drop " << receipt.slot_->dump() << " (thread switched)" << std::endl;
+            // slot is returned to the pool once all buffer observers are
+            // notified
+            buffer_->reserveSlot(receipt.slot_);
+            buffer_->releaseSlot(receipt.slot_);
+            (*sstorage_)[Indicator::DroppedNum]++;
+            return;
+        }
+
         buffer_->reserveSlot(receipt.slot_);
         packetRate_ = receipt.slot_->getHeader().sampleRate_;
         queue_.insert(Sample(receipt.slot_));
@@ -988,6 +1184,14 @@ PlaybackQueue::onNewData(const BufferReceipt& receipt)
     }
 }
 
+bool
+PlaybackQueue::isSwitchedFrom(const BufferSlot& slot)
+{
+    return threadPrefix_.size() && !threadPrefix_.match(slot.getPrefix()) &&
+        (switchPlaybackNo_ < 0 ||
+         frameSlot_.readSegmentHeader(slot).playbackNo_ >= switchPlaybackNo_);
+}
+
 void
 PlaybackQueue::onReset()
 {
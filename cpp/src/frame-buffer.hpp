@@ -16,6 +16,7 @@
 #include <ndn-cpp/name.hpp>
 
 #include "name-components.hpp"
+#include "sample-index.hpp"
 
 #include "slot-buffer.hpp"
 #include "ndnrtc-object.hpp"
@@ -39,8 +40,13 @@ namespace ndnrtc
     public:
 
         SlotSegment(const std::shared_ptr<const ndn::Interest>&);
+        /**
+         * Creates slot segment for the Interest which name was already
+         * parsed into the handle.
+         */
+        SlotSegment(const std::shared_ptr<const ndn::Interest>&, const NameHandle&);
 
-        const NamespaceInfo& getInfo() const;
+        const NameHandle& getInfo() const;
         void setData(const std::shared_ptr<WireSegment>& data);
         const std::shared_ptr<WireSegment>& getData() const { return data_; }
         
@@ -81,7 +87,7 @@ namespace ndnrtc
 
     private:
         std::shared_ptr<const ndn::Interest> interest_;
-        NamespaceInfo interestInfo_;
+        NameHandle interestInfo_;
         std::shared_ptr<WireSegment> data_;
         int64_t requestTimeUsec_, arrivalTimeUsec_;
         size_t requestNo_;
@@ -95,6 +101,7 @@ namespace ndnrtc
     class Manifest;
     class SampleValidator;
     class ManifestValidator;
+    class AudioManifestValidator;
 
     class BufferSlot
     {
@@ -139,17 +146,30 @@ namespace ndnrtc
          */
         void 
         segmentsRequested(const std::vector<std::shared_ptr<const ndn::Interest>>& interests);
+
+        /**
+         * Same as above, but takes Interests' names that were already parsed.
+         * @param handles Parsed names of the Interests, in the same order
+         */
+        void 
+        segmentsRequested(const std::vector<std::shared_ptr<const ndn::Interest>>& interests,
+                          const std::vector<NameHandle>& handles);
         
         /**
          * Clears all internal structures of this slot and returns to Free state
          * as if slot has just been created. No memory deallocation/reallocation is
-         * performed, thus operation is not expensive.
+         * performed, thus operation is not expensive. Assembly buffer is 
+         * reallocated only if it is still referenced by a packet read from 
+         * this slot.
          */
         void
         clear();
 
         /**
          * Adds received segment to this slot.
+         * Segment's payload is copied into slot's assembly buffer at its 
+         * final offset (segment number times payload size), so that the 
+         * packet is assembled by the time the last segment arrives.
          * @param segment Received segment
          * @note Added segment's name should correspond to one of the Interests, 
          * previously added using segmentsRequested method. Otherwise, this throws.
@@ -171,6 +191,18 @@ namespace ndnrtc
          */
         std::vector<std::shared_ptr<const ndn::Interest>> getPendingInterests() const;
 
+        /**
+         * Returns pending Interests which are needed to recover the sample.
+         * Once the number of segments is known, segments beyond it are
+         * skipped and no more segments than are missing for recovery
+         * (taking into account fetched parity) are returned, data segments
+         * first. Hence, an empty array is returned for a sample that FEC can
+         * recover already.
+         * @param maxRtxNum Segments retransmitted this many times are skipped
+         */
+        std::vector<std::shared_ptr<const ndn::Interest>> 
+        getRecoveryInterests(unsigned int maxRtxNum) const;
+
         /**
          * Returns boolean value on whether slot is verified
          */
@@ -181,12 +213,13 @@ namespace ndnrtc
         double getAssembledLevel() const { return asmLevel_; }
 
         const ndn::Name& getPrefix() const { return name_; }
-        const NamespaceInfo& getNameInfo() const { return nameInfo_; }
+        const SampleKey& getKey() const { return key_; }
+        const NameHandle& getNameInfo() const { return nameInfo_; }
         int getConsistencyState() const { return consistency_; }
         unsigned int getRtxNum() const { return nRtx_; }
         int getRtxNum(const ndn::Name& segmentName);
         bool hasOriginalSegments() const { return hasOriginalSegments_; }
-        size_t getFetchedNum() const { return fetched_.size(); }
+        size_t getFetchedNum() const { return nFetched_; }
         void toggleLock();
         
         int64_t getAssemblingTime() const
@@ -212,13 +245,17 @@ namespace ndnrtc
         friend AudioBundleSlot;
         friend SampleValidator;
         friend ManifestValidator;
+        friend AudioManifestValidator;
         friend Buffer;
 
         ndn::Name name_;
-        NamespaceInfo nameInfo_;
-        std::map<ndn::Name, std::shared_ptr<SlotSegment>> requested_, fetched_;
+        SampleKey key_;
+        NameHandle nameInfo_;
+        // requested segments, indexed by segment number; segment is fetched
+        // once it has data (see SlotSegment::isFetched())
+        std::vector<std::shared_ptr<SlotSegment>> dataSegments_, paritySegments_;
         std::shared_ptr<SlotSegment> lastFetched_;
-        unsigned int consistency_, nRtx_, assembledSize_;
+        unsigned int nFetched_, consistency_, nRtx_, assembledSize_;
         unsigned int nDataSegments_, nParitySegments_;
         bool hasOriginalSegments_;
         State state_;
@@ -226,9 +263,21 @@ namespace ndnrtc
         double assembled_, asmLevel_;
         mutable std::shared_ptr<Manifest> manifest_;
         mutable Verification verified_;
+        // segments' payloads are copied into these buffers upon arrival,
+        // at offset segNo*payloadSize_; buffers are kept between slot reuses
+        std::shared_ptr<std::vector<uint8_t>> frameData_, parityData_;
+        size_t payloadSize_;
+        unsigned int nDataAssembled_;
 
         virtual void updateConsistencyState(const std::shared_ptr<SlotSegment>& segment);
         void updateAssembledLevel();
+
+        std::vector<std::shared_ptr<SlotSegment>>& 
+        segments(bool isParity) { return (isParity ? paritySegments_ : dataSegments_); }
+        std::shared_ptr<SlotSegment> 
+        findSegment(const NameHandle& info) const;
+        void assemble(const std::shared_ptr<SlotSegment>& segment);
+        void copyPayload(const std::shared_ptr<SlotSegment>& segment);
     };
 
     //******************************************************************************
@@ -240,11 +289,13 @@ namespace ndnrtc
 
     class VideoFrameSlot {
     public:
-        VideoFrameSlot(const size_t storageSize = 16000);
+        VideoFrameSlot();
 
         /**
          * Tries to read VideoFramePacket from supplied BufferSlot.
-         * Also tries to recover frame using available FEC data, if possible.
+         * Returned packet shares slot's assembly buffer, thus no copying is
+         * performed. Also tries to recover frame using available FEC data, 
+         * if possible. Recovery is performed in place, in slot's buffer.
          * In this case, recovered flag is set to true;
          * @param slot Buffer slot that contains segments of video frame packet
          * @return shared_ptr of ImmutableVideoFramePacket or nullptr if 
@@ -257,7 +308,6 @@ namespace ndnrtc
         readSegmentHeader(const BufferSlot& slot);
         
     private:
-        std::shared_ptr<std::vector<uint8_t>> storage_;
         std::vector<uint8_t> fecList_;
     };
 
@@ -268,19 +318,17 @@ namespace ndnrtc
 
     class AudioBundleSlot {
     public:
-        AudioBundleSlot(const size_t storageSize = 2000);
+        AudioBundleSlot(){}
 
         /**
          * Tries to read AudioBundlePacket from supplied BufferSlot.
+         * Returned packet shares slot's assembly buffer.
          * @param slot Buffer slot that contains segment(s) of audio bundle
          * @return shared_ptr of ImmutableAudioBundle packet or nullptr if 
          * failed to read data.
          */
         std::shared_ptr<ImmutableAudioBundleAlias>
         readBundle(const BufferSlot& slot);
-
-    private:
-        std::shared_ptr<std::vector<uint8_t>> storage_;
     };
 
     //******************************************************************************
@@ -346,20 +394,25 @@ namespace ndnrtc
     private:
         friend PlaybackQueue;
 
+        typedef SampleIndex<std::shared_ptr<BufferSlot>> SlotIndex;
+
         mutable boost::recursive_mutex mutex_;
         std::shared_ptr<SlotPool> pool_;
-        std::map<ndn::Name, std::shared_ptr<BufferSlot>> activeSlots_, reservedSlots_;
+        SlotIndex activeSlots_, reservedSlots_;
         std::vector<IBufferObserver*> observers_;
         std::shared_ptr<statistics::StatisticsStorage> sstorage_;
+        // slots released while observers are notified of new data are
+        // returned to the pool once all observers are notified
+        unsigned int nNotifying_;
+        std::vector<std::shared_ptr<const BufferSlot>> releasedWhileNotifying_;
         
         std::string
         shortdump() const;
 
         void 
-        dumpSlotDictionary(std::stringstream&, 
-            const std::map<ndn::Name, std::shared_ptr<BufferSlot>> &) const;
+        dumpSlotDictionary(std::stringstream&, const SlotIndex&) const;
         
-        void invalidate(const ndn::Name& slotPrefix);
+        void invalidate(const SampleKey& slotKey);
         void invalidatePrevious(const ndn::Name& slotPrefix);
         
         void reserveSlot(const std::shared_ptr<const BufferSlot>& slot);
@@ -423,6 +476,17 @@ namespace ndnrtc
         double sampleRate() const { return packetRate_; }
         double samplePeriod() const { return (packetRate_ ? 1000./packetRate_ : 0); }
 
+        /**
+         * Follows switch to another thread of video stream: from now on,
+         * frames of other threads are queued (and kept in queue) only if
+         * they precede the frame the new thread starts with in playback
+         * order; others are dropped.
+         * @param threadPrefix Prefix of the thread switched to
+         * @param playbackNo Playback number of the first frame of the new
+         *                   thread or -1 to drop all frames of other threads
+         */
+        void switchThread(const ndn::Name& threadPrefix, PacketNumber playbackNo);
+
         std::string dump();
 
     private:
@@ -446,6 +510,11 @@ namespace ndnrtc
         std::set<Sample> queue_;
         std::vector<IPlaybackQueueObserver*> observers_;
         std::shared_ptr<statistics::StatisticsStorage> sstorage_;
+        ndn::Name threadPrefix_;
+        PacketNumber switchPlaybackNo_;
+        VideoFrameSlot frameSlot_;
+
+        bool isSwitchedFrom(const BufferSlot& slot);
 
         virtual void onNewRequest(const std::shared_ptr<BufferSlot>&);
         virtual void onNewData(const BufferReceipt& receipt);
@@ -64,8 +64,11 @@ Manifest::Manifest(NetworkData &&nd) : DataPacket(boost::move(nd)) {}
 
 bool Manifest::hasData(const ndn::Data &data) const
 {
-    ndn::Blob digest = (*data.getFullName())[-1].getValue();
+    return hasDigest((*data.getFullName())[-1].getValue());
+}
 
+bool Manifest::hasDigest(const ndn::Blob &digest) const
+{
     for (int i = 0; i < getBlobsNum(); ++i)
     {
         ndn::Blob b(getBlob(i).data(), getBlob(i).size());
@@ -114,13 +117,15 @@ AudioThreadMeta::getCodec() const
 
 //******************************************************************************
 VideoThreadMeta::VideoThreadMeta(double rate, PacketNumber deltaSeqNo, PacketNumber keySeqNo,
-                                 unsigned char gopPos, const FrameSegmentsInfo &segInfo, const VideoCoderParams &coder)
+                                 unsigned char gopPos, const FrameSegmentsInfo &segInfo, const VideoCoderParams &coder,
+                                 const std::pair<double, double> &parityRatio)
     : DataPacket(std::vector<uint8_t>())
 {
     Meta m({rate, deltaSeqNo, keySeqNo, gopPos,
             coder.gop_, coder.startBitrate_, coder.encodeWidth_, coder.encodeHeight_,
             segInfo.deltaAvgSegNum_, segInfo.deltaAvgParitySegNum_,
-            segInfo.keyAvgSegNum_, segInfo.keyAvgParitySegNum_});
+            segInfo.keyAvgSegNum_, segInfo.keyAvgParitySegNum_,
+            parityRatio.first, parityRatio.second});
     addBlob(sizeof(m), (uint8_t *)&m);
 }
 
@@ -154,6 +159,12 @@ FrameSegmentsInfo VideoThreadMeta::getSegInfo() const
                               m->keyAvgSegNum_, m->keyAvgParitySegNum_});
 }
 
+pair<double, double> VideoThreadMeta::getParityRatio() const
+{
+    Meta *m = (Meta *)blobs_[0].data();
+    return make_pair(m->deltaParityRatio_, m->keyParityRatio_);
+}
+
 VideoCoderParams VideoThreadMeta::getCoderParams() const
 {
     Meta *m = (Meta *)blobs_[0].data();
@@ -235,7 +246,7 @@ MediaStreamMeta::getStreamTimestamp() const
 WireSegment::WireSegment(const std::shared_ptr<ndn::Data> &data,
                          const std::shared_ptr<const ndn::Interest> &interest)
     : data_(data), interest_(interest),
-      isValid_(NameComponents::extractInfo(data->getName(), dataNameInfo_))
+      isValid_(NameComponents::extractHandle(data->getName(), dataNameInfo_))
 {
     if (dataNameInfo_.apiVersion_ != NameComponents::nameApiVersion())
     {
@@ -248,10 +259,10 @@ WireSegment::WireSegment(const std::shared_ptr<ndn::Data> &data,
     }
 }
 
-WireSegment::WireSegment(const NamespaceInfo &info,
+WireSegment::WireSegment(const NameHandle &handle,
                          const std::shared_ptr<ndn::Data> &data,
                          const std::shared_ptr<const ndn::Interest> &interest)
-    : dataNameInfo_(info), data_(data), interest_(interest), isValid_(true)
+    : dataNameInfo_(handle), data_(data), interest_(interest), isValid_(true)
 {
     if (dataNameInfo_.apiVersion_ != NameComponents::nameApiVersion())
     {
@@ -303,14 +314,14 @@ bool WireSegment::isOriginal() const
 }
 
 std::shared_ptr<WireSegment>
-WireSegment::createSegment(const NamespaceInfo &namespaceInfo,
+WireSegment::createSegment(const NameHandle &nameHandle,
                            const std::shared_ptr<ndn::Data> &data,
                            const std::shared_ptr<const ndn::Interest> &interest)
 {
-    if (namespaceInfo.streamType_ == MediaStreamParams::MediaStreamType::MediaStreamTypeVideo &&
-        (namespaceInfo.segmentClass_ == SegmentClass::Data || namespaceInfo.segmentClass_ == SegmentClass::Parity))
-        return std::make_shared<WireData<VideoFrameSegmentHeader>>(namespaceInfo, data, interest);
+    if (nameHandle.streamType_ == MediaStreamParams::MediaStreamType::MediaStreamTypeVideo &&
+        (nameHandle.segmentClass_ == SegmentClass::Data || nameHandle.segmentClass_ == SegmentClass::Parity))
+        return std::make_shared<WireData<VideoFrameSegmentHeader>>(nameHandle, data, interest);
 
-    return std::make_shared<WireData<DataSegmentHeader>>(namespaceInfo, data, interest);
+    return std::make_shared<WireData<DataSegmentHeader>>(nameHandle, data, interest);
     ;
 }
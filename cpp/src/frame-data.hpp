@@ -592,6 +592,26 @@ class DataSegment : protected DataPacket::Blob
         return sp;
     }
 
+    /**
+     * Writes segment's wire representation (header blob, followed by the
+     * payload) directly into provided memory, which must be at least size()
+     * bytes long. Resulting bytes are identical to getNetworkData(), but no
+     * intermediate copies are made.
+     * @return Number of bytes written
+     */
+    size_t writeWire(uint8_t *buffer) const
+    {
+        buffer[0] = 1; // one blob - segment header
+        buffer[1] = sizeof(Header) & 0x00ff;
+        buffer[2] = (sizeof(Header) & 0xff00) >> 8;
+        memcpy(buffer + 3, &header_, sizeof(Header));
+
+        if (Blob::size())
+            memcpy(buffer + 3 + sizeof(Header), Blob::data(), Blob::size());
+
+        return size();
+    }
+
     /**
      * This calculates total wire length for a segment with given payload 
      * length
@@ -845,7 +865,16 @@ class AudioBundlePacketT : public HeaderPacketT<CommonHeader, T>
 
     bool hasSpace(const AudioSampleBlob &sampleBlob) const
     {
-        return ((long)remainingSpace_ - (long)DataPacket::wireLength(sampleBlob.size())) >= 0;
+        return hasSpace(sampleBlob.payloadLength());
+    }
+
+    /**
+     * Checks whether sample with given payload length fits into the bundle
+     */
+    bool hasSpace(size_t samplePayloadLength) const
+    {
+        return ((long)remainingSpace_ -
+                (long)DataPacket::wireLength(AudioSampleBlob::wireLength(samplePayloadLength))) >= 0;
     }
 
     size_t getRemainingSpace() const { return remainingSpace_; }
@@ -853,36 +882,39 @@ class AudioBundlePacketT : public HeaderPacketT<CommonHeader, T>
     ENABLE_IF(T, Mutable)
     void clear()
     {
+        // bundle memory is allocated once and is reused after clearing
+        this->_data().reserve(wireLength_);
         HeaderPacketT<CommonHeader, T>::clear();
         this->remainingSpace_ = AudioBundlePacketT<T>::payloadLength(wireLength_);
     }
 
+    /**
+     * Appends sample to the bundle, copying sample payload straight into
+     * bundle memory.
+     * @throw std::runtime_error if there is no space for the sample
+     */
     ENABLE_IF(T, Mutable)
-    AudioBundlePacketT<T> &operator<<(const AudioSampleBlob &sampleBlob)
+    void append(const AudioSampleHeader &header, const uint8_t *payload, size_t payloadLength)
     {
-        if (hasSpace(sampleBlob))
-        {
-            this->_data()[0]++;
-
-            uint8_t b1 = sampleBlob.size() & 0x00ff, b2 = (sampleBlob.size() & 0xff00) >> 8;
-            this->payloadBegin_ = this->_data().insert(this->payloadBegin_, b1);
-            this->payloadBegin_++;
-            this->payloadBegin_ = this->_data().insert(this->payloadBegin_, b2);
-            this->payloadBegin_++;
-            for (int i = 0; i < sizeof(sampleBlob.getHeader()); ++i)
-            {
-                this->payloadBegin_ = this->_data().insert(this->payloadBegin_, ((uint8_t *)&sampleBlob.getHeader())[i]);
-                this->payloadBegin_++;
-            }
-            // insert blob
-            this->_data().insert(this->payloadBegin_, sampleBlob.data(),
-                                 sampleBlob.data() + (sampleBlob.size() - sizeof(sampleBlob.getHeader())));
-            this->reinit();
-            remainingSpace_ -= DataPacket::wireLength(sampleBlob.size());
-        }
-        else
+        if (!hasSpace(payloadLength))
             throw std::runtime_error("Can not add sample to bundle: no free space");
 
+        size_t sampleSize = AudioSampleBlob::wireLength(payloadLength);
+        uint8_t sizeBytes[2] = {(uint8_t)(sampleSize & 0x00ff), (uint8_t)((sampleSize & 0xff00) >> 8)};
+
+        this->_data()[0]++;
+        this->payloadBegin_ = this->_data().insert(this->payloadBegin_, sizeBytes, sizeBytes + 2) + 2;
+        this->payloadBegin_ = this->_data().insert(this->payloadBegin_, (const uint8_t *)&header,
+                                                   (const uint8_t *)&header + sizeof(header)) + sizeof(header);
+        this->_data().insert(this->payloadBegin_, payload, payload + payloadLength);
+        this->reinit();
+        remainingSpace_ -= DataPacket::wireLength(sampleSize);
+    }
+
+    ENABLE_IF(T, Mutable)
+    AudioBundlePacketT<T> &operator<<(const AudioSampleBlob &sampleBlob)
+    {
+        append(sampleBlob.getHeader(), sampleBlob.data(), sampleBlob.payloadLength());
         return *this;
     }
 
@@ -949,6 +981,12 @@ class Manifest : public DataPacket
           */
     bool hasData(const ndn::Data &data) const;
 
+    /**
+          * Checks whether data object with given implicit digest is a part of
+          * this manifest
+          */
+    bool hasDigest(const ndn::Blob &digest) const;
+
     /**
           * Returns total number of data objects described by this manifest
           */
@@ -972,7 +1010,8 @@ class VideoThreadMeta : public DataPacket
   public:
     VideoThreadMeta(double rate, PacketNumber deltaSeqNo, PacketNumber keySeqNo,
                     unsigned char gopPos,
-                    const FrameSegmentsInfo &segInfo, const VideoCoderParams &coder);
+                    const FrameSegmentsInfo &segInfo, const VideoCoderParams &coder,
+                    const std::pair<double, double> &parityRatio = std::make_pair(0.2, 0.2));
     VideoThreadMeta(NetworkData &&data);
 
     double getRate() const;
@@ -980,6 +1019,8 @@ class VideoThreadMeta : public DataPacket
     unsigned char getGopPos() const; // GOP position of delta frame
     FrameSegmentsInfo getSegInfo() const;
     VideoCoderParams getCoderParams() const;
+    // FEC parity ratio currently used by producer, first is delta, second is key
+    std::pair<double, double> getParityRatio() const;
 
   private:
     typedef struct _Meta
@@ -992,6 +1033,7 @@ class VideoThreadMeta : public DataPacket
         unsigned int width_, height_; // pixels
         double deltaAvgSegNum_, deltaAvgParitySegNum_;
         double keyAvgSegNum_, keyAvgParitySegNum_;
+        double deltaParityRatio_, keyParityRatio_;
     } __attribute__((packed)) Meta;
 };
 
@@ -1032,10 +1074,10 @@ class WireSegment
     std::shared_ptr<ndn::Data> getData() const { return data_; }
     std::shared_ptr<const ndn::Interest> getInterest() const { return interest_; }
 
-    ndn::Name getBasePrefix() const { return dataNameInfo_.basePrefix_; }
+    const ndn::Name& getBasePrefix() const { return dataNameInfo_.getBasePrefix(); }
     unsigned int getApiVersion() const { return dataNameInfo_.apiVersion_; }
     MediaStreamParams::MediaStreamType getStreamType() const { return dataNameInfo_.streamType_; }
-    std::string getStreamName() const { return dataNameInfo_.streamName_; }
+    const std::string& getStreamName() const { return dataNameInfo_.getStreamName(); }
     bool isMeta() const { return dataNameInfo_.isMeta_; }
     PacketNumber getSampleNo() const { return dataNameInfo_.sampleNo_; }
     bool isDelta() const { return dataNameInfo_.isDelta_; }
@@ -1043,7 +1085,7 @@ class WireSegment
     unsigned int getSegNo() const { return dataNameInfo_.segNo_; }
     bool isParity() const { return dataNameInfo_.isParity_; }
     SegmentClass getSegmentClass() const { return dataNameInfo_.segmentClass_; }
-    std::string getThreadName() const { return dataNameInfo_.threadName_; }
+    const std::string& getThreadName() const { return dataNameInfo_.getThreadName(); }
 
     bool isPacketHeaderSegment() const { return !dataNameInfo_.isParity_ && dataNameInfo_.segNo_ == 0; }
     virtual PacketNumber getPlaybackNo() const { return getSampleNo(); }
@@ -1064,7 +1106,7 @@ class WireSegment
         return (dataNameInfo_.isParity_ ? fec::parityWeight() : 1);
     }
 
-    const NamespaceInfo &getInfo() const { return dataNameInfo_; }
+    const NameHandle &getInfo() const { return dataNameInfo_; }
 
     /**
      * Retrieves segment header from data
@@ -1090,18 +1132,22 @@ class WireSegment
      */
     bool isOriginal() const;
 
+    /**
+     * Creates segment of appropriate type for the name that was already 
+     * parsed, thus avoiding parsing it again.
+     */
     static std::shared_ptr<WireSegment>
-    createSegment(const NamespaceInfo &namespaceInfo,
+    createSegment(const NameHandle &nameHandle,
                   const std::shared_ptr<ndn::Data> &data,
                   const std::shared_ptr<const ndn::Interest> &interest);
 
   protected:
-    NamespaceInfo dataNameInfo_;
+    NameHandle dataNameInfo_;
     bool isValid_;
     std::shared_ptr<ndn::Data> data_;
     std::shared_ptr<const ndn::Interest> interest_;
 
-    WireSegment(const NamespaceInfo &info,
+    WireSegment(const NameHandle &handle,
                 const std::shared_ptr<ndn::Data> &data,
                 const std::shared_ptr<const ndn::Interest> &interest);
 };
@@ -1121,10 +1167,10 @@ class WireData : public WireSegment
     {
     }
 
-    WireData(const NamespaceInfo &info,
+    WireData(const NameHandle &handle,
              const std::shared_ptr<ndn::Data> &data,
              const std::shared_ptr<const ndn::Interest> &interest)
-      : WireSegment(info, data, interest)
+      : WireSegment(handle, data, interest)
     {
     }
 
@@ -1140,7 +1186,7 @@ class WireData : public WireSegment
 
   private:
     // friend std::shared_ptr<WireData<SegmentHeader>>
-    // std::make_shared<WireData<SegmentHeader>>(const ndnrtc::NamespaceInfo &,
+    // std::make_shared<WireData<SegmentHeader>>(const ndnrtc::NameHandle &,
     //                                             const std::shared_ptr<ndn::Data> &,
     //                                             const std::shared_ptr<const ndn::Interest> &);
 
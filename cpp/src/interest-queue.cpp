@@ -9,32 +9,17 @@
 //
 
 #include "interest-queue.hpp"
-#include <boost/thread/lock_guard.hpp>
+#include <algorithm>
+#include <string.h>
 #include <ndn-cpp/face.hpp>
 #include <ndn-cpp/interest.hpp>
 
 #include "clock.hpp"
-#include "async.hpp"
 
 using namespace ndn;
 using namespace ndnrtc;
 using namespace ndnrtc::statistics;
 
-//******************************************************************************
-#pragma mark - construction/destruction
-InterestQueue::QueueEntry::QueueEntry(const std::shared_ptr<const ndn::Interest>& interest,
-                                      const std::shared_ptr<IPriority>& priority,
-                                      OnData onData,
-                                      OnTimeout onTimeout,
-                                      OnNetworkNack onNetworkNack):
-interest_(interest),
-priority_(priority),
-onDataCallback_(onData),
-onTimeoutCallback_(onTimeout),
-onNetworkNack_(onNetworkNack)
-{
-}
-
 //******************************************************************************
 DeadlinePriority::DeadlinePriority(const DeadlinePriority& p):
 arrivalDelayMs_(p.arrivalDelayMs_),
@@ -60,22 +45,35 @@ DeadlinePriority::getArrivalDeadlineFromEnqueue() const
 }
 
 //******************************************************************************
+#pragma mark - construction/destruction
 InterestQueue::InterestQueue(boost::asio::io_service& io,
                       const std::shared_ptr<Face> &face,
-                      const std::shared_ptr<statistics::StatisticsStorage>& statStorage):
+                      const std::shared_ptr<statistics::StatisticsStorage>& statStorage,
+                      size_t capacity):
 StatObject(statStorage),
 faceIo_(io),
 face_(face),
-queue_(PriorityQueue(QueueEntry::Comparator(true))),
-isDrainingQueue_(false),
-observer_(nullptr)
+observer_(nullptr),
+capacity_(capacity),
+head_(new QueueEntry()),
+size_(0),
+drainScheduled_(false),
+generation_(0),
+wheel_(WheelSize, std::make_pair(nullptr, nullptr)),
+issueDelay_({1., 5., 20.})
 {
     description_ = "iqueue";
+    tail_ = head_.load();
+    tail_->next_ = nullptr;
+    memset(wheelOccupancy_, 0, sizeof(wheelOccupancy_));
 }
 
 InterestQueue::~InterestQueue()
 {
-    reset();
+    QueueEntry *entry;
+    while ((entry = pop()))
+        delete entry;
+    delete tail_;
 }
 
 
@@ -90,43 +88,44 @@ InterestQueue::enqueueInterest(const std::shared_ptr<const Interest>& interest,
 {
     assert(interest.get());
 
-    QueueEntry entry(interest, priority, onData, onTimeout, onNetworkNack);
-    priority->setEnqueueTimestamp(clock::millisecondTimestamp());
-    
+    if (size_.fetch_add(1) >= capacity_)
     {
-        boost::lock_guard<boost::recursive_mutex> scopedLock(queueAccess_);
-        queue_.push(entry);
-    
-        if (!isDrainingQueue_)
-        {
-            isDrainingQueue_ = true;
-            async::dispatchAsync(faceIo_, std::bind(&InterestQueue::safeDrain, this));
-        }
-        else 
-          if (queue_.size() > 10)
-            // async::dispatchSync(faceIo_, std::bind(&InterestQueue::drainQueue, this));
-            drainQueue();   // this is a hack and it will break everything if enqueueInterest
-                            // is called from other than faceIo_ thread. however, the code 
-                            // above locks and I don't know how to avoid growing queues in 
-                            // io_service other than draining them forcibly
+        size_--;
+        (*statStorage_)[Indicator::InterestsDroppedNum]++;
+        LogWarnC << "queue is full (" << capacity_ << "), dropping "
+                 << interest->getName() << std::endl;
+
+        // let fetching logic treat it as a timeout
+        if (onTimeout)
+            faceIo_.post([onTimeout, interest](){ onTimeout(interest); });
+        return;
     }
 
-    // LogTraceC
-    // << "enqueue\t" << entry.interest_->getName()
-    // << "\texclude: " << entry.interest_->getExclude().toUri()
-    // << "\tpri: "
-    // << entry.getValue() << "\tlifetime: "
-    // << entry.interest_->getInterestLifetimeMilliseconds()
-    // << "\tqsize: " << queue_.size() << std::endl;
+    priority->setEnqueueTimestamp(clock::millisecondTimestamp());
+
+    QueueEntry *entry = new QueueEntry();
+    entry->next_.store(nullptr, std::memory_order_relaxed);
+    entry->interest_ = interest;
+    entry->priority_ = priority;
+    entry->onDataCallback_ = onData;
+    entry->onTimeoutCallback_ = onTimeout;
+    entry->onNetworkNack_ = onNetworkNack;
+    entry->enqueuedUsec_ = clock::microsecondTimestamp();
+    entry->deadlineMs_ = priority->getDeadline();
+    entry->generation_ = generation_.load(std::memory_order_relaxed);
+    entry->nextInBucket_ = nullptr;
+
+    QueueEntry *prev = head_.exchange(entry, std::memory_order_acq_rel);
+    prev->next_.store(entry, std::memory_order_release);
+
+    scheduleDrain();
 }
 
 void
 InterestQueue::reset()
 {
-    {
-        boost::lock_guard<boost::recursive_mutex> scopedLock(queueAccess_);
-        queue_ = PriorityQueue(QueueEntry::Comparator(true));
-    }
+    generation_++;
+    scheduleDrain();
 
     LogDebugC << "queue flushed" << std::endl;
 }
@@ -134,49 +133,140 @@ InterestQueue::reset()
 //******************************************************************************
 #pragma mark - private
 void
-InterestQueue::safeDrain()
+InterestQueue::scheduleDrain()
 {
-    boost::lock_guard<boost::recursive_mutex> scopedLock(queueAccess_);
-    drainQueue();    
+    // one drain is posted for all Interests enqueued until it runs; drain
+    // is always posted (never dispatched), so it won't run inline even if
+    // called on face thread
+    if (!drainScheduled_.exchange(true, std::memory_order_acq_rel))
+        faceIo_.post(std::bind(&InterestQueue::drainQueue, this));
+}
+
+InterestQueue::QueueEntry*
+InterestQueue::pop()
+{
+    QueueEntry *stub = tail_;
+    QueueEntry *next = stub->next_.load(std::memory_order_acquire);
+
+    if (!next)
+        return nullptr;
+
+    // next becomes new stub, its payload is moved out to the returned entry
+    QueueEntry *entry = stub;
+    entry->interest_ = std::move(next->interest_);
+    entry->priority_ = std::move(next->priority_);
+    entry->onDataCallback_ = std::move(next->onDataCallback_);
+    entry->onTimeoutCallback_ = std::move(next->onTimeoutCallback_);
+    entry->onNetworkNack_ = std::move(next->onNetworkNack_);
+    entry->enqueuedUsec_ = next->enqueuedUsec_;
+    entry->deadlineMs_ = next->deadlineMs_;
+    entry->generation_ = next->generation_;
+    entry->nextInBucket_ = nullptr;
+    tail_ = next;
+
+    return entry;
 }
 
 void 
 InterestQueue::drainQueue()
 {
-    // boost::lock_guard<boost::recursive_mutex> scopedLock(queueAccess_);
-    isDrainingQueue_ = (queue_.size() > 0);
+    // called on face thread only
+    drainScheduled_.store(false, std::memory_order_release);
 
-    if (isDrainingQueue_)
-    {
-        // LogTraceC 
-        // << "draining queue, size "  << queue_.size() 
-        // << ", top priority: " << queue_.top().getValue() << std::endl;
+    int64_t nowMs = clock::millisecondTimestamp();
+    uint64_t generation = generation_.load();
+    size_t nBatch = 0, nDiscarded = 0;
+    QueueEntry *entry;
 
-        while (isDrainingQueue_)
+    // distribute batch over the timing wheel by time left till deadline;
+    // overdue entries go to the first bucket and ones with deadlines
+    // beyond the wheel - to the last one
+    while ((entry = pop()))
+    {
+        if (entry->generation_ < generation)
         {
-            processEntry(queue_.top());
-            queue_.pop();
-            isDrainingQueue_ = (queue_.size() > 0);
+            delete entry;
+            nDiscarded++;
+            continue;
         }
+
+        int64_t left = entry->deadlineMs_ - nowMs;
+        unsigned int bucket = (unsigned int)std::max<int64_t>(0, std::min<int64_t>(WheelSize-1, left));
+        std::pair<QueueEntry*, QueueEntry*> &b = wheel_[bucket];
+
+        if (b.second)
+            b.second->nextInBucket_ = entry;
+        else
+            b.first = entry;
+        b.second = entry;
+        wheelOccupancy_[bucket/64] |= (1ull << (bucket%64));
+        nBatch++;
     }
+
+    if (nDiscarded)
+    {
+        size_ -= nDiscarded;
+        LogDebugC << "discarded " << nDiscarded << " interests" << std::endl;
+    }
+
+    if (!nBatch)
+        return;
+
+    int64_t nowUsec = clock::microsecondTimestamp();
+
+    // express in deadline order, entries of the same bucket - in FIFO order
+    for (unsigned int word = 0; word < WheelSize/64; ++word)
+        while (wheelOccupancy_[word])
+        {
+            unsigned int bucket = word*64 + __builtin_ctzll(wheelOccupancy_[word]);
+            wheelOccupancy_[word] &= wheelOccupancy_[word]-1;
+
+            entry = wheel_[bucket].first;
+            wheel_[bucket] = std::make_pair(nullptr, nullptr);
+
+            while (entry)
+            {
+                QueueEntry *next = entry->nextInBucket_;
+
+                size_--;
+                processEntry(*entry, nowUsec);
+                delete entry;
+                entry = next;
+            }
+        }
+
+    const std::vector<uint64_t> &counts = issueDelay_.getCounts();
+
+    (*statStorage_)[Indicator::QueueSize] = size_;
+    (*statStorage_)[Indicator::InterestsSentNum] += nBatch;
+    (*statStorage_)[Indicator::InterestIssueDelay] = issueDelayFilter_.value();
+    (*statStorage_)[Indicator::IssueDelayUnder1ms] = counts[0];
+    (*statStorage_)[Indicator::IssueDelayUnder5ms] = counts[1];
+    (*statStorage_)[Indicator::IssueDelayUnder20ms] = counts[2];
+    (*statStorage_)[Indicator::IssueDelayOver20ms] = counts[3];
+
+    LogTraceC << "expressed batch of " << nBatch << std::endl;
 }
 
 void
-InterestQueue::processEntry(const InterestQueue::QueueEntry &entry)
-{    
+InterestQueue::processEntry(const InterestQueue::QueueEntry &entry, int64_t nowUsec)
+{
+    double issueDelayMs = (double)(nowUsec - entry.enqueuedUsec_) / 1000.;
+
     LogTraceC << "express\t" << entry.interest_->getName()
               << "\texclude: " << entry.interest_->getExclude().toUri()
-              << "\tpri: " << entry.getValue() 
+              << "\tdeadline: " << entry.deadlineMs_
               << "\tlifetime: " << entry.interest_->getInterestLifetimeMilliseconds()
-              << "\tqsize: " << queue_.size()
+              << "\tqsize: " << size_
               << "\tmustBeFresh: " << entry.interest_->getMustBeFresh()
+              << "\tdelay: " << issueDelayMs
               << std::endl;
 
     face_->expressInterest(*(entry.interest_), entry.onDataCallback_, 
         entry.onTimeoutCallback_, entry.onNetworkNack_);
-    
-    (*statStorage_)[Indicator::QueueSize] = queue_.size();
-    (*statStorage_)[Indicator::InterestsSentNum]++;
+
+    issueDelay_.newValue(issueDelayMs);
+    issueDelayFilter_.newValue(issueDelayMs);
 
     if (observer_) observer_->onInterestIssued(entry.interest_);
 }
@@ -11,12 +11,14 @@
 #ifndef __ndnrtc__interest_queue__
 #define __ndnrtc__interest_queue__
 
-#include <queue>
+#include <atomic>
+#include <vector>
 #include <boost/asio.hpp>
 #include <memory>
 
 #include "ndnrtc-object.hpp"
 #include "statistics.hpp"
+#include "estimators.hpp"
 
 namespace ndn {
     class Interest;
@@ -54,6 +56,16 @@ namespace ndnrtc {
     /**
      * Interst queue class implements functionality for priority Interest queue.
      * Interests are expressed according to their priorities on Face thread.
+     *
+     * Interests may be enqueued from any thread: enqueueing is lock-free
+     * (multiple producers push into an intrusive MPSC list) and never
+     * expresses Interests on the caller's thread. Queue is drained only on
+     * face thread - a single drain is posted for any number of Interests
+     * enqueued meanwhile, and the whole batch is expressed at once, ordered
+     * by arrival deadlines. Ordering uses a timing wheel with 1ms buckets, so
+     * it takes linear time in the size of the batch.
+     * Queue is bounded - Interests enqueued over capacity are dropped and
+     * their timeout callbacks are called on face thread.
      */
     class InterestQueue : public NdnRtcComponent,
                           public IInterestQueue,
@@ -69,11 +81,12 @@ namespace ndnrtc {
 
         InterestQueue(boost::asio::io_service& io,
                       const std::shared_ptr<ndn::Face> &face,
-                      const std::shared_ptr<statistics::StatisticsStorage>& statStorage);
+                      const std::shared_ptr<statistics::StatisticsStorage>& statStorage,
+                      size_t capacity = 4096);
         ~InterestQueue();
         
         /**
-         * Enqueues Interest in the queue.
+         * Enqueues Interest in the queue. Thread-safe.
          * @param interest Interest to be expressed
          * @param priority Interest priority
          * @param onData OnData callback
@@ -87,75 +100,63 @@ namespace ndnrtc {
                         OnNetworkNack = OnNetworkNack());
         
         /**
-         * Flushes current interest queue
+         * Flushes current interest queue. Interests enqueued before this
+         * call and not yet expressed, will be discarded.
          */
         void reset();
         void registerObserver(IInterestQueueObserver *observer) { observer_ = observer; }
         void unregisterObserver() { observer_ = nullptr; }
-        size_t size() const { return queue_.size(); }
+        size_t size() const { return size_; }
+        size_t capacity() const { return capacity_; }
+
+        /**
+         * Histogram of Interest issue delays (time between enqueueing and
+         * expressing Interest) in milliseconds. Must be accessed on face
+         * thread.
+         */
+        const estimators::Histogram& getIssueDelayHistogram() const { return issueDelay_; }
         
     private:
-        class QueueEntry
+        struct QueueEntry
         {
-        public:
-            class Comparator
-            {
-            public:
-                Comparator(bool inverted):inverted_(inverted){}
-                
-                bool operator() (const QueueEntry& q1,
-                                 const QueueEntry& q2) const
-                {
-                    return inverted_^(q1.getValue() < q2.getValue());
-                }
-                
-            private:
-                bool inverted_;
-            };
-
-            QueueEntry(const std::shared_ptr<const ndn::Interest>& interest,
-                       const std::shared_ptr<IPriority>& priority,
-                       OnData onData,
-                       OnTimeout onTimeout,
-                       OnNetworkNack onNetworkNack);
-
-            int64_t
-            getValue() const { return priority_->getValue(); }
-            
-            QueueEntry& operator=(const QueueEntry& entry)
-            {
-                interest_ = entry.interest_; // we just copy the pointer, since it's a pointer to a const
-                priority_  = entry.priority_;
-                onDataCallback_ = entry.onDataCallback_;
-                onTimeoutCallback_ = entry.onTimeoutCallback_;
-                onNetworkNack_ = entry.onNetworkNack_;
-                return *this;
-            }
-
-        private:
-            friend InterestQueue;
-
+            std::atomic<QueueEntry*> next_;
             std::shared_ptr<const ndn::Interest> interest_;
             std::shared_ptr<IPriority> priority_;
             OnData onDataCallback_;
             OnTimeout onTimeoutCallback_;
             OnNetworkNack onNetworkNack_;
+            int64_t enqueuedUsec_, deadlineMs_;
+            uint64_t generation_;
+            // next entry in the timing wheel bucket
+            QueueEntry *nextInBucket_;
         };
-        
-        typedef std::priority_queue<QueueEntry, std::vector<QueueEntry>, 
-                    QueueEntry::Comparator> PriorityQueue;
-        
+
+        static const unsigned int WheelSize = 256; // buckets, 1ms each
+
         std::shared_ptr<ndn::Face> face_;
         boost::asio::io_service& faceIo_;
-        boost::recursive_mutex queueAccess_;
-        PriorityQueue queue_;
         IInterestQueueObserver *observer_;
-        bool isDrainingQueue_;
-        
-        void safeDrain();
+        const size_t capacity_;
+
+        // MPSC list: producers append at head_, consumer (face thread) pops
+        // at tail_; tail_ always points to a (consumed) stub entry
+        std::atomic<QueueEntry*> head_;
+        QueueEntry *tail_;
+        std::atomic<size_t> size_;
+        std::atomic<bool> drainScheduled_;
+        // incremented on reset, entries of older generations are discarded
+        std::atomic<uint64_t> generation_;
+
+        // timing wheel, accessed on face thread only
+        std::vector<std::pair<QueueEntry*, QueueEntry*>> wheel_;
+        uint64_t wheelOccupancy_[WheelSize/64];
+        estimators::Histogram issueDelay_;
+        estimators::Filter issueDelayFilter_;
+
+        void scheduleDrain();
         void drainQueue();
-        void stopQueueWatching();
-        void processEntry(const QueueEntry &entry);
+        QueueEntry* pop();
+        void processEntry(const QueueEntry &entry, int64_t nowUsec);
     };
     
     /**
@@ -170,6 +171,8 @@ namespace ndnrtc {
 
         int64_t getValue() const;
         void setEnqueueTimestamp(int64_t timestamp) { enqueuedMs_ = timestamp; }
+        // absolute arrival deadline, available once enqueue timestamp is set
+        int64_t getDeadline() const { return getArrivalDeadlineFromEnqueue(); }
 
         static std::shared_ptr<DeadlinePriority>
         fromNow(int64_t delayMs) { return std::make_shared<DeadlinePriority>(delayMs); }
@@ -0,0 +1,84 @@
+//
+// key-chain-lock.hpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#ifndef __key_chain_lock_hpp__
+#define __key_chain_lock_hpp__
+
+#include <map>
+#include <memory>
+#include <utility>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/recursive_mutex.hpp>
+#include <boost/thread/lock_guard.hpp>
+
+namespace ndnrtc
+{
+namespace detail
+{
+typedef struct _KeyChainMutexes
+{
+    boost::mutex mapMutex_;
+    std::map<const void *, std::weak_ptr<boost::recursive_mutex>> mutexes_;
+} KeyChainMutexes;
+
+inline KeyChainMutexes &keyChainMutexes()
+{
+    static KeyChainMutexes mutexes;
+    return mutexes;
+}
+}
+
+/**
+ * Key chains are not thread-safe, while one key chain may be shared by
+ * remote streams running on different consumer runtime shards and by local
+ * streams. Returns mutex that guards given key chain. Mutex is recursive, as
+ * verification callbacks may verify more data.
+ * Mutex lives as long as someone holds the returned pointer, i.e. while key
+ * chain is being used, and is removed from the registry afterwards. Thus,
+ * registry doesn't grow and key chain allocated later at the same address
+ * gets a new mutex.
+ */
+inline std::shared_ptr<boost::recursive_mutex> keyChainMutex(const void *keyChain)
+{
+    detail::KeyChainMutexes &registry = detail::keyChainMutexes();
+    boost::lock_guard<boost::mutex> scopedLock(registry.mapMutex_);
+    std::weak_ptr<boost::recursive_mutex> &entry = registry.mutexes_[keyChain];
+    std::shared_ptr<boost::recursive_mutex> m = entry.lock();
+
+    if (!m)
+    {
+        m = std::shared_ptr<boost::recursive_mutex>(new boost::recursive_mutex(),
+            [keyChain](boost::recursive_mutex *mutex) {
+                detail::KeyChainMutexes &registry = detail::keyChainMutexes();
+                {
+                    boost::lock_guard<boost::mutex> scopedLock(registry.mapMutex_);
+                    auto it = registry.mutexes_.find(keyChain);
+                    // entry may have been replaced already
+                    if (it != registry.mutexes_.end() && it->second.expired())
+                        registry.mutexes_.erase(it);
+                }
+                delete mutex;
+            });
+        entry = m;
+    }
+
+    return m;
+}
+
+/**
+ * Calls keyChain.verifyData() holding key chain's mutex.
+ */
+template <typename KeyChainType, typename... Args>
+void verifyData(KeyChainType &keyChain, Args &&... args)
+{
+    std::shared_ptr<boost::recursive_mutex> m = keyChainMutex(&keyChain);
+    boost::lock_guard<boost::recursive_mutex> scopedLock(*m);
+    keyChain.verifyData(std::forward<Args>(args)...);
+}
+}
+
+#endif
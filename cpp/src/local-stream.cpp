@@ -125,6 +125,7 @@ LocalVideoStream::LocalVideoStream(const std::string& streamPrefix,
 	const MediaStreamSettings& settings, bool useFec):
 pimpl_(std::make_shared<VideoStreamImpl>(streamPrefix, settings, useFec))
 {
+	pimpl_->startPipeline();
 	pimpl_->setupInvocation(MediaStreamBase::MetaCheckIntervalMs, 
 		std::bind(&MediaStreamBase::periodicInvocation, pimpl_));
 	pimpl_->publishMeta();
@@ -132,6 +133,9 @@ pimpl_(std::make_shared<VideoStreamImpl>(streamPrefix, settings, useFec))
 
 LocalVideoStream::~LocalVideoStream()
 {
+	// pipeline stages must be stopped while pimpl_ is still alive, as
+	// their callbacks may be running at this moment
+	pimpl_->stopPipeline();
 }
 
 void
@@ -8,7 +8,6 @@
 #include <boost/smart_ptr/shared_ptr.hpp>
 #include <boost/thread/lock_guard.hpp>
 #include <ndn-cpp/face.hpp>
-#include <ndn-cpp/util/memory-content-cache.hpp>
 
 #include "media-stream-base.hpp"
 #include "name-components.hpp"
@@ -48,27 +47,42 @@ MediaStreamBase::MediaStreamBase(const std::string &basePrefix,
     unsigned int minimumFreshness = min(settings_.params_.producerParams_.freshness_.metadataMs_, 
                                         settings_.params_.producerParams_.freshness_.sampleMs_);
     minimumFreshness = min(minimumFreshness, settings_.params_.producerParams_.freshness_.sampleKeyMs_);
-    // set cleanup interval for memory cache to 0
-    // this will make cache to cleanup every time there's an incoming interest 
-    // or data added (and prevent it from hanging for few ms when data rate is high)
-    cache_ = std::make_shared<MemoryContentCache>(settings_.face_, 0);
-    cache_->setMinimumCacheLifetime(1000);
+    contentStore_ = std::make_shared<ContentStore>(settings_.face_, settings_.faceIo_, statStorage_);
+    contentStore_->setDescription("content-store-" + settings_.params_.streamName_);
+    contentStore_->setMinimumCacheLifetime(1000);
     // set filter for prefix without the timestamp, because stream _meta is served there
-    cache_->setInterestFilter(streamPrefix_.getPrefix(-1), cache_->getStorePendingInterest());
+    contentStore_->setInterestFilter(streamPrefix_.getPrefix(-1));
+
+    if (settings_.sign_ && settings_.signing_.poolSize_)
+    {
+        KeyChain *keyChain = settings_.keyChain_;
+        try
+        {
+            signingPool_ = std::make_shared<SigningPool>(settings_.signing_.poolSize_,
+                                                         [keyChain]() { return cloneKeyChain(*keyChain); });
+        }
+        catch (std::exception &e)
+        {
+            LogWarnC << "can't create signing pool (" << e.what()
+                     << "), packets will be signed sequentially" << std::endl;
+        }
+    }
 
     PublisherSettings ps;
     ps.sign_ = settings_.sign_; // it's ok to sign every packet as data publisher
                                 // is used for low-rate data (max 10fps) and manifests
     ps.keyChain_ = settings_.keyChain_;
-    ps.memoryCache_ = cache_.get();
+    ps.signingPool_ = signingPool_.get();
+    ps.contentStore_ = contentStore_.get();
     ps.segmentWireLength_ = MAX_NDN_PACKET_SIZE; // it's ok to rely on link-layer fragmenting
                                                  // because data is low-rate
     ps.freshnessPeriodMs_ = settings_.params_.producerParams_.freshness_.metadataMs_;
     ps.statStorage_ = statStorage_.get();
+    ps.signDelayIndicator_ = statistics::Indicator::MetaSignDelay;
 
     if (settings_.storagePath_ != "")
     {
-        storage_ = std::make_shared<StorageEngine>(settings_.storagePath_);
+        storage_ = std::make_shared<StorageEngine>(settings_.storagePath_, statStorage_);
         ps.onSegmentsCached_ = std::bind(&MediaStreamBase::onSegmentsCached, this, _1);
     }
 
@@ -104,6 +118,7 @@ void
 MediaStreamBase::setLogger(std::shared_ptr<ndnlog::new_api::Logger> logger)
 {
     metadataPublisher_->setLogger(logger);
+    contentStore_->setLogger(logger);
 }
 
 void MediaStreamBase::publishMeta()
@@ -136,7 +151,7 @@ unsigned int MediaStreamBase::periodicInvocation()
 
 void MediaStreamBase::onSegmentsCached(std::vector<std::shared_ptr<const ndn::Data>> segments)
 {
+    // segments are written on storage's own thread
     if (storage_)
-        for (auto& d:segments)
-            storage_->put(d);
+        storage_->put(segments);
 }
@@ -11,16 +11,12 @@
 #include <boost/thread/mutex.hpp>
 #include <ndn-cpp/name.hpp>
 
+#include "content-store.hpp"
 #include "local-stream.hpp"
 #include "packet-publisher.hpp"
 #include "periodic.hpp"
 #include "statistics.hpp"
 
-namespace ndn
-{
-class MemoryContentCache;
-}
-
 namespace ndnrtc
 {
 namespace statistics
@@ -79,7 +75,9 @@ class MediaStreamBase : public NdnRtcComponent,
     MediaStreamSettings settings_;
     std::string basePrefix_;
     ndn::Name streamPrefix_;
-    std::shared_ptr<ndn::MemoryContentCache> cache_;
+    std::shared_ptr<ContentStore> contentStore_;
+    // must outlive publishers, which use it
+    std::shared_ptr<SigningPool> signingPool_;
     std::shared_ptr<CommonPacketPublisher> metadataPublisher_;
     std::shared_ptr<statistics::StatisticsStorage> statStorage_;
     std::shared_ptr<StorageEngine> storage_;
@@ -16,7 +16,16 @@
 #include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string.hpp>
 
+#include <deque>
+#include <type_traits>
+#include <unordered_map>
+#include <boost/thread/shared_mutex.hpp>
+#include <boost/thread/locks.hpp>
+#include <random>
+#include <ndn-cpp/interest.hpp>
+
 #include "name-components.hpp"
+#include "sample-index.hpp"
 
 using namespace std;
 using namespace ndnrtc;
@@ -30,6 +39,8 @@ const string NameComponents::NameComponentDelta = "d";
 const string NameComponents::NameComponentKey = "k";
 const string NameComponents::NameComponentParity = "_parity";
 const string NameComponents::NameComponentManifest = "_manifest";
+const unsigned int NameComponents::AudioManifestWindow = 10;
+const uint8_t NameComponents::RetransmissionNonceMarker = 0xa5;
 
 #include <bitset>
 
@@ -183,116 +194,428 @@ NameComponents::videoStreamPrefix(string basePrefix)
     return streamPrefix(MediaStreamParams::MediaStreamType::MediaStreamTypeVideo, basePrefix);
 }
 
+PacketNumber
+NameComponents::audioManifestBundleNo(PacketNumber bundleNo)
+{
+    return bundleNo - bundleNo % AudioManifestWindow + AudioManifestWindow - 1;
+}
+
+std::shared_ptr<Interest>
+NameComponents::retransmission(const Interest& interest)
+{
+    static thread_local std::mt19937 gen(std::random_device{}());
+    uint32_t random = gen();
+    uint8_t nonce[4] = { RetransmissionNonceMarker, 
+                         (uint8_t)random, (uint8_t)(random >> 8), (uint8_t)(random >> 16) };
+    std::shared_ptr<Interest> rtx = std::make_shared<Interest>(interest);
+
+    rtx->setNonce(Blob(nonce, sizeof(nonce)));
+    return rtx;
+}
+
+bool
+NameComponents::isRetransmission(const Interest& interest)
+{
+    return interest.getNonce().size() > 0 &&
+        interest.getNonce().buf()[0] == RetransmissionNonceMarker;
+}
+
 //******************************************************************************
-bool extractMeta(const ndn::Name& name, NamespaceInfo& info)
+static_assert(std::is_trivially_copyable<NameHandle>::value, 
+              "NameHandle must be trivially copyable");
+
+namespace ndnrtc {
+    /**
+     * Process-wide registry of stream prefixes and thread names seen in
+     * parsed names. Entries are looked up by the hash of raw name components
+     * and verified by comparing components, thus lookups do not allocate.
+     * Entries are never removed, so references to them stay valid; thus
+     * names of untrusted origin are only looked up, not interned (see
+     * NameComponents::extractHandle).
+     */
+    class NameRegistry {
+    public:
+        typedef struct _StreamEntry {
+            ndn::Name prefix_;  // components the stream was interned by
+            ndn::Name basePrefix_;
+            unsigned int apiVersion_;
+            MediaStreamParams::MediaStreamType streamType_;
+            std::string streamName_;
+            bool hasTimestamp_;
+            uint64_t streamTimestamp_;
+            uint64_t key_;
+        } StreamEntry;
+
+        typedef struct _ThreadEntry {
+            ndn::Name::Component component_;
+            std::string threadName_;
+            uint32_t key_;
+        } ThreadEntry;
+
+        static NameRegistry& getSharedInstance()
+        {
+            static NameRegistry registry;
+            return registry;
+        }
+
+        // interns stream prefix name[0, end); name[end-1] is either stream
+        // name or stream timestamp
+        uint32_t internStream(const Name& name, size_t end, size_t baseEnd, 
+                              unsigned int apiVersion, 
+                              MediaStreamParams::MediaStreamType streamType,
+                              bool hasTimestamp)
+        {
+            uint64_t h = prefixHash(name, end);
+
+            {
+                boost::shared_lock<boost::shared_mutex> lock(mutex_);
+                uint32_t id = findStream(name, end, h);
+                if (id) return id;
+            }
+
+            boost::unique_lock<boost::shared_mutex> lock(mutex_);
+            uint32_t id = findStream(name, end, h);
+            if (id) return id;
+
+            StreamEntry e;
+            e.prefix_ = name.getPrefix(end);
+            e.basePrefix_ = name.getPrefix(baseEnd);
+            e.apiVersion_ = apiVersion;
+            e.streamType_ = streamType;
+            e.streamName_ = name.get(hasTimestamp ? end-2 : end-1).toEscapedString();
+            e.hasTimestamp_ = hasTimestamp;
+            e.streamTimestamp_ = (hasTimestamp ? name.get(end-1).toTimestamp() : 0);
+            e.key_ = streamKey(name, end, baseEnd, apiVersion, streamType, hasTimestamp);
+            streams_.push_back(e);
+            id = (uint32_t)streams_.size();
+            streamIds_.insert(std::make_pair(h, id));
+
+            return id;
+        }
+
+        uint32_t internThread(const Name::Component& c)
+        {
+            uint64_t h = hashComponent(c, fnv1a(nullptr, 0));
+
+            {
+                boost::shared_lock<boost::shared_mutex> lock(mutex_);
+                uint32_t id = findThread(c, h);
+                if (id) return id;
+            }
+
+            boost::unique_lock<boost::shared_mutex> lock(mutex_);
+            uint32_t id = findThread(c, h);
+            if (id) return id;
+
+            ThreadEntry e;
+            e.component_ = c;
+            e.threadName_ = c.toEscapedString();
+            e.key_ = SampleKey::threadHash(e.threadName_);
+            threads_.push_back(e);
+            id = (uint32_t)threads_.size();
+            threadIds_.insert(std::make_pair(h, id));
+
+            return id;
+        }
+
+        // returns id of interned stream prefix name[0, end) or 0
+        uint32_t findStream(const Name& name, size_t end) const
+        {
+            boost::shared_lock<boost::shared_mutex> lock(mutex_);
+            return findStream(name, end, prefixHash(name, end));
+        }
+
+        // returns id of interned thread name or 0
+        uint32_t findThread(const Name::Component& c) const
+        {
+            boost::shared_lock<boost::shared_mutex> lock(mutex_);
+            return findThread(c, hashComponent(c, fnv1a(nullptr, 0)));
+        }
+
+        // key of stream prefix name[0, end), as used by SampleKey
+        static uint64_t streamKey(const Name& name, size_t end, size_t baseEnd,
+                                  unsigned int apiVersion,
+                                  MediaStreamParams::MediaStreamType streamType,
+                                  bool hasTimestamp)
+        {
+            return SampleKey::streamHash(name.getPrefix(baseEnd), apiVersion, streamType,
+                                         name.get(hasTimestamp ? end-2 : end-1).toEscapedString(),
+                                         hasTimestamp,
+                                         (hasTimestamp ? name.get(end-1).toTimestamp() : 0));
+        }
+
+        const StreamEntry& getStream(uint32_t id) const
+        {
+            boost::shared_lock<boost::shared_mutex> lock(mutex_);
+            return streams_[id-1];
+        }
+
+        const ThreadEntry& getThread(uint32_t id) const
+        {
+            boost::shared_lock<boost::shared_mutex> lock(mutex_);
+            return threads_[id-1];
+        }
+
+    private:
+        mutable boost::shared_mutex mutex_;
+        std::deque<StreamEntry> streams_;
+        std::deque<ThreadEntry> threads_;
+        std::unordered_multimap<uint64_t, uint32_t> streamIds_, threadIds_;
+
+        static uint64_t fnv1a(const void *data, size_t len, uint64_t h = 0xcbf29ce484222325ULL)
+        { return SampleKey::fnv1a(data, len, h); }
+
+        static uint64_t prefixHash(const Name& name, size_t end)
+        {
+            uint64_t h = fnv1a(nullptr, 0);
+            for (size_t i = 0; i < end; ++i)
+                h = hashComponent(name.get(i), h);
+            return h;
+        }
+
+        static uint64_t hashComponent(const Name::Component& c, uint64_t h)
+        {
+            const Blob& v = c.getValue();
+            size_t len = v.size();
+
+            h = fnv1a(&len, sizeof(len), h);
+            if (len)
+                h = fnv1a(v.buf(), len, h);
+            return h;
+        }
+
+        uint32_t findStream(const Name& name, size_t end, uint64_t h) const
+        {
+            auto range = streamIds_.equal_range(h);
+            for (auto it = range.first; it != range.second; ++it)
+            {
+                const Name& prefix = streams_[it->second-1].prefix_;
+                bool match = (prefix.size() == end);
+
+                for (size_t i = 0; match && i < end; ++i)
+                    match = (prefix.get(i) == name.get(i));
+                if (match)
+                    return it->second;
+            }
+            return 0;
+        }
+
+        uint32_t findThread(const Name::Component& c, uint64_t h) const
+        {
+            auto range = threadIds_.equal_range(h);
+            for (auto it = range.first; it != range.second; ++it)
+                if (threads_[it->second-1].component_ == c)
+                    return it->second;
+            return 0;
+        }
+    };
+}
+
+namespace {
+    const Name::Component& componentMeta()
+    {
+        static Name::Component c(NameComponents::NameComponentMeta);
+        return c;
+    }
+
+    const Name::Component& componentParity()
+    {
+        static Name::Component c(NameComponents::NameComponentParity);
+        return c;
+    }
+
+    const Name::Component& componentManifest()
+    {
+        static Name::Component c(NameComponents::NameComponentManifest);
+        return c;
+    }
+
+    // positions of variable-length components, found while parsing
+    typedef struct _NamePositions {
+        size_t baseEnd_, streamEnd_, threadIdx_;
+        bool hasTimestamp_;
+    } NamePositions;
+}
+
+NameHandle::NameHandle(const NamespaceInfo& info):
+    streamId_(0), threadId_(0), 
+    apiVersion_(info.apiVersion_), streamType_(info.streamType_),
+    isMeta_(info.isMeta_), isParity_(info.isParity_), isDelta_(info.isDelta_),
+    hasSeqNo_(info.hasSeqNo_), hasSegNo_(info.hasSegNo_), class_(info.class_),
+    segmentClass_(info.segmentClass_), sampleNo_(info.sampleNo_), 
+    segNo_(info.segNo_), metaVersion_(info.metaVersion_)
 {
-    // example: name == %FD%05/%00%00
-    if (name.size() >= 1 && name[0].isVersion())
+    bool hasThread = (info.threadName_ != "");
+    Name prefix = info.getPrefix(prefix_filter::StreamTS);
+
+    streamId_ = NameRegistry::getSharedInstance().internStream(prefix, prefix.size(),
+        info.basePrefix_.size(), apiVersion_, streamType_, hasThread);
+    streamKey_ = NameRegistry::getSharedInstance().getStream(streamId_).key_;
+
+    if (hasThread)
     {
-        info.metaVersion_ = name[0].toVersion();
-        if (name.size() >= 2)
+        threadId_ = NameRegistry::getSharedInstance().internThread(Name(info.threadName_).get(0));
+        threadKey_ = NameRegistry::getSharedInstance().getThread(threadId_).key_;
+    }
+    else
+        threadKey_ = SampleKey::threadHash("");
+}
+
+const Name& 
+NameHandle::getBasePrefix() const
+{
+    static Name empty;
+    return (streamId_ ? NameRegistry::getSharedInstance().getStream(streamId_).basePrefix_ : empty);
+}
+
+const std::string& 
+NameHandle::getStreamName() const
+{
+    static std::string empty;
+    return (streamId_ ? NameRegistry::getSharedInstance().getStream(streamId_).streamName_ : empty);
+}
+
+const std::string& 
+NameHandle::getThreadName() const
+{
+    static std::string empty;
+    return (threadId_ ? NameRegistry::getSharedInstance().getThread(threadId_).threadName_ : empty);
+}
+
+uint64_t
+NameHandle::getStreamTimestamp() const
+{
+    return (streamId_ ? NameRegistry::getSharedInstance().getStream(streamId_).streamTimestamp_ : 0);
+}
+
+NamespaceInfo
+NameHandle::getInfo() const
+{
+    NamespaceInfo info;
+
+    info.basePrefix_ = getBasePrefix();
+    info.apiVersion_ = apiVersion_;
+    info.streamType_ = streamType_;
+    info.streamName_ = getStreamName();
+    info.threadName_ = getThreadName();
+    info.isMeta_ = isMeta_;
+    info.isParity_ = isParity_;
+    info.isDelta_ = isDelta_;
+    info.hasSeqNo_ = hasSeqNo_;
+    info.hasSegNo_ = hasSegNo_;
+    info.class_ = class_;
+    info.segmentClass_ = segmentClass_;
+    info.sampleNo_ = sampleNo_;
+    info.segNo_ = segNo_;
+    info.metaVersion_ = metaVersion_;
+    info.streamTimestamp_ = getStreamTimestamp();
+
+    return info;
+}
+
+//******************************************************************************
+bool extractMeta(const ndn::Name& name, size_t idx, NameHandle& handle)
+{
+    // example: name[idx..] == %FD%05/%00%00
+    if (name.size() > idx && name[idx].isVersion())
+    {
+        handle.metaVersion_ = name[idx].toVersion();
+        if (name.size() > idx+1)
         {
-            info.segNo_ = name[1].toSegment();
-            info.hasSegNo_ = true;
+            handle.segNo_ = name[idx+1].toSegment();
+            handle.hasSegNo_ = true;
         }
         else
-            info.hasSegNo_ = false;
+            handle.hasSegNo_ = false;
         return true;
     }
 
     return false;
 }
 
-bool extractVideoStreamInfo(const ndn::Name& name, NamespaceInfo& info)
+bool extractVideoStreamInfo(const ndn::Name& name, size_t idx, 
+                            NameHandle& handle, NamePositions& pos)
 {
-    if (name.size() < 3)
+    if (name.size() < idx+3)
         return false;
 
-    int idx = 0;
-    info.streamName_ = name[idx++].toEscapedString();
-    info.isMeta_ = (name[idx++] == Name::Component(NameComponents::NameComponentMeta));
+    pos.streamEnd_ = ++idx;
+    handle.isMeta_ = (name[idx++] == componentMeta());
 
-    if (info.isMeta_)
-    {   // example: name == camera/_meta/%FD%05/%00%00
-        info.segmentClass_ = SegmentClass::Meta;
-        info.threadName_ = "";
-        return extractMeta(name.getSubName(idx), info);
+    if (handle.isMeta_)
+    {   // example: name[idx..] == camera/_meta/%FD%05/%00%00
+        handle.segmentClass_ = SegmentClass::Meta;
+        return extractMeta(name, idx, handle);
     }
     else
-    {   // example: name == camera/%FC%00%00%01c_%27%DE%D6/hi/d/%FE%07/%00%00
-
-        info.class_ = SampleClass::Unknown;
-        info.segmentClass_ = SegmentClass::Unknown;
-        info.streamTimestamp_ = name[idx-1].toTimestamp();
-        info.threadName_ = name[idx++].toEscapedString();
+    {   // example: name[idx..] == camera/%FC%00%00%01c_%27%DE%D6/hi/d/%FE%07/%00%00
+
+        handle.class_ = SampleClass::Unknown;
+        handle.segmentClass_ = SegmentClass::Unknown;
+        name[idx-1].toTimestamp();
+        pos.streamEnd_ = idx;
+        pos.hasTimestamp_ = true;
+        pos.threadIdx_ = idx++;
         
         if (name.size() <= idx)
             return false;
 
-        info.isMeta_ = (name[idx++] == Name::Component(NameComponents::NameComponentMeta));
+        handle.isMeta_ = (name[idx++] == componentMeta());
 
-        if (info.isMeta_)
+        if (handle.isMeta_)
         {   // example: camera/%FC%00%00%01c_%27%DE%D6/hi/_meta/%FD%05/%00%00
-            info.segmentClass_ = SegmentClass::Meta;
-            if(name.size() > idx-1 && extractMeta(name.getSubName(idx), info))
-                return true;
-            return false;
+            handle.segmentClass_ = SegmentClass::Meta;
+            return extractMeta(name, idx, handle);
         }
 
         if (name[idx-1] == Name::Component(NameComponents::NameComponentDelta) || 
             name[idx-1] == Name::Component(NameComponents::NameComponentKey))
         {
-            info.isDelta_ = (name[idx-1] == Name::Component(NameComponents::NameComponentDelta));
-            info.class_ = (info.isDelta_ ? SampleClass::Delta : SampleClass::Key);
+            handle.isDelta_ = (name[idx-1] == Name::Component(NameComponents::NameComponentDelta));
+            handle.class_ = (handle.isDelta_ ? SampleClass::Delta : SampleClass::Key);
+
+            if (name.size() > idx)
+                handle.sampleNo_ = (PacketNumber)name[idx++].toSequenceNumber();
+            else
+            {
+                handle.hasSeqNo_ = false;
+                return true;
+            }
+        
+            handle.hasSeqNo_ = true;
+            if (name.size() > idx)
+            {
+                handle.isParity_ = (name[idx] == componentParity());
+                handle.hasSegNo_ = true;
 
-            try{
-                if (name.size() > idx)
-                    info.sampleNo_ = (PacketNumber)name[idx++].toSequenceNumber();
-                else
+                if (handle.isParity_ && name.size() > idx+1)
                 {
-                    info.hasSeqNo_ = false;
+                    handle.segmentClass_ = SegmentClass::Parity;
+                    handle.segNo_ = name[idx+1].toSegment();
                     return true;
                 }
-            
-                info.hasSeqNo_ = true;
-                if (name.size() > idx)
+                else 
                 {
-                    info.isParity_ = (name[idx] == Name::Component(NameComponents::NameComponentParity));
-                    info.hasSegNo_ = true;
-
-                    if (info.isParity_ && name.size() > idx+1)
+                    if (handle.isParity_) 
+                        return false;
+                    else
                     {
-                        info.segmentClass_ = SegmentClass::Parity;
-                        info.segNo_ = name[idx+1].toSegment();
-                        return true;
-                    }
-                    else 
-                    {
-                        if (info.isParity_) 
-                            return false;
+                        if (name[idx] == componentManifest())
+                            handle.segmentClass_ = SegmentClass::Manifest;
                         else
                         {
-                            if (name[idx] == Name::Component(NameComponents::NameComponentManifest))
-                                info.segmentClass_ = SegmentClass::Manifest;
-                            else
-                            {
-                                info.segmentClass_ = SegmentClass::Data;
-                                info.segNo_ = name[idx].toSegment();
-                            }
+                            handle.segmentClass_ = SegmentClass::Data;
+                            handle.segNo_ = name[idx].toSegment();
                         }
-                        return true;
                     }
-                }
-                else
-                {
-                    info.segmentClass_ = SegmentClass::Unknown;
-                    info.hasSegNo_ = false;
                     return true;
                 }
             }
-            catch (std::runtime_error& e)
+            else
             {
-                return false;
+                handle.segmentClass_ = SegmentClass::Unknown;
+                handle.hasSegNo_ = false;
+                return true;
             }
         }
     }
@@ -300,77 +623,69 @@ bool extractVideoStreamInfo(const ndn::Name& name, NamespaceInfo& info)
     return false;
 }
 
-bool extractAudioStreamInfo(const ndn::Name& name, NamespaceInfo& info)
+bool extractAudioStreamInfo(const ndn::Name& name, size_t idx, 
+                            NameHandle& handle, NamePositions& pos)
 {
-    if (name.size() < 2)
+    if (name.size() < idx+2)
         return false;
 
-    int idx = 0;
-    info.streamName_ = name[idx++].toEscapedString();
-    info.isMeta_ = (name[idx++] == Name::Component(NameComponents::NameComponentMeta));
+    size_t start = idx;
+    pos.streamEnd_ = ++idx;
+    handle.isMeta_ = (name[idx++] == componentMeta());
     
-    if (info.isMeta_)
+    if (handle.isMeta_)
     {
-        info.segmentClass_ = SegmentClass::Meta;
-        if (name.size() < idx+1)
-            return false;
-
-        info.threadName_ = "";
-        return extractMeta(name.getSubName(idx), info);;
+        handle.segmentClass_ = SegmentClass::Meta;
+        return extractMeta(name, idx, handle);
     }
     else
     {
-        info.class_ = SampleClass::Unknown;
-        info.segmentClass_ = SegmentClass::Unknown;
-        info.streamTimestamp_ = name[idx-1].toTimestamp();
-        info.threadName_ = name[idx++].toEscapedString();
+        handle.class_ = SampleClass::Unknown;
+        handle.segmentClass_ = SegmentClass::Unknown;
+        name[idx-1].toTimestamp();
+        pos.streamEnd_ = idx;
+        pos.hasTimestamp_ = true;
 
-        if (name.size() == 3)
+        if (name.size() <= idx)
+            return false;
+
+        pos.threadIdx_ = idx++;
+
+        if (name.size() == start+3)
         {
-            info.hasSeqNo_ = false;
+            handle.hasSeqNo_ = false;
             return true;
         }
 
-        info.isMeta_ = (name[idx] == Name::Component(NameComponents::NameComponentMeta));
+        handle.isMeta_ = (name[idx] == componentMeta());
 
-        if (info.isMeta_)
+        if (handle.isMeta_)
         { 
-            info.segmentClass_ = SegmentClass::Meta;
-            if (name.size() > idx+1 && extractMeta(name.getSubName(idx+1), info))
-                return true;
-            return false;
+            handle.segmentClass_ = SegmentClass::Meta;
+            return extractMeta(name, idx+1, handle);
         }
 
-        info.isDelta_ = true;
-        info.class_ = SampleClass::Delta;
+        handle.isDelta_ = true;
+        handle.class_ = SampleClass::Delta;
+        handle.sampleNo_ = (PacketNumber)name[idx++].toSequenceNumber();
+        handle.hasSeqNo_ = true;
 
-        try
+        if (name.size() > idx)
         {
-            if (name.size() > 3)
-                info.sampleNo_ = (PacketNumber)name[idx++].toSequenceNumber();
-            
-            info.hasSeqNo_ = true;
-            if (name.size() > idx)
-            {
-                if (name[idx] == Name::Component(NameComponents::NameComponentManifest))
-                    info.segmentClass_ = SegmentClass::Manifest;
-                else
-                {
-                    info.hasSegNo_ = true;
-                    info.segmentClass_ = SegmentClass::Data;
-                    info.segNo_ = name[idx].toSegment();
-                }
-                return true;
-            }
+            if (name[idx] == componentManifest())
+                handle.segmentClass_ = SegmentClass::Manifest;
             else
             {
-                info.hasSegNo_ = false;
-                return true;
+                handle.hasSegNo_ = true;
+                handle.segmentClass_ = SegmentClass::Data;
+                handle.segNo_ = name[idx].toSegment();
             }
+            return true;
         }
-        catch (std::runtime_error& e)
+        else
         {
-            return false;
+            handle.hasSegNo_ = false;
+            return true;
         }
     }
 
@@ -380,40 +695,75 @@ bool extractAudioStreamInfo(const ndn::Name& name, NamespaceInfo& info)
 bool
 NameComponents::extractInfo(const ndn::Name& name, NamespaceInfo& info)
 {
-    bool goodName = false;
-    static Name ndnrtcSubName(NameComponents::NameComponentApp);
-    Name subName;
-    int i;
+    NameHandle handle;
 
-    for (i = name.size()-2; i > 0 && !goodName; --i)
+    if (extractHandle(name, handle))
     {
-        subName = name.getSubName(i);
-        goodName = ndnrtcSubName.match(subName);
+        info = handle.getInfo();
+        return true;
     }
 
-    if (goodName)
+    return false;
+}
+
+bool
+NameComponents::extractHandle(const ndn::Name& name, NameHandle& handle, bool intern)
+{
+    static Name::Component app(NameComponents::NameComponentApp);
+    static Name::Component audio(NameComponents::NameComponentAudio);
+    static Name::Component video(NameComponents::NameComponentVideo);
+    int appIdx = -1;
+
+    handle = NameHandle();
+    for (int i = (int)name.size()-2; i > 0 && appIdx < 0; --i)
+        if (name[i] == app) appIdx = i;
+
+    if (appIdx < 0 || !name[appIdx+1].isVersion() || 
+        name.size() <= (size_t)appIdx+2 ||
+        !(name[appIdx+2] == audio || name[appIdx+2] == video))
+        return false;
+
+    NamePositions pos;
+    pos.baseEnd_ = appIdx;
+    pos.hasTimestamp_ = false;
+    handle.apiVersion_ = name[appIdx+1].toVersion();
+    handle.streamType_ = (name[appIdx+2] == audio ? 
+                    MediaStreamParams::MediaStreamType::MediaStreamTypeAudio : 
+                    MediaStreamParams::MediaStreamType::MediaStreamTypeVideo );
+
+    try
     {
-        info.basePrefix_ = name.getSubName(0, i+1);
+        bool res = (handle.streamType_ == MediaStreamParams::MediaStreamType::MediaStreamTypeAudio ?
+            extractAudioStreamInfo(name, appIdx+3, handle, pos) :
+            extractVideoStreamInfo(name, appIdx+3, handle, pos));
+
+        if (!res)
+            return false;
 
-        if ((goodName = subName[1].isVersion()))
+        NameRegistry& registry = NameRegistry::getSharedInstance();
+        handle.streamId_ = (intern ? 
+            registry.internStream(name, pos.streamEnd_, pos.baseEnd_,
+                handle.apiVersion_, handle.streamType_, pos.hasTimestamp_) :
+            registry.findStream(name, pos.streamEnd_));
+        handle.streamKey_ = (handle.streamId_ ? registry.getStream(handle.streamId_).key_ :
+            NameRegistry::streamKey(name, pos.streamEnd_, pos.baseEnd_,
+                handle.apiVersion_, handle.streamType_, pos.hasTimestamp_));
+
+        if (pos.hasTimestamp_)
         {
-            info.apiVersion_ = subName[1].toVersion();
+            const Name::Component& thread = name[pos.threadIdx_];
 
-            if (subName.size() > 2 &&
-                (goodName = (subName[2] == Name::Component(NameComponents::NameComponentAudio) ||
-                            subName[2] == Name::Component(NameComponents::NameComponentVideo)))  )
-            {
-                info.streamType_ = (subName[2] == Name::Component(NameComponents::NameComponentAudio) ? 
-                                MediaStreamParams::MediaStreamType::MediaStreamTypeAudio : 
-                                MediaStreamParams::MediaStreamType::MediaStreamTypeVideo );
-
-                if (info.streamType_ == MediaStreamParams::MediaStreamType::MediaStreamTypeAudio)
-                    return extractAudioStreamInfo(subName.getSubName(3), info);
-                else
-                    return extractVideoStreamInfo(subName.getSubName(3), info);
-            }
+            handle.threadId_ = (intern ? registry.internThread(thread) : registry.findThread(thread));
+            handle.threadKey_ = (handle.threadId_ ? registry.getThread(handle.threadId_).key_ :
+                SampleKey::threadHash(thread.toEscapedString()));
         }
-    }
+        else
+            handle.threadKey_ = SampleKey::threadHash("");
 
-    return false;
+        return true;
+    }
+    catch (std::runtime_error& e)
+    {
+        return false;
+    }
 }
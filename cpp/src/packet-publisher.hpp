@@ -12,14 +12,18 @@
 #include <ndn-cpp/c/common.h>
 #include <ndn-cpp/interest.hpp>
 #include <ndn-cpp/security/key-chain.hpp>
-#include <ndn-cpp/util/memory-content-cache.hpp>
 #include <ndn-cpp/digest-sha256-signature.hpp>
 
 #include <ndn-cpp/key-locator.hpp>
 
+#include "content-store.hpp"
 #include "frame-data.hpp"
 #include "ndnrtc-object.hpp"
 #include "statistics.hpp"
+#include "signing-pool.hpp"
+#include "key-chain-lock.hpp"
+#include "estimators.hpp"
+#include "clock.hpp"
 
 #define ADD_CRC 0
 // this number defines iteration when publisher will
@@ -30,7 +34,6 @@ namespace ndn
 {
 class Face;
 class KeyChain;
-class MemoryContentCache;
 class Name;
 class Interest;
 class InterestFilter;
@@ -53,22 +56,45 @@ typedef NetworkDataT<Mutable> MutableNetworkData;
 typedef std::vector<std::shared_ptr<const ndn::Data>> PublishedDataPtrVector;
 typedef std::function<void(PublishedDataPtrVector)> OnSegmentsCached;
 
-template <typename KeyChain, typename MemoryCache>
+template <typename KeyChain, typename Store>
 struct _PublisherSettings
 {
-    _PublisherSettings() : keyChain_(nullptr), memoryCache_(nullptr),
-                           statStorage_(nullptr) {}
+    typedef typename Store::PendingInterest PendingInterest;
+
+    _PublisherSettings() : keyChain_(nullptr), contentStore_(nullptr),
+                           statStorage_(nullptr), signingPool_(nullptr),
+                           signDelayIndicator_(statistics::Indicator::SignDelay) {}
 
     KeyChain *keyChain_;
-    MemoryCache *memoryCache_;
+    Store *contentStore_;
     statistics::StatisticsStorage *statStorage_;
+    // if set, segments of each published packet are signed as one batch
+    // on this pool, otherwise - one by one on the publishing thread
+    SigningPoolT<KeyChain> *signingPool_;
+    // indicator for average batch signing delay
+    statistics::Indicator signDelayIndicator_;
     OnSegmentsCached onSegmentsCached_;
     size_t segmentWireLength_;
     unsigned int freshnessPeriodMs_;
     bool sign_ = true;
 };
 
-typedef _PublisherSettings<ndn::KeyChain, ndn::MemoryContentCache> PublisherSettings;
+typedef _PublisherSettings<ndn::KeyChain, ContentStore> PublisherSettings;
+
+// Interests found pending for segments of the most recently published packet
+typedef struct _PitStats
+{
+    unsigned int nSegments_ = 0;
+    // segments that had at least one Interest pending
+    unsigned int nHits_ = 0;
+    unsigned int nInterests_ = 0;
+    // Interests marked by consumers as retransmissions (see
+    // NameComponents::retransmission); Interests of other consumers pending
+    // for the same segment are not counted
+    unsigned int nRetransmissions_ = 0;
+
+    unsigned int getRetransmissionsNum() const { return nRetransmissions_; }
+} PitStats;
 
 template <typename SegmentType, typename Settings>
 class PacketPublisher : public NdnRtcComponent
@@ -77,7 +103,7 @@ class PacketPublisher : public NdnRtcComponent
     PacketPublisher(const Settings &settings) : settings_(settings), fullPitClean_(0)
     {
         assert(settings_.keyChain_);
-        assert(settings_.memoryCache_);
+        assert(settings_.contentStore_);
         assert(settings_.statStorage_);
     }
 
@@ -97,7 +123,7 @@ class PacketPublisher : public NdnRtcComponent
                                    _DataSegmentHeader &commonHeader, int freshnessMs,
                                    bool forcePitClean = false, bool banPitClean = false)
     {
-        PublishedDataPtrVector ndnSegments;
+        std::vector<std::shared_ptr<ndn::Data>> ndnSegments;
         std::vector<SegmentType> segments = SegmentType::slice(data, settings_.segmentWireLength_);
         LogTraceC << "sliced into " << segments.size() << " segments" << std::endl;
 
@@ -107,8 +133,10 @@ class PacketPublisher : public NdnRtcComponent
 
         unsigned int segIdx = 0;
         freshnessMs = (freshnessMs == -1 ? settings_.freshnessPeriodMs_ : freshnessMs);
+        pitStats_ = PitStats();
+        pitStats_.nSegments_ = segments.size();
 
-        for (auto segment : segments)
+        for (auto &segment : segments)
         {
             ndn::Name segmentName(name);
             segmentName.appendSegment(segIdx);
@@ -119,20 +147,31 @@ class PacketPublisher : public NdnRtcComponent
             checkForPendingInterests(segmentName, commonHeader);
             segment.setHeader(commonHeader);
 
-            std::shared_ptr<MutableNetworkData> segmentData = segment.getNetworkData();
+            // segment is written once, straight into the buffer which
+            // becomes data content without being copied
+            std::shared_ptr<std::vector<uint8_t>> segmentWire =
+                std::make_shared<std::vector<uint8_t>>(segment.size());
+            segment.writeWire(segmentWire->data());
+
             std::shared_ptr<ndn::Data> ndnSegment(std::make_shared<ndn::Data>(segmentName));
             ndnSegment->getMetaInfo().setFreshnessPeriod(freshnessMs);
             ndnSegment->getMetaInfo().setFinalBlockId(ndn::Name::Component::fromSegment(segments.size() - 1));
-            ndnSegment->setContent(segmentData->getData(), segment.size());
-            sign(ndnSegment);
-            settings_.memoryCache_->add(*ndnSegment);
+            ndnSegment->setContent(ndn::Blob(segmentWire, false));
             ++segIdx;
             ndnSegments.push_back(ndnSegment);
+        }
+
+        // all segments are signed at once, before any of them is cached
+        sign(ndnSegments);
+
+        for (auto &ndnSegment : ndnSegments)
+        {
+            settings_.contentStore_->add(*ndnSegment);
 
             (*settings_.statStorage_)[statistics::Indicator::BytesPublished] += ndnSegment->getContent().size();
             (*settings_.statStorage_)[statistics::Indicator::RawBytesPublished] += ndnSegment->getDefaultWireEncoding().size();
 
-            LogTraceC << "cached " << segmentName << " ("
+            LogTraceC << "cached " << ndnSegment->getName() << " ("
                       << ndnSegment->getContent().size() << "b payload, "
                       << ndnSegment->getDefaultWireEncoding().size() << "b wire, "
                       << ndnSegment->getMetaInfo().getFreshnessPeriod() << "ms fp)"
@@ -143,21 +182,32 @@ class PacketPublisher : public NdnRtcComponent
             cleanPit(name, forcePitClean);
 
         (*settings_.statStorage_)[statistics::Indicator::PublishedSegmentsNum] += segments.size();
-        
+
+        PublishedDataPtrVector publishedSegments(ndnSegments.begin(), ndnSegments.end());
         if (settings_.onSegmentsCached_) 
-            settings_.onSegmentsCached_(ndnSegments);
+            settings_.onSegmentsCached_(publishedSegments);
 
-        return ndnSegments;
+        return publishedSegments;
     }
 
+    /**
+     * Returns statistics of pending Interests for the last call to publish().
+     * Must be called on the same thread as publish().
+     */
+    const PitStats &getLastPitStats() const { return pitStats_; }
+
   private:
+    typedef std::vector<std::shared_ptr<const typename Settings::PendingInterest>> PendingInterests;
+
     Settings settings_;
     unsigned int fullPitClean_;
+    estimators::Filter signDelay_;
+    PitStats pitStats_;
 
     void checkForPendingInterests(const ndn::Name &name, _DataSegmentHeader &commonHeader)
     {
-        std::vector<std::shared_ptr<const ndn::MemoryContentCache::PendingInterest>> pendingInterests;
-        settings_.memoryCache_->getPendingInterestsForName(name, pendingInterests);
+        PendingInterests pendingInterests;
+        settings_.contentStore_->getPendingInterestsForName(name, pendingInterests);
 
         if (pendingInterests.size())
         {
@@ -166,26 +216,55 @@ class PacketPublisher : public NdnRtcComponent
             commonHeader.generationDelayMs_ = ndn_getNowMilliseconds() - pendingInterests.back()->getTimeoutPeriodStart();
 
             (*settings_.statStorage_)[statistics::Indicator::InterestsReceivedNum] += pendingInterests.size();
+            pitStats_.nHits_++;
+            pitStats_.nInterests_ += pendingInterests.size();
+            for (auto &pi : pendingInterests)
+                if (NameComponents::isRetransmission(*pi->getInterest()))
+                    pitStats_.nRetransmissions_++;
 
             LogTraceC << "PIT hit " << pendingInterests.back()->getInterest()->toUri() << std::endl;
         }
     }
 
-    void sign(std::shared_ptr<ndn::Data> segment)
+    void sign(const std::vector<std::shared_ptr<ndn::Data>> &segments)
     {
         if (settings_.sign_)
         {
-            settings_.keyChain_->sign(*segment);
-            (*settings_.statStorage_)[statistics::Indicator::SignNum]++;
+            int64_t signStartUsec = clock::microsecondTimestamp();
+            {
+                // key chain may be shared with other streams
+                std::shared_ptr<boost::recursive_mutex> keyChainLock = keyChainMutex(settings_.keyChain_);
+                boost::lock_guard<boost::recursive_mutex> scopedLock(*keyChainLock);
+
+                if (settings_.signingPool_ && segments.size() > 1)
+                    settings_.signingPool_->sign(*settings_.keyChain_, segments);
+                else
+                    for (auto &segment : segments)
+                        settings_.keyChain_->sign(*segment);
+            }
+
+            double batchMs = (double)(clock::microsecondTimestamp() - signStartUsec) / 1000.;
+            signDelay_.newValue(batchMs);
+
+            (*settings_.statStorage_)[statistics::Indicator::SignNum] += segments.size();
+            (*settings_.statStorage_)[settings_.signDelayIndicator_] = signDelay_.value();
+
+            LogTraceC << "signed batch of " << segments.size() << " in " << batchMs << "ms" << std::endl;
         }
         else
         {
+            // segments get (dummy) digest signatures - authenticity is
+            // provided by signed manifests, carrying segments' implicit digests
             static uint8_t digest[ndn_SHA256_DIGEST_SIZE];
             memset(digest, 0, ndn_SHA256_DIGEST_SIZE);
             ndn::Blob signatureBits(digest, sizeof(digest));
-            segment->setSignature(ndn::DigestSha256Signature());
-            ndn::DigestSha256Signature *sha256Signature = (ndn::DigestSha256Signature *)segment->getSignature();
-            sha256Signature->setSignature(signatureBits);
+
+            for (auto &segment : segments)
+            {
+                segment->setSignature(ndn::DigestSha256Signature());
+                ndn::DigestSha256Signature *sha256Signature = (ndn::DigestSha256Signature *)segment->getSignature();
+                sha256Signature->setSignature(signatureBits);
+            }
         }
     }
 
@@ -194,8 +273,8 @@ class PacketPublisher : public NdnRtcComponent
      */
     void cleanPit(const ndn::Name &name, bool forceFullPitClean = false)
     {
-        std::vector<std::shared_ptr<const ndn::MemoryContentCache::PendingInterest>> pendingInterests;
-        settings_.memoryCache_->getPendingInterestsWithPrefix(name, pendingInterests);
+        PendingInterests pendingInterests;
+        settings_.contentStore_->getPendingInterestsWithPrefix(name, pendingInterests);
 
         if (pendingInterests.size())
         {
@@ -220,9 +299,9 @@ class PacketPublisher : public NdnRtcComponent
 
     void deepCleanPit(const ndn::Name &name)
     {
-        NamespaceInfo info;
+        NameHandle info;
 
-        if (!NameComponents::extractInfo(name, info))
+        if (!NameComponents::extractHandle(name, info))
         {
             LogErrorC << "can't extract info from " << name << std::endl;
             return;
@@ -231,18 +310,19 @@ class PacketPublisher : public NdnRtcComponent
         if (info.isMeta_)
             return;
 
-        std::vector<std::shared_ptr<const ndn::MemoryContentCache::PendingInterest>> pendingInterests;
+        PendingInterests pendingInterests;
 
         // extract all pending interests for this stream
-        settings_.memoryCache_->getPendingInterestsWithPrefix(info.getPrefix(prefix_filter::Stream), pendingInterests);
+        settings_.contentStore_->getPendingInterestsWithPrefix(info.getPrefix(prefix_filter::Stream), pendingInterests);
 
         if (pendingInterests.size())
         {
             for (auto pi : pendingInterests)
             {
-                NamespaceInfo piInfo;
+                NameHandle piInfo;
 
-                if (NameComponents::extractInfo(pi->getInterest()->getName(), piInfo))
+                // Interest names come from network and are not interned
+                if (NameComponents::extractHandle(pi->getInterest()->getName(), piInfo, false))
                 {
                     // we are interested in older interests (those that request data that has already been published)
                     // this is needed to respond with NACKs, when consumer runs slightly behind producer
@@ -265,7 +345,7 @@ class PacketPublisher : public NdnRtcComponent
         nack->getMetaInfo().setFreshnessPeriod(settings_.freshnessPeriodMs_);
         nack->setContent((const uint8_t *)"nack", 4);
         nack->getMetaInfo().setType(ndn_ContentType_NACK);
-        settings_.memoryCache_->add(*nack);
+        settings_.contentStore_->add(*nack);
     }
 };
 
@@ -0,0 +1,41 @@
+//
+// parity-control.cpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include "parity-control.hpp"
+
+#include <algorithm>
+
+using namespace ndnrtc;
+
+ParityControl::ParityControl(const ParityControlSettings &settings)
+    : settings_(settings),
+      delta_(settings.initialRatio_),
+      key_(settings.initialRatio_)
+{
+}
+
+void ParityControl::interestsReceived(bool isKey, unsigned int nInterests,
+                                      unsigned int nRetransmissions)
+{
+    if (nInterests == 0)
+        return;
+
+    ClassState &s = (isKey ? key_ : delta_);
+    double share = std::min(1., (double)nRetransmissions / (double)nInterests);
+    double loss = (s.nObservations_ ? s.loss_ + (share - s.loss_) * settings_.smoothing_ : share);
+
+    s.loss_ = loss;
+    if (++s.nObservations_ < settings_.minObservations_)
+        return;
+
+    double protection = (isKey ? settings_.keyProtection_ : settings_.deltaProtection_);
+    double minRatio = (isKey ? settings_.minKeyRatio_ : settings_.minDeltaRatio_);
+    double maxRatio = (isKey ? settings_.maxKeyRatio_ : settings_.maxDeltaRatio_);
+    double ratio = (loss < 1. ? protection * loss / (1. - loss) : maxRatio);
+
+    s.ratio_ = std::max(minRatio, std::min(maxRatio, ratio));
+}
@@ -0,0 +1,80 @@
+//
+// parity-control.hpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#ifndef __parity_control_h__
+#define __parity_control_h__
+
+#include <atomic>
+
+namespace ndnrtc
+{
+
+typedef struct _ParityControlSettings
+{
+    // ratio used until loss estimation is available
+    double initialRatio_ = 0.2;
+    // ratio bounds for delta and key frames
+    double minDeltaRatio_ = 0., maxDeltaRatio_ = 0.5;
+    double minKeyRatio_ = 0.1, maxKeyRatio_ = 1.;
+    // how many times expected losses are over-provisioned with parity
+    double deltaProtection_ = 1.5, keyProtection_ = 3.;
+    // loss estimation smoothing factor
+    double smoothing_ = 1. / 16.;
+    // number of observations needed before ratio starts to follow
+    // loss estimation
+    unsigned int minObservations_ = 10;
+} ParityControlSettings;
+
+/**
+ * ParityControl chooses FEC parity ratio for frames of one thread, separately
+ * for key and delta frames, based on loss hints observed by the producer.
+ * The hint is the share of Interests marked by consumers as retransmissions
+ * (see NameComponents::retransmission) among Interests received for frame
+ * segments: those pending at the time of publishing and those answered from
+ * content store since previous frame of the same class was published. The
+ * latter carry retransmissions of data lost after it was published. For a
+ * loss estimate p, the ratio is protection * p / (1 - p), i.e. parity
+ * segments cover expected losses several times over, bounded by min/max
+ * ratios of the frame class.
+ * Loss hints are given on the publishing thread, while ratio can be read
+ * from any thread.
+ */
+class ParityControl
+{
+  public:
+    ParityControl(const ParityControlSettings &settings = ParityControlSettings());
+
+    /**
+     * Updates loss estimation with Interests received for a published frame.
+     * @param isKey Whether frame is key or delta
+     * @param nInterests Total number of Interests received for segments of
+     *        frame class (pending and answered from content store)
+     * @param nRetransmissions Number of Interests marked by consumers as
+     *        retransmissions
+     */
+    void interestsReceived(bool isKey, unsigned int nInterests, unsigned int nRetransmissions);
+
+    double getRatio(bool isKey) const { return (isKey ? key_ : delta_).ratio_; }
+    double getLossEstimate(bool isKey) const { return (isKey ? key_ : delta_).loss_; }
+
+  private:
+    ParityControl(const ParityControl &) = delete;
+
+    struct ClassState
+    {
+        ClassState(double ratio) : ratio_(ratio), loss_(0), nObservations_(0) {}
+
+        std::atomic<double> ratio_, loss_;
+        unsigned int nObservations_;
+    };
+
+    ParityControlSettings settings_;
+    ClassState delta_, key_;
+};
+}
+
+#endif
@@ -89,9 +89,9 @@ void FrameFetchingTask::requestSegment(const std::shared_ptr<const Interest>& in
         {
             if (data->getMetaInfo().getType() != ndn_ContentType_NACK)
             {
-                NamespaceInfo info;
-                NameComponents::extractInfo(data->getName(), info);
-                std::shared_ptr<WireSegment> segment = WireSegment::createSegment(info, data, interest);
+                NameHandle handle;
+                NameComponents::extractHandle(data->getName(), handle);
+                std::shared_ptr<WireSegment> segment = WireSegment::createSegment(handle, data, interest);
                 BufferSlot::State s = slot_->getState();
                 std::shared_ptr<SlotSegment> seg = slot_->segmentReceived(segment);
                 taskProgress_ += (settings_.nRtx_+1) - seg->getRequestNum();
@@ -212,9 +212,72 @@ FetchMethodLocal::express(const std::shared_ptr<const ndn::Interest>& interest,
                           ndn::OnTimeout,
                           ndn::OnNetworkNack onNack)
 {
-    std::shared_ptr<Data> data = storage_->get(interest->getName());
+    std::shared_ptr<Data> data;
+    auto it = prefetched_.find(interest->getName());
+
+    if (it != prefetched_.end())
+        data = it->second;
+    else if (prefetchedFrames_.empty())
+        data = storage_->get(interest->getName());
+    else
+    {
+        // segments of prefetched frames that were not retrieved 
+        // are not in the storage
+        NamespaceInfo info;
+        if (!NameComponents::extractInfo(interest->getName(), info) ||
+            prefetchedFrames_.find(info.getPrefix(prefix_filter::Sample)) == prefetchedFrames_.end())
+            data = storage_->get(interest->getName());
+    }
+
     if (data.get())
         onData(interest, data);
     else
         onNack(interest, std::make_shared<NetworkNack>());
 }
+
+size_t
+FetchMethodLocal::prefetch(const std::vector<ndn::Name>& frameNames)
+{
+    std::vector<Name> names;
+    for (auto& n:frameNames)
+        names.push_back(Name(n).appendSegment(0));
+
+    std::vector<std::shared_ptr<Data>> segments = storage_->get(names);
+    size_t nFrames = 0;
+    names.clear();
+
+    for (size_t i = 0; i < frameNames.size(); ++i)
+    {
+        if (!segments[i].get())
+            continue;
+
+        ImmutableHeaderPacket<VideoFrameSegmentHeader> segment(segments[i]->getContent());
+        if (!segment.isValid())
+            continue;
+
+        prefetched_[segments[i]->getName()] = segments[i];
+        prefetchedFrames_.insert(frameNames[i]);
+        nFrames++;
+
+        const VideoFrameSegmentHeader& header = segment.getHeader();
+        for (int segNo = 1; segNo < header.totalSegmentsNum_; ++segNo)
+            names.push_back(Name(frameNames[i]).appendSegment(segNo));
+        for (int segNo = 0; segNo < header.paritySegmentsNum_; ++segNo)
+            names.push_back(Name(frameNames[i]).append(NameComponents::NameComponentParity)
+                                               .appendSegment(segNo));
+    }
+
+    segments = storage_->get(names);
+    for (size_t i = 0; i < names.size(); ++i)
+        if (segments[i].get())
+            prefetched_[names[i]] = segments[i];
+
+    return nFrames;
+}
+
+void
+FetchMethodLocal::clear()
+{
+    prefetched_.clear();
+    prefetchedFrames_.clear();
+}
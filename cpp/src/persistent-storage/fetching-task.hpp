@@ -8,6 +8,8 @@
 #ifndef __fetching_task_hpp__
 #define __fetching_task_hpp__
 
+#include <map>
+#include <set>
 #include <boost/shared_ptr.hpp>
 #include <boost/enable_shared_from_this.hpp>
 #include <ndn-cpp/name.hpp>
@@ -116,6 +118,11 @@ namespace ndnrtc {
                              ndn::OnNetworkNack) = 0;
     };
 
+    /**
+     * Retrieves data from local persistent storage. Segments of several 
+     * frames can be prefetched in batches (see prefetch()), after that 
+     * interests for these frames are answered from memory.
+     */
     class FetchMethodLocal : public IFetchMethod {
     public:
         FetchMethodLocal(const std::shared_ptr<StorageEngine>& storage) : storage_(storage) {}
@@ -126,8 +133,26 @@ namespace ndnrtc {
                              ndn::OnTimeout,
                              ndn::OnNetworkNack) override;
 
+        /**
+         * Retrieves all data and parity segments of given video frames from
+         * the storage. Segments are retrieved in two batches: segments #0 of
+         * all frames first and, once number of segments of each frame is 
+         * known from the headers, the rest of the segments.
+         * @param frameNames Frame names (without segment components)
+         * @return Number of frames found in the storage
+         */
+        size_t prefetch(const std::vector<ndn::Name>& frameNames);
+
+        /**
+         * Releases prefetched data.
+         */
+        void clear();
+
     private:
         std::shared_ptr<StorageEngine> storage_;
+        std::map<ndn::Name, std::shared_ptr<ndn::Data>> prefetched_;
+        // frames for which all segments were prefetched
+        std::set<ndn::Name> prefetchedFrames_;
     };
 
     class FetchMethodRemote : public IFetchMethod {
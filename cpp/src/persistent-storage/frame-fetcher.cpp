@@ -6,6 +6,10 @@
 //
 
 #include "frame-fetcher.hpp"
+
+#include <list>
+#include <boost/thread/mutex.hpp>
+
 #include "storage-engine.hpp"
 #include "persistent-storage/fetching-task.hpp"
 #include "frame-data.hpp"
@@ -18,11 +22,170 @@ using namespace ndnrtc;
 using namespace ndn;
 
 namespace ndnrtc {
+    /**
+     * Map which evicts least recently used entries once its' capacity is 
+     * exceeded.
+     */
+    template<typename Key, typename Value>
+    class LruMap {
+    public:
+        LruMap(size_t capacity):capacity_(capacity){}
+
+        bool get(const Key& key, Value& value)
+        {
+            auto it = index_.find(key);
+            if (it == index_.end())
+                return false;
+
+            entries_.splice(entries_.begin(), entries_, it->second);
+            value = it->second->second;
+            return true;
+        }
+
+        bool take(const Key& key, Value& value)
+        {
+            auto it = index_.find(key);
+            if (it == index_.end())
+                return false;
+
+            value = it->second->second;
+            entries_.erase(it->second);
+            index_.erase(it);
+            return true;
+        }
+
+        void put(const Key& key, const Value& value)
+        {
+            auto it = index_.find(key);
+            if (it != index_.end())
+            {
+                it->second->second = value;
+                entries_.splice(entries_.begin(), entries_, it->second);
+                return;
+            }
+
+            entries_.push_front(std::make_pair(key, value));
+            index_[key] = entries_.begin();
+
+            while (entries_.size() > capacity_)
+            {
+                index_.erase(entries_.back().first);
+                entries_.pop_back();
+            }
+        }
+
+        size_t size() const { return entries_.size(); }
+
+    private:
+        typedef std::list<std::pair<Key, Value>> Entries;
+
+        size_t capacity_;
+        Entries entries_;
+        std::map<Key, typename Entries::iterator> index_;
+    };
+
+    typedef struct _DecodedFrame {
+        FrameInfo info_;
+        std::shared_ptr<WebRtcVideoFrame> frame_;
+    } DecodedFrame;
+
+    /**
+     * Decoder of a GOP. Keeps decoder state after decoding a frame, so that 
+     * decoding can be continued from the next delta frame of the GOP.
+     */
+    class GopDecoder {
+    public:
+        GopDecoder(const VideoCoderParams& params, PacketNumber keyNo, 
+                   PacketNumber nextDeltaNo):
+            keyNo_(keyNo), nextDeltaNo_(nextDeltaNo),
+            decoder_(std::make_shared<VideoDecoder>(params,
+                [this](const FrameInfo& fi, const WebRtcVideoFrame& f){
+                    decoded_.info_ = fi;
+                    // frame buffer is ref-counted, decoder won't reuse it
+                    // while the frame is kept
+                    decoded_.frame_ = std::make_shared<WebRtcVideoFrame>(f);
+                })) {}
+
+        bool decode(const FrameInfo& fi, const webrtc::EncodedImage& image, 
+                    DecodedFrame& decoded)
+        {
+            decoded_.frame_.reset();
+            decoder_->processFrame(fi, image);
+            decoded = decoded_;
+
+            return (bool)decoded.frame_;
+        }
+
+        PacketNumber getKeyNo() const { return keyNo_; }
+        PacketNumber getNextDeltaNo() const { return nextDeltaNo_; }
+        void setNextDeltaNo(PacketNumber deltaNo) { nextDeltaNo_ = deltaNo; }
+
+    private:
+        GopDecoder(const GopDecoder&) = delete;
+
+        PacketNumber keyNo_, nextDeltaNo_;
+        DecodedFrame decoded_;
+        std::shared_ptr<VideoDecoder> decoder_;
+    };
+
+    class FrameFetcherCacheImpl {
+    public:
+        FrameFetcherCacheImpl(size_t maxFrames, size_t maxGops):
+            frames_(maxFrames), gops_(maxGops){}
+
+        bool getFrame(const ndn::Name& frameName, DecodedFrame& frame)
+        {
+            boost::lock_guard<boost::mutex> scopedLock(mutex_);
+            return frames_.get(frameName, frame);
+        }
+
+        void addFrame(const ndn::Name& frameName, const DecodedFrame& frame)
+        {
+            boost::lock_guard<boost::mutex> scopedLock(mutex_);
+            frames_.put(frameName, frame);
+        }
+
+        // decoder is taken out of the cache while it's being used, 
+        // thus it is never shared by several fetchers
+        std::shared_ptr<GopDecoder> takeDecoder(const ndn::Name& keyFrameName)
+        {
+            boost::lock_guard<boost::mutex> scopedLock(mutex_);
+            std::shared_ptr<GopDecoder> decoder;
+            gops_.take(keyFrameName, decoder);
+            return decoder;
+        }
+
+        void returnDecoder(const ndn::Name& keyFrameName, 
+                           const std::shared_ptr<GopDecoder>& decoder)
+        {
+            boost::lock_guard<boost::mutex> scopedLock(mutex_);
+            gops_.put(keyFrameName, decoder);
+        }
+
+        size_t getFramesNum() const 
+        {
+            boost::lock_guard<boost::mutex> scopedLock(mutex_);
+            return frames_.size();
+        }
+
+        size_t getGopsNum() const 
+        {
+            boost::lock_guard<boost::mutex> scopedLock(mutex_);
+            return gops_.size();
+        }
+
+    private:
+        mutable boost::mutex mutex_;
+        LruMap<ndn::Name, DecodedFrame> frames_;
+        LruMap<ndn::Name, std::shared_ptr<GopDecoder>> gops_;
+    };
+
     class FrameFetcherImpl : public IFrameFetcher,
                              public ndnlog::new_api::ILoggingObject,
                              public std::enable_shared_from_this<FrameFetcherImpl> {
     public:
-        FrameFetcherImpl(const std::shared_ptr<StorageEngine>& storage);
+        FrameFetcherImpl(const std::shared_ptr<StorageEngine>& storage,
+                         const std::shared_ptr<FrameFetcherCache>& cache);
         ~FrameFetcherImpl(){ reset(); }
 
         void fetch(const ndn::Name& frameName, 
@@ -41,20 +204,32 @@ namespace ndnrtc {
         FetchingTask::Settings fetchSettings_;
 
         std::shared_ptr<StorageEngine> storage_;
+        std::shared_ptr<FrameFetcherCacheImpl> cache_;
         NamespaceInfo frameNameInfo_;
         OnBufferAllocate onBufferAllocate_;
         OnFrameFetched onFrameFetched_;
         OnFetchFailure onFetchFailure_;
 
-        std::shared_ptr<IFetchMethod> fetchMethod_;
+        std::shared_ptr<FetchMethodLocal> fetchMethod_;
         std::map<ndn::Name, std::shared_ptr<FrameFetchingTask>> fetchingTasks_;
         std::shared_ptr<FrameFetchingTask> keyFrameTask_, targetFrameTask_;
-        std::map<ndn::Name, std::shared_ptr<FrameFetchingTask>> deltasTasks_;
-
+        std::map<PacketNumber, std::shared_ptr<FrameFetchingTask>> deltasTasks_;
+        PacketNumber keyNo_;
+        ndn::Name keyFrameName_;
+        std::shared_ptr<GopDecoder> gopDecoder_;
+
+        void fetchGop(PacketNumber keyNo, PacketNumber firstDeltaNo);
+        bool isTargetInGop(PacketNumber keyNo);
+        void fetchTarget();
         void fetchGopKey(const std::shared_ptr<const SlotSegment>& deltaSegment);
         void fetchGopDelta(const std::shared_ptr<const SlotSegment>& segment);
+        std::shared_ptr<FrameFetchingTask> makeTask(const ndn::Name& frameName, 
+                                                      OnSegment onFirstSegment = OnSegment());
+        void setKeyFrame(PacketNumber keyNo);
         void checkReadyDecode();
         void decode();
+        bool decodeFrame(const std::shared_ptr<const BufferSlot>& slot, DecodedFrame& decoded);
+        void deliver(const DecodedFrame& decoded, int nFetched);
         void reset();
         void halt(std::string reason);
         VideoCoderParams setupDecoderParams(const std::shared_ptr<ImmutableVideoFramePacket>&) const;
@@ -62,8 +237,25 @@ namespace ndnrtc {
 }
 
 //******************************************************************************
-FrameFetcher::FrameFetcher(const std::shared_ptr<StorageEngine>& storage):
-    pimpl_(std::make_shared<FrameFetcherImpl>(storage)){}
+FrameFetcherCache::FrameFetcherCache(size_t maxFrames, size_t maxGops):
+    pimpl_(std::make_shared<FrameFetcherCacheImpl>(maxFrames, maxGops)){}
+
+size_t
+FrameFetcherCache::getFramesNum() const
+{
+    return pimpl_->getFramesNum();
+}
+
+size_t
+FrameFetcherCache::getGopsNum() const
+{
+    return pimpl_->getGopsNum();
+}
+
+//******************************************************************************
+FrameFetcher::FrameFetcher(const std::shared_ptr<StorageEngine>& storage,
+                           const std::shared_ptr<FrameFetcherCache>& cache):
+    pimpl_(std::make_shared<FrameFetcherImpl>(storage, cache)){}
 
 void
 FrameFetcher::fetch(const ndn::Name& frameName, 
@@ -93,10 +285,13 @@ FrameFetcher::setLogger(std::shared_ptr<ndnlog::new_api::Logger> logger)
 }
 
 //******************************************************************************
-FrameFetcherImpl::FrameFetcherImpl(const std::shared_ptr<StorageEngine>& storage)
+FrameFetcherImpl::FrameFetcherImpl(const std::shared_ptr<StorageEngine>& storage,
+                                   const std::shared_ptr<FrameFetcherCache>& cache)
     : storage_(storage), 
+      cache_(cache ? cache->pimpl_ : FrameFetcherCache().pimpl_),
       state_(FrameFetcher::Idle), 
-      fetchSettings_({3,1000})
+      fetchSettings_({3,1000}),
+      keyNo_(0)
 {
     fetchMethod_ = std::make_shared<FetchMethodLocal>(storage_);
     description_ = "frame-fetcher";
@@ -119,76 +314,127 @@ FrameFetcherImpl::fetch(const ndn::Name& frameName,
         onFetchFailure_ = onFetchFailure;
         state_ = FrameFetcher::Fetching;
 
-        if (!frameNameInfo_.isDelta_) // if it's a key frame - all is easy, just fetch it and decode
+        DecodedFrame decoded;
+        PacketNumber keyNo, firstDeltaNo;
+
+        if (cache_->getFrame(frameNameInfo_.getPrefix(prefix_filter::Sample), decoded))
         {
-            std::shared_ptr<FrameFetcherImpl> self = shared_from_this();
-            std::shared_ptr<FrameFetchingTask> task 
-                = std::make_shared<FrameFetchingTask>(
-                    frameName,
-                    fetchMethod_,
-                    [self, this](const std::shared_ptr<const FetchingTask>& task, 
-                       const std::shared_ptr<const BufferSlot>& slot)
-                    {
-                        LogInfoC << "target frame fetched" << std::endl;
-                        checkReadyDecode();
-                    },
-                    [self, this](const std::shared_ptr<const FetchingTask>& task,
-                      std::string reason)
-                    {
-                        LogErrorC << "failed to fetch target frame: " << reason << std::endl;
-                        halt(reason);
-                    },
-                    fetchSettings_);
-
-            LogInfoC << "initiating fetching for target frame " << frameName << std::endl;
-
-            targetFrameTask_ = task;
-            keyFrameTask_ = task;
-            fetchingTasks_[frameName] = task;
-
-            task->setLogger(getLogger());
-            task->start();
+            LogInfoC << "target frame found in cache" << std::endl;
+
+            state_ = FrameFetcher::Decoding;
+            deliver(decoded, 0);
         }
+        else if (!frameNameInfo_.isDelta_) // if it's a key frame - all is easy, just fetch it and decode
+            fetchGop(frameNameInfo_.sampleNo_, 0);
+        else if (storage_->getGop(frameNameInfo_.getPrefix(prefix_filter::ThreadNT),
+                                  frameNameInfo_.sampleNo_, keyNo, firstDeltaNo) &&
+                 isTargetInGop(keyNo))
+            fetchGop(keyNo, firstDeltaNo);
         else
+            // GOP is not in the index (or target's GOP key frame was not
+            // recorded and index yields previous GOP) - figure out Key
+            // frame # from the target frame first
+            fetchTarget();
+    }
+    else
+        throw std::runtime_error("Bad frame name provided");
+}
+
+void
+FrameFetcherImpl::fetchGop(PacketNumber keyNo, PacketNumber firstDeltaNo)
+{
+    std::vector<Name> frames;
+    setKeyFrame(keyNo);
+
+    if (frameNameInfo_.isDelta_)
+    {
+        gopDecoder_ = cache_->takeDecoder(keyFrameName_);
+
+        // decoder may continue only if it hasn't passed target frame yet
+        if (gopDecoder_ && gopDecoder_->getNextDeltaNo() <= frameNameInfo_.sampleNo_)
         {
-            // spawn fetching target frame
-            std::shared_ptr<FrameFetcherImpl> self = shared_from_this();
-            std::shared_ptr<FrameFetchingTask> task 
-                = std::make_shared<FrameFetchingTask>(
-                    frameName,
-                    fetchMethod_,
-                    [self, this](const std::shared_ptr<const FetchingTask>& task, 
-                       const std::shared_ptr<const BufferSlot>& slot)
-                    {
-                        LogInfoC << "target frame fetched" << std::endl;
-                        checkReadyDecode();
-                    },
-                    [self, this](const std::shared_ptr<const FetchingTask>& task,
-                      std::string reason)
-                    {
-                        LogErrorC << "failed to fetch target frame: " << reason << std::endl;
-                        halt(reason);
-                    },
-                    fetchSettings_,
-                    [self, this](const std::shared_ptr<const FetchingTask>& task,
-                              const std::shared_ptr<const SlotSegment>& segment)
-                    {
-                        // on first segment
-                        // figure out Key frame # and request it here
-                        fetchGopKey(segment);
-                    });
-
-            LogInfoC << "initiating fetching for target frame " << frameName << std::endl;
-
-            targetFrameTask_ = task;
-            fetchingTasks_[frameName] = task;
-
-            task->setLogger(getLogger());
-            task->start();
+            firstDeltaNo = gopDecoder_->getNextDeltaNo();
+            LogInfoC << "will continue decoding GOP " << keyNo 
+                     << " from delta " << firstDeltaNo << std::endl;
         }
+        else
+        {
+            gopDecoder_.reset();
+            keyFrameTask_ = makeTask(keyFrameName_);
+            frames.push_back(keyFrameName_);
+        }
+
+        Name prefix(frameNameInfo_.getPrefix(prefix_filter::Thread));
+        for (PacketNumber deltaSeqNo = firstDeltaNo; 
+             deltaSeqNo <= frameNameInfo_.sampleNo_; 
+             ++deltaSeqNo)
+        {
+            Name deltaFrameName(prefix);
+            deltaFrameName.appendSequenceNumber(deltaSeqNo);
+
+            deltasTasks_[deltaSeqNo] = makeTask(deltaFrameName);
+            frames.push_back(deltaFrameName);
+        }
+
+        targetFrameTask_ = deltasTasks_[frameNameInfo_.sampleNo_];
     }
     else
-        throw std::runtime_error("Bad frame name provided");
+    {
+        keyFrameTask_ = makeTask(keyFrameName_);
+        targetFrameTask_ = keyFrameTask_;
+        frames.push_back(keyFrameName_);
+    }
+
+    size_t nPrefetched = fetchMethod_->prefetch(frames);
+    LogInfoC << "prefetched " << nPrefetched << "/" << frames.size() 
+             << " frames of GOP " << keyNo << std::endl;
+
+    // decoding starts once all tasks are completed, thus tasks are
+    // created before any of them is started
+    std::vector<std::shared_ptr<FrameFetchingTask>> tasks;
+    for (auto t:fetchingTasks_)
+        tasks.push_back(t.second);
+
+    for (auto t:tasks)
+        if (state_ == FrameFetcher::Fetching)
+            t->start();
+}
+
+bool
+FrameFetcherImpl::isTargetInGop(PacketNumber keyNo)
+{
+    std::shared_ptr<Data> d = storage_->get(Name(frameNameInfo_.getPrefix(prefix_filter::Sample)).appendSegment(0));
+
+    if (d)
+    {
+        ImmutableHeaderPacket<VideoFrameSegmentHeader> segment(d->getContent());
+        if (segment.isValid() && segment.getHeader().pairedSequenceNo_ == keyNo)
+            return true;
+    }
+
+    LogWarnC << "GOP index doesn't match target frame "
+             << frameNameInfo_.getPrefix(prefix_filter::Sample) << std::endl;
+    return false;
+}
+
+void
+FrameFetcherImpl::fetchTarget()
+{
+    std::shared_ptr<FrameFetcherImpl> self = shared_from_this();
+    std::shared_ptr<FrameFetchingTask> task = makeTask(frameNameInfo_.getPrefix(prefix_filter::Sample),
+        [self, this](const std::shared_ptr<const FetchingTask>& task,
+                     const std::shared_ptr<const SlotSegment>& segment)
+        {
+            // on first segment
+            // figure out Key frame # and request it here
+            fetchGopKey(segment);
+        });
+
+    LogInfoC << "initiating fetching for target frame " << frameNameInfo_.getPrefix(prefix_filter::Sample) << std::endl;
+
+    targetFrameTask_ = task;
+    deltasTasks_[frameNameInfo_.sampleNo_] = task;
+    task->start();
 }
 
 void 
@@ -198,47 +444,22 @@ FrameFetcherImpl::fetchGopKey(const std::shared_ptr<const SlotSegment>& deltaSeg
         std::dynamic_pointer_cast<WireData<VideoFrameSegmentHeader>>(deltaSegment->getData());
     
     PacketNumber keyFrameNumber = videoFrameSegment->segment().getHeader().pairedSequenceNo_;
-    Name keyFrameName = frameNameInfo_.getPrefix(prefix_filter::ThreadNT)
-                                      .append(NameComponents::NameComponentKey)
-                                      .appendSequenceNumber(keyFrameNumber);
+    setKeyFrame(keyFrameNumber);
     
     LogInfoC << "will fetch Key frame " << keyFrameNumber
-             << " (" << keyFrameName << ")" << std::endl;
+             << " (" << keyFrameName_ << ")" << std::endl;
     
     std::shared_ptr<FrameFetcherImpl> self = shared_from_this();
-    std::shared_ptr<FrameFetchingTask> task = 
-        std::make_shared<FrameFetchingTask>(
-            keyFrameName,
-            fetchMethod_,
-            [self, this](const std::shared_ptr<const FetchingTask>& task, 
-                         const std::shared_ptr<const BufferSlot>& slot)
-            {
-                LogInfoC << "key frame fetched" << std::endl;
-                checkReadyDecode();
-            },
-            [self, this](const std::shared_ptr<const FetchingTask>& task,
-                         std::string reason)
-            {
-                LogErrorC << "failed to fetch Key frame: " << reason << std::endl;
-                halt(reason);
-            },
-            fetchSettings_,
+    std::shared_ptr<FrameFetchingTask> task = makeTask(keyFrameName_,
             [self, this](const std::shared_ptr<const FetchingTask>& task,
                          const std::shared_ptr<const SlotSegment>& segment)
             {
                 // on first segment
                 // figure out First Delta gop number and request them all
                 fetchGopDelta(segment);
-            },
-            [](const std::shared_ptr<const FetchingTask>& task,
-                     const std::shared_ptr<const SlotSegment>& segment)
-            {
             });
 
     keyFrameTask_ = task;
-    fetchingTasks_[keyFrameName] = task;
-
-    task->setLogger(getLogger());
     task->start();
 }
 
@@ -269,34 +490,51 @@ FrameFetcherImpl::fetchGopDelta(const std::shared_ptr<const SlotSegment>& segmen
 
             LogDebugC << "will fetch " << deltaFrameName << std::endl;
 
-            std::shared_ptr<FrameFetcherImpl> self = shared_from_this();
-            std::shared_ptr<FrameFetchingTask> task = 
-                std::make_shared<FrameFetchingTask>(
-                    deltaFrameName,
-                    fetchMethod_,
-                    [self, this, deltaSeqNo](const std::shared_ptr<const FetchingTask>& task, 
-                                const std::shared_ptr<const BufferSlot>& slot)
-                    {
-                        LogDebugC << "delta " << deltaSeqNo << " fetched" << std::endl;
-                        checkReadyDecode();
-                    },
-                    [self, this](const std::shared_ptr<const FetchingTask>& task,
-                                 std::string reason)
-                    {
-                        LogErrorC << "failed to fetch delta frame: " << reason << std::endl;
-                        halt(reason);
-                    },
-                    fetchSettings_);
-
-            deltasTasks_[deltaFrameName] = task;
-            fetchingTasks_[deltaFrameName] = task;
-
-            task->setLogger(getLogger());
+            std::shared_ptr<FrameFetchingTask> task = makeTask(deltaFrameName);
+            deltasTasks_[deltaSeqNo] = task;
             task->start();
         }
     }
 }
 
+std::shared_ptr<FrameFetchingTask>
+FrameFetcherImpl::makeTask(const ndn::Name& frameName, OnSegment onFirstSegment)
+{
+    std::shared_ptr<FrameFetcherImpl> self = shared_from_this();
+    std::shared_ptr<FrameFetchingTask> task = 
+        std::make_shared<FrameFetchingTask>(
+            frameName,
+            fetchMethod_,
+            [self, this, frameName](const std::shared_ptr<const FetchingTask>& task, 
+                                    const std::shared_ptr<const BufferSlot>& slot)
+            {
+                LogDebugC << "fetched " << frameName << std::endl;
+                checkReadyDecode();
+            },
+            [self, this, frameName](const std::shared_ptr<const FetchingTask>& task,
+                                    std::string reason)
+            {
+                LogErrorC << "failed to fetch " << frameName << ": " << reason << std::endl;
+                halt(reason);
+            },
+            fetchSettings_,
+            onFirstSegment);
+
+    fetchingTasks_[frameName] = task;
+    task->setLogger(getLogger());
+
+    return task;
+}
+
+void
+FrameFetcherImpl::setKeyFrame(PacketNumber keyNo)
+{
+    keyNo_ = keyNo;
+    keyFrameName_ = frameNameInfo_.getPrefix(prefix_filter::ThreadNT)
+                                  .append(NameComponents::NameComponentKey)
+                                  .appendSequenceNumber(keyNo);
+}
+
 void
 FrameFetcherImpl::checkReadyDecode()
 {
@@ -320,86 +558,92 @@ FrameFetcherImpl::checkReadyDecode()
 void
 FrameFetcherImpl::decode()
 {
-    // initialize decoder here and start decoding...
+    DecodedFrame decoded;
+
+    // decoder is either taken from the cache, or GOP is decoded 
+    // from the key frame
+    if (keyFrameTask_)
+    {
+        LogDebugC << "decoding Key " << keyNo_ << std::endl;
+
+        gopDecoder_.reset();
+        if (!decodeFrame(keyFrameTask_->getSlot(), decoded))
+            return;
+    }
+
+    // deltas are ordered by their sequence numbers, target frame is the last one
+    for (auto t:deltasTasks_)
+    {
+        LogDebugC << "decoding Delta " << t.first << std::endl;
+
+        if (!decodeFrame(t.second->getSlot(), decoded))
+            return;
+        gopDecoder_->setNextDeltaNo(t.first+1);
+    }
+
+    cache_->returnDecoder(keyFrameName_, gopDecoder_);
+    deliver(decoded, fetchingTasks_.size());
+}
+
+bool
+FrameFetcherImpl::decodeFrame(const std::shared_ptr<const BufferSlot>& slot, 
+                              DecodedFrame& decoded)
+{
     VideoFrameSlot frameSlot;
     bool recovered = false;
-    std::shared_ptr<const BufferSlot> slot = keyFrameTask_->getSlot();
     std::shared_ptr<ImmutableVideoFramePacket> framePacket =
         frameSlot.readPacket(*slot, recovered);
-    
-    if (framePacket.get())
+
+    if (!framePacket.get())
     {
-        VideoFrameSegmentHeader header = frameSlot.readSegmentHeader(*slot);
-        FrameInfo finfo({ (uint64_t)(slot->getHeader().publishUnixTimestamp_*1000),
-                                     header.playbackNo_,
-                                     slot->getPrefix().toUri() });
-        VideoCoderParams params = setupDecoderParams(framePacket);
-        std::shared_ptr<FrameFetcherImpl> self = shared_from_this();
-        int needToDecode = fetchingTasks_.size();
-        OnDecodedImage onDecoded = 
-            [&needToDecode, self, this](const FrameInfo& fi, const WebRtcVideoFrame& f){
-                --needToDecode;
-
-                if (needToDecode == 0)
-                {
-                    uint8_t* buffer = onBufferAllocate_(self, f.width(), f.height());
-                    if (buffer)
-                    {
-                        state_ = FrameFetcher::Completed;
-
-                        ConvertFromI420(f, webrtc::kBGRA, 0, buffer);
-                        onFrameFetched_(self, fi, fetchingTasks_.size(), 
-                                        f.width(), f.height(), buffer);
-                    }
-                    else
-                        LogWarnC << "received null buffer for frame" << std::endl;
-                    reset();
-                }
-            };
-        std::shared_ptr<VideoDecoder> decoder = 
-            std::make_shared<VideoDecoder>(params, onDecoded);
-
-        LogDebugC << "need to decode " << needToDecode << " frames. decoding Key" << std::endl;
-        assert(needToDecode > 0);
-        decoder->processFrame(finfo, framePacket->getFrame());
-
-        // decode deltas if needed
-        for (auto t:deltasTasks_)
-        {
-            LogDebugC << "decoding Delta " << needToDecode << std::endl;
-
-            slot = t.second->getSlot();
-            framePacket = frameSlot.readPacket(*slot, recovered);
-            if (framePacket.get())
-                decoder->processFrame(finfo, framePacket->getFrame());
-            else
-                halt("Couldn't retrieve frame from "+t.second->getSlot()->getPrefix().toUri());
-        }
+        halt("Couldn't retrieve frame from "+slot->getPrefix().toUri());
+        return false;
+    }
 
-        if (targetFrameTask_ != keyFrameTask_)
-        {
-            assert(needToDecode == 1);
-            LogDebugC << "decoding target frame " << needToDecode << std::endl;
+    VideoFrameSegmentHeader header = frameSlot.readSegmentHeader(*slot);
+    FrameInfo finfo({ (uint64_t)(slot->getHeader().publishUnixTimestamp_*1000),
+                                 header.playbackNo_,
+                                 slot->getPrefix().toUri() });
 
-            slot = targetFrameTask_->getSlot();
-            framePacket = frameSlot.readPacket(*slot, recovered);
-            if (framePacket.get())
-            {
-                header = frameSlot.readSegmentHeader(*slot);
-                finfo.timestamp_ = (uint64_t)(slot->getHeader().publishUnixTimestamp_*1000);
-                finfo.playbackNo_ = header.playbackNo_;
-                finfo.ndnName_ = slot->getPrefix().toUri();
+    if (!gopDecoder_) // GOP starts with this key frame
+        gopDecoder_ = std::make_shared<GopDecoder>(setupDecoderParams(framePacket),
+                                                   keyNo_, header.pairedSequenceNo_);
+    else if (header.pairedSequenceNo_ != gopDecoder_->getKeyNo())
+    {
+        // may happen if key frame index is inconsistent with recording
+        halt("Frame "+slot->getPrefix().toUri()+" does not belong to GOP "+
+             keyFrameName_.toUri());
+        return false;
+    }
 
-                decoder->processFrame(finfo, framePacket->getFrame());
-            }
-            else
-                halt("Couldn't retrieve frame from "+targetFrameTask_->getSlot()->getPrefix().toUri());
-        }
+    if (!gopDecoder_->decode(finfo, framePacket->getFrame(), decoded))
+    {
+        halt("Couldn't decode frame "+slot->getPrefix().toUri());
+        return false;
+    }
+
+    cache_->addFrame(slot->getPrefix(), decoded);
+    return true;
+}
+
+void
+FrameFetcherImpl::deliver(const DecodedFrame& decoded, int nFetched)
+{
+    std::shared_ptr<FrameFetcherImpl> self = shared_from_this();
+    const WebRtcVideoFrame& f = *decoded.frame_;
+    uint8_t* buffer = onBufferAllocate_(self, f.width(), f.height());
+
+    if (buffer)
+    {
+        state_ = FrameFetcher::Completed;
 
-        assert(needToDecode == 0);
+        ConvertFromI420(f, webrtc::kBGRA, 0, buffer);
+        onFrameFetched_(self, decoded.info_, nFetched, 
+                        f.width(), f.height(), buffer);
     }
     else
-        halt("Couldn't retrieve frame from "+keyFrameTask_->getSlot()->getPrefix().toUri());
+        LogWarnC << "received null buffer for frame" << std::endl;
+    reset();
 }
 
 void
@@ -415,6 +659,8 @@ FrameFetcherImpl::reset()
     deltasTasks_.clear();
     keyFrameTask_.reset();
     targetFrameTask_.reset();
+    gopDecoder_.reset();
+    fetchMethod_->clear();
 }
 
 void
@@ -7,20 +7,37 @@
 
 #include "storage-engine.hpp"
 
+#include <deque>
+#include <memory>
+#include <map>
+#include <algorithm>
+#include <limits>
+#include <cctype>
+#include <boost/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
 #include <ndn-cpp/name.hpp>
 #include <ndn-cpp/data.hpp>
 #include <ndn-cpp/util/blob.hpp>
 
+#include "clock.hpp"
+#include "estimators.hpp"
+#include "statistics.hpp"
+#include "name-components.hpp"
+#include "frame-data.hpp"
+
 #if HAVE_PERSISTENT_STORAGE
 
 #ifndef __ANDROID__ // use RocksDB on linux and macOS
-    
+
     #include <rocksdb/db.h>
+    #include <rocksdb/write_batch.h>
     namespace db_namespace = rocksdb;
 
 #else // for Android - use LevelDB
 
     #include <leveldb/db.h>
+    #include <leveldb/write_batch.h>
     namespace db_namespace = leveldb;
 
 #endif
@@ -28,19 +45,38 @@
 #endif
 
 using namespace ndnrtc;
+using namespace ndnrtc::statistics;
 using namespace ndn;
 
+// key frame index entries are stored under keys starting with zero byte, 
+// thus they never clash with wire-encoded data names:
+//      \0gop<thread prefix URI>/<key frame no>  ->  <first delta no>
+static const std::string GopIndexKeyPrefix("\0gop", 4);
+// storage format version is stored under a key starting with zero byte too;
+// storages recorded before it was introduced have data keyed by name URIs
+// and no version key
+static const std::string FormatVersionKey("\0version", 8);
+static const int FormatVersion = 2;
+
 //******************************************************************************
 namespace ndnrtc {
 
 class StorageEngineImpl {
     public:
     #if HAVE_PERSISTENT_STORAGE
-        StorageEngineImpl(std::string dbPath): dbPath_(dbPath), db_(nullptr)
+        StorageEngineImpl(std::string dbPath,
+                          const std::shared_ptr<StatisticsStorage>& statStorage,
+                          size_t maxBacklog):
+            dbPath_(dbPath), db_(nullptr), uriKeys_(false),
+            statStorage_(statStorage), maxBacklog_(maxBacklog),
+            isRunning_(false), isWriting_(false),
+            writeDelay_(0.05)
         {
         }
     #else
-        StorageEngineImpl(std::string dbPath) {
+        StorageEngineImpl(std::string dbPath,
+                          const std::shared_ptr<StatisticsStorage>& statStorage,
+                          size_t maxBacklog) {
             throw std::runtime_error("The library is not copmiled with persistent storage support.");
         }
     #endif
@@ -56,7 +92,22 @@ class StorageEngineImpl {
             options.create_if_missing = true;
 
             db_namespace::Status status = db_namespace::DB::Open(options, dbPath_, &db_);
-            return status.ok();
+            if (!status.ok())
+                return false;
+
+            if (!checkFormat())
+            {
+                delete db_;
+                db_ = nullptr;
+                return false;
+            }
+
+            loadGopIndex();
+
+            isRunning_ = true;
+            writer_ = boost::thread(&StorageEngineImpl::write, this);
+
+            return true;
 #else
             return false;
 #endif
@@ -65,23 +116,51 @@ class StorageEngineImpl {
         void close()
         {
 #if HAVE_PERSISTENT_STORAGE
+            {
+                boost::lock_guard<boost::mutex> scopedLock(mutex_);
+                isRunning_ = false;
+            }
+            hasBacklog_.notify_one();
+
+            // writer flushes backlog before exiting
+            if (writer_.joinable())
+                writer_.join();
+
             if (db_)
                 delete db_;
+            db_ = nullptr;
 #endif
         }
 
-        bool put(const std::shared_ptr<const Data>& data)
+        bool put(const std::vector<std::shared_ptr<const Data>>& batch)
         {
 #if HAVE_PERSISTENT_STORAGE
             if (!db_)
                 throw std::runtime_error("DB is not open");
 
-            db_namespace::Status s = 
-                db_->Put(db_namespace::WriteOptions(),
-                         data->getName().toUri(),
-                         db_namespace::Slice((const char*)data->wireEncode().buf(),
-                                             data->wireEncode().size()));
-            return s.ok();
+            if (batch.empty())
+                return true;
+
+            size_t backlogSize;
+            {
+                boost::lock_guard<boost::mutex> scopedLock(mutex_);
+
+                if (backlog_.size() >= maxBacklog_)
+                {
+                    if (statStorage_)
+                        (*statStorage_)[Indicator::StorageDroppedNum] += batch.size();
+                    return false;
+                }
+
+                backlog_.push_back(Batch(batch, clock::microsecondTimestamp()));
+                backlogSize = backlog_.size();
+            }
+            hasBacklog_.notify_one();
+
+            if (statStorage_)
+                (*statStorage_)[Indicator::StorageBacklogSize] = backlogSize;
+
+            return true;
 #else
             return false;
 #endif
@@ -93,33 +172,361 @@ class StorageEngineImpl {
             if (!db_)
                 throw std::runtime_error("DB is not open");
 
-            static std::string dataString;
+            { // data may be still waiting to be written
+                std::shared_ptr<Data> data = getFromBacklog(dataName);
+                if (data)
+                    return data;
+            }
+
+            std::string key = dbKey(dataName);
+            db_namespace::Slice keySlice(key);
+    #ifndef __ANDROID__
+            // decode right from the DB-owned buffer
+            db_namespace::PinnableSlice value;
             db_namespace::Status s = db_->Get(db_namespace::ReadOptions(),
-                                              dataName.toUri(),
-                                              &dataString);
+                                              db_->DefaultColumnFamily(),
+                                              keySlice, &value);
+    #else
+            std::string value;
+            db_namespace::Status s = db_->Get(db_namespace::ReadOptions(),
+                                              keySlice, &value);
+    #endif
             if (s.ok())
             {
                 std::shared_ptr<Data> data = std::make_shared<Data>();
-                data->wireDecode((const uint8_t*)dataString.data(), dataString.size());
-                
+                data->wireDecode((const uint8_t*)value.data(), value.size());
+
                 return data;
             }
 #endif
             return std::shared_ptr<Data>(nullptr);
         }
 
+        std::vector<std::shared_ptr<Data>> get(const std::vector<Name>& dataNames)
+        {
+            std::vector<std::shared_ptr<Data>> batch(dataNames.size());
+#if HAVE_PERSISTENT_STORAGE
+            if (!db_)
+                throw std::runtime_error("DB is not open");
+
+            // DB keys of the packets that are not in the backlog and 
+            // their positions in the batch
+            std::vector<std::pair<std::string, size_t>> keys;
+            keys.reserve(dataNames.size());
+
+            for (size_t i = 0; i < dataNames.size(); ++i)
+                if (!(batch[i] = getFromBacklog(dataNames[i])))
+                    keys.push_back(std::make_pair(dbKey(dataNames[i]), i));
+
+            // sorted keys let iterator move forward only
+            std::sort(keys.begin(), keys.end());
+
+            std::unique_ptr<db_namespace::Iterator> it(db_->NewIterator(db_namespace::ReadOptions()));
+            for (auto& k:keys)
+            {
+                db_namespace::Slice keySlice(k.first);
+                it->Seek(keySlice);
+
+                if (it->Valid() && it->key() == keySlice)
+                {
+                    std::shared_ptr<Data> data = std::make_shared<Data>();
+                    data->wireDecode((const uint8_t*)it->value().data(), it->value().size());
+                    batch[k.second] = data;
+                }
+            }
+#endif
+            return batch;
+        }
+
+        bool getGop(const Name& threadPrefix, PacketNumber deltaNo,
+                    PacketNumber& keyNo, PacketNumber& firstDeltaNo)
+        {
+            boost::lock_guard<boost::mutex> scopedLock(mutex_);
+
+            auto thread = gopIndex_.find(threadPrefix.toUri());
+            if (thread == gopIndex_.end())
+                return false;
+
+            // GOP with the latest first delta which is not after the frame
+            auto gop = thread->second.upper_bound(deltaNo);
+            if (gop == thread->second.begin())
+                return false;
+            --gop;
+
+            firstDeltaNo = gop->first;
+            keyNo = gop->second;
+
+            return true;
+        }
+
+        void flush()
+        {
+#if HAVE_PERSISTENT_STORAGE
+            boost::unique_lock<boost::mutex> lock(mutex_);
+            isFlushed_.wait(lock, [this](){ return backlog_.empty() && !isWriting_; });
+#endif
+        }
+
     private:
+        struct Batch {
+            Batch(const std::vector<std::shared_ptr<const Data>>& packets, int64_t enqueuedUsec):
+                packets_(packets), enqueuedUsec_(enqueuedUsec){}
+
+            std::vector<std::shared_ptr<const Data>> packets_;
+            int64_t enqueuedUsec_;
+        };
+
         std::string dbPath_;
 #if HAVE_PERSISTENT_STORAGE
         db_namespace::DB* db_;
+        // storage recorded before format version was introduced
+        bool uriKeys_;
+#endif
+        std::shared_ptr<StatisticsStorage> statStorage_;
+        size_t maxBacklog_;
+
+        boost::thread writer_;
+        boost::mutex mutex_;
+        boost::condition_variable hasBacklog_, isFlushed_;
+        // batches waiting to be written and batches being written now
+        std::deque<Batch> backlog_, writing_;
+        bool isRunning_, isWriting_;
+        estimators::Filter writeDelay_;
+        // thread prefix URI -> (first delta no -> key no)
+        // modified by writer thread only, with mutex_ locked
+        std::map<std::string, std::map<PacketNumber, PacketNumber>> gopIndex_;
+
+        typedef struct _GopIndexEntry {
+            std::string thread_;
+            PacketNumber keyNo_, firstDeltaNo_;
+        } GopIndexEntry;
+
+        void addToGopIndex(const GopIndexEntry& e)
+        {
+            auto res = gopIndex_[e.thread_].insert(std::make_pair(e.firstDeltaNo_, e.keyNo_));
+
+            // key frames with no deltas in between share first delta; 
+            // deltas belong to the latest of them
+            if (!res.second && res.first->second < e.keyNo_)
+                res.first->second = e.keyNo_;
+        }
+
+        bool isGopIndexed(const GopIndexEntry& e) const
+        {
+            auto thread = gopIndex_.find(e.thread_);
+            if (thread == gopIndex_.end())
+                return false;
+
+            auto gop = thread->second.find(e.firstDeltaNo_);
+            return (gop != thread->second.end() && gop->second >= e.keyNo_);
+        }
+
+#if HAVE_PERSISTENT_STORAGE
+        std::string dbKey(const Name& dataName) const
+        {
+            if (uriKeys_)
+                return dataName.toUri();
+
+            Blob key = dataName.wireEncode();
+            return std::string((const char*)key.buf(), key.size());
+        }
 #endif
+
+        // checks whether data is a segment of a key frame and extracts 
+        // GOP index entry from it
+        static bool getGopIndexEntry(const std::shared_ptr<const Data>& d, GopIndexEntry& e)
+        {
+            NameHandle handle;
+
+            if (!NameComponents::extractHandle(d->getName(), handle) ||
+                handle.streamType_ != MediaStreamParams::MediaStreamType::MediaStreamTypeVideo ||
+                handle.class_ != SampleClass::Key ||
+                handle.segmentClass_ != SegmentClass::Data)
+                return false;
+
+            ImmutableHeaderPacket<VideoFrameSegmentHeader> segment(d->getContent());
+            if (!segment.isValid())
+                return false;
+
+            e.thread_ = handle.getPrefix(prefix_filter::ThreadNT).toUri();
+            e.keyNo_ = handle.sampleNo_;
+            e.firstDeltaNo_ = segment.getHeader().pairedSequenceNo_;
+
+            return true;
+        }
+
+#if HAVE_PERSISTENT_STORAGE
+        void write()
+        {
+            boost::unique_lock<boost::mutex> lock(mutex_);
+
+            while (true)
+            {
+                hasBacklog_.wait(lock, [this](){ return !backlog_.empty() || !isRunning_; });
+
+                if (backlog_.empty())
+                    break;
+
+                // everything accumulated while writer was busy is written at once
+                writing_.swap(backlog_);
+                isWriting_ = true;
+                lock.unlock();
+
+                db_namespace::WriteBatch writeBatch;
+                size_t nPackets = 0;
+                std::vector<GopIndexEntry> gops;
+
+                for (auto& b:writing_)
+                    for (auto& d:b.packets_)
+                    {
+                        SignedBlob wire = d->wireEncode();
+
+                        writeBatch.Put(dbKey(d->getName()),
+                                       db_namespace::Slice((const char*)wire.buf(), wire.size()));
+                        nPackets++;
+
+                        // index is not modified by other threads, thus it's
+                        // safe to read it without locking
+                        GopIndexEntry e;
+                        if (getGopIndexEntry(d, e) && !isGopIndexed(e) &&
+                            std::find_if(gops.begin(), gops.end(), [&e](const GopIndexEntry& g){
+                                return g.keyNo_ == e.keyNo_ && g.thread_ == e.thread_;
+                            }) == gops.end())
+                        {
+                            std::string indexKey = GopIndexKeyPrefix + e.thread_ + "/" + std::to_string(e.keyNo_);
+                            std::string indexValue = std::to_string(e.firstDeltaNo_);
+
+                            writeBatch.Put(indexKey, indexValue);
+                            gops.push_back(e);
+                        }
+                    }
+
+                db_namespace::Status s = db_->Write(db_namespace::WriteOptions(), &writeBatch);
+                int64_t now = clock::microsecondTimestamp();
+
+                for (auto& b:writing_)
+                    writeDelay_.newValue((double)(now - b.enqueuedUsec_) / 1000.);
+
+                if (statStorage_)
+                {
+                    (*statStorage_)[Indicator::StorageWriteDelay] = writeDelay_.value();
+                    if (s.ok())
+                        (*statStorage_)[Indicator::StorageWrittenNum] += nPackets;
+                    else
+                        (*statStorage_)[Indicator::StorageDroppedNum] += nPackets;
+                }
+
+                lock.lock();
+                writing_.clear();
+                isWriting_ = false;
+
+                if (s.ok())
+                    for (auto& e:gops)
+                        addToGopIndex(e);
+
+                if (statStorage_)
+                    (*statStorage_)[Indicator::StorageBacklogSize] = backlog_.size();
+                if (backlog_.empty())
+                    isFlushed_.notify_all();
+            }
+
+            isFlushed_.notify_all();
+        }
+
+        static bool parsePacketNumber(const std::string& s, PacketNumber& n)
+        {
+            if (s.empty() || !isdigit(s[0]))
+                return false;
+
+            try
+            {
+                size_t len = 0;
+                unsigned long v = std::stoul(s, &len);
+
+                if (len != s.size() || v > (unsigned long)std::numeric_limits<PacketNumber>::max())
+                    return false;
+
+                n = (PacketNumber)v;
+                return true;
+            }
+            catch (std::exception&)
+            {
+                return false;
+            }
+        }
+
+        // checks storage format version; storage without version is either
+        // new (version is written then) or recorded by earlier versions,
+        // which is read and written in its format - data keyed by name URIs
+        bool checkFormat()
+        {
+            std::string version;
+            db_namespace::Status s = db_->Get(db_namespace::ReadOptions(), FormatVersionKey, &version);
+
+            if (s.ok())
+                return (version == std::to_string(FormatVersion));
+            if (!s.IsNotFound())
+                return false;
+
+            std::unique_ptr<db_namespace::Iterator> it(db_->NewIterator(db_namespace::ReadOptions()));
+            it->Seek("/");
+            uriKeys_ = (it->Valid() && it->key().starts_with("/"));
+
+            if (uriKeys_)
+                return true;
+
+            return db_->Put(db_namespace::WriteOptions(), FormatVersionKey,
+                            std::to_string(FormatVersion)).ok();
+        }
+
+        void loadGopIndex()
+        {
+            std::unique_ptr<db_namespace::Iterator> it(db_->NewIterator(db_namespace::ReadOptions()));
+
+            for (it->Seek(GopIndexKeyPrefix);
+                 it->Valid() && it->key().starts_with(GopIndexKeyPrefix);
+                 it->Next())
+            {
+                std::string key = it->key().ToString();
+                size_t pos = key.find_last_of('/');
+
+                GopIndexEntry e;
+
+                // skip malformed entries
+                if (pos != std::string::npos && pos > GopIndexKeyPrefix.size() &&
+                    parsePacketNumber(key.substr(pos+1), e.keyNo_) &&
+                    parsePacketNumber(it->value().ToString(), e.firstDeltaNo_))
+                {
+                    e.thread_ = key.substr(GopIndexKeyPrefix.size(), pos - GopIndexKeyPrefix.size());
+                    addToGopIndex(e);
+                }
+            }
+        }
+#endif
+
+        std::shared_ptr<Data> getFromBacklog(const Name& dataName)
+        {
+            boost::lock_guard<boost::mutex> scopedLock(mutex_);
+
+            // batches being written can't be modified by writer thread
+            // while the lock is held
+            for (auto queue:{ &writing_, &backlog_ })
+                for (auto& b:*queue)
+                    for (auto& d:b.packets_)
+                        if (d->getName().equals(dataName))
+                            return std::make_shared<Data>(*d);
+
+            return std::shared_ptr<Data>(nullptr);
+        }
 };
 
 }
 
 //******************************************************************************
-StorageEngine::StorageEngine(std::string dbPath):
-    pimpl_(std::make_shared<StorageEngineImpl>(dbPath))
+StorageEngine::StorageEngine(std::string dbPath,
+                             const std::shared_ptr<StatisticsStorage>& statStorage,
+                             size_t maxBacklog):
+    pimpl_(std::make_shared<StorageEngineImpl>(dbPath, statStorage, maxBacklog))
 {
     pimpl_->open();
 }
@@ -131,12 +538,33 @@ StorageEngine::~StorageEngine()
 
 void StorageEngine::put(const std::shared_ptr<const Data>& data)
 {
-    pimpl_->put(data);
+    pimpl_->put(std::vector<std::shared_ptr<const Data>>(1, data));
+}
+
+bool StorageEngine::put(const std::vector<std::shared_ptr<const Data>>& batch)
+{
+    return pimpl_->put(batch);
 }
 
-std::shared_ptr<Data> 
+std::shared_ptr<Data>
 StorageEngine::get(const Name& dataName)
 {
     return pimpl_->get(dataName);
 }
 
+std::vector<std::shared_ptr<Data>>
+StorageEngine::get(const std::vector<Name>& dataNames)
+{
+    return pimpl_->get(dataNames);
+}
+
+bool StorageEngine::getGop(const Name& threadPrefix, PacketNumber deltaNo,
+                           PacketNumber& keyNo, PacketNumber& firstDeltaNo)
+{
+    return pimpl_->getGop(threadPrefix, deltaNo, keyNo, firstDeltaNo);
+}
+
+void StorageEngine::flush()
+{
+    pimpl_->flush();
+}
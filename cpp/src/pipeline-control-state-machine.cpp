@@ -7,6 +7,7 @@
 
 #include "pipeline-control-state-machine.hpp"
 #include <memory>
+#include <cmath>
 #include <boost/assign.hpp>
 
 #include "clock.hpp"
@@ -98,13 +99,19 @@ class ReceivedMetadataProcessing
                 << startOffSeqNums_.second << " (key)"
                 << std::endl;
 
-            ctrl->sampleEstimator_->bootstrapSegmentNumber(metadata->getSegInfo().deltaAvgSegNum_,
+            // parity averages lag behind producer's parity ratio changes,
+            // so number of parity segments is derived from the ratio producer
+            // currently uses
+            FrameSegmentsInfo segInfo = metadata->getSegInfo();
+            std::pair<double, double> parityRatio = metadata->getParityRatio();
+
+            ctrl->sampleEstimator_->bootstrapSegmentNumber(segInfo.deltaAvgSegNum_,
                                                            SampleClass::Delta, SegmentClass::Data);
-            ctrl->sampleEstimator_->bootstrapSegmentNumber(metadata->getSegInfo().deltaAvgParitySegNum_,
+            ctrl->sampleEstimator_->bootstrapSegmentNumber((parityRatio.first > 0 ? std::ceil(parityRatio.first * segInfo.deltaAvgSegNum_) : 0),
                                                            SampleClass::Delta, SegmentClass::Parity);
-            ctrl->sampleEstimator_->bootstrapSegmentNumber(metadata->getSegInfo().keyAvgSegNum_,
+            ctrl->sampleEstimator_->bootstrapSegmentNumber(segInfo.keyAvgSegNum_,
                                                            SampleClass::Key, SegmentClass::Data);
-            ctrl->sampleEstimator_->bootstrapSegmentNumber(metadata->getSegInfo().keyAvgParitySegNum_,
+            ctrl->sampleEstimator_->bootstrapSegmentNumber((parityRatio.second > 0 ? std::ceil(parityRatio.second * segInfo.keyAvgSegNum_) : 0),
                                                            SampleClass::Key, SegmentClass::Parity);
 
             ctrl->interestControl_->initialize(metadata->getRate(), pipelineInitial);
@@ -640,14 +647,14 @@ Adjusting::onSegment(const std::shared_ptr<const EventSegment> &ev)
 std::string
 Adjusting::onTimeout(const std::shared_ptr<const EventTimeout> &ev)
 {
-    ctrl_->pipeliner_->express({ ev->getInterest() });
+    ctrl_->pipeliner_->express({ NameComponents::retransmission(*ev->getInterest()) });
     return str();
 }
 
 std::string
 Adjusting::onNack(const std::shared_ptr<const EventNack> &ev)
 {
-    ctrl_->pipeliner_->express({ ev->getInterest() });
+    ctrl_->pipeliner_->express({ NameComponents::retransmission(*ev->getInterest()) });
     return str();
 }
 
@@ -669,13 +676,13 @@ Fetching::onSegment(const std::shared_ptr<const EventSegment> &ev)
 std::string
 Fetching::onTimeout(const std::shared_ptr<const EventTimeout> &ev)
 {
-    ctrl_->pipeliner_->express({ ev->getInterest() });
+    ctrl_->pipeliner_->express({ NameComponents::retransmission(*ev->getInterest()) });
     return str();
 }
 
 std::string
 Fetching::onNack(const std::shared_ptr<const EventNack> &ev)
 {
-    ctrl_->pipeliner_->express({ ev->getInterest() });
+    ctrl_->pipeliner_->express({ NameComponents::retransmission(*ev->getInterest()) });
     return str();
 }
@@ -97,29 +97,29 @@ class EventSegment : public PipelineControlEvent
 class EventTimeout : public PipelineControlEvent
 {
   public:
-    EventTimeout(const NamespaceInfo &info, const std::shared_ptr<const ndn::Interest> &i) 
+    EventTimeout(const NameHandle &info, const std::shared_ptr<const ndn::Interest> &i) 
         : PipelineControlEvent(PipelineControlEvent::Timeout), info_(info), interest_(i) {}
 
-    const NamespaceInfo &getInfo() const { return info_; }
+    const NameHandle &getInfo() const { return info_; }
     const std::shared_ptr<const ndn::Interest> getInterest() const { return interest_; }
 
   private:
-    NamespaceInfo info_;
+    NameHandle info_;
     const std::shared_ptr<const ndn::Interest> interest_;
 };
 
 class EventNack : public PipelineControlEvent
 {
   public:
-    EventNack(const NamespaceInfo &info, int reason, const std::shared_ptr<const ndn::Interest> &i) 
+    EventNack(const NameHandle &info, int reason, const std::shared_ptr<const ndn::Interest> &i) 
         : PipelineControlEvent(PipelineControlEvent::Nack), info_(info), reason_(reason), interest_(i) {}
 
-    const NamespaceInfo &getInfo() const { return info_; }
+    const NameHandle &getInfo() const { return info_; }
     int getReason() const { return reason_; }
     const std::shared_ptr<const ndn::Interest> getInterest() const { return interest_; }
 
   private:
-    NamespaceInfo info_;
+    NameHandle info_;
     int reason_;
     const std::shared_ptr<const ndn::Interest> interest_;
 };
@@ -163,7 +163,7 @@ class PipelineControlStateMachine : public NdnRtcComponent
     {
         _Struct(const ndn::Name threadPrefix) : threadPrefix_(threadPrefix) {}
 
-        const ndn::Name threadPrefix_;
+        ndn::Name threadPrefix_; // changes upon switching to another thread
         std::shared_ptr<DrdEstimator> drdEstimator_;
         std::shared_ptr<IBuffer> buffer_;
         std::shared_ptr<IPipeliner> pipeliner_;
@@ -180,6 +180,10 @@ class PipelineControlStateMachine : public NdnRtcComponent
     std::shared_ptr<PipelineControlState> currentState() const { return currentState_; }
     void dispatch(const std::shared_ptr<const PipelineControlEvent> &ev);
 
+    const ndn::Name &getThreadPrefix() const { return ppCtrl_->threadPrefix_; }
+    // not thread-safe! should be called on the same thread as dispatch(...)
+    void setThreadPrefix(const ndn::Name &threadPrefix) { ppCtrl_->threadPrefix_ = threadPrefix; }
+
     // not thread-safe! should be called on the same thread as dispatch(...)
     void attach(IPipelineControlStateMachineObserver *);
     // not thread-safe! should be called on the same thread as dispatch(...)
@@ -70,7 +70,8 @@ PipelineControl::PipelineControl(const std::shared_ptr<StatisticsStorage> &statS
     : StatObject(statStorage),
       machine_(machine),
       interestControl_(interestControl),
-      pipeliner_(pipeliner)
+      pipeliner_(pipeliner),
+      switch_(ThreadSwitch())
 {
     description_ = "pipeline-control";
 }
@@ -98,8 +99,36 @@ void PipelineControl::stop()
     LogDebugC << "stopped" << std::endl;
 }
 
+void PipelineControl::switchThread(const ndn::Name &threadPrefix, PacketNumber keySeqNo,
+                                   OnThreadSwitched onSwitched)
+{
+    switch_.threadPrefix_ = threadPrefix;
+    switch_.threadName_ = threadPrefix.get(-1).toEscapedString();
+    switch_.keySeqNo_ = keySeqNo;
+    switch_.onSwitched_ = onSwitched;
+
+    LogInfoC << "switching from " << machine_.getThreadPrefix()
+             << " to " << threadPrefix << " at key " << keySeqNo << std::endl;
+
+    pipeliner_->switchThread(threadPrefix, keySeqNo);
+}
+
 void PipelineControl::segmentArrived(const std::shared_ptr<WireSegment> &s)
 {
+    // the first data segment of the key frame of the new thread completes
+    // switch - its header tells the first delta frame that follows it
+    if (switch_.onSwitched_ && !s->isParity() &&
+        s->getSampleClass() == SampleClass::Key &&
+        s->getSampleNo() == switch_.keySeqNo_ &&
+        s->getThreadName() == switch_.threadName_)
+    {
+        std::shared_ptr<WireData<VideoFrameSegmentHeader>> keySegment =
+            std::dynamic_pointer_cast<WireData<VideoFrameSegmentHeader>>(s);
+        if (keySegment)
+            completeSwitch(keySegment->segment().getHeader().pairedSequenceNo_,
+                           keySegment->segment().getHeader().playbackNo_);
+    }
+
     if (s->getSampleClass() == SampleClass::Key ||
         s->getSampleClass() == SampleClass::Delta ||
         s->getSegmentClass() == SegmentClass::Meta)
@@ -108,13 +137,13 @@ void PipelineControl::segmentArrived(const std::shared_ptr<WireSegment> &s)
     }
 }
 
-void PipelineControl::segmentRequestTimeout(const NamespaceInfo &n, 
+void PipelineControl::segmentRequestTimeout(const NameHandle &n, 
                                             const std::shared_ptr<const ndn::Interest> &interest)
 {
     machine_.dispatch(std::make_shared<EventTimeout>(n, interest));
 }
 
-void PipelineControl::segmentNack(const NamespaceInfo &n, int reason,
+void PipelineControl::segmentNack(const NameHandle &n, int reason,
                                    const std::shared_ptr<const ndn::Interest> &interest)
 {
     machine_.dispatch(std::make_shared<EventNack>(n, reason, interest));
@@ -159,6 +188,15 @@ void PipelineControl::onStateMachineChangedState(const std::shared_ptr<const Pip
         (*statStorage_)[statistics::Indicator::RebufferingsNum]++;
 
         stop();
+        if (switch_.onSwitched_)
+        {
+            LogInfoC << "restarting on " << switch_.threadPrefix_ << std::endl;
+            machine_.setThreadPrefix(switch_.threadPrefix_);
+
+            OnThreadSwitched onSwitched = switch_.onSwitched_;
+            switch_.onSwitched_ = OnThreadSwitched();
+            onSwitched(switch_.threadPrefix_, -1);
+        }
         start();
     }
 }
@@ -168,11 +206,29 @@ void PipelineControl::onStateMachineReceivedEvent(const std::shared_ptr<const Pi
 {
 }
 
+void PipelineControl::completeSwitch(PacketNumber deltaSeqNo, PacketNumber playbackNo)
+{
+    LogInfoC << "switched to " << switch_.threadPrefix_ << " at key "
+             << switch_.keySeqNo_ << " (" << playbackNo << "p), next delta "
+             << deltaSeqNo << std::endl;
+
+    machine_.setThreadPrefix(switch_.threadPrefix_);
+    pipeliner_->setSequenceNumber(deltaSeqNo, SampleClass::Delta);
+
+    OnThreadSwitched onSwitched = switch_.onSwitched_;
+    switch_.onSwitched_ = OnThreadSwitched();
+    onSwitched(switch_.threadPrefix_, playbackNo);
+}
+
 void PipelineControl::onRetransmissionRequired(const std::vector<std::shared_ptr<const ndn::Interest>> &interests)
 {
     if (machine_.currentState()->toInt() >= PipelineControlState::Bootstrapping)
     {
         LogDebugC << "retransmission for " << interests[0]->getName().getPrefix(-1) << std::endl;
-        pipeliner_->express(interests, true);
+
+        std::vector<std::shared_ptr<const ndn::Interest>> rtxInterests;
+        for (auto &i : interests)
+            rtxInterests.push_back(NameComponents::retransmission(*i));
+        pipeliner_->express(rtxInterests, true);
     }
 }
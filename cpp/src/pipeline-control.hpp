@@ -47,15 +47,36 @@ class PipelineControl : public NdnRtcComponent,
                         public statistics::StatObject
 {
   public:
+    typedef std::function<void(const ndn::Name &threadPrefix, PacketNumber playbackNo)> OnThreadSwitched;
+
     ~PipelineControl();
 
     void start();
     void stop();
 
+    /**
+     * Switches fetching to another thread of the same stream at key frame
+     * boundary. Key frame keySeqNo of the new thread is requested right
+     * away, while current thread is fetched until this key frame arrives.
+     * From then on, delta frames of the new thread are fetched, starting
+     * from the one that follows this key frame. If pipeline is restarted
+     * before that (i.e. due to starvation), it restarts on the new thread.
+     * @param threadPrefix Prefix of the thread to switch to
+     * @param keySeqNo Key frame to switch at (normally, the next key frame
+     *                 to be published by the new thread)
+     * @param onSwitched Called once switch is completed with playback
+     *                   number of the key frame or -1 if pipeline was
+     *                   restarted
+     */
+    void switchThread(const ndn::Name &threadPrefix, PacketNumber keySeqNo,
+                      OnThreadSwitched onSwitched);
+    bool isSwitchingThread() const { return (bool)switch_.onSwitched_; }
+    const ndn::Name &getThreadPrefix() const { return machine_.getThreadPrefix(); }
+
     void segmentArrived(const std::shared_ptr<WireSegment> &);
-    void segmentRequestTimeout(const NamespaceInfo &, 
+    void segmentRequestTimeout(const NameHandle &, 
                                const std::shared_ptr<const ndn::Interest> &);
-    void segmentNack(const NamespaceInfo &, int,
+    void segmentNack(const NameHandle &, int,
                      const std::shared_ptr<const ndn::Interest> &);
     void segmentStarvation();
 
@@ -82,9 +103,19 @@ class PipelineControl : public NdnRtcComponent,
                                                 const std::shared_ptr<statistics::StatisticsStorage> &storage);
 
   private:
+    typedef struct _ThreadSwitch {
+        ndn::Name threadPrefix_;
+        std::string threadName_;
+        PacketNumber keySeqNo_;
+        OnThreadSwitched onSwitched_;
+    } ThreadSwitch;
+
     PipelineControlStateMachine machine_;
     std::shared_ptr<IInterestControl> interestControl_;
     std::shared_ptr<IPipeliner> pipeliner_;
+    ThreadSwitch switch_;
+
+    void completeSwitch(PacketNumber deltaSeqNo, PacketNumber playbackNo);
 
     PipelineControl(const std::shared_ptr<statistics::StatisticsStorage> &statStorage,
                     const PipelineControlStateMachine &machine,
@@ -0,0 +1,353 @@
+//
+// pipeline-stage.hpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#ifndef __pipeline_stage_h__
+#define __pipeline_stage_h__
+
+#if defined(__linux__) && !defined(__ANDROID__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <boost/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/atomic.hpp>
+#include <boost/lockfree/queue.hpp>
+
+#include "ndnrtc-object.hpp"
+#include "estimators.hpp"
+#include "clock.hpp"
+
+namespace ndnrtc
+{
+
+/**
+ * Defines what happens to an item pushed into a full stage queue.
+ *  - DropNewest: incoming item is dropped;
+ *  - DropOldest: oldest queued item is dropped to make room for incoming one;
+ *  - Wait: producer waits until there is room in the queue (used for stages
+ *    which can't afford losing items, e.g. after encoding).
+ */
+enum class StageOverflow
+{
+    DropNewest,
+    DropOldest,
+    Wait
+};
+
+/**
+ * StageQueue is a bounded lock-free queue which connects two pipeline
+ * stages. Any number of threads may push into the queue, items are expected
+ * to be consumed by one thread. Besides items, queue keeps track of its
+ * occupancy and of the stage latency - smoothed time between pushing an item
+ * and the moment consumer reports it as processed (see done()).
+ * T must be copyable and default-constructible - heavy items should be
+ * passed as shared pointers.
+ */
+template <typename T>
+class StageQueue
+{
+  public:
+    typedef std::function<void(const T &)> OnDropped;
+
+    StageQueue(size_t capacity, StageOverflow overflow)
+        : capacity_(std::max((size_t)1, capacity)),
+          overflow_(overflow),
+          queue_(capacity_ + 1),
+          size_(0), nWaiting_(0), isClosed_(false), latencyMs_(0) {}
+
+    ~StageQueue()
+    {
+        Item *item;
+        while (queue_.pop(item))
+            delete item;
+    }
+
+    /**
+     * Pushes item into the queue. If queue is full, acts according to the
+     * overflow policy. Dropped items (either incoming or evicted) are
+     * passed to onDropped callback.
+     * @return true if item was queued, false if it was dropped or queue is
+     *          closed
+     */
+    bool push(const T &value, const OnDropped &onDropped = OnDropped())
+    {
+        while (!isClosed_ && !reserve())
+        {
+            if (overflow_ == StageOverflow::DropNewest)
+            {
+                if (onDropped)
+                    onDropped(value);
+                return false;
+            }
+
+            if (overflow_ == StageOverflow::DropOldest)
+            {
+                Item *oldest;
+                if (queue_.pop(oldest))
+                {
+                    release();
+                    if (onDropped)
+                        onDropped(oldest->value_);
+                    delete oldest;
+                }
+            }
+            else
+                waitForRoom();
+        }
+
+        if (isClosed_)
+        {
+            // queue may have been closed after the room was reserved
+            release();
+            return false;
+        }
+
+        queue_.push(new Item(value, clock::microsecondTimestamp()));
+        return true;
+    }
+
+    /**
+     * Pops item from the queue.
+     * @param value Popped item
+     * @param enqueuedUsec Microsecond timestamp of when item was pushed
+     * @return false if queue is empty
+     */
+    bool pop(T &value, int64_t &enqueuedUsec)
+    {
+        Item *item;
+        if (!queue_.pop(item))
+            return false;
+
+        release();
+        value = item->value_;
+        enqueuedUsec = item->enqueuedUsec_;
+        delete item;
+
+        return true;
+    }
+
+    /**
+     * Called by consumer once popped item has been processed.
+     * @param enqueuedUsec Timestamp returned by pop()
+     */
+    void done(int64_t enqueuedUsec)
+    {
+        latencyFilter_.newValue((double)(clock::microsecondTimestamp() - enqueuedUsec) / 1000.);
+        latencyMs_ = latencyFilter_.value();
+    }
+
+    /**
+     * Closes the queue: all pending items are discarded, subsequent pushes
+     * fail and producers waiting for the room are released.
+     */
+    void close()
+    {
+        isClosed_ = true;
+        notifyRoom();
+
+        T value;
+        int64_t ts;
+        while (pop(value, ts))
+            ;
+    }
+
+    void reopen() { isClosed_ = false; }
+
+    size_t size() const { return (size_ > 0 ? (size_t)size_ : 0); }
+    bool empty() const { return size_ <= 0; }
+    size_t capacity() const { return capacity_; }
+    double getLatency() const { return latencyMs_; }
+
+  private:
+    StageQueue(const StageQueue &) = delete;
+
+    typedef struct _Item
+    {
+        _Item(const T &value, int64_t enqueuedUsec)
+            : value_(value), enqueuedUsec_(enqueuedUsec) {}
+
+        T value_;
+        int64_t enqueuedUsec_;
+    } Item;
+
+    const size_t capacity_;
+    const StageOverflow overflow_;
+    // one extra node is allocated for the queue's internal dummy node
+    boost::lockfree::queue<Item *> queue_;
+    boost::atomic<int> size_, nWaiting_;
+    boost::atomic<bool> isClosed_;
+    boost::mutex roomMutex_;
+    boost::condition_variable roomCondition_;
+    estimators::Filter latencyFilter_;
+    boost::atomic<double> latencyMs_;
+
+    bool reserve()
+    {
+        if (++size_ <= (int)capacity_)
+            return true;
+        size_--;
+        return false;
+    }
+
+    void release()
+    {
+        size_--;
+        notifyRoom();
+    }
+
+    void waitForRoom()
+    {
+        boost::unique_lock<boost::mutex> lock(roomMutex_);
+        // waiter is counted before the check, hence either consumer sees
+        // the counter and notifies us, or we see the room here
+        nWaiting_++;
+        if (!isClosed_ && size_ >= (int)capacity_)
+            roomCondition_.wait(lock);
+        nWaiting_--;
+    }
+
+    void notifyRoom()
+    {
+        if (nWaiting_ > 0)
+        {
+            boost::lock_guard<boost::mutex> scopedLock(roomMutex_);
+            roomCondition_.notify_all();
+        }
+    }
+};
+
+/**
+ * PipelineStage is a worker thread fed by a StageQueue. Items pushed into the
+ * stage are processed on the worker thread in the order they were pushed.
+ * Producer never waits for processing, unless stage overflow policy is Wait
+ * and the queue is full. While the queue is empty, worker sleeps and is woken
+ * up by the next push.
+ */
+template <typename T>
+class PipelineStage : public NdnRtcComponent
+{
+  public:
+    typedef std::function<void(const T &)> OnItem;
+    typedef typename StageQueue<T>::OnDropped OnDropped;
+
+    PipelineStage(size_t capacity, StageOverflow overflow)
+        : queue_(capacity, overflow), isRunning_(false), isSleeping_(false)
+    {
+        description_ = "pipeline-stage";
+    }
+
+    ~PipelineStage() { stop(); }
+
+    void start(OnItem onItem, OnDropped onDropped = OnDropped())
+    {
+        if (isRunning_)
+            return;
+
+        onItem_ = onItem;
+        onDropped_ = onDropped;
+        queue_.reopen();
+        isRunning_ = true;
+        worker_ = boost::thread(&PipelineStage::run, this);
+    }
+
+    void stop()
+    {
+        if (!isRunning_)
+            return;
+
+        isRunning_ = false;
+        queue_.close();
+        wake();
+
+        if (worker_.joinable() && boost::this_thread::get_id() != worker_.get_id())
+            worker_.join();
+    }
+
+    bool isRunning() const { return isRunning_; }
+
+    /**
+     * Hands off item to the stage.
+     * @return false if item was dropped or stage is not running
+     */
+    bool push(const T &item)
+    {
+        if (!isRunning_)
+            return false;
+
+        bool queued = queue_.push(item, onDropped_);
+        if (queued && isSleeping_)
+            wake();
+
+        return queued;
+    }
+
+    size_t getOccupancy() const { return queue_.size(); }
+    size_t getCapacity() const { return queue_.capacity(); }
+    double getLatency() const { return queue_.getLatency(); }
+
+    /**
+     * Pins stage worker thread to specified CPU core. Stage must be running.
+     * @return true on success
+     */
+    bool pinToCore(unsigned int core)
+    {
+#if defined(__linux__) && !defined(__ANDROID__)
+        cpu_set_t cpuSet;
+        CPU_ZERO(&cpuSet);
+        CPU_SET(core, &cpuSet);
+
+        return (pthread_setaffinity_np(worker_.native_handle(), sizeof(cpu_set_t), &cpuSet) == 0);
+#else
+        return false;
+#endif
+    }
+
+  private:
+    PipelineStage(const PipelineStage &) = delete;
+
+    StageQueue<T> queue_;
+    OnItem onItem_;
+    OnDropped onDropped_;
+    boost::atomic<bool> isRunning_, isSleeping_;
+    boost::mutex wakeMutex_;
+    boost::condition_variable wakeCondition_;
+    boost::thread worker_;
+
+    void wake()
+    {
+        boost::lock_guard<boost::mutex> scopedLock(wakeMutex_);
+        wakeCondition_.notify_one();
+    }
+
+    void run()
+    {
+        while (isRunning_)
+        {
+            T item;
+            int64_t enqueuedUsec;
+
+            if (queue_.pop(item, enqueuedUsec))
+            {
+                onItem_(item);
+                queue_.done(enqueuedUsec);
+                continue;
+            }
+
+            boost::unique_lock<boost::mutex> lock(wakeMutex_);
+            isSleeping_ = true;
+            // producer checks isSleeping_ after pushing, hence either it
+            // sees the flag and wakes us, or we see non-empty queue here
+            if (isRunning_ && queue_.empty())
+                wakeCondition_.wait(lock);
+            isSleeping_ = false;
+        }
+    }
+};
+}
+
+#endif
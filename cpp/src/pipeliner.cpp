@@ -60,7 +60,7 @@ Pipeliner::express(const ndn::Name& threadPrefix, bool placeInBuffer)
     }
     else
     {
-        Name n = nameScheme_->samplePrefix(threadPrefix, nextSamplePriority_);
+        Name n = nameScheme_->samplePrefix(threadPrefixFor(threadPrefix, nextSamplePriority_), nextSamplePriority_);
         n.appendSequenceNumber((nextSamplePriority_ == SampleClass::Delta ? seqCounter_.delta_ : seqCounter_.key_));
         
         const std::vector<std::shared_ptr<const Interest>> batch = getBatch(n, nextSamplePriority_);
@@ -95,7 +95,7 @@ Pipeliner::onIncomingData(const ndn::Name& threadPrefix)
     
     while (interestControl_->room() > 0)
     {
-        Name n = nameScheme_->samplePrefix(threadPrefix, nextSamplePriority_);
+        Name n = nameScheme_->samplePrefix(threadPrefixFor(threadPrefix, nextSamplePriority_), nextSamplePriority_);
         n.appendSequenceNumber((nextSamplePriority_ == SampleClass::Delta ?
                                 seqCounter_.delta_ : seqCounter_.key_));
 
@@ -129,6 +129,7 @@ Pipeliner::reset()
 
     nextSamplePriority_ = SampleClass::Delta;
     lastRequestedSample_ = SampleClass::Unknown;
+    keyThreadPrefix_.clear();
 }
 
 void 
@@ -150,6 +151,33 @@ Pipeliner::getSequenceNumber(SampleClass cls)
     return 0;
 }
 
+void
+Pipeliner::switchThread(const ndn::Name& threadPrefix, PacketNumber keySeqNo)
+{
+    keyThreadPrefix_ = threadPrefix;
+
+    Name n = nameScheme_->samplePrefix(threadPrefix, SampleClass::Key);
+    n.appendSequenceNumber(keySeqNo);
+
+    const std::vector<std::shared_ptr<const Interest>> batch = getBatch(n, SampleClass::Key);
+    int64_t deadline = playbackQueue_->size()+playbackQueue_->pendingSize();
+
+    request(batch, DeadlinePriority::fromNow(deadline));
+    buffer_->requested(batch);
+    interestControl_->increment();
+
+    // key frames of the current thread are not needed anymore
+    seqCounter_.key_ = keySeqNo+1;
+    if (nextSamplePriority_ == SampleClass::Key)
+        nextSamplePriority_ = SampleClass::Delta;
+
+    LogInfoC << "switching to " << threadPrefix << ", requested key "
+        << keySeqNo << " x" << batch.size() << std::endl;
+
+    (*sstorage_)[Indicator::RequestedNum]++;
+    (*sstorage_)[Indicator::RequestedKeyNum]++;
+}
+
 #pragma mark - private
 void
 Pipeliner::request(const std::vector<std::shared_ptr<const ndn::Interest>>& interests,
@@ -230,8 +258,10 @@ void Pipeliner::onNewData(const BufferReceipt& receipt)
     }
     
     // set priority for requesting next key frame when key segment is received
+    // (key frames of the thread being switched from do not count)
     if (receipt.slot_->getNameInfo().class_ == SampleClass::Key &&
-        receipt.oldState_ == BufferSlot::State::New)
+        receipt.oldState_ == BufferSlot::State::New &&
+        (keyThreadPrefix_.size() == 0 || keyThreadPrefix_.match(receipt.slot_->getPrefix())))
         setNeedSample(SampleClass::Key);
 }
 
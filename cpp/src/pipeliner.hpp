@@ -53,6 +53,7 @@ namespace ndnrtc {
         virtual void setSequenceNumber(PacketNumber seqNo, SampleClass cls) = 0;
         virtual PacketNumber getSequenceNumber(SampleClass cls) = 0;
         virtual void setInterestLifetime(unsigned int lifetimeMs) = 0;
+        virtual void switchThread(const ndn::Name& threadPrefix, PacketNumber keySeqNo) = 0;
     };
 
     /**
@@ -139,6 +140,18 @@ namespace ndnrtc {
 
         void setInterestLifetime(unsigned int lifetimeMs) {  interestLifetime_ = lifetimeMs; }
 
+        /**
+         * Starts switching to another thread: requests key frame keySeqNo of
+         * the new thread right away and requests all further key frames from
+         * the new thread. Delta frames are requested from the thread prefix
+         * passed to onIncomingData(), thus caller shall switch it once key
+         * frame of the new thread arrives (and set delta sequence number
+         * accordingly). Cleared by reset().
+         * @param threadPrefix Prefix of the thread to switch to
+         * @param keySeqNo Sequence number of the key frame to start from
+         */
+        void switchThread(const ndn::Name& threadPrefix, PacketNumber keySeqNo);
+
         /**
          * This class
          */
@@ -181,6 +194,10 @@ namespace ndnrtc {
         std::shared_ptr<statistics::StatisticsStorage> sstorage_;
         SequenceCounter seqCounter_;
         SampleClass nextSamplePriority_, lastRequestedSample_;
+        ndn::Name keyThreadPrefix_; // set when switching threads
+
+        const ndn::Name& threadPrefixFor(const ndn::Name& threadPrefix, SampleClass cls) const
+        { return (cls == SampleClass::Key && keyThreadPrefix_.size() ? keyThreadPrefix_ : threadPrefix); }
 
         void request(const std::vector<std::shared_ptr<const ndn::Interest>>& interests,
             const std::shared_ptr<DeadlinePriority>& prioirty);
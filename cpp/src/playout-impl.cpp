@@ -13,6 +13,7 @@
 #include "frame-buffer.hpp"
 #include "frame-data.hpp"
 #include "clock.hpp"
+#include "event-trace.hpp"
 
 using namespace ndnrtc;
 using namespace std;
@@ -101,7 +102,7 @@ void PlayoutImpl::extractSample()
 {
     if (!isRunning_) return;
     
-    stringstream debugStr;
+    std::string debugStr;
     int64_t sampleDelay = (int64_t)round(pqueue_->samplePeriod());
     bool validForPlayback = false;
     jitterTiming_.startFramePlayout();
@@ -113,7 +114,13 @@ void PlayoutImpl::extractSample()
             correctAdjustment(slot->getHeader().publishTimestampMs_);
             lastTimestamp_ = slot->getHeader().publishTimestampMs_;
             sampleDelay = playTimeMs;
-            debugStr << slot->dump();
+            trace::Tracer::record((validForPlayback ? trace::Event::SamplePlayed : trace::Event::SampleSkipped),
+                slot->getNameInfo().sampleNo_, -1, 
+                trace::Tracer::flags(false, slot->getNameInfo().class_ == SampleClass::Key),
+                (uint32_t)sampleDelay);
+            // slot is released once extracted
+            if (LogIsEnabledC(ndnlog::NdnLoggerLevelDebug))
+                debugStr = slot->dump();
             (*statStorage_)[Indicator::LatencyEstimated] = (clock::unixTimestamp() - slot->getHeader().publishUnixTimestamp_);
         });
 
@@ -133,7 +140,7 @@ void PlayoutImpl::extractSample()
     int64_t actualDelay = adjustDelay(sampleDelay);
 
     if (validForPlayback)
-        LogDebugC << "●-- play frame " << debugStr.str() << actualDelay << "ms" << std::endl;
+        LogDebugC << "●-- play frame " << debugStr << actualDelay << "ms" << std::endl;
 
     std::shared_ptr<PlayoutImpl> me = std::dynamic_pointer_cast<PlayoutImpl>(shared_from_this());
     jitterTiming_.updatePlayoutTime(actualDelay);
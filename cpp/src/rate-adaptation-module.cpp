@@ -0,0 +1,327 @@
+//
+// rate-adaptation-module.cpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include "rate-adaptation-module.hpp"
+
+#include <algorithm>
+#include <ndn-cpp/data.hpp>
+
+#include "clock.hpp"
+#include "drd-estimator.hpp"
+#include "frame-data.hpp"
+#include "statistics.hpp"
+
+using namespace ndnrtc;
+using namespace ndnrtc::statistics;
+
+const RateAdaptationModule::Settings RateAdaptationModule::DefaultSettings = {
+    2000,   // windowMs_
+    8000,   // upHoldMs_
+    64000,  // maxUpHoldMs_
+    1000,   // downHoldMs_
+    0.85,   // margin_
+    0.05,   // lossRatio_
+    2.5     // rttRatio_
+};
+
+RateAdaptationModule::RateAdaptationModule(const Settings& settings):
+settings_(settings),
+current_(0),
+interval_({-1, -1, 0, 0, 0}),
+bandwidth_(0), rtt_(0), minRtt_(0),
+isCongested_(false),
+lastSwitchMs_(-1), lastUpMs_(-1), lastCongestionMs_(-1),
+upHoldMs_(settings.upHoldMs_)
+{
+}
+
+int
+RateAdaptationModule::initialize(const CodecMode& codecMode,
+                                 uint32_t nStreams,
+                                 StreamEntry* streamArray)
+{
+    if (codecMode != CodecModeNormal) return -1;
+    if (!nStreams || !streamArray) return -2;
+
+    streams_.assign(streamArray, streamArray+nStreams);
+    std::stable_sort(streams_.begin(), streams_.end(),
+                     [](const StreamEntry& a, const StreamEntry& b){
+                         return a.bitrate_ < b.bitrate_;
+                     });
+
+    current_ = 0;
+    window_.clear();
+    interval_ = {-1, -1, 0, 0, 0};
+    bandwidth_ = rtt_ = minRtt_ = 0;
+    isCongested_ = false;
+    lastSwitchMs_ = lastUpMs_ = lastCongestionMs_ = -1;
+    upHoldMs_ = settings_.upHoldMs_;
+
+    return 0;
+}
+
+void
+RateAdaptationModule::interestExpressed(const std::string &name,
+                                        unsigned int streamId)
+{
+    // losses are calculated against received data, nothing to do here
+}
+
+void
+RateAdaptationModule::interestTimeout(const std::string &name,
+                                      unsigned int streamId)
+{
+    interval_.nLost_++;
+}
+
+void
+RateAdaptationModule::dataReceived(const std::string &name,
+                                   unsigned int streamId,
+                                   unsigned int dataSize,
+                                   double rttMs,
+                                   unsigned int nRtx)
+{
+    interval_.bytes_ += dataSize;
+    interval_.nReceived_++;
+    // data that needed retransmissions was late
+    if (nRtx) interval_.nLost_++;
+
+    if (rttMs > 0)
+    {
+        rtt_ = (rtt_ ? 0.9*rtt_ + 0.1*rttMs : rttMs);
+        // baseline follows the minimum, slowly drifting towards current
+        // values in order to follow route changes
+        minRtt_ = (minRtt_ ? std::min(rttMs, minRtt_ + 0.0001*(rttMs - minRtt_)) : rttMs);
+    }
+}
+
+void
+RateAdaptationModule::getInterestRate(int64_t timestampMs,
+                                      double& interestRate,
+                                      unsigned int& streamId)
+{
+    interestRate = 0;
+    streamId = 0;
+    if (streams_.empty()) return;
+
+    updateEstimation(timestampMs);
+    adapt(timestampMs);
+
+    uint64_t bytes = 0;
+    unsigned int nReceived = 0;
+    for (auto& i:window_)
+    {
+        bytes += i.bytes_;
+        nReceived += i.nReceived_;
+    }
+
+    // segments per second that fit into estimated throughput
+    if (nReceived && bytes)
+        interestRate = bandwidth_*1000./8./((double)bytes/(double)nReceived);
+    streamId = streams_[current_].id_;
+}
+
+void
+RateAdaptationModule::setStreamId(unsigned int streamId)
+{
+    for (size_t idx = 0; idx < streams_.size(); ++idx)
+        if (streams_[idx].id_ == streamId)
+        {
+            if (idx != current_)
+            {
+                current_ = idx;
+                lastSwitchMs_ = interval_.startMs_;
+            }
+            break;
+        }
+}
+
+#pragma mark - private
+double
+RateAdaptationModule::requiredBandwidth(size_t idx) const
+{
+    return streams_[idx].bitrate_*(1+streams_[idx].parityRatio_)/settings_.margin_;
+}
+
+void
+RateAdaptationModule::updateEstimation(int64_t timestampMs)
+{
+    if (interval_.startMs_ < 0)
+    {
+        // first call - start measuring from now
+        interval_ = {timestampMs, -1, 0, 0, 0};
+        lastSwitchMs_ = lastCongestionMs_ = timestampMs;
+        return;
+    }
+
+    interval_.endMs_ = timestampMs;
+    window_.push_back(interval_);
+    interval_ = {timestampMs, -1, 0, 0, 0};
+
+    while (window_.size() > 1 &&
+           timestampMs - window_[1].startMs_ >= settings_.windowMs_)
+        window_.pop_front();
+
+    uint64_t bytes = 0;
+    unsigned int nReceived = 0, nLost = 0;
+    for (auto& i:window_)
+    {
+        bytes += i.bytes_;
+        nReceived += i.nReceived_;
+        nLost += i.nLost_;
+    }
+
+    int64_t spanMs = timestampMs - window_.front().startMs_;
+
+    // bytes per millisecond * 8 gives Kbit/s
+    bandwidth_ = (spanMs >= settings_.windowMs_ ? (double)bytes*8./(double)spanMs : 0);
+    isCongested_ = (spanMs >= settings_.windowMs_/2) &&
+        ((nReceived + nLost && (double)nLost/(double)(nReceived + nLost) > settings_.lossRatio_) ||
+         (minRtt_ && rtt_ > settings_.rttRatio_*minRtt_));
+}
+
+void
+RateAdaptationModule::adapt(int64_t timestampMs)
+{
+    if (isCongested_)
+    {
+        lastCongestionMs_ = timestampMs;
+
+        if (current_ > 0 && timestampMs - lastSwitchMs_ >= settings_.downHoldMs_)
+        {
+            size_t fit = 0;
+            for (size_t idx = 1; idx < current_; ++idx)
+                if (requiredBandwidth(idx) <= bandwidth_)
+                    fit = idx;
+
+            // probing up failed - wait longer before next probe
+            if (lastUpMs_ >= 0 && timestampMs - lastUpMs_ < upHoldMs_)
+                upHoldMs_ = std::min(2*upHoldMs_, settings_.maxUpHoldMs_);
+
+            current_ = fit;
+            lastSwitchMs_ = timestampMs;
+
+            // losses, that made module step down, should not make it
+            // step down again
+            for (auto& i:window_) i.nLost_ = 0;
+        }
+    }
+    else if (current_+1 < streams_.size() && bandwidth_ > 0 &&
+             timestampMs - lastCongestionMs_ >= upHoldMs_ &&
+             timestampMs - lastSwitchMs_ >= upHoldMs_)
+    {
+        // previous probe held up - no congestion since then
+        if (lastUpMs_ >= 0 && lastCongestionMs_ < lastUpMs_)
+            upHoldMs_ = settings_.upHoldMs_;
+
+        current_++;
+        lastSwitchMs_ = lastUpMs_ = timestampMs;
+    }
+}
+
+//******************************************************************************
+RateAdaptationControl::RateAdaptationControl(boost::asio::io_service& io,
+                                             const std::shared_ptr<RateAdaptationModule>& module,
+                                             const std::shared_ptr<DrdEstimator>& drdEstimator,
+                                             const std::shared_ptr<StatisticsStorage>& storage,
+                                             unsigned int updateIntervalMs):
+Periodic(io),
+module_(module),
+drdEstimator_(drdEstimator),
+sstorage_(storage),
+updateIntervalMs_(updateIntervalMs),
+streamId_(0), requestedId_(0)
+{
+    description_ = "rate-adaptation";
+}
+
+RateAdaptationControl::~RateAdaptationControl()
+{
+    stop();
+}
+
+void
+RateAdaptationControl::start(unsigned int streamId, OnSwitchRequired onSwitchRequired)
+{
+    streamId_ = requestedId_ = streamId;
+    module_->setStreamId(streamId);
+    onSwitchRequired_ = onSwitchRequired;
+    setupInvocation(updateIntervalMs_, std::bind(&RateAdaptationControl::update, this));
+
+    LogInfoC << "started from stream " << streamId << std::endl;
+}
+
+void
+RateAdaptationControl::stop()
+{
+    if (isPeriodicInvocationSet())
+    {
+        cancelInvocation();
+        LogInfoC << "stopped" << std::endl;
+    }
+}
+
+void
+RateAdaptationControl::setStreamId(unsigned int streamId)
+{
+    // stream was switched not upon module's recommendation
+    if (streamId != requestedId_)
+    {
+        module_->setStreamId(streamId);
+        requestedId_ = streamId;
+    }
+    streamId_ = streamId;
+}
+
+void
+RateAdaptationControl::segmentArrived(const std::shared_ptr<WireSegment>& segment)
+{
+    // module does not need full data names, thread name identifies stream
+    module_->dataReceived(segment->getThreadName(), streamId_,
+                          segment->getData()->getDefaultWireEncoding().size(),
+                          drdEstimator_->getOriginalEstimation(), 0);
+}
+
+void
+RateAdaptationControl::segmentRequestTimeout(const NameHandle& handle,
+                                             const std::shared_ptr<const ndn::Interest>&)
+{
+    module_->interestTimeout(handle.getThreadName(), streamId_);
+}
+
+void
+RateAdaptationControl::segmentNack(const NameHandle& handle, int,
+                                   const std::shared_ptr<const ndn::Interest>&)
+{
+    module_->interestTimeout(handle.getThreadName(), streamId_);
+}
+
+#pragma mark - private
+unsigned int
+RateAdaptationControl::update()
+{
+    double interestRate;
+    unsigned int streamId;
+
+    module_->getInterestRate(clock::millisecondTimestamp(), interestRate, streamId);
+    (*sstorage_)[Indicator::BandwidthEstimation] = module_->getBandwidthEstimation();
+
+    if (streamId != requestedId_)
+    {
+        // module steps down only upon congestion
+        bool isDown = module_->isCongested();
+
+        LogInfoC << "switch " << (isDown ? "down" : "up") << " to stream " << streamId
+                 << " (estimated " << module_->getBandwidthEstimation() << " Kbit/s)" << std::endl;
+
+        (*sstorage_)[(isDown ? Indicator::ThreadSwitchDownNum : Indicator::ThreadSwitchUpNum)]++;
+        requestedId_ = streamId;
+        if (onSwitchRequired_) onSwitchRequired_(streamId);
+    }
+
+    return updateIntervalMs_;
+}
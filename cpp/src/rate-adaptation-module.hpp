@@ -12,8 +12,14 @@
 #define ndnrtc_rate_adaptation_module_h
 
 #include <string>
+#include <deque>
+#include <vector>
 #include <stdint.h>
 
+#include "ndnrtc-object.hpp"
+#include "periodic.hpp"
+#include "segment-controller.hpp"
+
 namespace ndnrtc {
     
     /**
@@ -97,6 +103,146 @@ namespace ndnrtc {
                                      double& interestRate,
                                      unsigned int& streamId) = 0;
     };
+
+    namespace statistics {
+        class StatisticsStorage;
+    }
+
+    class DrdEstimator;
+
+    /**
+     * Throughput-based rate adaptation module for switching between producer's
+     * simulcast threads on the consumer side.
+     * Throughput is measured as the amount of data received between
+     * consecutive getInterestRate() calls and averaged over a sliding window.
+     * Congestion is detected when the share of timed out (or retransmitted)
+     * Interests in the window exceeds a threshold or when smoothed RTT grows
+     * well above the minimal RTT observed. Upon congestion, module steps down
+     * immediately to the stream that fits into measured throughput (at least
+     * one stream lower). As received throughput is capped by the bitrate of
+     * the stream being fetched, it can't tell whether a higher stream fits;
+     * thus module probes one stream up after a congestion-free hold period.
+     * If probe ends up in congestion soon after, hold period is doubled, so
+     * failed probes become rare.
+     * Only CodecModeNormal (simulcast) is supported.
+     * Module is not thread-safe.
+     */
+    class RateAdaptationModule : public IRateAdaptationModule {
+    public:
+        typedef struct _Settings {
+            unsigned int windowMs_;       // throughput averaging window
+            unsigned int upHoldMs_;       // congestion-free period before probing up
+            unsigned int maxUpHoldMs_;    // limit for up hold period backoff
+            unsigned int downHoldMs_;     // minimal interval between switches down
+            double margin_;               // share of throughput streams may take
+            double lossRatio_;            // share of lost Interests meaning congestion
+            double rttRatio_;             // RTT growth over min RTT meaning congestion
+        } Settings;
+
+        static const Settings DefaultSettings;
+
+        RateAdaptationModule(const Settings& settings = DefaultSettings);
+
+        int initialize(const CodecMode& codecMode,
+                       uint32_t nStreams,
+                       StreamEntry* streamArray);
+        void interestExpressed(const std::string &name,
+                               unsigned int streamId);
+        void interestTimeout(const std::string &name,
+                             unsigned int streamId);
+        void dataReceived(const std::string &name,
+                          unsigned int streamId,
+                          unsigned int dataSize,
+                          double rttMs,
+                          unsigned int nRtx);
+        void getInterestRate(int64_t timestampMs,
+                             double& interestRate,
+                             unsigned int& streamId);
+
+        /**
+         * Sets stream currently fetched by consumer (i.e. if stream was
+         * chosen by user). Module continues adaptation from this stream.
+         */
+        void setStreamId(unsigned int streamId);
+
+        /**
+         * Returns estimated throughput in Kbit/s or 0 if window is not
+         * filled up yet.
+         */
+        double getBandwidthEstimation() const { return bandwidth_; }
+        bool isCongested() const { return isCongested_; }
+
+    private:
+        typedef struct _Interval {
+            int64_t startMs_, endMs_;
+            uint64_t bytes_;
+            unsigned int nReceived_, nLost_;
+        } Interval;
+
+        Settings settings_;
+        std::vector<StreamEntry> streams_; // sorted by bitrate, ascending
+        size_t current_;
+        std::deque<Interval> window_;
+        Interval interval_;
+        double bandwidth_, rtt_, minRtt_;
+        bool isCongested_;
+        int64_t lastSwitchMs_, lastUpMs_, lastCongestionMs_;
+        unsigned int upHoldMs_;
+
+        double requiredBandwidth(size_t idx) const;
+        void updateEstimation(int64_t timestampMs);
+        void adapt(int64_t timestampMs);
+    };
+
+    /**
+     * RateAdaptationControl feeds rate adaptation module with the events of
+     * remote video stream's SegmentController and DRD estimations and
+     * periodically queries module for recommended stream. Whenever it differs
+     * from the stream being fetched, supplied callback is called (once per
+     * decision) - actual switching is up to the callback's implementation
+     * which should call setStreamId() once switch is completed.
+     * Estimated bandwidth and switch decisions are reported to statistics.
+     */
+    class RateAdaptationControl : public NdnRtcComponent,
+                                  public ISegmentControllerObserver,
+                                  private Periodic
+    {
+    public:
+        typedef std::function<void(unsigned int streamId)> OnSwitchRequired;
+
+        RateAdaptationControl(boost::asio::io_service& io,
+                              const std::shared_ptr<RateAdaptationModule>& module,
+                              const std::shared_ptr<DrdEstimator>& drdEstimator,
+                              const std::shared_ptr<statistics::StatisticsStorage>& storage,
+                              unsigned int updateIntervalMs = 50);
+        ~RateAdaptationControl();
+
+        void start(unsigned int streamId, OnSwitchRequired onSwitchRequired);
+        void stop();
+        bool isRunning() const { return isPeriodicInvocationSet(); }
+
+        /**
+         * Sets stream, which is currently fetched.
+         */
+        void setStreamId(unsigned int streamId);
+        unsigned int getStreamId() const { return streamId_; }
+
+        void segmentArrived(const std::shared_ptr<WireSegment> &);
+        void segmentRequestTimeout(const NameHandle &,
+                                   const std::shared_ptr<const ndn::Interest> &);
+        void segmentNack(const NameHandle &, int,
+                         const std::shared_ptr<const ndn::Interest> &);
+        void segmentStarvation() {}
+
+    private:
+        std::shared_ptr<RateAdaptationModule> module_;
+        std::shared_ptr<DrdEstimator> drdEstimator_;
+        std::shared_ptr<statistics::StatisticsStorage> sstorage_;
+        unsigned int updateIntervalMs_, streamId_, requestedId_;
+        OnSwitchRequired onSwitchRequired_;
+
+        unsigned int update();
+    };
 }
 
 #endif
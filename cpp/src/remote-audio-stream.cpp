@@ -38,7 +38,7 @@ RemoteAudioStreamImpl::RemoteAudioStreamImpl(boost::asio::io_service &io,
 
     pipeliner_ = std::make_shared<Pipeliner>(pps,
                                                std::make_shared<Pipeliner::AudioNameScheme>());
-    validator_ = std::make_shared<SampleValidator>(keyChain, sstorage_);
+    validator_ = std::make_shared<AudioManifestValidator>(face, keyChain, sstorage_);
     buffer_->attach(validator_.get());
 }
 
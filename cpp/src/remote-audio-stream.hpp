@@ -12,7 +12,7 @@
 
 namespace ndnrtc
 {
-class SampleValidator;
+class AudioManifestValidator;
 
 class RemoteAudioStreamImpl : public RemoteStreamImpl
 {
@@ -29,7 +29,7 @@ class RemoteAudioStreamImpl : public RemoteStreamImpl
 
   private:
     boost::asio::io_service &io_;
-    std::shared_ptr<SampleValidator> validator_;
+    std::shared_ptr<AudioManifestValidator> validator_;
 
     void setupPlayout();
     void releasePlayout();
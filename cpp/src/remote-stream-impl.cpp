@@ -55,7 +55,7 @@ RemoteStreamImpl::RemoteStreamImpl(boost::asio::io_service &io,
     segmentController_ = std::make_shared<SegmentController>(io, 500, sstorage_);
     buffer_ = std::make_shared<Buffer>(sstorage_, std::make_shared<SlotPool>(500));
     playbackQueue_ = std::make_shared<PlaybackQueue>(Name(streamPrefix), std::dynamic_pointer_cast<Buffer>(buffer_));
-    rtxController_ = std::make_shared<RetransmissionController>(sstorage_, playbackQueue_, drdEstimator_);
+    rtxController_ = std::make_shared<RetransmissionController>(io, sstorage_, playbackQueue_, drdEstimator_);
     buffer_->attach(rtxController_.get());
     // playout and playout-control created in subclasses
 
@@ -105,7 +105,38 @@ void RemoteStreamImpl::start(const std::string &threadName)
 
 void RemoteStreamImpl::setThread(const std::string &threadName)
 {
-    threadName_ = threadName;
+    if (!isRunning_)
+    {
+        threadName_ = threadName;
+        return;
+    }
+
+    std::shared_ptr<RemoteStreamImpl> me = std::dynamic_pointer_cast<RemoteStreamImpl>(shared_from_this());
+    async::dispatchAsync(io_, [me, threadName, this]() {
+        if (!isRunning_ || threadName == threadName_)
+            return;
+
+        if (threadsMeta_.find(threadName) == threadsMeta_.end())
+        {
+            LogWarnC << "can't switch to unknown thread " << threadName << std::endl;
+            return;
+        }
+
+        if (switchThreadName_ != "")
+        {
+            LogWarnC << "can't switch to " << threadName << " - switching to "
+                     << switchThreadName_ << " is in progress" << std::endl;
+            return;
+        }
+
+        LogInfoC << "switching from thread " << threadName_
+                 << " to " << threadName << std::endl;
+
+        // switch starts from the next key frame of the new thread, thus
+        // its fresh metadata is needed
+        switchThreadName_ = threadName;
+        fetchThreadMeta(threadName, clock::millisecondTimestamp());
+    });
 }
 
 void RemoteStreamImpl::stop()
@@ -240,7 +271,8 @@ void RemoteStreamImpl::fetchThreadMeta(const std::string &threadName, const int6
                         },
                         [me, threadName, this](const std::string &msg) {
                             LogWarnC << "error fetching thread meta: " << msg << std::endl;
-                            if (needMeta_ && !metaFetcher_->hasPendingRequest())
+                            if ((needMeta_ || threadName == switchThreadName_) &&
+                                !metaFetcher_->hasPendingRequest())
                                 me->fetchThreadMeta(threadName, clock::millisecondTimestamp());
                         });
 }
@@ -260,6 +292,9 @@ void RemoteStreamImpl::threadMetaFetched(const std::string &thread, NetworkData
         if (cuedToRun_ && !isRunning_)
             initiateFetching();
     }
+
+    if (isRunning_ && thread == switchThreadName_)
+        switchThread(thread);
 }
 
 void RemoteStreamImpl::initiateFetching()
@@ -294,9 +329,29 @@ void RemoteStreamImpl::stopFetching()
         interestQueue_->reset();
         isRunning_ = false;
         needMeta_ = false;
+        switchThreadName_ = "";
     }
 }
 
+void RemoteStreamImpl::switchThread(const std::string &threadName)
+{
+    // by default, fetching is restarted on the new thread
+    stopFetching();
+    threadName_ = threadName;
+    initiateFetching();
+    threadSwitched(threadName);
+}
+
+void RemoteStreamImpl::threadSwitched(const std::string &threadName)
+{
+    LogInfoC << "switched to thread " << threadName << std::endl;
+
+    threadName_ = threadName;
+    switchThreadName_ = "";
+    (*sstorage_)[Indicator::ThreadSwitchedNum]++;
+    notifyObservers(RemoteStream::Event::ThreadSwitched);
+}
+
 void RemoteStreamImpl::addValidationInfo(const std::vector<ValidationErrorInfo> &validationInfo)
 {
     for (auto &vi : validationInfo)
@@ -81,7 +81,7 @@ class RemoteStreamImpl : public NdnRtcComponent
     std::shared_ptr<ndn::Face> face_;
     std::shared_ptr<ndn::KeyChain> keyChain_;
     ndn::Name streamPrefix_;
-    std::string threadName_;
+    std::string threadName_, switchThreadName_;
     std::shared_ptr<statistics::StatisticsStorage> sstorage_;
 
     std::vector<IRemoteStreamObserver *> observers_;
@@ -111,6 +111,8 @@ class RemoteStreamImpl : public NdnRtcComponent
     void threadMetaFetched(const std::string &thread, NetworkData &);
     virtual void initiateFetching();
     virtual void stopFetching();
+    virtual void switchThread(const std::string &threadName);
+    void threadSwitched(const std::string &threadName);
     void addValidationInfo(const std::vector<ValidationErrorInfo> &);
     void notifyObservers(RemoteStream::Event ev);
 };
@@ -158,3 +158,15 @@ RemoteVideoStream::start(const std::string& threadName, IExternalRenderer* rende
 {
 	std::dynamic_pointer_cast<RemoteVideoStreamImpl>(pimpl_)->start(threadName, renderer);
 }
+
+void
+RemoteVideoStream::start(const std::string& threadName, IExternalPlanarRenderer* renderer)
+{
+	std::dynamic_pointer_cast<RemoteVideoStreamImpl>(pimpl_)->start(threadName, renderer);
+}
+
+void
+RemoteVideoStream::setRateAdaptation(bool enabled)
+{
+	std::dynamic_pointer_cast<RemoteVideoStreamImpl>(pimpl_)->setRateAdaptation(enabled);
+}
@@ -6,6 +6,7 @@
 //
 
 #include "remote-video-stream.hpp"
+#include <algorithm>
 #include <ndn-cpp/name.hpp>
 #include <webrtc/common_video/libyuv/include/webrtc_libyuv.h>
 
@@ -18,6 +19,9 @@
 #include "playout-control.hpp"
 #include "sample-validator.hpp"
 #include "video-decoder.hpp"
+#include "rate-adaptation-module.hpp"
+#include "frame-buffer.hpp"
+#include "async.hpp"
 #include "clock.hpp"
 
 using namespace ndnrtc;
@@ -28,7 +32,9 @@ RemoteVideoStreamImpl::RemoteVideoStreamImpl(boost::asio::io_service &io,
                                              const std::shared_ptr<ndn::Face> &face,
                                              const std::shared_ptr<ndn::KeyChain> &keyChain,
                                              const std::string &streamPrefix) 
-    : RemoteStreamImpl(io, face, keyChain, streamPrefix)
+    : RemoteStreamImpl(io, face, keyChain, streamPrefix),
+      renderer_(nullptr), planarRenderer_(nullptr),
+      rateAdaptationEnabled_(false)
 {
     type_ = MediaStreamParams::MediaStreamType::MediaStreamTypeVideo;
 
@@ -51,6 +57,9 @@ RemoteVideoStreamImpl::RemoteVideoStreamImpl(boost::asio::io_service &io,
 
     validator_ = std::make_shared<ManifestValidator>(face, keyChain, sstorage_);
     buffer_->attach(validator_.get());
+
+    rateModule_ = std::make_shared<RateAdaptationModule>();
+    rateControl_ = std::make_shared<RateAdaptationControl>(io, rateModule_, drdEstimator_, sstorage_);
 }
 
 RemoteVideoStreamImpl::~RemoteVideoStreamImpl()
@@ -63,6 +72,16 @@ void RemoteVideoStreamImpl::start(const std::string &threadName,
 {
     assert(renderer);
     renderer_ = renderer;
+    planarRenderer_ = nullptr;
+    RemoteStreamImpl::start(threadName);
+}
+
+void RemoteVideoStreamImpl::start(const std::string &threadName,
+                                  IExternalPlanarRenderer *renderer)
+{
+    assert(renderer);
+    renderer_ = nullptr;
+    planarRenderer_ = renderer;
     RemoteStreamImpl::start(threadName);
 }
 
@@ -73,10 +92,14 @@ void RemoteVideoStreamImpl::initiateFetching()
     setupDecoder();
     setupPipelineControl();
     pipelineControl_->start();
+
+    if (rateAdaptationEnabled_)
+        setupRateAdaptation();
 }
 
 void RemoteVideoStreamImpl::stopFetching()
 {
+    releaseRateAdaptation();
     RemoteStreamImpl::stopFetching();
 
     releasePipelineControl();
@@ -89,11 +112,42 @@ void RemoteVideoStreamImpl::setLogger(std::shared_ptr<ndnlog::new_api::Logger> l
     validator_->setLogger(logger);
     std::dynamic_pointer_cast<NdnRtcComponent>(playoutControl_)->setLogger(logger);
     std::dynamic_pointer_cast<Playout>(playout_)->setLogger(logger);
+    rateControl_->setLogger(logger);
+}
+
+void RemoteVideoStreamImpl::setRateAdaptation(bool enabled)
+{
+    std::shared_ptr<RemoteVideoStreamImpl> me = std::dynamic_pointer_cast<RemoteVideoStreamImpl>(shared_from_this());
+    async::dispatchAsync(io_, [me, enabled, this]() {
+        if (enabled == rateAdaptationEnabled_)
+            return;
+
+        rateAdaptationEnabled_ = enabled;
+        if (isRunning_)
+        {
+            if (enabled)
+                setupRateAdaptation();
+            else
+                releaseRateAdaptation();
+        }
+    });
 }
 
 #pragma mark private
 void RemoteVideoStreamImpl::feedFrame(const FrameInfo &frameInfo, const WebRtcVideoFrame &frame)
 {
+    if (planarRenderer_)
+    {
+        // decoder's buffer is passed as is, no copy or conversion
+        WebRtcSmartPtr<webrtc::VideoFrameBuffer> buffer = frame.video_frame_buffer();
+
+        LogTraceC << "passing frame " << frameInfo.playbackNo_ << "p to renderer (I420)" << std::endl;
+        planarRenderer_->renderI420Frame(frameInfo, buffer->width(), buffer->height(),
+                                         buffer->StrideY(), buffer->StrideU(), buffer->StrideV(),
+                                         buffer->DataY(), buffer->DataU(), buffer->DataV());
+        return;
+    }
+
     uint8_t *rgbFrameBuffer = renderer_->getFrameBuffer(frame.width(),
                                                         frame.height());
 
@@ -109,16 +163,81 @@ void RemoteVideoStreamImpl::feedFrame(const FrameInfo &frameInfo, const WebRtcVi
         LogTraceC << "renderer is busy." << std::endl;
 }
 
+void RemoteVideoStreamImpl::switchThread(const std::string &threadName)
+{
+    VideoThreadMeta meta(threadsMeta_[threadName]->data());
+    Name threadPrefix(getStreamPrefix());
+    threadPrefix.append(threadName);
+
+    // the new thread is played from its next key frame, current thread is
+    // played up to it, so there is no gap in playback
+    pipelineControl_->switchThread(threadPrefix, meta.getSeqNo().second + 1,
+                                   [this, threadName](const Name &threadPrefix, PacketNumber playbackNo) {
+                                       std::dynamic_pointer_cast<PlaybackQueue>(playbackQueue_)->switchThread(threadPrefix, playbackNo);
+                                       threadSwitched(threadName);
+
+                                       if (rateControl_->isRunning())
+                                       {
+                                           std::vector<std::string>::iterator it = std::find(rateThreads_.begin(), rateThreads_.end(), threadName);
+                                           if (it != rateThreads_.end())
+                                               rateControl_->setStreamId(it - rateThreads_.begin());
+                                       }
+                                   });
+}
+
+void RemoteVideoStreamImpl::setupRateAdaptation()
+{
+    std::vector<StreamEntry> streams;
+    unsigned int currentId = 0;
+
+    rateThreads_.clear();
+    for (auto &t : threadsMeta_)
+    {
+        VideoThreadMeta meta(t.second->data());
+        StreamEntry entry = {(unsigned int)rateThreads_.size(),
+                             (double)meta.getCoderParams().startBitrate_,
+                             meta.getParityRatio().first};
+
+        if (t.first == threadName_)
+            currentId = entry.id_;
+        streams.push_back(entry);
+        rateThreads_.push_back(t.first);
+    }
+
+    if (rateModule_->initialize(CodecModeNormal, streams.size(), streams.data()) != 0)
+    {
+        LogWarnC << "failed to initialize rate adaptation" << std::endl;
+        return;
+    }
+
+    segmentController_->attach(rateControl_.get());
+    rateControl_->start(currentId, [this](unsigned int streamId) {
+        setThread(rateThreads_[streamId]);
+    });
+}
+
+void RemoteVideoStreamImpl::releaseRateAdaptation()
+{
+    if (rateControl_->isRunning())
+    {
+        rateControl_->stop();
+        segmentController_->detach(rateControl_.get());
+    }
+}
+
 void RemoteVideoStreamImpl::setupDecoder()
 {
     std::shared_ptr<RemoteVideoStreamImpl> me = std::dynamic_pointer_cast<RemoteVideoStreamImpl>(shared_from_this());
     VideoThreadMeta meta(threadsMeta_[threadName_]->data());
-    std::shared_ptr<VideoDecoder> decoder =
-        std::make_shared<VideoDecoder>(meta.getCoderParams(),
+    // frames are decoded and passed to renderer on decoder pool threads
+    std::shared_ptr<AsyncDecoder> decoder =
+        std::make_shared<AsyncDecoder>(meta.getCoderParams(),
                                          [this, me](const FrameInfo& finfo, const WebRtcVideoFrame &frame) 
                                          {
                                             feedFrame(finfo, frame);
-                                         });
+                                         },
+                                         sstorage_);
+    decoder->setLogger(logger_);
     std::dynamic_pointer_cast<VideoPlayout>(playout_)->registerFrameConsumer(decoder.get());
     decoder_ = decoder;
 }
@@ -126,6 +245,7 @@ void RemoteVideoStreamImpl::setupDecoder()
 void RemoteVideoStreamImpl::releaseDecoder()
 {
     dynamic_pointer_cast<VideoPlayout>(playout_)->deregisterFrameConsumer();
+    decoder_->stop();
     decoder_.reset();
 }
 
@@ -19,8 +19,11 @@ class IPlayoutControl;
 class VideoPlayout;
 class PipelineControl;
 class ManifestValidator;
-class VideoDecoder;
+class AsyncDecoder;
+class RateAdaptationModule;
+class RateAdaptationControl;
 class IExternalRenderer;
+class IExternalPlanarRenderer;
 
 class RemoteVideoStreamImpl : public RemoteStreamImpl
 {
@@ -32,14 +35,27 @@ class RemoteVideoStreamImpl : public RemoteStreamImpl
     ~RemoteVideoStreamImpl();
 
     void start(const std::string &threadName, IExternalRenderer *render);
+    void start(const std::string &threadName, IExternalPlanarRenderer *render);
     void initiateFetching();
     void stopFetching();
     void setLogger(std::shared_ptr<ndnlog::new_api::Logger> logger);
 
+    void setRateAdaptation(bool enabled);
+    bool isRateAdaptationEnabled() const { return rateAdaptationEnabled_; }
+
   private:
     std::shared_ptr<ManifestValidator> validator_;
     IExternalRenderer *renderer_;
-    std::shared_ptr<VideoDecoder> decoder_;
+    IExternalPlanarRenderer *planarRenderer_;
+    std::shared_ptr<AsyncDecoder> decoder_;
+    bool rateAdaptationEnabled_;
+    std::shared_ptr<RateAdaptationModule> rateModule_;
+    std::shared_ptr<RateAdaptationControl> rateControl_;
+    std::vector<std::string> rateThreads_; // stream ids for rate adaptation
+
+    void switchThread(const std::string &threadName);
+    void setupRateAdaptation();
+    void releaseRateAdaptation();
 
     void feedFrame(const FrameInfo&, const WebRtcVideoFrame &);
     void setupDecoder();
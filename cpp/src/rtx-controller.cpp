@@ -18,15 +18,18 @@ using namespace std;
 using namespace ndnrtc;
 using namespace ndnrtc::statistics;
 
-#define RTX_DEADLINE_MS 100
+const unsigned int RetransmissionController::MaxSegmentRtx = 2;
 
-RetransmissionController::RetransmissionController(std::shared_ptr<statistics::StatisticsStorage> storage,
+RetransmissionController::RetransmissionController(boost::asio::io_service &io,
+                                                   std::shared_ptr<statistics::StatisticsStorage> storage,
                                                    std::shared_ptr<IPlaybackQueue> playbackQueue,
                                                    const std::shared_ptr<DrdEstimator> &drdEstimator)
     : StatObject(storage),
+      Periodic(io),
       playbackQueue_(playbackQueue),
       drdEstimator_(drdEstimator),
-      enabled_(false)
+      enabled_(false),
+      timerFireTimestamp_(0)
 {
     description_ = "rtx-controller";
 }
@@ -48,6 +51,9 @@ void RetransmissionController::detach(IRtxObserver *observer)
 void RetransmissionController::setEnabled(bool enable)
 {
     enabled_ = enable;
+    if (!enabled_)
+        onReset();
+
     LogTraceC << (enabled_ ? "enabled" : "disabled") << std::endl;
 }
 
@@ -56,58 +62,112 @@ void RetransmissionController::onNewRequest(const std::shared_ptr<BufferSlot> &s
     if (!enabled_)
         return;
 
-    if (activeSlots_.find(slot->getPrefix()) != activeSlots_.end())
-        throw std::runtime_error("slot is being tracked already");
-
     int64_t now = clock::millisecondTimestamp();
     int64_t queueSize = playbackQueue_->size() + playbackQueue_->pendingSize();
     // for key frames playback delay will be GOP milliseconds from now
     // NOTE: gop is assumed as 30 below. probably need to be changed to adequate number
     int64_t playbackDeadline = (slot->getNameInfo().class_ == SampleClass::Key ? now + playbackQueue_->samplePeriod() * 30 : now + queueSize);
 
-    activeSlots_[slot->getPrefix()] = {slot, playbackDeadline};
-
-    checkRetransmissions();
+    activeSlots_.push({playbackDeadline, playbackDeadline, slot, slot->getKey(), 0});
+    scheduleCheck();
 }
 
 void RetransmissionController::onNewData(const BufferReceipt &receipt)
 {
-    if (enabled_)
+    // timer is armed with DRD known at the time; if DRD has grown since,
+    // earliest sample may be due already
+    if (enabled_ && !activeSlots_.empty() &&
+        activeSlots_.top().deadlineTimestamp_ - clock::millisecondTimestamp() < getRtxLeadTime())
+    {
         checkRetransmissions();
+        scheduleCheck();
+    }
 }
 
 void RetransmissionController::onReset()
 {
-    activeSlots_.clear();
+    activeSlots_ = decltype(activeSlots_)();
+    cancelInvocation();
+    timerFireTimestamp_ = 0;
 }
 
-void RetransmissionController::checkRetransmissions()
+unsigned int RetransmissionController::checkRetransmissions()
 {
     int64_t now = clock::millisecondTimestamp();
+    int64_t leadTime = getRtxLeadTime();
 
-    for (auto it = activeSlots_.begin(); it != activeSlots_.end(); /* no increment */)
+    while (!activeSlots_.empty())
     {
-        std::shared_ptr<BufferSlot> slot = it->second.slot_;
-        int64_t playbackDeadline = it->second.deadlineTimestamp_;
-        bool needRtx = (playbackDeadline - now < drdEstimator_->getOriginalAverage().latestValue());
-        bool assembledOrCleared = (slot->getState() >= BufferSlot::State::Ready || slot->getState() == BufferSlot::State::Free);
+        if (!isActive(activeSlots_.top()))
+        {
+            activeSlots_.pop();
+            continue;
+        }
 
-        if (needRtx || assembledOrCleared)
+        if (activeSlots_.top().deadlineTimestamp_ - now >= leadTime)
+            break;
+
+        ActiveSlotEntry entry = activeSlots_.top();
+        activeSlots_.pop();
+
+        std::vector<std::shared_ptr<const ndn::Interest>> interests =
+            entry.slot_->getRecoveryInterests(MaxSegmentRtx);
+
+        LogTraceC << "rtx required " << entry.slot_->dump()
+                  << " playback in " << entry.playbackTimestamp_ - now << "ms"
+                  << " x" << interests.size() << std::endl;
+
+        if (interests.size())
         {
-            activeSlots_.erase(it++);
+            (*statStorage_)[Indicator::RtxNum] += interests.size();
+            for (auto o : observers_)
+                o->onRetransmissionRequired(interests);
 
-            if (needRtx && !assembledOrCleared)
+            // check again once retransmitted Interests had time to return
+            if (++entry.nRtx_ < MaxSegmentRtx)
             {
-                LogTraceC << "rtx required " << slot->dump()
-                          << " playback in " << playbackDeadline - now << "ms" << std::endl;
-
-                std::vector<std::shared_ptr<const ndn::Interest>> pendingInterests = slot->getPendingInterests();
-                if (pendingInterests.size())
-                    for (auto o : observers_)
-                        o->onRetransmissionRequired(pendingInterests);
+                entry.deadlineTimestamp_ = now + 2 * leadTime;
+                activeSlots_.push(entry);
             }
         }
-        else
-            ++it;
     }
+
+    if (activeSlots_.empty())
+        return 0;
+    return (unsigned int)std::max<int64_t>(1, activeSlots_.top().deadlineTimestamp_ - leadTime - now);
+}
+
+void RetransmissionController::scheduleCheck()
+{
+    if (activeSlots_.empty())
+        return;
+
+    int64_t now = clock::millisecondTimestamp();
+    int64_t fireTimestamp = std::max(now + 1, activeSlots_.top().deadlineTimestamp_ - getRtxLeadTime());
+
+    if (isPeriodicInvocationSet())
+    {
+        if (timerFireTimestamp_ <= fireTimestamp)
+            return;
+        cancelInvocation();
+    }
+
+    timerFireTimestamp_ = fireTimestamp;
+    setupInvocation((unsigned int)(fireTimestamp - now), [this]() {
+        unsigned int nextCheckMs = checkRetransmissions();
+        timerFireTimestamp_ = (nextCheckMs ? clock::millisecondTimestamp() + nextCheckMs : 0);
+        return nextCheckMs;
+    });
+}
+
+bool RetransmissionController::isActive(const ActiveSlotEntry &entry) const
+{
+    return entry.slot_->getKey() == entry.key_ &&
+           entry.slot_->getState() != BufferSlot::State::Free &&
+           entry.slot_->getState() < BufferSlot::State::Ready;
+}
+
+int64_t RetransmissionController::getRtxLeadTime() const
+{
+    return (int64_t)drdEstimator_->getOriginalEstimation();
 }
@@ -11,8 +11,12 @@
 #ifndef __rtx_controller_h__
 #define __rtx_controller_h__
 
+#include <queue>
+#include <boost/asio.hpp>
 #include <ndn-cpp/name.hpp>
+
 #include "frame-buffer.hpp"
+#include "periodic.hpp"
 #include "statistics.hpp"
 
 namespace ndnrtc
@@ -21,12 +25,34 @@ class IPlaybackQueue;
 class IRtxObserver;
 class DrdEstimator;
 
+/**
+ * Retransmission controller keeps track of requested samples and asks its
+ * observers to re-express pending Interests of a sample when sample's
+ * playback deadline is closer than one original DRD away. If the sample is
+ * still incomplete one DRD after a retransmission, it is retransmitted
+ * again.
+ * Tracked samples are kept in a min-heap ordered by playback deadline; a
+ * single timer is armed for the earliest deadline minus DRD, thus incoming
+ * data costs nothing unless the earliest sample is due. Samples which
+ * were assembled or released by the buffer in the meantime are dropped
+ * from the heap lazily, once they reach the top.
+ * Only segments that are needed for the sample recovery are retransmitted:
+ * if FEC can recover the frame from what has arrived, nothing is
+ * requested; otherwise, only as many pending segments as are missing,
+ * each retransmitted at most MaxSegmentRtx times (sample is dropped from
+ * the heap after MaxSegmentRtx retransmissions).
+ * All calls are expected on the io_service thread.
+ */
 class RetransmissionController : public NdnRtcComponent,
                                  public IBufferObserver,
-                                 public statistics::StatObject
+                                 public statistics::StatObject,
+                                 private Periodic
 {
   public:
-    RetransmissionController(std::shared_ptr<statistics::StatisticsStorage> storage,
+    static const unsigned int MaxSegmentRtx;
+
+    RetransmissionController(boost::asio::io_service &io,
+                             std::shared_ptr<statistics::StatisticsStorage> storage,
                              std::shared_ptr<IPlaybackQueue> playbackQueue,
                              const std::shared_ptr<DrdEstimator> &drdEstimator);
 
@@ -37,19 +63,35 @@ class RetransmissionController : public NdnRtcComponent,
     bool isEnabled() { return enabled_; }
 
   private:
-    typedef struct _ActiveSlotListEntry
+    typedef struct _ActiveSlotEntry
     {
-        std::shared_ptr<BufferSlot> slot_;
+        // retransmission is due one DRD before this time: sample's playback
+        // deadline at first, then two DRDs after the last retransmission
         int64_t deadlineTimestamp_;
-    } ActiveSlotListEntry;
+        int64_t playbackTimestamp_;
+        std::shared_ptr<BufferSlot> slot_;
+        // slots are pooled, key tells whether slot still holds the sample
+        SampleKey key_;
+        unsigned int nRtx_;
+
+        bool operator>(const struct _ActiveSlotEntry &e) const
+        {
+            return deadlineTimestamp_ > e.deadlineTimestamp_;
+        }
+    } ActiveSlotEntry;
 
     std::vector<IRtxObserver *> observers_;
-    std::map<ndn::Name, ActiveSlotListEntry> activeSlots_;
+    std::priority_queue<ActiveSlotEntry, std::vector<ActiveSlotEntry>,
+                        std::greater<ActiveSlotEntry>> activeSlots_;
     std::shared_ptr<IPlaybackQueue> playbackQueue_;
     std::shared_ptr<DrdEstimator> drdEstimator_;
     bool enabled_;
+    int64_t timerFireTimestamp_;
 
-    void checkRetransmissions();
+    unsigned int checkRetransmissions();
+    void scheduleCheck();
+    bool isActive(const ActiveSlotEntry &entry) const;
+    int64_t getRtxLeadTime() const;
 
     // IBuffer observer
     void onNewRequest(const std::shared_ptr<BufferSlot> &);
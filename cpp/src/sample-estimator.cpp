@@ -38,7 +38,8 @@ SampleEstimator::~SampleEstimator()
 void
 SampleEstimator::bootstrapSegmentNumber(double value, SampleClass st, SegmentClass dt)
 {
-    estimators_[std::make_pair(st,dt)].segNum_.newValue((value > 0 ? value : 1.) );
+    // producer may publish no parity at all
+    estimators_[std::make_pair(st,dt)].segNum_.newValue((value > 0 || dt == SegmentClass::Parity ? value : 1.) );
 }
 
 void SampleEstimator::bootstrapSegmentSize(double value, SampleClass st, SegmentClass dt)
@@ -54,24 +55,21 @@ SampleEstimator::segmentArrived(const std::shared_ptr<WireSegment>& segment)
     {
         SampleClass st = segment->getSampleClass();
         SegmentClass dt = segment->getSegmentClass();
-        
-        estimators_[std::make_pair(st,dt)].segNum_.newValue(segment->getSlicesNum());
+        std::shared_ptr<WireData<VideoFrameSegmentHeader>> videoSegment =
+            std::dynamic_pointer_cast<WireData<VideoFrameSegmentHeader>>(segment);
+
         estimators_[std::make_pair(st,dt)].segSize_.newValue(segment->getData()->getContent().size());
-        
-        if (st == SampleClass::Delta)
-        {
-            if (dt == SegmentClass::Data)
-                (*sstorage_)[Indicator::SegmentsDeltaAvgNum] = segment->getSlicesNum();
-            else
-                (*sstorage_)[Indicator::SegmentsDeltaParityAvgNum] = segment->getSlicesNum();
-        }
-        else
+
+        if (videoSegment && dt == SegmentClass::Data)
         {
-            if (dt == SegmentClass::Data)
-                (*sstorage_)[Indicator::SegmentsKeyAvgNum] = segment->getSlicesNum();
-            else
-                (*sstorage_)[Indicator::SegmentsKeyParityAvgNum] = segment->getSlicesNum();
+            // number of parity segments follows producer's parity ratio and
+            // may drop to zero, in which case no parity segments would
+            // arrive - so it is tracked using data segment headers
+            updateSegmentNumber(segment->getSlicesNum(), st, SegmentClass::Data);
+            updateSegmentNumber(videoSegment->segment().getHeader().paritySegmentsNum_, st, SegmentClass::Parity);
         }
+        else if (!videoSegment)
+            updateSegmentNumber(segment->getSlicesNum(), st, dt);
     }
 }
 
@@ -104,3 +102,23 @@ SampleEstimator::getSegmentSizeEstimation(SampleClass st, SegmentClass dt)
 }
 
 #pragma mark - private
+void
+SampleEstimator::updateSegmentNumber(double value, SampleClass st, SegmentClass dt)
+{
+    estimators_[std::make_pair(st,dt)].segNum_.newValue(value);
+
+    if (st == SampleClass::Delta)
+    {
+        if (dt == SegmentClass::Data)
+            (*sstorage_)[Indicator::SegmentsDeltaAvgNum] = value;
+        else
+            (*sstorage_)[Indicator::SegmentsDeltaParityAvgNum] = value;
+    }
+    else
+    {
+        if (dt == SegmentClass::Data)
+            (*sstorage_)[Indicator::SegmentsKeyAvgNum] = value;
+        else
+            (*sstorage_)[Indicator::SegmentsKeyParityAvgNum] = value;
+    }
+}
@@ -81,11 +81,13 @@ namespace ndnrtc {
 		EstimatorMap estimators_;
         std::shared_ptr<statistics::StatisticsStorage> sstorage_;
 
-		void segmentRequestTimeout(const NamespaceInfo&, 
+		void segmentRequestTimeout(const NameHandle&, 
                                    const std::shared_ptr<const ndn::Interest> &){}
-        void segmentNack(const NamespaceInfo&, int, 
+        void segmentNack(const NameHandle&, int, 
                          const std::shared_ptr<const ndn::Interest> &){}
 		void segmentStarvation(){}
+
+        void updateSegmentNumber(double value, SampleClass st, SegmentClass dt);
 	};
 }
 
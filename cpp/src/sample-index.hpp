@@ -0,0 +1,273 @@
+//
+// sample-index.hpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#ifndef __sample_index_h__
+#define __sample_index_h__
+
+#include <stdint.h>
+#include <vector>
+
+#include "name-components.hpp"
+
+namespace ndnrtc
+{
+
+/**
+ * SampleKey is a compact integer replacement for sample prefix name
+ * (<base-prefix>/ndnrtc/<api>/<type>/<stream>/<ts>/<thread>/<class>/<seq>).
+ * Stream and thread names are hashed into integer ids, so building a key
+ * requires no memory allocation and comparing two keys is a matter of a few
+ * integer comparisons.
+ * Stream id is a 64-bit hash of everything in the prefix up to the thread
+ * name - collisions are not checked for, however probability of collision
+ * between streams fetched by a single consumer is negligible.
+ */
+class SampleKey
+{
+  public:
+    SampleKey() : streamId_(0), threadId_(0), sampleNo_(0), isDelta_(false) {}
+    explicit SampleKey(const NamespaceInfo &info)
+        : streamId_(streamHash(info)),
+          threadId_(threadHash(info.threadName_)),
+          sampleNo_(info.sampleNo_),
+          isDelta_(info.isDelta_) {}
+    explicit SampleKey(const NameHandle &handle)
+        : streamId_(handle.streamKey_),
+          threadId_(handle.threadKey_),
+          sampleNo_(handle.sampleNo_),
+          isDelta_(handle.isDelta_) {}
+
+    uint64_t getStreamId() const { return streamId_; }
+    uint32_t getThreadId() const { return threadId_; }
+    PacketNumber getSampleNo() const { return sampleNo_; }
+    bool isDelta() const { return isDelta_; }
+
+    bool operator==(const SampleKey &k) const
+    {
+        return sampleNo_ == k.sampleNo_ && threadId_ == k.threadId_ &&
+               streamId_ == k.streamId_ && isDelta_ == k.isDelta_;
+    }
+    bool operator!=(const SampleKey &k) const { return !(*this == k); }
+
+    uint64_t hash() const
+    {
+        // splitmix64 finalizer - consecutive sample numbers must not end up
+        // in neighbouring buckets
+        uint64_t h = streamId_ ^ ((uint64_t)threadId_ << 32) ^
+                     ((uint64_t)(uint32_t)sampleNo_ << 1) ^ (isDelta_ ? 1 : 0);
+        h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+        return h ^ (h >> 31);
+    }
+
+    static uint64_t fnv1a(const void *data, size_t len, uint64_t h = 0xcbf29ce484222325ULL)
+    {
+        const uint8_t *p = (const uint8_t *)data;
+        for (size_t i = 0; i < len; ++i)
+            h = (h ^ p[i]) * 0x100000001b3ULL;
+        return h;
+    }
+
+    static uint64_t streamHash(const ndn::Name &basePrefix, unsigned int apiVersion,
+                               MediaStreamParams::MediaStreamType streamType,
+                               const std::string &streamName, bool hasTimestamp,
+                               uint64_t streamTimestamp)
+    {
+        uint64_t h = fnv1a(nullptr, 0);
+        for (size_t i = 0; i < basePrefix.size(); ++i)
+        {
+            const ndn::Blob &c = basePrefix.get(i).getValue();
+            size_t len = c.size();
+
+            h = fnv1a(&len, sizeof(len), h);
+            if (len)
+                h = fnv1a(c.buf(), len, h);
+        }
+
+        h = fnv1a(&apiVersion, sizeof(apiVersion), h);
+        h = fnv1a(&streamType, sizeof(streamType), h);
+        h = fnv1a(streamName.data(), streamName.size(), h);
+        if (hasTimestamp)
+            h = fnv1a(&streamTimestamp, sizeof(streamTimestamp), h);
+
+        return h;
+    }
+
+    static uint64_t streamHash(const NamespaceInfo &info)
+    {
+        return streamHash(info.basePrefix_, info.apiVersion_, info.streamType_,
+                          info.streamName_, info.threadName_ != "",
+                          info.streamTimestamp_);
+    }
+
+    static uint32_t threadHash(const std::string &threadName)
+    {
+        return (uint32_t)fnv1a(threadName.data(), threadName.size());
+    }
+
+  private:
+    uint64_t streamId_;
+    uint32_t threadId_;
+    PacketNumber sampleNo_;
+    bool isDelta_;
+};
+
+/**
+ * SampleIndex is a flat open-addressing hash table (linear probing, backward
+ * shift deletion) that maps sample keys to values. Its storage is allocated
+ * upfront for the expected number of entries and is only reallocated if the
+ * table grows over half of its capacity, therefore lookups, insertions and
+ * removals do not allocate memory in steady state.
+ * Iteration order is unspecified.
+ */
+template <typename V>
+class SampleIndex
+{
+  public:
+    SampleIndex(size_t expectedSize = 16) : size_(0)
+    {
+        size_t capacity = 16;
+        while (capacity < 2 * expectedSize)
+            capacity <<= 1;
+        buckets_.resize(capacity);
+    }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    size_t capacity() const { return buckets_.size(); }
+
+    /**
+     * Returns pointer to the value stored for the key or nullptr if there
+     * is no such key. Pointer stays valid until next insertion or removal.
+     */
+    V *find(const SampleKey &key)
+    {
+        size_t idx = lookup(key);
+        return (buckets_[idx].used_ ? &buckets_[idx].value_ : nullptr);
+    }
+
+    const V *find(const SampleKey &key) const
+    {
+        size_t idx = lookup(key);
+        return (buckets_[idx].used_ ? &buckets_[idx].value_ : nullptr);
+    }
+
+    /**
+     * Inserts value for the key, if the key is not in the index yet.
+     * @return true if value was inserted, false if the key already exists
+     */
+    bool insert(const SampleKey &key, const V &value)
+    {
+        if (2 * (size_ + 1) > buckets_.size())
+            rehash(2 * buckets_.size());
+
+        size_t idx = lookup(key);
+        if (buckets_[idx].used_)
+            return false;
+
+        buckets_[idx].key_ = key;
+        buckets_[idx].value_ = value;
+        buckets_[idx].used_ = true;
+        size_++;
+
+        return true;
+    }
+
+    /**
+     * Removes the key from the index.
+     * @return true if the key was found and removed
+     */
+    bool erase(const SampleKey &key)
+    {
+        size_t idx = lookup(key);
+        if (!buckets_[idx].used_)
+            return false;
+
+        size_t mask = buckets_.size() - 1;
+        size_t hole = idx;
+
+        // shift back entries of the probe sequence, so no tombstones needed
+        for (size_t next = (hole + 1) & mask; buckets_[next].used_; next = (next + 1) & mask)
+        {
+            size_t home = buckets_[next].key_.hash() & mask;
+            if (((next - home) & mask) >= ((next - hole) & mask))
+            {
+                buckets_[hole].key_ = buckets_[next].key_;
+                buckets_[hole].value_ = buckets_[next].value_;
+                hole = next;
+            }
+        }
+
+        buckets_[hole].used_ = false;
+        buckets_[hole].value_ = V();
+        size_--;
+
+        return true;
+    }
+
+    void clear()
+    {
+        for (auto &b : buckets_)
+        {
+            b.used_ = false;
+            b.value_ = V();
+        }
+        size_ = 0;
+    }
+
+    /**
+     * Calls f(key, value) for every entry in the index. Index must not be
+     * modified from within f.
+     */
+    template <typename F>
+    void forEach(F f) const
+    {
+        for (auto &b : buckets_)
+            if (b.used_)
+                f(b.key_, b.value_);
+    }
+
+  private:
+    struct Bucket
+    {
+        Bucket() : used_(false) {}
+
+        SampleKey key_;
+        V value_;
+        bool used_;
+    };
+
+    std::vector<Bucket> buckets_;
+    size_t size_;
+
+    // returns bucket index that either holds the key or is the free bucket
+    // where the key should be inserted
+    size_t lookup(const SampleKey &key) const
+    {
+        size_t mask = buckets_.size() - 1;
+        size_t idx = key.hash() & mask;
+
+        while (buckets_[idx].used_ && buckets_[idx].key_ != key)
+            idx = (idx + 1) & mask;
+
+        return idx;
+    }
+
+    void rehash(size_t capacity)
+    {
+        std::vector<Bucket> old(capacity);
+        old.swap(buckets_);
+        size_ = 0;
+
+        for (auto &b : old)
+            if (b.used_)
+                insert(b.key_, b.value_);
+    }
+};
+}
+
+#endif
@@ -12,8 +12,11 @@
 
 #include "name-components.hpp"
 #include "meta-fetcher.hpp"
+#include "key-chain-lock.hpp"
 
 static const unsigned int META_FETCHER_POOL_SIZE = 100;
+// number of recent audio manifest windows kept by validator
+static const unsigned int AUDIO_MANIFEST_WINDOWS = 8;
 
 using namespace ndnrtc;
 using namespace ndn;
@@ -29,7 +32,7 @@ void SampleValidator::onNewData(const BufferReceipt &receipt)
     std::shared_ptr<SampleValidator> me = std::dynamic_pointer_cast<SampleValidator>(shared_from_this());
     std::shared_ptr<int> nVerifiedSegments(std::make_shared<int>(0));
     std::shared_ptr<const BufferSlot> slot = receipt.slot_;
-    keyChain_->verifyData(receipt.segment_->getData()->getData(),
+    verifyData(*keyChain_, receipt.segment_->getData()->getData(),
                           [me, this, slot, nVerifiedSegments](const std::shared_ptr<ndn::Data> &data) {
                               // success
                               (*nVerifiedSegments)++;
@@ -130,8 +133,12 @@ void ManifestValidator::verifySlot(const std::shared_ptr<const BufferSlot> slot)
     assert(slot->getState() >= BufferSlot::State::Ready);
 
     bool verified = true;
-    for (auto &it : slot->fetched_)
-        verified &= slot->manifest_->hasData(*(it.second->getData()->getData()));
+    for (auto &s : slot->dataSegments_)
+        if (s && s->isFetched())
+            verified &= slot->manifest_->hasData(*(s->getData()->getData()));
+    for (auto &s : slot->paritySegments_)
+        if (s && s->isFetched())
+            verified &= slot->manifest_->hasData(*(s->getData()->getData()));
     slot->verified_ = (verified ? BufferSlot::Verification::Verified : BufferSlot::Verification::Failed);
 
     if (slot->getVerificationStatus() == BufferSlot::Verification::Failed)
@@ -146,3 +153,158 @@ void ManifestValidator::verifySlot(const std::shared_ptr<const BufferSlot> slot)
         (*statStorage_)[Indicator::VerifySuccess]++;
     }
 }
+
+//******************************************************************************
+AudioManifestValidator::AudioManifestValidator(std::shared_ptr<ndn::Face> face,
+                                               std::shared_ptr<ndn::KeyChain> keyChain,
+                                               const std::shared_ptr<StatisticsStorage> &statStorage)
+    : ManifestValidator(face, keyChain, statStorage)
+{
+    description_ = "audio-sample-validator";
+}
+
+void AudioManifestValidator::onNewRequest(const std::shared_ptr<BufferSlot> &slot)
+{
+    if (slot->getState() == BufferSlot::State::New)
+    {
+        PacketNumber lastBundleNo = NameComponents::audioManifestBundleNo(slot->getNameInfo().sampleNo_);
+        std::map<PacketNumber, Window>::iterator it = windows_.find(lastBundleNo);
+
+        if (it == windows_.end())
+        {
+            while (windows_.size() >= AUDIO_MANIFEST_WINDOWS)
+                windows_.erase(windows_.begin());
+
+            it = windows_.insert(std::make_pair(lastBundleNo, Window())).first;
+            fetchManifest(slot->getNameInfo().getPrefix(prefix_filter::Thread), lastBundleNo);
+        }
+
+        if (it->second.manifest_)
+            slot->manifest_ = it->second.manifest_;
+        else if (it->second.failed_)
+            slot->verified_ = BufferSlot::Verification::Failed;
+        else
+            it->second.slots_.push_back(slot);
+    }
+}
+
+void AudioManifestValidator::onNewData(const BufferReceipt &receipt)
+{
+    if (receipt.slot_->manifest_)
+    {
+        ManifestValidator::onNewData(receipt);
+        return;
+    }
+
+    // slot may be released before manifest arrives - keep segment's digest
+    PacketNumber bundleNo = receipt.slot_->getNameInfo().sampleNo_;
+    std::map<PacketNumber, Window>::iterator it = windows_.find(NameComponents::audioManifestBundleNo(bundleNo));
+
+    if (it != windows_.end() && !it->second.manifest_ && !it->second.failed_)
+        it->second.digests_[bundleNo].push_back((*receipt.segment_->getData()->getData()->getFullName())[-1].getValue());
+}
+
+void AudioManifestValidator::fetchManifest(const Name &threadPrefix, PacketNumber lastBundleNo)
+{
+    if (metaFetcherPool_.size() == 0)
+        metaFetcherPool_.enlarge(META_FETCHER_POOL_SIZE);
+
+    std::shared_ptr<AudioManifestValidator> me = std::dynamic_pointer_cast<AudioManifestValidator>(shared_from_this());
+    std::shared_ptr<MetaFetcher> mfetcher = metaFetcherPool_.pop();
+    Name manifestName(threadPrefix);
+    manifestName.appendSequenceNumber(lastBundleNo).append(NameComponents::NameComponentManifest);
+
+    mfetcher->fetch(face_, keyChain_,
+                    manifestName,
+                    [mfetcher, lastBundleNo, me, this](NetworkData &nd, const std::vector<ValidationErrorInfo> info) {
+                        if (info.size())
+                        {
+                            for (auto &i : info)
+                                LogWarnC << "manifest verification failure " << i.getData()->getName()
+                                         << " (KeyLocator " << (KeyLocator::getFromSignature(i.getData()->getSignature())).getKeyName()
+                                         << "), reason: "
+                                         << i.getReason() << std::endl;
+                            onManifestFailure(lastBundleNo);
+                        }
+                        else
+                            onManifest(lastBundleNo, std::make_shared<Manifest>(boost::move(nd)));
+                        metaFetcherPool_.push(mfetcher);
+                    },
+                    [mfetcher, lastBundleNo, me, this](const std::string &) {
+                        LogErrorC << "couldn't fetch manifest for bundles up to " << lastBundleNo << std::endl;
+
+                        metaFetcherPool_.push(mfetcher);
+                        windows_.erase(lastBundleNo);
+                        (*statStorage_)[Indicator::VerifyFailure]++;
+                    });
+
+    LogTraceC << "fetch " << manifestName << std::endl;
+}
+
+void AudioManifestValidator::onManifest(PacketNumber lastBundleNo,
+                                        const std::shared_ptr<Manifest> &manifest)
+{
+    std::map<PacketNumber, Window>::iterator it = windows_.find(lastBundleNo);
+    if (it == windows_.end())
+    {
+        LogWarnC << "late manifest arrival for bundles up to " << lastBundleNo << std::endl;
+        return;
+    }
+
+    LogTraceC << "received manifest for bundles up to " << lastBundleNo
+              << " (" << manifest->size() << " segments)" << std::endl;
+
+    Window &window = it->second;
+    window.manifest_ = manifest;
+    for (auto &slot : window.slots_)
+        // slots could have been reused for other bundles in the meantime
+        if (slot->getState() >= BufferSlot::State::New &&
+            NameComponents::audioManifestBundleNo(slot->getNameInfo().sampleNo_) == lastBundleNo)
+        {
+            // bundle is verified with its slot
+            window.digests_.erase(slot->getNameInfo().sampleNo_);
+            slot->manifest_ = manifest;
+            if (slot->getState() >= BufferSlot::State::Ready &&
+                slot->getVerificationStatus() == BufferSlot::Verification::Unknown)
+                verifySlot(slot);
+        }
+
+    // bundles which slots were released before manifest arrived
+    for (auto &d : window.digests_)
+    {
+        bool verified = true;
+        for (auto &digest : d.second)
+            verified &= manifest->hasDigest(digest);
+
+        if (verified)
+        {
+            LogDebugC << "verified bundle " << d.first << std::endl;
+            (*statStorage_)[Indicator::VerifySuccess]++;
+        }
+        else
+        {
+            LogErrorC << "bundle verification failure " << d.first << std::endl;
+            (*statStorage_)[Indicator::VerifyFailure]++;
+        }
+    }
+
+    window.slots_.clear();
+    window.digests_.clear();
+}
+
+void AudioManifestValidator::onManifestFailure(PacketNumber lastBundleNo)
+{
+    std::map<PacketNumber, Window>::iterator it = windows_.find(lastBundleNo);
+    if (it == windows_.end())
+        return;
+
+    for (auto &slot : it->second.slots_)
+        if (slot->getState() >= BufferSlot::State::New &&
+            NameComponents::audioManifestBundleNo(slot->getNameInfo().sampleNo_) == lastBundleNo)
+            slot->verified_ = BufferSlot::Verification::Failed;
+
+    it->second.failed_ = true;
+    it->second.slots_.clear();
+    it->second.digests_.clear();
+    (*statStorage_)[Indicator::VerifyFailure]++;
+}
@@ -8,6 +8,8 @@
 #ifndef __sample_validator_h__
 #define __sample_validator_h__
 
+#include <ndn-cpp/util/blob.hpp>
+
 #include "ndnrtc-object.hpp"
 #include "frame-buffer.hpp"
 #include "statistics.hpp"
@@ -48,7 +50,7 @@ class ManifestValidator : public NdnRtcComponent, public IBufferObserver, statis
                       std::shared_ptr<ndn::KeyChain> keyChain,
                       const std::shared_ptr<statistics::StatisticsStorage> &statStorage);
 
-  private:
+  protected:
     template <typename T>
     class Pool
     {
@@ -102,6 +104,49 @@ class ManifestValidator : public NdnRtcComponent, public IBufferObserver, statis
     void onReset() {}
     void verifySlot(const std::shared_ptr<const BufferSlot> slot);
 };
+
+/**
+ * Validates audio bundles against manifests, each covering a window of
+ * bundles (see NameComponents::audioManifestBundleNo). Manifest is fetched
+ * once per window and shared by all slots of the window.
+ * Manifest is published after the last bundle of the window, thus earlier
+ * bundles are usually played and their slots reused by the time it
+ * arrives. Digests of segments received before the manifest are kept per
+ * window and such bundles are checked against the manifest upon arrival.
+ */
+class AudioManifestValidator : public ManifestValidator
+{
+  public:
+    AudioManifestValidator(std::shared_ptr<ndn::Face> face,
+                           std::shared_ptr<ndn::KeyChain> keyChain,
+                           const std::shared_ptr<statistics::StatisticsStorage> &statStorage);
+
+  private:
+    typedef struct _Window
+    {
+        _Window() : failed_(false) {}
+
+        // set if manifest failed verification
+        bool failed_;
+        std::shared_ptr<Manifest> manifest_;
+        // slots waiting for manifest
+        std::vector<std::shared_ptr<BufferSlot>> slots_;
+        // digests of segments received before manifest, by bundle number
+        std::map<PacketNumber, std::vector<ndn::Blob>> digests_;
+    } Window;
+
+    // windows are keyed by the last bundle number
+    std::map<PacketNumber, Window> windows_;
+
+    void onNewRequest(const std::shared_ptr<BufferSlot> &);
+    void onNewData(const BufferReceipt &receipt);
+    void onReset() { windows_.clear(); }
+
+  protected:
+    virtual void fetchManifest(const ndn::Name &threadPrefix, PacketNumber lastBundleNo);
+    void onManifest(PacketNumber lastBundleNo, const std::shared_ptr<Manifest> &manifest);
+    void onManifestFailure(PacketNumber lastBundleNo);
+};
 }
 
 #endif
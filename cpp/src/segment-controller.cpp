@@ -9,6 +9,7 @@
 #include "frame-data.hpp"
 #include "async.hpp"
 #include "clock.hpp"
+#include "event-trace.hpp"
 
 #include <boost/thread/lock_guard.hpp>
 
@@ -234,14 +235,17 @@ void SegmentControllerImpl::onData(const std::shared_ptr<const Interest> &intere
 
     lastDataTimestampMs_ = clock::millisecondTimestamp();
     starvationFired_ = false;
-    NamespaceInfo info;
+    NameHandle info;
 
-    if (NameComponents::extractInfo(data->getName(), info))
+    if (NameComponents::extractHandle(data->getName(), info))
     {
         std::shared_ptr<WireSegment> segment = WireSegment::createSegment(info, data, interest);
 
         if (segment->isValid())
         {
+            trace::Tracer::record(trace::Event::SegmentReceived, info.sampleNo_, info.segNo_,
+                trace::Tracer::flags(info.isParity_, info.class_ == SampleClass::Key),
+                data->getContent().size());
             LogTraceC << data->getName() << " "
                       << data->getContent().size() << " bytes" << std::endl;
             {
@@ -269,11 +273,13 @@ void SegmentControllerImpl::onTimeout(const std::shared_ptr<const Interest> &int
         return;
     }
 
-    NamespaceInfo info;
+    NameHandle info;
 
-    if (NameComponents::extractInfo(interest->getName(), info))
+    if (NameComponents::extractHandle(interest->getName(), info))
     {
         LogTraceC << interest->getName() << std::endl;
+        trace::Tracer::record(trace::Event::SegmentTimeout, info.sampleNo_, info.segNo_,
+            trace::Tracer::flags(info.isParity_, info.class_ == SampleClass::Key));
 
         {
             boost::lock_guard<boost::mutex> scopedLock(mutex_);
@@ -298,15 +304,17 @@ void SegmentControllerImpl::onNetworkNack(const std::shared_ptr<const Interest>
         return;
     }
 
-    NamespaceInfo info;
+    NameHandle info;
 
-    if (NameComponents::extractInfo(interest->getName(), info))
+    if (NameComponents::extractHandle(interest->getName(), info))
     {
         LogTraceC << interest->getName() << std::endl;
 
         {
             boost::lock_guard<boost::mutex> scopedLock(mutex_);
             int reason = (networkNack->getReason() == ndn_NetworkNackReason_OTHER_CODE ? networkNack->getOtherReasonCode() : networkNack->getReason());
+            trace::Tracer::record(trace::Event::SegmentNack, info.sampleNo_, info.segNo_,
+                trace::Tracer::flags(info.isParity_, info.class_ == SampleClass::Key), reason);
 
             for (auto &o : observers_)
                 o->segmentNack(info, reason, interest);
@@ -95,13 +95,13 @@ class ISegmentControllerObserver
     /**
      * Called whenever interest has timed out
      */
-    virtual void segmentRequestTimeout(const NamespaceInfo &, 
+    virtual void segmentRequestTimeout(const NameHandle &, 
                                        const std::shared_ptr<const ndn::Interest> &) = 0;
 
     /**
      * Called whenever interest gets network nack
      */
-    virtual void segmentNack(const NamespaceInfo &, int,
+    virtual void segmentNack(const NameHandle &, int,
                              const std::shared_ptr<const ndn::Interest> &) = 0;
 
     /**
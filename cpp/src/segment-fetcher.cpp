@@ -13,6 +13,7 @@
 
 #include "segment-fetcher.hpp"
 #include "simple-log.hpp"
+#include "key-chain-lock.hpp"
 
 using namespace ndn;
 using namespace std;
@@ -90,8 +91,8 @@ SegmentFetcher::onSegmentReceived
 	const std::shared_ptr<Data>& data)
 {
 	if (validatorKeyChain_)
-		validatorKeyChain_->verifyData
-	(data,
+		verifyData(*validatorKeyChain_,
+	data,
 		bind(&SegmentFetcher::processSegment, 
 			std::dynamic_pointer_cast<SegmentFetcher>(shared_from_this()), _1, originalInterest),
 		(const OnDataValidationFailed)bind(&SegmentFetcher::onVerifyFailed, 
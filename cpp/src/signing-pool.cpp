@@ -0,0 +1,106 @@
+//
+// signing-pool.cpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <ndn-cpp/security/key-chain.hpp>
+#include <ndn-cpp/security/safe-bag.hpp>
+#include <ndn-cpp/security/pib/pib-memory.hpp>
+#include <ndn-cpp/security/tpm/tpm-back-end-memory.hpp>
+
+#include "signing-pool.hpp"
+
+using namespace ndnrtc;
+using namespace ndn;
+
+//******************************************************************************
+SigningPoolBase::SigningPoolBase(unsigned int nThreads)
+    : work_(std::make_shared<boost::asio::io_service::work>(io_))
+{
+    description_ = "signing-pool";
+
+    for (unsigned int i = 0; i < nThreads; ++i)
+        threads_.push_back(std::make_shared<boost::thread>([this]() { io_.run(); }));
+}
+
+SigningPoolBase::~SigningPoolBase()
+{
+    work_.reset();
+    io_.stop();
+
+    for (auto &t : threads_)
+        if (t->joinable())
+            t->join();
+}
+
+void SigningPoolBase::perform(const std::vector<std::function<void(void)>> &tasks)
+{
+    if (tasks.empty())
+        return;
+
+    boost::mutex m;
+    boost::condition_variable isDone;
+    size_t nPending = tasks.size() - 1;
+    std::exception_ptr error;
+
+    for (size_t i = 1; i < tasks.size(); ++i)
+    {
+        std::function<void(void)> task = tasks[i];
+        io_.post([task, &m, &isDone, &nPending, &error]() {
+            std::exception_ptr e;
+
+            try
+            {
+                task();
+            }
+            catch (...)
+            {
+                e = std::current_exception();
+            }
+
+            boost::lock_guard<boost::mutex> scopedLock(m);
+            if (e && !error)
+                error = e;
+            if (--nPending == 0)
+                isDone.notify_one();
+        });
+    }
+
+    std::exception_ptr e;
+    try
+    {
+        tasks[0]();
+    }
+    catch (...)
+    {
+        e = std::current_exception();
+    }
+
+    boost::unique_lock<boost::mutex> lock(m);
+    isDone.wait(lock, [&nPending]() { return nPending == 0; });
+
+    if (e)
+        std::rethrow_exception(e);
+    if (error)
+        std::rethrow_exception(error);
+}
+
+//******************************************************************************
+std::shared_ptr<KeyChain> ndnrtc::cloneKeyChain(KeyChain &keyChain)
+{
+    std::shared_ptr<CertificateV2> cert =
+        keyChain.getPib().getDefaultIdentity()->getDefaultKey()->getDefaultCertificate();
+    // key never leaves the process, thus it's exported unencrypted
+    std::shared_ptr<SafeBag> safeBag = keyChain.exportSafeBag(*cert);
+
+    std::shared_ptr<KeyChain> clone =
+        std::make_shared<KeyChain>(std::make_shared<PibMemory>(), std::make_shared<TpmBackEndMemory>());
+    clone->importSafeBag(*safeBag);
+    clone->setDefaultIdentity(*clone->getPib().getIdentity(cert->getIdentity()));
+
+    return clone;
+}
@@ -0,0 +1,121 @@
+//
+// signing-pool.hpp
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#ifndef __signing_pool_h__
+#define __signing_pool_h__
+
+#include <boost/asio.hpp>
+#include <boost/thread.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "ndnrtc-object.hpp"
+
+namespace ndn
+{
+class Data;
+class KeyChain;
+}
+
+namespace ndnrtc
+{
+
+/**
+ * Pool of worker threads shared by signing pools of all key chain types.
+ */
+class SigningPoolBase : public NdnRtcComponent
+{
+  public:
+    /**
+     * @param nThreads Number of worker threads (in addition to the calling
+     *                 thread)
+     */
+    SigningPoolBase(unsigned int nThreads);
+    ~SigningPoolBase();
+
+    size_t getSize() const { return threads_.size(); }
+
+  protected:
+    /**
+     * Runs first task on calling thread and the rest - on pool threads.
+     * Returns when all tasks are completed. Rethrows first exception thrown
+     * by any of the tasks.
+     */
+    void perform(const std::vector<std::function<void(void)>> &tasks);
+
+  private:
+    SigningPoolBase(const SigningPoolBase &) = delete;
+
+    boost::asio::io_service io_;
+    std::shared_ptr<boost::asio::io_service::work> work_;
+    std::vector<std::shared_ptr<boost::thread>> threads_;
+};
+
+/**
+ * SigningPool is a small pool of worker threads for signing batches of data
+ * packets (e.g. all segments of a frame) in parallel. Batch is split evenly
+ * between pool threads and the calling thread, which also signs its share
+ * and returns once the whole batch is signed.
+ * Key chains are not thread-safe, thus every worker signs with its own key
+ * chain, created by the factory provided at construction (e.g. a key chain
+ * with in-memory TPM holding a copy of the signing key, see
+ * cloneKeyChain()). Calling thread signs with the key chain passed to
+ * sign(). Concurrent calls to sign() are serialized.
+ */
+template <typename KeyChain>
+class SigningPoolT : public SigningPoolBase
+{
+  public:
+    typedef std::function<std::shared_ptr<KeyChain>(void)> KeyChainFactory;
+
+    /**
+     * @param nThreads Number of worker threads (in addition to the calling
+     *                 thread)
+     * @param makeKeyChain Creates key chain for a worker
+     */
+    SigningPoolT(unsigned int nThreads, KeyChainFactory makeKeyChain)
+        : SigningPoolBase(nThreads)
+    {
+        for (unsigned int i = 0; i < nThreads; ++i)
+            workerKeyChains_.push_back(makeKeyChain());
+    }
+
+    void sign(KeyChain &keyChain, const std::vector<std::shared_ptr<ndn::Data>> &batch)
+    {
+        boost::lock_guard<boost::mutex> scopedLock(signMutex_);
+        size_t nChunks = std::min(batch.size(), workerKeyChains_.size() + 1);
+        std::vector<std::function<void(void)>> tasks;
+
+        for (size_t chunk = 0; chunk < nChunks; ++chunk)
+        {
+            KeyChain *chunkKeyChain = (chunk == 0 ? &keyChain : workerKeyChains_[chunk - 1].get());
+
+            tasks.push_back([chunkKeyChain, &batch, chunk, nChunks]() {
+                for (size_t i = chunk; i < batch.size(); i += nChunks)
+                    chunkKeyChain->sign(*batch[i]);
+            });
+        }
+
+        perform(tasks);
+    }
+
+  private:
+    boost::mutex signMutex_;
+    std::vector<std::shared_ptr<KeyChain>> workerKeyChains_;
+};
+
+typedef SigningPoolT<ndn::KeyChain> SigningPool;
+
+/**
+ * Creates key chain with in-memory PIB and TPM, which holds a copy of the
+ * default certificate and private key of the given key chain.
+ * Throws if key chain doesn't allow exporting its' default key (e.g.
+ * security v1 key chains).
+ */
+std::shared_ptr<ndn::KeyChain> cloneKeyChain(ndn::KeyChain &keyChain);
+}
+
+#endif
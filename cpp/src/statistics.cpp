@@ -53,6 +53,12 @@ map_list_of
 ( Indicator::PlayedKeyNum, "Played key frames" ) 
 ( Indicator::SkippedNum, "Skipped" )
 ( Indicator::LatencyEstimated, "Latency (est.)" )
+
+// decoder
+( Indicator::DecodeQueueSize, "Decoder queue" )
+( Indicator::DecodeDelay, "Decode delay (avg)" )
+( Indicator::DecodingTime, "Decoding time (avg)" )
+( Indicator::DecodeDroppedNum, "Dropped before decoding" )
 // pipeliner
 ( Indicator::SegmentsDeltaAvgNum, "Delta segments average" ) 
 ( Indicator::SegmentsKeyAvgNum, "Key segments average" ) 
@@ -74,12 +80,23 @@ map_list_of
 ( Indicator::State, "Consumer state" )
 ( Indicator::DoubleRtFrames, "Number of frames with additional round trips for assembling" )
 ( Indicator::DoubleRtFramesKey, "Number of key frames with additional round trips for assemnbling" )
+// rate adaptation
+( Indicator::BandwidthEstimation, "Bandwidth estimation (kbps)" )
+( Indicator::ThreadSwitchUpNum, "Thread switches up (decided)" )
+( Indicator::ThreadSwitchDownNum, "Thread switches down (decided)" )
+( Indicator::ThreadSwitchedNum, "Thread switches (completed)" )
 // DRD estimator
 ( Indicator::DrdOriginalEstimation, "DRD estimation (orig)" )
 ( Indicator::DrdCachedEstimation, "DRD estimation (cach)" )
 // interest queue
 ( Indicator::QueueSize, "Interest queue" )
 ( Indicator::InterestsSentNum, "Sent interests" )
+( Indicator::InterestsDroppedNum, "Dropped interests (queue full)" )
+( Indicator::InterestIssueDelay, "Interest issue delay (avg)" )
+( Indicator::IssueDelayUnder1ms, "Interests issued in <1ms" )
+( Indicator::IssueDelayUnder5ms, "Interests issued in 1-5ms" )
+( Indicator::IssueDelayUnder20ms, "Interests issued in 5-20ms" )
+( Indicator::IssueDelayOver20ms, "Interests issued in >=20ms" )
 // producer
 // media thread
 ( Indicator::BytesPublished, "Payload published bytes" )
@@ -90,9 +107,37 @@ map_list_of
 ( Indicator::PublishedKeyNum, "Published key frames" )
 ( Indicator::InterestsReceivedNum, "Interests received" )
 ( Indicator::SignNum, "Sign operations")
+( Indicator::SignDelay, "Sign delay (avg)")
+( Indicator::MetaSignDelay, "Metadata sign delay (avg)")
+( Indicator::FanOut, "Interests per answered segment (avg)" )
+( Indicator::AggregationRatio, "Interests per data sent" )
+( Indicator::GenerationDelay, "Generation delay (avg)" )
+( Indicator::GenerationDelayUnder5ms, "Interests answered in <5ms" )
+( Indicator::GenerationDelayUnder20ms, "Interests answered in 5-20ms" )
+( Indicator::GenerationDelayUnder100ms, "Interests answered in 20-100ms" )
+( Indicator::GenerationDelayOver100ms, "Interests answered in >=100ms" )
+( Indicator::AudioBundlePoolSize, "Audio bundle pool size" )
+( Indicator::AudioBundlePoolOccupancy, "Audio bundle pool occupancy" )
+( Indicator::AudioBundlePoolExhausted, "Audio bundle pool exhausted" )
 
 // encoder
 ( Indicator::EncodedNum, "Encoded frames" )
+( Indicator::EncodingDelay, "Encoding delay (avg)" )
+( Indicator::EncodeQueueSize, "Encoder queue" )
+
+// producer pipeline stages
+( Indicator::ScaleQueueSize, "Scaler queue" )
+( Indicator::ScaleDelay, "Scaling delay (avg)" )
+( Indicator::ParityQueueSize, "Parity queue" )
+( Indicator::ParityDelay, "Parity delay (avg)" )
+( Indicator::PublishQueueSize, "Publish queue" )
+( Indicator::PublishDelay, "Publish delay (avg)" )
+
+// persistent storage
+( Indicator::StorageBacklogSize, "Storage backlog size" )
+( Indicator::StorageWrittenNum, "Packets written to storage" )
+( Indicator::StorageDroppedNum, "Packets dropped by storage" )
+( Indicator::StorageWriteDelay, "Storage write delay (avg)" )
 
 // capturer
 ( Indicator::CapturedNum, "Captured frames" );
@@ -133,6 +178,11 @@ map_list_of
 ( Indicator::PlayedKeyNum, 0. )
 ( Indicator::SkippedNum, 0. )
 ( Indicator::LatencyEstimated, 0. )
+// decoder
+( Indicator::DecodeQueueSize, 0. )
+( Indicator::DecodeDelay, 0. )
+( Indicator::DecodingTime, 0. )
+( Indicator::DecodeDroppedNum, 0. )
 // pipeliner
 ( Indicator::SegmentsDeltaAvgNum, 0. )
 ( Indicator::SegmentsKeyAvgNum, 0. )
@@ -154,12 +204,23 @@ map_list_of
 ( Indicator::State, 0. )
 ( Indicator::DoubleRtFrames, 0. )
 ( Indicator::DoubleRtFramesKey, 0. )
+// rate adaptation
+( Indicator::BandwidthEstimation, 0. )
+( Indicator::ThreadSwitchUpNum, 0. )
+( Indicator::ThreadSwitchDownNum, 0. )
+( Indicator::ThreadSwitchedNum, 0. )
 // DRD estimator
 ( Indicator::DrdCachedEstimation, 0. )
 ( Indicator::DrdOriginalEstimation, 0. )
 // interest queue
 ( Indicator::QueueSize, 0. )
-( Indicator::InterestsSentNum, 0. );
+( Indicator::InterestsSentNum, 0. )
+( Indicator::InterestsDroppedNum, 0. )
+( Indicator::InterestIssueDelay, 0. )
+( Indicator::IssueDelayUnder1ms, 0. )
+( Indicator::IssueDelayUnder5ms, 0. )
+( Indicator::IssueDelayUnder20ms, 0. )
+( Indicator::IssueDelayOver20ms, 0. );
 
 const StatisticsStorage::StatRepo StatisticsStorage::ProducerStatRepo =
 map_list_of ( Indicator::Timestamp, 0. )
@@ -173,10 +234,36 @@ map_list_of ( Indicator::Timestamp, 0. )
 ( Indicator::PublishedKeyNum, 0. )
 ( Indicator::InterestsReceivedNum, 0. )
 ( Indicator::SignNum, 0. )
+( Indicator::SignDelay, 0. )
+( Indicator::MetaSignDelay, 0. )
+( Indicator::FanOut, 0. )
+( Indicator::AggregationRatio, 0. )
+( Indicator::GenerationDelay, 0. )
+( Indicator::GenerationDelayUnder5ms, 0. )
+( Indicator::GenerationDelayUnder20ms, 0. )
+( Indicator::GenerationDelayUnder100ms, 0. )
+( Indicator::GenerationDelayOver100ms, 0. )
+( Indicator::AudioBundlePoolSize, 0. )
+( Indicator::AudioBundlePoolOccupancy, 0. )
+( Indicator::AudioBundlePoolExhausted, 0. )
 ( Indicator::CurrentProducerFramerate, 0. )
 // encoder
 ( Indicator::DroppedNum, 0. )
 ( Indicator::EncodedNum, 0. )
+( Indicator::EncodingDelay, 0. )
+( Indicator::EncodeQueueSize, 0. )
+// producer pipeline stages
+( Indicator::ScaleQueueSize, 0. )
+( Indicator::ScaleDelay, 0. )
+( Indicator::ParityQueueSize, 0. )
+( Indicator::ParityDelay, 0. )
+( Indicator::PublishQueueSize, 0. )
+( Indicator::PublishDelay, 0. )
+// persistent storage
+( Indicator::StorageBacklogSize, 0. )
+( Indicator::StorageWrittenNum, 0. )
+( Indicator::StorageDroppedNum, 0. )
+( Indicator::StorageWriteDelay, 0. )
 // capturer
 ( Indicator::CapturedNum, 0. );
 
@@ -217,6 +304,11 @@ boost::assign::map_list_of
 (Indicator::PlayedKeyNum, "framesPlayedKey")
 (Indicator::SkippedNum, "skipNoKey")
 (Indicator::LatencyEstimated, "latEst")
+// decoder
+(Indicator::DecodeQueueSize, "decQueue")
+(Indicator::DecodeDelay, "decDelay")
+(Indicator::DecodingTime, "decTime")
+(Indicator::DecodeDroppedNum, "decDropped")
 // pipeliner
 (Indicator::SegmentsDeltaAvgNum, "segAvgDelta")
 (Indicator::SegmentsKeyAvgNum, "segAvgKey")
@@ -238,12 +330,23 @@ boost::assign::map_list_of
 (Indicator::State, "state" )
 ( Indicator::DoubleRtFrames, "doubleRt" )
 ( Indicator::DoubleRtFramesKey, "doubleRtKey" )
+// rate adaptation
+(Indicator::BandwidthEstimation, "bwEst")
+(Indicator::ThreadSwitchUpNum, "switchUp")
+(Indicator::ThreadSwitchDownNum, "switchDown")
+(Indicator::ThreadSwitchedNum, "switched")
 // DRD estimator
 (Indicator::DrdOriginalEstimation, "drdEst")
 (Indicator::DrdCachedEstimation, "drdPrime")
 // interest queue
 (Indicator::QueueSize, "iqueue")
 (Indicator::InterestsSentNum, "isent")
+(Indicator::InterestsDroppedNum, "idropped")
+(Indicator::InterestIssueDelay, "issueDelay")
+(Indicator::IssueDelayUnder1ms, "issue1ms")
+(Indicator::IssueDelayUnder5ms, "issue5ms")
+(Indicator::IssueDelayUnder20ms, "issue20ms")
+(Indicator::IssueDelayOver20ms, "issueOver20ms")
 // producer
 (Indicator::BytesPublished, "bytesPub")
 (Indicator::RawBytesPublished, "rawBytesPub")
@@ -253,23 +356,128 @@ boost::assign::map_list_of
 (Indicator::PublishedKeyNum, "framesPubKey")
 (Indicator::InterestsReceivedNum, "irecvd")
 (Indicator::SignNum, "signNum")
+(Indicator::SignDelay, "signDelay")
+(Indicator::MetaSignDelay, "metaSignDelay")
+(Indicator::FanOut, "fanOut")
+(Indicator::AggregationRatio, "aggRatio")
+(Indicator::GenerationDelay, "genDelay")
+(Indicator::GenerationDelayUnder5ms, "gen5ms")
+(Indicator::GenerationDelayUnder20ms, "gen20ms")
+(Indicator::GenerationDelayUnder100ms, "gen100ms")
+(Indicator::GenerationDelayOver100ms, "genOver100ms")
+(Indicator::AudioBundlePoolSize, "aPoolSize")
+(Indicator::AudioBundlePoolOccupancy, "aPoolOcc")
+(Indicator::AudioBundlePoolExhausted, "aPoolExhausted")
 // encoder
 (Indicator::EncodedNum, "framesEncoded")
+(Indicator::EncodingDelay, "encDelay")
+(Indicator::EncodeQueueSize, "encQueue")
+// producer pipeline stages
+(Indicator::ScaleQueueSize, "scaleQueue")
+(Indicator::ScaleDelay, "scaleDelay")
+(Indicator::ParityQueueSize, "parityQueue")
+(Indicator::ParityDelay, "parityDelay")
+(Indicator::PublishQueueSize, "pubQueue")
+(Indicator::PublishDelay, "pubDelay")
+// persistent storage
+(Indicator::StorageBacklogSize, "storeBacklog")
+(Indicator::StorageWrittenNum, "storeWritten")
+(Indicator::StorageDroppedNum, "storeDropped")
+(Indicator::StorageWriteDelay, "storeDelay")
 // capturer
 (Indicator::CapturedNum, "framesCaptured");
 
+StatisticsStorage::StatisticsStorage(const StatRepo& indicators)
+{
+    for (auto& it:indicators)
+    {
+        present_.set((size_t)it.first);
+        values_[(size_t)it.first].value_.store(it.second, std::memory_order_relaxed);
+    }
+}
+
+StatisticsStorage::StatisticsStorage(const StatisticsStorage& statisticsStorage)
+{
+    *this = statisticsStorage;
+}
+
+StatisticsStorage&
+StatisticsStorage::operator=(const StatisticsStorage& other)
+{
+    if (this != &other)
+    {
+        Snapshot snapshot;
+        other.snapshot(snapshot);
+
+        present_ = other.present_;
+        for (size_t idx = 0; idx < IndicatorsNum; ++idx)
+            set(idx, snapshot[idx]);
+    }
+    return *this;
+}
+
 StatisticsStorage::StatRepo
 StatisticsStorage::getIndicators() const
 {
+    Snapshot snapshot;
+    this->snapshot(snapshot);
+
     StatRepo copy;
-    for (StatRepo::const_iterator it = indicators_.begin(); it != indicators_.end(); ++it)
-        copy[it->first] = it->second;
+    for (size_t idx = 0; idx < IndicatorsNum; ++idx)
+        if (present_[idx])
+            copy[(Indicator)idx] = snapshot[idx];
     return copy;
 }
 
+void
+StatisticsStorage::snapshot(Snapshot& snapshot) const
+{
+    for (size_t idx = 0; idx < IndicatorsNum; ++idx)
+        snapshot[idx] = values_[idx].value_.load(std::memory_order_relaxed);
+
+    for (auto& shard:shards_)
+        for (size_t idx = 0; idx < IndicatorsNum; ++idx)
+            snapshot[idx] += shard.deltas_[idx].load(std::memory_order_relaxed);
+}
+
 void
 StatisticsStorage::updateIndicator(const statistics::Indicator& indicator,
                                    const double& value) throw(std::out_of_range)
 {
-    indicators_.at(indicator) = value;
+    set(index(indicator), value);
+}
+
+double
+StatisticsStorage::get(size_t idx) const
+{
+    double value = values_[idx].value_.load(std::memory_order_relaxed);
+    for (auto& shard:shards_)
+        value += shard.deltas_[idx].load(std::memory_order_relaxed);
+    return value;
+}
+
+void
+StatisticsStorage::set(size_t idx, double value)
+{
+    values_[idx].value_.store(value, std::memory_order_relaxed);
+    for (auto& shard:shards_)
+        shard.deltas_[idx].store(0, std::memory_order_relaxed);
+}
+
+void
+StatisticsStorage::add(size_t idx, double delta)
+{
+    // shard is shared only if there are more threads than shards, hence
+    // CAS loop rarely spins
+    std::atomic<double>& d = shards_[shardIndex()].deltas_[idx];
+    double current = d.load(std::memory_order_relaxed);
+    while (!d.compare_exchange_weak(current, current+delta, std::memory_order_relaxed));
+}
+
+size_t
+StatisticsStorage::shardIndex()
+{
+    static std::atomic<size_t> nThreads(0);
+    static thread_local size_t shard = nThreads.fetch_add(1)%ShardsNum;
+    return shard;
 }
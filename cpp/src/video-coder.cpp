@@ -113,7 +113,6 @@ FrameScaler::FrameScaler(unsigned int dstWidth, unsigned int dstHeight)
     : srcWidth_(0), srcHeight_(0),
       dstWidth_(dstWidth), dstHeight_(dstHeight)
 {
-    initScaledFrame();
 }
 
 const WebRtcVideoFrame
@@ -124,25 +123,20 @@ FrameScaler::operator()(const WebRtcVideoFrame &frame)
     //     scaledFrameBuffer_->ScaleFrom(frame);
     // });
 
-    scaledFrameBuffer_->ScaleFrom(*(frame.video_frame_buffer()));
+    if (frame.width() == (int)dstWidth_ && frame.height() == (int)dstHeight_)
+        return frame;
 
-    return WebRtcVideoFrame(scaledFrameBuffer_, frame.rotation(), frame.timestamp_us());
-}
+    // pool hands out a buffer that is not referenced by any frame still
+    // queued for encoding and allocates a new one otherwise
+    WebRtcSmartPtr<WebRtcVideoFrameBuffer> scaledFrameBuffer =
+        bufferPool_.CreateBuffer(dstWidth_, dstHeight_);
 
-void FrameScaler::initScaledFrame()
-{
-    int stride_y = dstWidth_;
-    int stride_uv = (dstWidth_ + 1) / 2;
-    int target_width = dstWidth_;
-    int target_height = dstHeight_;
+    if (!scaledFrameBuffer)
+        throw std::runtime_error("failed to allocate scaled frame");
 
-    scaledFrameBuffer_ = I420Buffer::Create(target_width,
-                                            abs(target_height),
-                                            stride_y,
-                                            stride_uv, stride_uv);
+    scaledFrameBuffer->ScaleFrom(*(frame.video_frame_buffer()));
 
-    if (!scaledFrameBuffer_)
-        throw std::runtime_error("failed to allocate scaled frame");
+    return WebRtcVideoFrame(scaledFrameBuffer, frame.rotation(), frame.timestamp_us());
 }
 
 //********************************************************************************
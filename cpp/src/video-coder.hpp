@@ -13,6 +13,7 @@
 #define __ndnrtc__video_coder__
 
 #include <webrtc/modules/video_coding/include/video_codec_interface.h>
+#include <webrtc/common_video/include/i420_buffer_pool.h>
 
 #include "webrtc.hpp"
 #include "ndnrtc-common.hpp"
@@ -50,6 +51,9 @@ class IEncoderDelegate
      * was the first to access pool. As frame scaling involves pool access,
      * one has to ensure that scaling is always performed on the same thread.
      * This rule affects applies to all FrameScaler instances.
+     * Scaled frames are allocated from the scaler's own pool, so a frame
+     * returned by the scaler stays valid while it waits for the encoder,
+     * regardless of how many frames were scaled after it.
      */
 class FrameScaler
 {
@@ -64,10 +68,7 @@ class FrameScaler
     unsigned int dstWidth_, dstHeight_;
     // webrtc::Scaler scaler_;
     // WebRtcVideoFrame scaledFrame_;
-    WebRtcSmartPtr<WebRtcVideoFrameBuffer> scaledFrameBuffer_;
-
-    void
-    initScaledFrame();
+    webrtc::I420BufferPool bufferPool_;
 };
 
 /**
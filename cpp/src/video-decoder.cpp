@@ -20,6 +20,7 @@
 
 using namespace std;
 using namespace ndnrtc;
+using namespace ndnrtc::statistics;
 
 //********************************************************************************
 #pragma mark - construction/destruction
@@ -90,3 +91,129 @@ int32_t VideoDecoder::Decoded(WebRtcVideoFrame &decodedImage)
     onDecodedImage_(frameInfo_, decodedImage);
     return 0;
 }
+
+//********************************************************************************
+#pragma mark - DecoderPool
+DecoderPool::DecoderPool(unsigned int nThreads):
+work_(std::make_shared<boost::asio::io_service::work>(io_))
+{
+    for (unsigned int i = 0; i < std::max(1u, nThreads); ++i)
+        threads_.push_back(std::make_shared<boost::thread>([this](){ io_.run(); }));
+}
+
+DecoderPool::~DecoderPool()
+{
+    work_.reset();
+    io_.stop();
+
+    for (auto &t : threads_)
+        if (t->joinable())
+            t->join();
+}
+
+DecoderPool& DecoderPool::getSharedPool()
+{
+    // decoders are multi-threaded themselves, so half of the cores is
+    // enough to decode several streams in parallel
+    static DecoderPool pool(std::max(2u, boost::thread::hardware_concurrency()/2));
+    return pool;
+}
+
+//********************************************************************************
+#pragma mark - AsyncDecoder
+AsyncDecoder::AsyncDecoder(const VideoCoderParams& settings,
+                           OnDecodedImage onDecodedImage,
+                           const std::shared_ptr<StatisticsStorage>& statStorage,
+                           DecoderPool& pool, size_t queueSize):
+decoder_(std::make_shared<VideoDecoder>(settings, onDecodedImage)),
+statStorage_(statStorage),
+strand_(pool.getIo()),
+queue_(queueSize, StageOverflow::DropNewest),
+waitForKey_(false)
+{
+    description_ = "async-" + decoder_->getDescription();
+}
+
+AsyncDecoder::~AsyncDecoder()
+{
+    stop();
+}
+
+void AsyncDecoder::processFrame(const FrameInfo& frameInfo, const webrtc::EncodedImage& encodedImage)
+{
+    bool isKey = (encodedImage._frameType == webrtc::kVideoFrameKey);
+
+    if (waitForKey_ && !isKey)
+    {
+        LogDebugC << "drop " << frameInfo.playbackNo_ << "p: waiting for key frame" << std::endl;
+        (*statStorage_)[Indicator::DecodeDroppedNum]++;
+        return;
+    }
+    waitForKey_ = false;
+
+    // encoded image points into sample's buffer, which is not available
+    // after this call returns
+    EncodedFrame frame;
+    frame.frameInfo_ = frameInfo;
+    frame.image_ = encodedImage;
+    frame.buffer_ = std::make_shared<std::vector<uint8_t>>(encodedImage._buffer,
+                                                           encodedImage._buffer + encodedImage._length);
+
+    if (queue_.push(frame))
+    {
+        std::shared_ptr<AsyncDecoder> me = std::static_pointer_cast<AsyncDecoder>(shared_from_this());
+        strand_.post([me](){ me->decodeNext(); });
+    }
+    else
+    {
+        LogWarnC << "decoder queue is full (" << queue_.capacity() << "), drop "
+                 << frameInfo.playbackNo_ << "p" << std::endl;
+
+        waitForKey_ = true;
+        (*statStorage_)[Indicator::DecodeDroppedNum]++;
+    }
+
+    (*statStorage_)[Indicator::DecodeQueueSize] = queue_.size();
+}
+
+void AsyncDecoder::stop()
+{
+    queue_.close();
+
+    // wait for the frame being decoded
+    boost::lock_guard<boost::mutex> scopedLock(decodeMutex_);
+    queue_.reopen();
+    waitForKey_ = false;
+}
+
+void AsyncDecoder::setLogger(std::shared_ptr<ndnlog::new_api::Logger> logger)
+{
+    NdnRtcComponent::setLogger(logger);
+    decoder_->setLogger(logger);
+}
+
+void AsyncDecoder::decodeNext()
+{
+    // called on decoder pool thread, serialized by strand
+    boost::lock_guard<boost::mutex> scopedLock(decodeMutex_);
+    EncodedFrame frame;
+    int64_t enqueuedUsec;
+
+    if (!queue_.pop(frame, enqueuedUsec))
+        return;
+
+    webrtc::EncodedImage image(frame.image_);
+    image._buffer = frame.buffer_->data();
+    image._length = frame.buffer_->size();
+    image._size = frame.buffer_->size();
+
+    int64_t decodeStartUsec = clock::microsecondTimestamp();
+    decoder_->processFrame(frame.frameInfo_, image);
+
+    decodingTime_.newValue((double)(clock::microsecondTimestamp() - decodeStartUsec) / 1000.);
+    queue_.done(enqueuedUsec);
+
+    (*statStorage_)[Indicator::DecodeQueueSize] = queue_.size();
+    (*statStorage_)[Indicator::DecodeDelay] = queue_.getLatency();
+    (*statStorage_)[Indicator::DecodingTime] = decodingTime_.value();
+}
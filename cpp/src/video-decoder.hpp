@@ -12,12 +12,17 @@
 #ifndef __ndnrtc__video_decoder__
 #define __ndnrtc__video_decoder__
 
+#include <atomic>
+#include <boost/asio.hpp>
+#include <boost/thread.hpp>
 #include <webrtc/modules/video_coding/include/video_codec_interface.h>
 
 #include "ndnrtc-common.hpp"
 #include "webrtc.hpp"
 #include "video-playout-impl.hpp"
 #include "interfaces.hpp"
+#include "pipeline-stage.hpp"
+#include "statistics.hpp"
 
 namespace ndnrtc {
     typedef std::function<void(const FrameInfo&, const WebRtcVideoFrame&)> OnDecodedImage;
@@ -47,6 +52,80 @@ namespace ndnrtc {
         // interface conformance - webrtc::DecodedImageCallback
         int32_t Decoded(WebRtcVideoFrame& decodedImage);
     };
+
+    /**
+     * DecoderPool is a pool of threads for decoding frames of remote streams.
+     * One pool is shared by all remote streams (see getSharedPool()), frames
+     * of each stream are decoded sequentially by AsyncDecoder.
+     */
+    class DecoderPool
+    {
+    public:
+        DecoderPool(unsigned int nThreads);
+        ~DecoderPool();
+
+        boost::asio::io_service& getIo() { return io_; }
+        size_t getSize() const { return threads_.size(); }
+
+        static DecoderPool& getSharedPool();
+
+    private:
+        DecoderPool(const DecoderPool&) = delete;
+
+        boost::asio::io_service io_;
+        std::shared_ptr<boost::asio::io_service::work> work_;
+        std::vector<std::shared_ptr<boost::thread>> threads_;
+    };
+
+    /**
+     * AsyncDecoder moves decoding (and everything that happens to decoded
+     * frames in OnDecodedImage callback, such as color conversion and
+     * rendering) off the playout thread. Encoded frames are copied into a
+     * bounded queue and decoded on the decoder pool threads, one at a time
+     * and in the order they were received.
+     * If the queue is full, incoming frame is dropped and all consequent
+     * delta frames are dropped until next key frame.
+     */
+    class AsyncDecoder : public IEncodedFrameConsumer,
+                         public NdnRtcComponent
+    {
+    public:
+        AsyncDecoder(const VideoCoderParams& settings,
+            OnDecodedImage onDecodedImage,
+            const std::shared_ptr<statistics::StatisticsStorage>& statStorage,
+            DecoderPool& pool = DecoderPool::getSharedPool(),
+            size_t queueSize = 8);
+        ~AsyncDecoder();
+
+        // interface conformance - IEncodedFrameConsumer
+        void processFrame(const FrameInfo&, const webrtc::EncodedImage&);
+
+        /**
+         * Discards queued frames and waits for the frame being decoded (if
+         * any). Must not be called from OnDecodedImage callback.
+         */
+        void stop();
+
+        void setLogger(std::shared_ptr<ndnlog::new_api::Logger> logger);
+
+    private:
+        typedef struct _EncodedFrame {
+            FrameInfo frameInfo_;
+            webrtc::EncodedImage image_;
+            std::shared_ptr<std::vector<uint8_t>> buffer_;
+        } EncodedFrame;
+
+        std::shared_ptr<VideoDecoder> decoder_;
+        std::shared_ptr<statistics::StatisticsStorage> statStorage_;
+        boost::asio::io_service::strand strand_;
+        StageQueue<EncodedFrame> queue_;
+        boost::mutex decodeMutex_;
+        // set by stop() and processFrame(), which may run on different threads
+        std::atomic<bool> waitForKey_;
+        estimators::Filter decodingTime_;
+
+        void decodeNext();
+    };
 }
 
 #endif /* defined(__ndnrtc__video_decoder__) */
@@ -5,8 +5,6 @@
 //  Copyright 2013-2016 Regents of the University of California
 //
 
-#define BOOST_THREAD_PROVIDES_FUTURE
-#include <boost/thread/future.hpp>
 #include <boost/asio.hpp>
 #include <ndn-cpp/c/common.h>
 #include <ndn-cpp/face.hpp>
@@ -17,6 +15,7 @@
 #include "video-stream-impl.hpp"
 #include "frame-data.hpp"
 #include "video-thread.hpp"
+#include "encoder-worker.hpp"
 #include "video-coder.hpp"
 #include "packet-publisher.hpp"
 #include "name-components.hpp"
@@ -25,8 +24,7 @@
 #include "clock.hpp"
 #include "async.hpp"
 #include "params.hpp"
-
-#define PARITY_RATIO 0.2
+#include "parity-control.hpp"
 
 using namespace ndnrtc;
 using namespace ndnrtc::statistics;
@@ -34,29 +32,75 @@ using namespace ndn;
 using namespace estimators;
 
 typedef std::shared_ptr<VideoFramePacket> FramePacketPtr;
-typedef boost::future<FramePacketPtr> FutureFrame;
-typedef std::shared_ptr<boost::future<FramePacketPtr>> FutureFramePtr;
 
+//******************************************************************************
+struct VideoStreamImpl::RawFrame
+{
+    RawFrame(const WebRtcVideoFrame &frame, PacketNumber playbackNo)
+        : frame_(frame), playbackNo_(playbackNo) {}
+
+    WebRtcVideoFrame frame_;
+    PacketNumber playbackNo_;
+};
+
+struct VideoStreamImpl::EncodedFrame
+{
+    std::string thread_;
+    FramePacketPtr fp_;
+    PacketNumber playbackNo_;
+    unsigned char gopPos_;
+};
+
+struct VideoStreamImpl::PreparedFrame
+{
+    std::string thread_;
+    FramePacketPtr fp_;
+    std::shared_ptr<NetworkData> parityData_;
+    std::shared_ptr<VideoStreamImpl::MetaKeeper> keeper_;
+    std::shared_ptr<ParityControl> parityControl_;
+    Name dataName_;
+    bool isKey_;
+    PacketNumber seqNo_, pairedSeq_, playbackNo_;
+    unsigned char gopPos_;
+    size_t nDataSeg_, nParitySeg_;
+    double parityRatio_;
+};
+
+//******************************************************************************
 VideoStreamImpl::VideoStreamImpl(const std::string &streamPrefix,
                                  const MediaStreamSettings &settings, bool useFec)
     : MediaStreamBase(streamPrefix, settings),
       playbackCounter_(0),
-      fecEnabled_(useFec),
-      busyPublishing_(0)
+      nextCore_(0),
+      fecEnabled_(useFec)
 {
     if (settings_.params_.type_ == MediaStreamParams::MediaStreamType::MediaStreamTypeAudio)
         throw std::runtime_error("Wrong media stream parameters type supplied (audio instead of video)");
 
     description_ = "vstream-" + settings_.params_.streamName_;
 
+    const EncoderWorkerSettings &ws = settings_.encoderWorkers_;
+    scaleStage_ = std::make_shared<PipelineStage<RawFramePtr>>(ws.queueSize_,
+        (ws.dropPolicy_ == EncoderWorkerSettings::DropNewest ? StageOverflow::DropNewest
+                                                            : StageOverflow::DropOldest));
+    parityStage_ = std::make_shared<PipelineStage<EncodedFramePtr>>(ws.publishQueueSize_,
+                                                                    StageOverflow::Wait);
+    publishQueue_ = std::make_shared<StageQueue<PreparedFramePtr>>(ws.publishQueueSize_,
+                                                                   StageOverflow::Wait);
+
+    scaleStage_->setDescription("scale-stage-" + settings_.params_.streamName_);
+    parityStage_->setDescription("parity-stage-" + settings_.params_.streamName_);
+
     for (int i = 0; i < settings_.params_.getThreadNum(); ++i)
         if (settings_.params_.getVideoThread(i))
             add(settings_.params_.getVideoThread(i));
 
     PublisherSettings ps;
-    ps.sign_ = false; // stream samples are not signed - we use manifests for verification
+    // unless asked otherwise, stream samples are not signed - we use manifests for verification
+    ps.sign_ = (settings_.sign_ && settings_.signing_.mode_ == SigningSettings::SignAll);
     ps.keyChain_ = settings_.keyChain_;
-    ps.memoryCache_ = cache_.get();
+    ps.signingPool_ = signingPool_.get();
+    ps.contentStore_ = contentStore_.get();
     ps.segmentWireLength_ = settings_.params_.producerParams_.segmentSize_;
     ps.freshnessPeriodMs_ = settings_.params_.producerParams_.freshness_.sampleMs_;
     ps.statStorage_ = statStorage_.get();
@@ -68,11 +112,14 @@ VideoStreamImpl::VideoStreamImpl(const std::string &streamPrefix,
 
     framePublisher_ = std::make_shared<VideoPacketPublisher>(ps);
     framePublisher_->setDescription("seg-publisher-" + settings_.params_.streamName_);
+
+    contentStore_->setOnSampleHit(std::bind(&VideoStreamImpl::onSampleHit, this,
+                                            std::placeholders::_1, std::placeholders::_2));
 }
 
 VideoStreamImpl::~VideoStreamImpl()
 {
-    // cleanup
+    stopPipeline();
 }
 
 std::vector<std::string> VideoStreamImpl::getThreads() const
@@ -80,7 +127,7 @@ std::vector<std::string> VideoStreamImpl::getThreads() const
     boost::lock_guard<boost::mutex> scopedLock(internalMutex_);
     std::vector<std::string> threads;
 
-    for (auto it : threads_)
+    for (auto it : encoders_)
         threads.push_back(it.first);
 
     return threads;
@@ -115,8 +162,10 @@ void VideoStreamImpl::setLogger(std::shared_ptr<ndnlog::new_api::Logger> logger)
     boost::lock_guard<boost::mutex> scopedLock(internalMutex_);
     MediaStreamBase::setLogger(logger);
 
-    for (auto t : threads_)
+    for (auto t : encoders_)
         t.second->setLogger(logger);
+    scaleStage_->setLogger(logger);
+    parityStage_->setLogger(logger);
     framePublisher_->setLogger(logger);
     metadataPublisher_->setLogger(logger);
     ILoggingObject::setLogger(logger);
@@ -127,7 +176,7 @@ void VideoStreamImpl::add(const MediaThreadParams *mp)
 {
     const VideoThreadParams *params = static_cast<const VideoThreadParams *>(mp);
     // check if thread already exists
-    if (threads_.find(params->threadName_) != threads_.end())
+    if (encoders_.find(params->threadName_) != encoders_.end())
     {
         std::stringstream ss;
         ss << "Thread " << params->threadName_ << " has been added already";
@@ -136,15 +185,27 @@ void VideoStreamImpl::add(const MediaThreadParams *mp)
     else
     {
         boost::lock_guard<boost::mutex> scopedLock(internalMutex_);
-
-        threads_[params->threadName_] = std::make_shared<VideoThread>(params->coderParams_);
-        scalers_[params->threadName_] = std::make_shared<FrameScaler>(params->coderParams_.encodeWidth_,
-                                                                        params->coderParams_.encodeHeight_);
-        seqCounters_[params->threadName_].first = -1;
-        seqCounters_[params->threadName_].second = -1;
-        metaKeepers_[params->threadName_] = std::make_shared<MetaKeeper>(params);
-
-        threads_[params->threadName_]->setDescription("thread-" + params->threadName_);
+        std::string threadName = params->threadName_;
+        unsigned int nCores = std::max(1u, boost::thread::hardware_concurrency());
+        std::shared_ptr<EncoderWorker> worker =
+            std::make_shared<EncoderWorker>(params->coderParams_, settings_.encoderWorkers_,
+                                            nextCore_++ % nCores);
+
+        encoders_[threadName] = worker;
+        scalers_[threadName] = std::make_shared<FrameScaler>(params->coderParams_.encodeWidth_,
+                                                             params->coderParams_.encodeHeight_);
+        seqCounters_[threadName].first = -1;
+        seqCounters_[threadName].second = -1;
+        metaKeepers_[threadName] = std::make_shared<MetaKeeper>(params);
+        parityControls_[threadName] = std::make_shared<ParityControl>();
+
+        worker->setDescription(threadName);
+        worker->setLogger(logger_);
+        worker->start(std::bind(&VideoStreamImpl::onFrameEncoded, this, threadName,
+                                std::placeholders::_1, std::placeholders::_2,
+                                std::placeholders::_3, std::placeholders::_4),
+                      std::bind(&VideoStreamImpl::onFrameDropped, this, threadName,
+                                std::placeholders::_1));
     }
 
     LogTraceC << "added thread " << params->threadName_ << std::endl;
@@ -152,63 +213,72 @@ void VideoStreamImpl::add(const MediaThreadParams *mp)
 
 void VideoStreamImpl::remove(const std::string &threadName)
 {
-    if (threads_.find(threadName) != threads_.end())
+    std::shared_ptr<EncoderWorker> worker;
+
+    if (encoders_.find(threadName) != encoders_.end())
     {
         boost::lock_guard<boost::mutex> scopedLock(internalMutex_);
 
-        threads_.erase(threadName);
+        worker = encoders_[threadName];
+        encoders_.erase(threadName);
         scalers_.erase(threadName);
         seqCounters_.erase(threadName);
         metaKeepers_.erase(threadName);
+        parityControls_.erase(threadName);
 
         LogTraceC << "remove thread " << threadName << std::endl;
     }
+
+    // worker must be stopped outside of the lock, as it may be
+    // waiting for it in onFrameEncoded callback
+    if (worker)
+        worker->stop();
 }
 
-bool VideoStreamImpl::feedFrame(const WebRtcVideoFrame &frame)
+void VideoStreamImpl::startPipeline()
 {
-    (*statStorage_)[Indicator::CapturedNum]++;
+    // stage workers may still run while stream is being destroyed, thus
+    // they hold weak reference to it
+    std::weak_ptr<VideoStreamImpl> me = std::static_pointer_cast<VideoStreamImpl>(shared_from_this());
+
+    scaleStage_->start(std::bind(&VideoStreamImpl::scale, this, std::placeholders::_1),
+                       [this](const RawFramePtr &rawFrame) {
+                           onFrameDropped("*", rawFrame->playbackNo_);
+                       });
+    parityStage_->start(std::bind(&VideoStreamImpl::prepare, this, me, std::placeholders::_1));
+}
 
-    if (busyPublishing_ > 0)
-    {
-        LogWarnC << "⨂ busy publishing (capture rate may be too high)" << std::endl;
-        return false;
-    }
+void VideoStreamImpl::stopPipeline()
+{
+    // stages are stopped in reverse order of frames flow, so that none of
+    // them is left waiting for the room in the next one: parity stage may
+    // be waiting for publish queue and encoders - for parity stage
+    publishQueue_->close();
+    parityStage_->stop();
 
-    if (threads_.size())
+    std::map<std::string, std::shared_ptr<EncoderWorker>> encoders;
     {
         boost::lock_guard<boost::mutex> scopedLock(internalMutex_);
-        LogDebugC << "↓ feeding " << playbackCounter_ << "p into encoders..." << std::endl;
+        encoders = encoders_;
+    }
 
-        std::map<std::string, FutureFramePtr> futureFrames;
-        for (auto it : threads_)
-        {
-            FutureFramePtr ff =
-                std::make_shared<FutureFrame>(boost::move(boost::async(boost::launch::async,
-                                                                         std::bind(&VideoThread::encode, it.second.get(), 
-                                                                         (*scalers_[it.first])(frame)))));
-            futureFrames[it.first] = ff;
-        }
+    for (auto it : encoders)
+        it.second->stop();
 
-        std::map<std::string, FramePacketPtr> frames;
-        for (auto it : futureFrames)
-        {
-            FramePacketPtr f(it.second->get());
-            if (f.get())
-            {
-                (*statStorage_)[Indicator::EncodedNum]++;
-                frames[it.first] = f;
-            }
-        }
+    scaleStage_->stop();
+}
+
+bool VideoStreamImpl::feedFrame(const WebRtcVideoFrame &frame)
+{
+    (*statStorage_)[Indicator::CapturedNum]++;
 
-        (*statStorage_)[Indicator::DroppedNum] += (threads_.size() - frames.size());
-        bool result = false;
+    {
+        boost::lock_guard<boost::mutex> scopedLock(internalMutex_);
 
-        if (frames.size())
+        if (encoders_.empty())
         {
-            publish(frames);
-            playbackCounter_++;
-            result = true;
+            LogWarnC << "incoming frame was given, but there are no threads" << std::endl;
+            return false;
         }
 
         if (!isPeriodicInvocationSet())
@@ -217,131 +287,249 @@ bool VideoStreamImpl::feedFrame(const WebRtcVideoFrame &frame)
             setupInvocation(MediaStreamBase::MetaCheckIntervalMs,
                             std::bind(&VideoStreamImpl::periodicInvocation, me));
         }
+    }
 
-        return result;
+    LogDebugC << "↓ feeding " << playbackCounter_ << "p into pipeline..." << std::endl;
+
+    // hand off frame to scaling stage - capturing thread never waits for
+    // scaling, encoding or publishing
+    if (scaleStage_->push(std::make_shared<RawFrame>(frame, playbackCounter_)))
+    {
+        playbackCounter_++;
+        return true;
     }
-    else
-        LogWarnC << "incoming frame was given, but there are no threads" << std::endl;
 
     return false;
 }
 
-void VideoStreamImpl::publish(std::map<std::string, FramePacketPtr> &frames)
+void VideoStreamImpl::scale(const RawFramePtr &rawFrame)
 {
-    LogTraceC << "will publish " << frames.size() << " frames" << std::endl;
-
-    for (auto it : frames)
+    // called on scaling stage thread
+    std::vector<std::pair<std::shared_ptr<EncoderWorker>, std::shared_ptr<FrameScaler>>> targets;
     {
-        // prepare packet header
-        bool isKey = (it.second->getFrame()._frameType == webrtc::kVideoFrameKey);
+        boost::lock_guard<boost::mutex> scopedLock(internalMutex_);
+        for (auto it : encoders_)
+            targets.push_back(std::make_pair(it.second, scalers_[it.first]));
+    }
+
+    for (auto &t : targets)
+        t.first->enqueue((*t.second)(rawFrame->frame_), rawFrame->playbackNo_);
+}
+
+void VideoStreamImpl::onFrameEncoded(const std::string &thread, const FramePacketPtr &fp,
+                                     PacketNumber playbackNo, double encodeMs, unsigned char gopPos)
+{
+    // called on encoder worker thread
+    (*statStorage_)[Indicator::EncodedNum]++;
 
-        if (isKey)
-            seqCounters_[it.first].first++;
+    std::shared_ptr<EncodedFrame> encodedFrame = std::make_shared<EncodedFrame>();
+    encodedFrame->thread_ = thread;
+    encodedFrame->fp_ = fp;
+    encodedFrame->playbackNo_ = playbackNo;
+    encodedFrame->gopPos_ = gopPos;
+
+    // waits if parity stage is behind - encoded frames must not be lost
+    parityStage_->push(encodedFrame);
+}
+
+void VideoStreamImpl::onFrameDropped(const std::string &thread, PacketNumber playbackNo)
+{
+    // may be called on capture, scaling or encoder worker threads,
+    // thus, must not acquire internalMutex_
+    (*statStorage_)[Indicator::DroppedNum]++;
+
+    LogDebugC << "⨂ " << thread << " dropped " << playbackNo << "p" << std::endl;
+}
+
+void VideoStreamImpl::prepare(const std::weak_ptr<VideoStreamImpl> &me,
+                              const EncodedFramePtr &encodedFrame)
+{
+    // called on parity stage thread
+    const std::string &thread = encodedFrame->thread_;
+    const FramePacketPtr &fp = encodedFrame->fp_;
+    std::shared_ptr<PreparedFrame> f = std::make_shared<PreparedFrame>();
+
+    f->thread_ = thread;
+    f->fp_ = fp;
+    f->isKey_ = (fp->getFrame()._frameType == webrtc::kVideoFrameKey);
+    f->playbackNo_ = encodedFrame->playbackNo_;
+    f->gopPos_ = encodedFrame->gopPos_;
+    f->dataName_ = Name(streamPrefix_);
+
+    { // sequence counters and sync lists are shared among video threads
+        boost::lock_guard<boost::mutex> scopedLock(internalMutex_);
+
+        if (seqCounters_.find(thread) == seqCounters_.end())
+        {
+            LogWarnC << "thread " << thread << " was removed, skip publishing" << std::endl;
+            return;
+        }
+
+        // prepare packet header
+        if (f->isKey_)
+            seqCounters_[thread].first++;
         else
-            seqCounters_[it.first].second++;
+            seqCounters_[thread].second++;
+
+        f->seqNo_ = (f->isKey_ ? seqCounters_[thread].first : seqCounters_[thread].second);
+        f->pairedSeq_ = (f->isKey_ ? seqCounters_[thread].second + 1 : seqCounters_[thread].first);
+        f->keeper_ = metaKeepers_[thread];
+        f->parityControl_ = parityControls_[thread];
 
         CommonHeader packetHdr;
-        packetHdr.sampleRate_ = metaKeepers_[it.first]->getRate();
+        packetHdr.sampleRate_ = f->keeper_->getRate();
         packetHdr.publishTimestampMs_ = clock::millisecondTimestamp();
         packetHdr.publishUnixTimestamp_ = clock::unixTimestamp();
 
-        it.second->setSyncList(getCurrentSyncList(isKey));
-        it.second->setHeader(packetHdr);
+        fp->setSyncList(getCurrentSyncList(f->isKey_));
+        fp->setHeader(packetHdr);
 
-        LogTraceC << "thread " << it.first << " " << packetHdr.sampleRate_
+        LogTraceC << "thread " << thread << " " << packetHdr.sampleRate_
                   << "fps " << packetHdr.publishTimestampMs_ << "ms " << std::endl;
 
-        lastPublished_[it.first].timestamp_ = (uint64_t)(packetHdr.publishUnixTimestamp_*1000);
-        lastPublished_[it.first].playbackNo_ = playbackCounter_;
-        lastPublished_[it.first].ndnName_ = publish(it.first, it.second);
+        f->dataName_.append(thread)
+            .append((f->isKey_ ? NameComponents::NameComponentKey : NameComponents::NameComponentDelta))
+            .appendSequenceNumber(f->seqNo_);
+
+        lastPublished_[thread].timestamp_ = (uint64_t)(packetHdr.publishUnixTimestamp_*1000);
+        lastPublished_[thread].playbackNo_ = f->playbackNo_;
+        lastPublished_[thread].ndnName_ = f->dataName_.toUri();
     }
-}
 
-std::string VideoStreamImpl::publish(const std::string &thread, FramePacketPtr &fp)
-{
-    std::shared_ptr<NetworkData> parityData = fp->getParityData(
-        VideoFrameSegment::payloadLength(settings_.params_.producerParams_.segmentSize_),
-        PARITY_RATIO);
-
-    bool isKey = (fp->getFrame()._frameType == webrtc::kVideoFrameKey);
-    PacketNumber seqNo = (isKey ? seqCounters_[thread].first : seqCounters_[thread].second);
-    PacketNumber pairedSeq = (isKey ? seqCounters_[thread].second + 1 : seqCounters_[thread].first);
-    PacketNumber playbackNo = playbackCounter_;
-    unsigned char gopPos = (char)threads_[thread]->getCoder().getGopCounter();
-    Name dataName(streamPrefix_);
-    dataName.append(thread)
-        .append((isKey ? NameComponents::NameComponentKey : NameComponents::NameComponentDelta))
-        .appendSequenceNumber(seqNo);
-
-    size_t nDataSeg = VideoFrameSegment::numSlices(*fp,
-                                                   settings_.params_.producerParams_.segmentSize_);
-    size_t nParitySeg = VideoFrameSegment::numSlices(*parityData,
-                                                     settings_.params_.producerParams_.segmentSize_);
-    std::shared_ptr<VideoStreamImpl> me = std::static_pointer_cast<VideoStreamImpl>(shared_from_this());
-    std::shared_ptr<MetaKeeper> keeper = metaKeepers_[thread];
+    // parity ratio follows losses observed for this thread and frame class,
+    // on clean links delta frames may go without parity at all
+    f->parityRatio_ = f->parityControl_->getRatio(f->isKey_);
+    f->nDataSeg_ = VideoFrameSegment::numSlices(*fp,
+                                                settings_.params_.producerParams_.segmentSize_);
+    f->nParitySeg_ = 0;
+
+    if (f->parityRatio_ > 0)
+    {
+        f->parityData_ = fp->getParityData(
+            VideoFrameSegment::payloadLength(settings_.params_.producerParams_.segmentSize_),
+            f->parityRatio_);
+
+        if (f->parityData_)
+            f->nParitySeg_ = VideoFrameSegment::numSlices(*f->parityData_,
+                                                          settings_.params_.producerParams_.segmentSize_);
+    }
 
     LogTraceC << "spawned publish task for "
-              << seqNo
-              << (isKey ? "k " : "d ")
-              << playbackNo << "p "
-              << "(" << SAMPLE_SUFFIX(dataName) << ")" << std::endl;
-
-    busyPublishing_++;
-    async::dispatchAsync(settings_.faceIo_, [me, nParitySeg, nDataSeg, seqNo, pairedSeq, keeper, isKey,
-                                             thread, fp, parityData, dataName, playbackNo, gopPos, this] {
-        VideoFrameSegmentHeader segmentHdr;
-        segmentHdr.totalSegmentsNum_ = nDataSeg;
-        segmentHdr.paritySegmentsNum_ = nParitySeg;
-        segmentHdr.playbackNo_ = playbackNo;
-        segmentHdr.pairedSequenceNo_ = pairedSeq;
-
-        PublishedDataPtrVector segments =
-            me->framePublisher_->publish(dataName, *fp, segmentHdr,
-                                         (isKey ? settings_.params_.producerParams_.freshness_.sampleKeyMs_ : -1),
-                                         isKey, true);
-        assert(segments.size());
-        keeper->updateMeta(isKey, nDataSeg, nParitySeg, seqNo, pairedSeq, gopPos);
+              << f->seqNo_
+              << (f->isKey_ ? "k " : "d ")
+              << f->playbackNo_ << "p "
+              << "(" << SAMPLE_SUFFIX(f->dataName_) << ")" << std::endl;
+
+    // waits if face thread is behind
+    if (publishQueue_->push(f))
+        async::dispatchAsync(settings_.faceIo_, [me]() {
+            if (std::shared_ptr<VideoStreamImpl> stream = me.lock())
+                stream->publishNext();
+        });
+}
 
-        LogDebugC << "↓ published "
-                  << seqNo << (isKey ? "k " : "d ") << playbackNo << "p "
-                  << "(" << SAMPLE_SUFFIX(dataName) << ")x" << segments.size()
-                  << " Dgen " << segmentHdr.generationDelayMs_ << "ms" << std::endl;
+void VideoStreamImpl::publishNext()
+{
+    // called on face thread, once per each prepared frame
+    PreparedFramePtr f;
+    int64_t enqueuedUsec;
 
-        PublishedDataPtrVector paritySegments;
-        if (nParitySeg)
-        {
-            Name parityName(dataName);
-            parityName.append(NameComponents::NameComponentParity);
-
-            paritySegments =
-                me->framePublisher_->publish(parityName, *parityData, segmentHdr,
-                                             (isKey ? settings_.params_.producerParams_.freshness_.sampleKeyMs_ : -1),
-                                             isKey);
-            assert(paritySegments.size());
-            std::copy(paritySegments.begin(), paritySegments.end(), std::back_inserter(segments));
-
-            LogDebugC << "↓ published "
-                      << seqNo << (isKey ? "k " : "d ") << playbackNo << "p "
-                      << "(" << PARITY_SUFFIX(parityName) << ")x" << paritySegments.size()
-                      << std::endl;
-        }
-        publishManifest(dataName, segments);
-        busyPublishing_--;
-
-        LogInfoC << "▻ published frame "
-                 << seqNo << (isKey ? "k " : "d ") << playbackNo << "p "
-                 << " data segments x" << segments.size()
-                 << " parity segments x" << paritySegments.size()
-                 << std::endl;
-
-        (*statStorage_)[Indicator::PublishedNum]++;
-        if (isKey)
-            (*statStorage_)[Indicator::PublishedKeyNum]++;
-        if (busyPublishing_ == 0)
+    if (publishQueue_->pop(f, enqueuedUsec))
+    {
+        publish(f);
+        publishQueue_->done(enqueuedUsec);
+
+        if (publishQueue_->empty())
             (*statStorage_)[Indicator::ProcessedNum]++;
-    });
+    }
+}
 
-    return dataName.toUri();
+void VideoStreamImpl::onSampleHit(const NameHandle &handle, const ndn::Interest &interest)
+{
+    // called on face thread; thread of the hit sample was interned when
+    // the sample was published
+    if (!handle.isValid() || handle.class_ == SampleClass::Unknown)
+        return;
+
+    PitStats &cacheHits = cacheHits_[std::make_pair(handle.getThreadName(),
+                                                    handle.class_ == SampleClass::Key)];
+    cacheHits.nInterests_++;
+    if (NameComponents::isRetransmission(interest))
+        cacheHits.nRetransmissions_++;
+}
+
+void VideoStreamImpl::publish(const PreparedFramePtr &f)
+{
+    VideoFrameSegmentHeader segmentHdr;
+    segmentHdr.totalSegmentsNum_ = f->nDataSeg_;
+    segmentHdr.paritySegmentsNum_ = f->nParitySeg_;
+    segmentHdr.playbackNo_ = f->playbackNo_;
+    segmentHdr.pairedSequenceNo_ = f->pairedSeq_;
+
+    PublishedDataPtrVector segments =
+        framePublisher_->publish(f->dataName_, *f->fp_, segmentHdr,
+                                 (f->isKey_ ? settings_.params_.producerParams_.freshness_.sampleKeyMs_ : -1),
+                                 f->isKey_, true);
+    assert(segments.size());
+    PitStats pitStats = framePublisher_->getLastPitStats();
+    f->keeper_->updateMeta(f->isKey_, f->nDataSeg_, f->nParitySeg_, f->parityRatio_,
+                           f->seqNo_, f->pairedSeq_, f->gopPos_);
+
+    LogDebugC << "↓ published "
+              << f->seqNo_ << (f->isKey_ ? "k " : "d ") << f->playbackNo_ << "p "
+              << "(" << SAMPLE_SUFFIX(f->dataName_) << ")x" << segments.size()
+              << " Dgen " << segmentHdr.generationDelayMs_ << "ms" << std::endl;
+
+    PublishedDataPtrVector paritySegments;
+    if (f->nParitySeg_)
+    {
+        Name parityName(f->dataName_);
+        parityName.append(NameComponents::NameComponentParity);
+
+        paritySegments =
+            framePublisher_->publish(parityName, *f->parityData_, segmentHdr,
+                                     (f->isKey_ ? settings_.params_.producerParams_.freshness_.sampleKeyMs_ : -1),
+                                     f->isKey_);
+        assert(paritySegments.size());
+        std::copy(paritySegments.begin(), paritySegments.end(), std::back_inserter(segments));
+
+        pitStats.nSegments_ += framePublisher_->getLastPitStats().nSegments_;
+        pitStats.nHits_ += framePublisher_->getLastPitStats().nHits_;
+        pitStats.nInterests_ += framePublisher_->getLastPitStats().nInterests_;
+        pitStats.nRetransmissions_ += framePublisher_->getLastPitStats().nRetransmissions_;
+
+        LogDebugC << "↓ published "
+                  << f->seqNo_ << (f->isKey_ ? "k " : "d ") << f->playbackNo_ << "p "
+                  << "(" << PARITY_SUFFIX(parityName) << ")x" << paritySegments.size()
+                  << std::endl;
+    }
+    publishManifest(f->dataName_, segments);
+
+    // retransmissions of segments lost after publishing are answered from
+    // content store, they never show up in PIT
+    PitStats &cacheHits = cacheHits_[std::make_pair(f->thread_, f->isKey_)];
+    pitStats.nInterests_ += cacheHits.nInterests_;
+    pitStats.nRetransmissions_ += cacheHits.nRetransmissions_;
+    cacheHits = PitStats();
+
+    f->parityControl_->interestsReceived(f->isKey_, pitStats.nInterests_,
+                                         pitStats.getRetransmissionsNum());
+    LogTraceC << "parity " << f->seqNo_ << (f->isKey_ ? "k" : "d")
+              << " interests " << pitStats.nInterests_
+              << " rtx " << pitStats.getRetransmissionsNum()
+              << " loss " << f->parityControl_->getLossEstimate(f->isKey_)
+              << " ratio " << f->parityRatio_ << " -> "
+              << f->parityControl_->getRatio(f->isKey_) << std::endl;
+
+    LogInfoC << "▻ published frame "
+             << f->seqNo_ << (f->isKey_ ? "k " : "d ") << f->playbackNo_ << "p "
+             << " data segments x" << segments.size()
+             << " parity segments x" << paritySegments.size()
+             << std::endl;
+
+    (*statStorage_)[Indicator::PublishedNum]++;
+    if (f->isKey_)
+        (*statStorage_)[Indicator::PublishedKeyNum]++;
 }
 
 void VideoStreamImpl::publishManifest(ndn::Name dataName, PublishedDataPtrVector &segments)
@@ -350,7 +538,7 @@ void VideoStreamImpl::publishManifest(ndn::Name dataName, PublishedDataPtrVector
     dataName.append(NameComponents::NameComponentManifest).appendVersion(0);
     PublishedDataPtrVector ss = metadataPublisher_->publish(dataName, m);
 
-    LogDebugC << (busyPublishing_ == 1 ? "⤷" : "↓")
+    LogDebugC << (publishQueue_->empty() ? "⤷" : "↓")
               << " published manifest ☆ (" << dataName.getSubName(-5, 5) << ")x"
               << ss.size() << std::endl;
 }
@@ -383,11 +571,31 @@ bool VideoStreamImpl::updateMeta()
                   << " seq " << it.second->getMeta().getSeqNo().first << " "
                   << it.second->getMeta().getSeqNo().second << " "
                   << " gop pos " << (int)it.second->getMeta().getGopPos()
+                  << " parity ratio " << it.second->getMeta().getParityRatio().first << " "
+                  << it.second->getMeta().getParityRatio().second
                   << std::endl;
 
         (*statStorage_)[Indicator::CurrentProducerFramerate] = it.second->getRate();
     }
 
+    // pipeline stages occupancy and latency
+    size_t encodeQueueSize = 0;
+    double encodeDelay = 0;
+    for (auto it : encoders_)
+    {
+        encodeQueueSize += it.second->getQueueDepth();
+        encodeDelay = std::max(encodeDelay, it.second->getLatency());
+    }
+
+    (*statStorage_)[Indicator::ScaleQueueSize] = scaleStage_->getOccupancy();
+    (*statStorage_)[Indicator::ScaleDelay] = scaleStage_->getLatency();
+    (*statStorage_)[Indicator::EncodeQueueSize] = encodeQueueSize;
+    (*statStorage_)[Indicator::EncodingDelay] = encodeDelay;
+    (*statStorage_)[Indicator::ParityQueueSize] = parityStage_->getOccupancy();
+    (*statStorage_)[Indicator::ParityDelay] = parityStage_->getLatency();
+    (*statStorage_)[Indicator::PublishQueueSize] = publishQueue_->size();
+    (*statStorage_)[Indicator::PublishDelay] = publishQueue_->getLatency();
+
     return false;
 }
 
@@ -399,6 +607,7 @@ VideoStreamImpl::MetaKeeper::MetaKeeper(const VideoThreadParams *params)
       deltaParity_(Average(std::make_shared<TimeWindow>(100))),
       keyData_(Average(std::make_shared<SampleWindow>(2))),
       keyParity_(Average(std::make_shared<SampleWindow>(2))),
+      parityRatio_(ParityControlSettings().initialRatio_, ParityControlSettings().initialRatio_),
       versionNumber_(0)
 {
 }
@@ -408,7 +617,8 @@ VideoStreamImpl::MetaKeeper::~MetaKeeper()
 }
 
 void VideoStreamImpl::MetaKeeper::updateMeta(bool isKey, size_t nDataSeg, size_t nParitySeg,
-                                             PacketNumber seqNo, PacketNumber pairedSeqNo, unsigned char gopPos)
+                                             double parityRatio, PacketNumber seqNo,
+                                             PacketNumber pairedSeqNo, unsigned char gopPos)
 {
     Average &dataAvg = (isKey ? keyData_ : deltaData_);
     Average &parityAvg = (isKey ? keyParity_ : deltaParity_);
@@ -424,6 +634,7 @@ void VideoStreamImpl::MetaKeeper::updateMeta(bool isKey, size_t nDataSeg, size_t
     parityAvg.newValue(nParitySeg);
     seqNo_.first = (isKey ? pairedSeqNo : seqNo); // first is delta
     seqNo_.second = (isKey ? seqNo : pairedSeqNo); // second is key
+    (isKey ? parityRatio_.second : parityRatio_.first) = parityRatio;
     gopPos_ = gopPos;
     versionNumber_++;
 }
@@ -438,7 +649,8 @@ VideoStreamImpl::MetaKeeper::getMeta() const
     segInfo.keyAvgParitySegNum_ = keyParity_.value();
 
     return boost::move(VideoThreadMeta(rateMeter_.value(), seqNo_.first, seqNo_.second, gopPos_,
-                                       segInfo, ((VideoThreadParams *)params_)->coderParams_));
+                                       segInfo, ((VideoThreadParams *)params_)->coderParams_,
+                                       parityRatio_));
 }
 
 double
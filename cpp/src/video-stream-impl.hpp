@@ -19,11 +19,7 @@
 #include "packet-publisher.hpp"
 #include "frame-converter.hpp"
 #include "estimators.hpp"
-
-namespace ndn
-{
-class MemoryContentCache;
-}
+#include "pipeline-stage.hpp"
 
 namespace ndnlog
 {
@@ -35,14 +31,25 @@ class Logger;
 
 namespace ndnrtc
 {
-class VideoThread;
+class EncoderWorker;
 class FrameScaler;
+class ParityControl;
 class VideoThreadParams;
 struct Mutable;
 template <typename T>
 class VideoFramePacketT;
 typedef VideoFramePacketT<Mutable> VideoFramePacketAlias;
 
+/**
+ * Video stream publishes captured frames through a pipeline of stages:
+ *  capture -> scale -> encode -> parity -> publish
+ * Each stage runs on its own thread (encoding - one thread per video thread,
+ * publishing - on face thread) and stages are connected by lock-free queues,
+ * so that frame N+1 can be scaled and encoded while frame N is still being
+ * published. Raw frames may be dropped by the scaling and encoding stages
+ * if these can't keep up with the capture rate; encoded frames are never
+ * dropped.
+ */
 class VideoStreamImpl : public MediaStreamBase
 {
   public:
@@ -74,7 +81,7 @@ class VideoStreamImpl : public MediaStreamBase
         VideoThreadMeta getMeta() const;
         double getRate() const;
 
-        void updateMeta(bool isKey, size_t nDataSeg, size_t nParitySeg, 
+        void updateMeta(bool isKey, size_t nDataSeg, size_t nParitySeg, double parityRatio,
                         PacketNumber seqNo, PacketNumber pairedSeqNo, unsigned char gopPos);
 
         uint32_t getVersionNumber() const { return versionNumber_; }
@@ -86,28 +93,53 @@ class VideoStreamImpl : public MediaStreamBase
         estimators::Average deltaData_, deltaParity_;
         estimators::Average keyData_, keyParity_;
         std::pair<PacketNumber, PacketNumber> seqNo_;
+        std::pair<double, double> parityRatio_; // first is delta, second is key
         unsigned char gopPos_;
         uint32_t versionNumber_;
     };
 
+    // items passed between pipeline stages, defined in .cpp
+    struct RawFrame;
+    struct EncodedFrame;
+    struct PreparedFrame;
+    typedef std::shared_ptr<RawFrame> RawFramePtr;
+    typedef std::shared_ptr<EncodedFrame> EncodedFramePtr;
+    typedef std::shared_ptr<PreparedFrame> PreparedFramePtr;
+
     bool fecEnabled_;
-    boost::atomic<int> busyPublishing_;
     RawFrameConverter conv_;
-    std::map<std::string, std::shared_ptr<VideoThread>> threads_;
+    std::map<std::string, std::shared_ptr<EncoderWorker>> encoders_;
     std::map<std::string, std::shared_ptr<FrameScaler>> scalers_;
     std::map<std::string, std::shared_ptr<MetaKeeper>> metaKeepers_;
+    std::map<std::string, std::shared_ptr<ParityControl>> parityControls_;
     std::map<std::string, std::pair<uint64_t, uint64_t>> seqCounters_;
     uint64_t playbackCounter_;
+    unsigned int nextCore_;
+    std::shared_ptr<PipelineStage<RawFramePtr>> scaleStage_;
+    std::shared_ptr<PipelineStage<EncodedFramePtr>> parityStage_;
+    std::shared_ptr<StageQueue<PreparedFramePtr>> publishQueue_;
     std::shared_ptr<VideoPacketPublisher> framePublisher_;
     std::map<std::string, FrameInfo> lastPublished_;
+    // Interests answered from content store since last published frame of
+    // thread and frame class (true for key); accessed on face thread only
+    std::map<std::pair<std::string, bool>, PitStats> cacheHits_;
 
     void add(const MediaThreadParams *params) override;
     void remove(const std::string &threadName) override;
     bool updateMeta() override;
+    void startPipeline();
+    void stopPipeline();
 
     bool feedFrame(const WebRtcVideoFrame &frame);
-    void publish(std::map<std::string, std::shared_ptr<VideoFramePacketAlias>> &frames);
-    std::string publish(const std::string &thread, std::shared_ptr<VideoFramePacketAlias> &fp);
+    // pipeline stages
+    void scale(const RawFramePtr &rawFrame);
+    void onFrameEncoded(const std::string &thread, const std::shared_ptr<VideoFramePacketAlias> &fp,
+                        PacketNumber playbackNo, double encodeMs, unsigned char gopPos);
+    void onFrameDropped(const std::string &thread, PacketNumber playbackNo);
+    void prepare(const std::weak_ptr<VideoStreamImpl> &me, const EncodedFramePtr &encodedFrame);
+    void publish(const PreparedFramePtr &preparedFrame);
+    void publishNext();
+    void onSampleHit(const NameHandle &handle, const ndn::Interest &interest);
     void publishManifest(ndn::Name dataName, PublishedDataPtrVector &segments);
     std::map<std::string, PacketNumber> getCurrentSyncList(bool forKey = false);
 };
@@ -37,6 +37,8 @@ public:
 class MockNdnMemoryCache 
 {
 public:
+	typedef ndn::MemoryContentCache::PendingInterest PendingInterest;
+
 	MOCK_METHOD2(setInterestFilter, void(const ndn::Name&, const ndn::OnInterestCallback&));
 	MOCK_METHOD2(getPendingInterestsForName, void(const ndn::Name&, std::vector<std::shared_ptr<const ndn::MemoryContentCache::PendingInterest> >&));
 	MOCK_METHOD2(getPendingInterestsWithPrefix, void(const ndn::Name&, std::vector<std::shared_ptr<const ndn::MemoryContentCache::PendingInterest> >&));
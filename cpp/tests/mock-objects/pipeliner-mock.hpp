@@ -23,6 +23,7 @@ public:
     MOCK_METHOD2(setSequenceNumber, void(PacketNumber seqNo, ndnrtc::SampleClass cls));
     MOCK_METHOD1(getSequenceNumber, PacketNumber(ndnrtc::SampleClass));
     MOCK_METHOD1(setInterestLifetime, void(unsigned int));
+    MOCK_METHOD2(switchThread, void(const ndn::Name&, PacketNumber));
 };
 
 #endif
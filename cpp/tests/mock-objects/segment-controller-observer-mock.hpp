@@ -16,8 +16,8 @@ class MockSegmentControllerObserver : public ndnrtc::ISegmentControllerObserver
 {
 public:
 	MOCK_METHOD1(segmentArrived, void(const std::shared_ptr<ndnrtc::WireSegment>&));
-	MOCK_METHOD2(segmentRequestTimeout, void(const ndnrtc::NamespaceInfo&, const std::shared_ptr<const ndn::Interest> &));
-	MOCK_METHOD3(segmentNack, void(const ndnrtc::NamespaceInfo&, int, const std::shared_ptr<const ndn::Interest> &));
+	MOCK_METHOD2(segmentRequestTimeout, void(const ndnrtc::NameHandle&, const std::shared_ptr<const ndn::Interest> &));
+	MOCK_METHOD3(segmentNack, void(const ndnrtc::NameHandle&, int, const std::shared_ptr<const ndn::Interest> &));
 	MOCK_METHOD0(segmentStarvation, void());
 };
 
@@ -0,0 +1,117 @@
+//
+// test-audio-bundle-ring.cc
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include <stdlib.h>
+#include <boost/thread.hpp>
+
+#include "gtest/gtest.h"
+#include "src/audio-bundle-ring.hpp"
+
+using namespace ndnrtc;
+
+TEST(TestAudioBundleRing, TestPushPop)
+{
+    AudioBundleRing ring(1000, 2, 4);
+    uint8_t sample[100] = {0};
+
+    EXPECT_EQ(2, ring.getSize());
+    EXPECT_EQ(0, ring.getOccupancy());
+
+    std::shared_ptr<AudioBundlePacket> b1 = ring.acquire();
+    b1->append({false}, sample, sizeof(sample));
+    ring.push(1, b1);
+    std::shared_ptr<AudioBundlePacket> b2 = ring.acquire();
+    EXPECT_EQ(2, ring.getSize());
+    EXPECT_EQ(2, ring.getOccupancy());
+
+    // pool grows under pressure
+    std::shared_ptr<AudioBundlePacket> b3 = ring.acquire();
+    std::shared_ptr<AudioBundlePacket> b4 = ring.acquire();
+    ASSERT_TRUE((bool)b3);
+    ASSERT_TRUE((bool)b4);
+    EXPECT_EQ(4, ring.getSize());
+    EXPECT_EQ(4, ring.getOccupancy());
+
+    // ...until it's exhausted
+    EXPECT_FALSE(ring.acquire());
+    EXPECT_EQ(1, ring.getExhaustedNum());
+
+    uint64_t bundleNo;
+    std::shared_ptr<AudioBundlePacket> bundle;
+    ASSERT_TRUE(ring.pop(bundleNo, bundle));
+    EXPECT_EQ(1, bundleNo);
+    EXPECT_EQ(b1, bundle);
+    EXPECT_EQ(1, bundle->getSamplesNum());
+    EXPECT_FALSE(ring.pop(bundleNo, bundle));
+
+    // released bundles are cleared and reused
+    ring.release(bundle);
+    EXPECT_EQ(3, ring.getOccupancy());
+    std::shared_ptr<AudioBundlePacket> b5 = ring.acquire();
+    EXPECT_EQ(b1, b5);
+    EXPECT_EQ(0, b5->getSamplesNum());
+    EXPECT_EQ(4, ring.getSize());
+}
+
+TEST(TestAudioBundleRing, TestThreads)
+{
+    AudioBundleRing ring(1000, 4, 8);
+    uint8_t sample[100] = {0};
+    unsigned int nBundles = 10000, nPopped = 0, nDropped = 0;
+    uint64_t lastBundleNo = 0;
+    bool ordered = true;
+    boost::atomic<bool> done(false);
+
+    boost::thread consumer([&]() {
+        uint64_t bundleNo;
+        std::shared_ptr<AudioBundlePacket> bundle;
+
+        while (true)
+        {
+            // producer is done if it was done before the queue was found empty
+            bool finished = done;
+
+            if (ring.pop(bundleNo, bundle))
+            {
+                ordered &= (nPopped == 0 || bundleNo > lastBundleNo);
+                ordered &= (bundle->getSamplesNum() == 1);
+                lastBundleNo = bundleNo;
+                nPopped++;
+                ring.release(bundle);
+            }
+            else if (finished)
+                break;
+        }
+    });
+
+    for (unsigned int i = 0; i < nBundles; ++i)
+    {
+        std::shared_ptr<AudioBundlePacket> bundle = ring.acquire();
+        if (bundle)
+        {
+            bundle->append({false}, sample, sizeof(sample));
+            ring.push(i, bundle);
+        }
+        else
+            nDropped++;
+    }
+
+    done = true;
+    consumer.join();
+
+    EXPECT_TRUE(ordered);
+    EXPECT_EQ(nBundles, nPopped + nDropped);
+    EXPECT_EQ(nDropped, ring.getExhaustedNum());
+    EXPECT_GE(8, ring.getSize());
+    EXPECT_EQ(0, ring.getOccupancy());
+}
+
+//******************************************************************************
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,81 @@
+//
+// test-consumer-runtime.cc
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include <stdlib.h>
+#include <set>
+#include <boost/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/lock_guard.hpp>
+
+#include "gtest/gtest.h"
+#include "consumer-runtime.hpp"
+
+using namespace ndnrtc;
+
+TEST(TestConsumerRuntime, TestShards)
+{
+    ConsumerRuntime runtime(4);
+
+    ASSERT_EQ(4, runtime.getShardsNum());
+    EXPECT_NE(runtime.getFace(0), runtime.getFace(1));
+    EXPECT_NE(&runtime.getIo(0), &runtime.getIo(1));
+    EXPECT_ANY_THROW(runtime.getIo(4));
+
+    // each shard runs on its own thread
+    boost::mutex m;
+    std::set<boost::thread::id> threads;
+    boost::atomic<int> nDone(0);
+
+    for (unsigned int i = 0; i < runtime.getShardsNum(); ++i)
+        runtime.getIo(i).post([&](){
+            boost::lock_guard<boost::mutex> scopedLock(m);
+            threads.insert(boost::this_thread::get_id());
+            nDone++;
+        });
+
+    while (nDone < 4) boost::this_thread::sleep_for(boost::chrono::milliseconds(10));
+
+    EXPECT_EQ(4, threads.size());
+    EXPECT_EQ(0, threads.count(boost::this_thread::get_id()));
+    EXPECT_EQ(0, runtime.selectShard());
+    EXPECT_EQ(ConsumerRuntime::AnyShard, runtime.getShard(std::shared_ptr<RemoteStream>()));
+}
+
+TEST(TestConsumerRuntime, TestStats)
+{
+    ConsumerRuntime runtime(2, "localhost", 50);
+
+    // keep shard 1 busy
+    for (int i = 0; i < 4; ++i)
+        runtime.getIo(1).post([](){
+            int64_t start = clock();
+            while (clock() - start < CLOCKS_PER_SEC/10);
+        });
+
+    // busy shard is avoided
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(250));
+    EXPECT_EQ(0, runtime.selectShard());
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(350));
+
+    std::vector<ConsumerRuntime::ShardStats> stats = runtime.getShardStats();
+    ASSERT_EQ(2, stats.size());
+
+    EXPECT_EQ(0, stats[0].shardNo_);
+    EXPECT_EQ(0, stats[0].nStreams_);
+    EXPECT_GT(stats[1].maxIoDelayUsec_, 50000);
+    EXPECT_LE(stats[0].maxIoDelayUsec_, stats[1].maxIoDelayUsec_);
+    EXPECT_LE(0, stats[0].cpuUsage_);
+
+    runtime.stop();
+    EXPECT_ANY_THROW(runtime.createVideoStream(std::shared_ptr<ndn::KeyChain>(), "/prefix", "stream"));
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,305 @@
+//
+// test-content-store.cc
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include <stdlib.h>
+
+#include <boost/asio.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <ndn-cpp/face.hpp>
+#include <ndn-cpp/interest.hpp>
+#include <ndn-cpp/data.hpp>
+
+#include "gtest/gtest.h"
+#include "src/content-store.hpp"
+#include "name-components.hpp"
+#include "statistics.hpp"
+
+using namespace ndnrtc;
+using namespace ndn;
+
+namespace {
+    std::string streamName = "/ndn/edu/ucla/remap/peter/ndncon/instance1/ndnrtc/%FD%03/video/camera";
+    std::string threadName = streamName+"/%FC%00%00%01c_%27%DE%D6/hi";
+
+    // face that records data put instead of sending it
+    class FaceStub : public Face
+    {
+    public:
+        FaceStub() : Face("localhost") {}
+
+        void putData(const Data& data, WireFormat& wireFormat) override
+        {
+            putNames_.push_back(data.getName());
+        }
+
+        std::vector<Name> putNames_;
+    };
+
+    Data segment(PacketNumber seqNo, unsigned int segNo, int freshnessMs = 1000, bool delta = true)
+    {
+        Data data(Name(threadName).append(delta ? "d" : "k").appendSequenceNumber(seqNo).appendSegment(segNo));
+        data.getMetaInfo().setFreshnessPeriod(freshnessMs);
+        return data;
+    }
+
+    std::shared_ptr<Interest> interest(const Name& name, int lifetimeMs = 1000)
+    {
+        return std::make_shared<Interest>(name, lifetimeMs);
+    }
+
+    void expressInterest(ContentStore& store, FaceStub& face, const std::shared_ptr<Interest>& i)
+    {
+        store.onInterest(std::make_shared<Name>(streamName), i, face, 0,
+                         std::shared_ptr<const InterestFilter>());
+    }
+
+    void runFor(boost::asio::io_service& io, int ms)
+    {
+        boost::asio::steady_timer timer(io);
+        timer.expires_from_now(std::chrono::milliseconds(ms));
+        timer.async_wait([&io](const boost::system::error_code&){ io.stop(); });
+        io.run();
+        io.reset();
+    }
+}
+
+TEST(TestContentStore, TestFindSegments)
+{
+    boost::asio::io_service io;
+    FaceStub face;
+    ContentStore store(&face, io);
+
+    for (unsigned int segNo = 0; segNo < 5; ++segNo)
+        store.add(segment(1, segNo));
+    store.add(segment(2, 0, 0));
+
+    EXPECT_EQ(2, store.getSamplesNum());
+    ASSERT_TRUE((bool)store.find(*interest(segment(1, 3).getName())));
+    EXPECT_EQ(segment(1, 3).getName(), store.find(*interest(segment(1, 3).getName()))->getName());
+    EXPECT_FALSE(store.find(*interest(segment(1, 5).getName())));
+    EXPECT_FALSE(store.find(*interest(segment(3, 0).getName())));
+    EXPECT_FALSE(store.find(*interest(segment(1, 0, 1000, false).getName())));
+
+    // Interest for sample prefix
+    Name samplePrefix(threadName);
+    samplePrefix.append("d").appendSequenceNumber(1);
+    EXPECT_TRUE((bool)store.find(*interest(samplePrefix)));
+
+    // stale data is not returned for MustBeFresh Interests
+    std::shared_ptr<Interest> fresh = interest(segment(2, 0).getName());
+    EXPECT_TRUE((bool)store.find(*fresh));
+    fresh->setMustBeFresh(true);
+    EXPECT_FALSE(store.find(*fresh));
+
+    expressInterest(store, face, interest(segment(1, 4).getName()));
+    ASSERT_EQ(1, face.putNames_.size());
+    EXPECT_EQ(segment(1, 4).getName(), face.putNames_[0]);
+    EXPECT_EQ(0, store.getPendingNum());
+}
+
+TEST(TestContentStore, TestPendingInterests)
+{
+    boost::asio::io_service io;
+    FaceStub face;
+    ContentStore store(&face, io);
+    Name samplePrefix(threadName);
+    samplePrefix.append("d").appendSequenceNumber(7);
+
+    expressInterest(store, face, interest(segment(7, 0).getName()));
+    expressInterest(store, face, interest(segment(7, 0).getName()));
+    expressInterest(store, face, interest(segment(7, 1).getName()));
+    expressInterest(store, face, interest(segment(8, 0).getName()));
+    expressInterest(store, face, interest(Name(streamName).append("_meta")));
+
+    EXPECT_EQ(5, store.getPendingNum());
+    EXPECT_EQ(0, face.putNames_.size());
+
+    {
+        ContentStore::PendingInterests pis;
+        store.getPendingInterestsForName(segment(7, 0).getName(), pis);
+        EXPECT_EQ(2, pis.size());
+    }
+    {
+        ContentStore::PendingInterests pis;
+        store.getPendingInterestsWithPrefix(samplePrefix, pis);
+        EXPECT_EQ(3, pis.size());
+    }
+    {
+        ContentStore::PendingInterests pis;
+        store.getPendingInterestsWithPrefix(Name(streamName), pis);
+        EXPECT_EQ(5, pis.size());
+    }
+
+    // both Interests are satisfied with one data
+    store.add(segment(7, 0));
+    EXPECT_EQ(1, face.putNames_.size());
+    EXPECT_EQ(3, store.getPendingNum());
+
+    {
+        ContentStore::PendingInterests pis;
+        store.getPendingInterestsWithPrefix(samplePrefix, pis);
+        ASSERT_EQ(1, pis.size());
+        EXPECT_EQ(segment(7, 1).getName(), pis[0]->getInterest()->getName());
+    }
+
+    Data meta(Name(streamName).append("_meta").appendVersion(1).appendSegment(0));
+    meta.getMetaInfo().setFreshnessPeriod(1000);
+    store.add(meta);
+    EXPECT_EQ(2, face.putNames_.size());
+    EXPECT_EQ(2, store.getPendingNum());
+}
+
+TEST(TestContentStore, TestRing)
+{
+    boost::asio::io_service io;
+    FaceStub face;
+    ContentStore store(&face, io, nullptr, 4);
+
+    for (PacketNumber seqNo = 0; seqNo < 6; ++seqNo)
+    {
+        store.add(segment(seqNo, 0));
+        store.add(segment(seqNo, 1));
+    }
+    store.add(segment(0, 0, 1000, false));
+
+    EXPECT_EQ(5, store.getSamplesNum());
+    EXPECT_FALSE(store.find(*interest(segment(1, 0).getName())));
+    EXPECT_TRUE((bool)store.find(*interest(segment(2, 1).getName())));
+    EXPECT_TRUE((bool)store.find(*interest(segment(5, 1).getName())));
+    EXPECT_TRUE((bool)store.find(*interest(segment(0, 0, 1000, false).getName())));
+
+    // data for samples older than the ring answers pending Interests, but
+    // does not evict newer samples
+    expressInterest(store, face, interest(segment(1, 2).getName()));
+    store.add(segment(1, 2));
+    EXPECT_EQ(1, face.putNames_.size());
+    EXPECT_EQ(0, store.getPendingNum());
+    EXPECT_TRUE((bool)store.find(*interest(segment(5, 1).getName())));
+    EXPECT_FALSE(store.find(*interest(segment(1, 2).getName())));
+}
+
+TEST(TestContentStore, TestLatestMeta)
+{
+    boost::asio::io_service io;
+    FaceStub face;
+    ContentStore store(&face, io);
+
+    for (int version = 1; version <= 3; ++version)
+        for (int segNo = 0; segNo < 2; ++segNo)
+        {
+            Data meta(Name(streamName).append("_meta").appendVersion(version).appendSegment(segNo));
+            meta.getMetaInfo().setFreshnessPeriod(1000);
+            store.add(meta);
+        }
+
+    std::shared_ptr<const Data> data = store.find(*interest(Name(streamName).append("_meta")));
+    ASSERT_TRUE((bool)data);
+    EXPECT_EQ(Name(streamName).append("_meta").appendVersion(3).appendSegment(0), data->getName());
+}
+
+TEST(TestContentStore, TestExpiration)
+{
+    boost::asio::io_service io;
+    FaceStub face;
+    ContentStore store(&face, io);
+    store.setMinimumCacheLifetime(50);
+
+    store.add(segment(1, 0, 20));
+    store.add(segment(2, 0, 100));
+
+    Data meta(Name(streamName).append("_meta").appendVersion(1).appendSegment(0));
+    meta.getMetaInfo().setFreshnessPeriod(20);
+    store.add(meta);
+
+    expressInterest(store, face, interest(segment(3, 0).getName(), 30));
+    expressInterest(store, face, interest(segment(3, 1).getName(), 300));
+    EXPECT_EQ(2, store.getPendingNum());
+
+    runFor(io, 80);
+
+    // minimum cache lifetime is longer than freshness of the first sample
+    EXPECT_EQ(1, store.getSamplesNum());
+    EXPECT_FALSE(store.find(*interest(segment(1, 0).getName())));
+    EXPECT_TRUE((bool)store.find(*interest(segment(2, 0).getName())));
+    EXPECT_FALSE(store.find(*interest(Name(streamName).append("_meta"))));
+    EXPECT_EQ(1, store.getPendingNum());
+
+    runFor(io, 300);
+
+    EXPECT_EQ(0, store.getSamplesNum());
+    EXPECT_EQ(0, store.getPendingNum());
+}
+
+TEST(TestContentStore, TestAggregation)
+{
+    boost::asio::io_service io;
+    FaceStub face1, face2;
+    std::shared_ptr<statistics::StatisticsStorage> storage(statistics::StatisticsStorage::createProducerStatistics());
+    const statistics::StatisticsStorage& stat = *storage;
+    ContentStore store(&face1, io, storage);
+
+    for (int i = 0; i < 3; ++i)
+        expressInterest(store, face1, interest(segment(1, 0).getName()));
+    expressInterest(store, face2, interest(segment(1, 0).getName()));
+    expressInterest(store, face1, interest(segment(2, 0).getName()));
+
+    // one data per face for all Interests pending for a segment
+    store.add(segment(1, 0));
+    EXPECT_EQ(1, face1.putNames_.size());
+    EXPECT_EQ(1, face2.putNames_.size());
+    EXPECT_EQ(1, store.getPendingNum());
+    EXPECT_EQ(2, stat[statistics::Indicator::AggregationRatio]);
+    EXPECT_LT(0, stat[statistics::Indicator::FanOut]);
+    EXPECT_EQ(4, stat[statistics::Indicator::GenerationDelayUnder5ms]+
+                 stat[statistics::Indicator::GenerationDelayUnder20ms]+
+                 stat[statistics::Indicator::GenerationDelayUnder100ms]+
+                 stat[statistics::Indicator::GenerationDelayOver100ms]);
+
+    store.add(segment(2, 0));
+    EXPECT_EQ(2, face1.putNames_.size());
+    EXPECT_EQ(0, store.getPendingNum());
+    EXPECT_EQ(5./3., stat[statistics::Indicator::AggregationRatio]);
+}
+
+TEST(TestContentStore, TestSampleHit)
+{
+    boost::asio::io_service io;
+    FaceStub face;
+    ContentStore store(&face, io);
+    std::vector<NameHandle> hits;
+    int nRetransmissions = 0;
+
+    store.setOnSampleHit([&hits, &nRetransmissions](const NameHandle &handle, const Interest &i) {
+        hits.push_back(handle);
+        if (NameComponents::isRetransmission(i))
+            nRetransmissions++;
+    });
+
+    // Interests satisfied when data is added are not hits
+    expressInterest(store, face, interest(segment(1, 0).getName()));
+    store.add(segment(1, 0));
+    store.add(segment(2, 0, 1000, false));
+    EXPECT_EQ(0, hits.size());
+
+    expressInterest(store, face, interest(segment(1, 0).getName()));
+    expressInterest(store, face, NameComponents::retransmission(*interest(segment(1, 0).getName())));
+    expressInterest(store, face, NameComponents::retransmission(*interest(segment(2, 0, 1000, false).getName())));
+    expressInterest(store, face, interest(segment(3, 0).getName()));
+
+    ASSERT_EQ(3, hits.size());
+    EXPECT_EQ(2, nRetransmissions);
+    EXPECT_EQ("hi", hits[0].getThreadName());
+    EXPECT_EQ(SampleClass::Delta, hits[1].class_);
+    EXPECT_EQ(SampleClass::Key, hits[2].class_);
+    EXPECT_EQ(2, hits[2].sampleNo_);
+}
+
+//******************************************************************************
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -173,6 +173,24 @@ TEST(TestFilter, TestSmoothing)
 	EXPECT_LT(5.5-f.value(), 0.5);
 }
 
+TEST(TestHistogram, TestBuckets)
+{
+	Histogram h(boost::assign::list_of (1.) (5.) (20.));
+	std::vector<double> values = boost::assign::list_of (0.) (0.5) (1.) (4.9) (5.) (19.) (20.) (100.);
+	for (auto v:values) h.newValue(v);
+
+	ASSERT_EQ(4, h.getCounts().size());
+	EXPECT_EQ(2, h.getCounts()[0]);
+	EXPECT_EQ(2, h.getCounts()[1]);
+	EXPECT_EQ(2, h.getCounts()[2]);
+	EXPECT_EQ(2, h.getCounts()[3]);
+	EXPECT_EQ(values.size(), h.getTotal());
+
+	h.reset();
+	EXPECT_EQ(0, h.getTotal());
+	EXPECT_EQ(0, h.getCounts()[3]);
+}
+
 
 int main(int argc, char **argv) {
 	::testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,116 @@
+//
+// test-event-trace.cc
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include <stdlib.h>
+#include <boost/thread.hpp>
+
+#include "gtest/gtest.h"
+#include "event-trace.hpp"
+
+using namespace ndnrtc::trace;
+
+TEST(TestEventTrace, TestDumpAndRead)
+{
+    Tracer::clear();
+
+    int nThreads = 4, n = 1000;
+    std::vector<boost::thread> threads;
+    // threads are kept alive until dumped, as rings are freed on thread exit
+    boost::barrier recorded(nThreads+1), dumped(nThreads+1);
+
+    for (int t = 0; t < nThreads; ++t)
+        threads.push_back(boost::thread([t, n, &recorded, &dumped](){
+            for (int i = 0; i < n; ++i)
+                Tracer::record(Event::SegmentReceived, t, i, Tracer::flags(i%2, false), i*10);
+            recorded.wait();
+            dumped.wait();
+        }));
+    recorded.wait();
+
+    std::string path = "/tmp/test-event-trace.bin";
+    EXPECT_EQ(nThreads*n, Tracer::dump(path));
+
+    dumped.wait();
+    for (auto &t:threads) t.join();
+    // rings of exited threads are freed
+    EXPECT_EQ(0, Tracer::dump("/tmp/test-event-trace-exited.bin"));
+    remove("/tmp/test-event-trace-exited.bin");
+
+    std::vector<ThreadTrace> traces;
+    int64_t unixOffset = 0;
+    ASSERT_TRUE(Tracer::read(path, traces, unixOffset));
+    EXPECT_NE(0, unixOffset);
+
+    int nRecords = 0;
+    for (auto& trace:traces)
+    {
+        if (trace.records_.empty()) continue;
+
+        // each thread has its own ring
+        int32_t sampleNo = trace.records_.front().sampleNo_;
+        ASSERT_EQ(n, trace.records_.size());
+        for (int i = 0; i < n; ++i)
+        {
+            const Record& r = trace.records_[i];
+            EXPECT_EQ(sampleNo, r.sampleNo_);
+            EXPECT_EQ(i, r.segNo_);
+            EXPECT_EQ((uint16_t)Event::SegmentReceived, r.event_);
+            EXPECT_EQ((i%2 ? FlagParity : 0), r.flags_);
+            EXPECT_EQ(i*10, r.arg_);
+            if (i)
+            {
+                EXPECT_LE(trace.records_[i-1].timestampUsec_, r.timestampUsec_);
+            }
+        }
+        nRecords += trace.records_.size();
+    }
+
+    EXPECT_EQ(nThreads*n, nRecords);
+    remove(path.c_str());
+}
+
+TEST(TestEventTrace, TestRingOverwrite)
+{
+    Tracer::clear();
+
+    int n = Tracer::RingSize + 100;
+    for (int i = 0; i < n; ++i)
+        Tracer::record(Event::SamplePlayed, i, -1);
+
+    std::string path = "/tmp/test-event-trace.bin";
+    // slot next to be written is never dumped
+    EXPECT_EQ(Tracer::RingSize-1, Tracer::dump(path));
+
+    std::vector<ThreadTrace> traces;
+    int64_t unixOffset = 0;
+    ASSERT_TRUE(Tracer::read(path, traces, unixOffset));
+
+    for (auto& trace:traces)
+        if (trace.records_.size())
+        {
+            // only the most recent records are kept
+            EXPECT_EQ(n-Tracer::RingSize+1, trace.records_.front().sampleNo_);
+            EXPECT_EQ(n-1, trace.records_.back().sampleNo_);
+        }
+
+    { // disabled tracer records nothing
+        Tracer::clear();
+        Tracer::setEnabled(false);
+        Tracer::record(Event::SamplePlayed, 0, -1);
+        EXPECT_EQ(0, Tracer::dump(path));
+        Tracer::setEnabled(true);
+    }
+
+    EXPECT_FALSE(Tracer::read("/tmp/no-such-trace.bin", traces, unixOffset));
+    remove(path.c_str());
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,181 @@
+//
+// test-fec.cc
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include <stdlib.h>
+#include <string.h>
+#include <boost/chrono.hpp>
+
+#include "gtest/gtest.h"
+#include "tests-helpers.hpp"
+#include "src/fec.hpp"
+
+using namespace fec;
+
+namespace {
+    void fillRandom(std::vector<unsigned char>& v)
+    {
+        for (auto& c : v) c = (unsigned char)(rand()%256);
+    }
+
+    // erases nErased random symbols, returns number of erased source symbols
+    int erase(std::vector<unsigned char>& data, std::vector<unsigned char>& rList,
+              unsigned int k, unsigned int len, unsigned int nErased)
+    {
+        int nErasedData = 0;
+
+        while (nErased)
+        {
+            unsigned int i = rand()%rList.size();
+            if (rList[i] == FEC_RLIST_SYMREADY)
+            {
+                rList[i] = FEC_RLIST_SYMEMPTY;
+                if (i < k)
+                {
+                    memset(&data[i*len], 0, len);
+                    nErasedData++;
+                }
+                nErased--;
+            }
+        }
+
+        return nErasedData;
+    }
+
+    class BackendScope {
+    public:
+        BackendScope(Backend b):old_(getBackend()) { setBackend(b); }
+        ~BackendScope() { setBackend(old_); }
+    private:
+        Backend old_;
+    };
+}
+
+TEST(TestFec, TestNativeRecovery)
+{
+    BackendScope scope(Backend::Native);
+    srand(0);
+
+    for (int iter = 0; iter < 200; ++iter)
+    {
+        unsigned int k = 1+rand()%30, m = 1+rand()%10, len = 1+rand()%1200;
+        std::vector<unsigned char> data(k*len), parity(m*len), rList(k+m, FEC_RLIST_SYMREADY);
+
+        fillRandom(data);
+        std::vector<unsigned char> original(data);
+
+        ASSERT_EQ(0, Rs28Encoder(k, m, len).encode(data.data(), parity.data()));
+
+        int nErasedData = erase(data, rList, k, len, rand()%(m+1));
+        EXPECT_EQ(nErasedData, Rs28Decoder(k, m, len).decode(data.data(), parity.data(), rList.data()));
+        EXPECT_EQ(original, data);
+
+        for (unsigned int i = 0; i < k; ++i)
+            EXPECT_NE(FEC_RLIST_SYMEMPTY, rList[i]);
+    }
+
+    { // not enough symbols
+        unsigned int k = 10, m = 2, len = 100;
+        std::vector<unsigned char> data(k*len), parity(m*len), rList(k+m, FEC_RLIST_SYMREADY);
+
+        fillRandom(data);
+        ASSERT_EQ(0, Rs28Encoder(k, m, len).encode(data.data(), parity.data()));
+        erase(data, rList, k, len, m+1);
+        EXPECT_EQ(-1, Rs28Decoder(k, m, len).decode(data.data(), parity.data(), rList.data()));
+    }
+}
+
+TEST(TestFec, TestBackendsCompatibility)
+{
+    srand(1);
+
+    for (int iter = 0; iter < 50; ++iter)
+    {
+        unsigned int k = 1+rand()%30, m = 1+rand()%10, len = 1+rand()%1200;
+        std::vector<unsigned char> data(k*len), nativeParity(m*len), openFecParity(m*len);
+
+        fillRandom(data);
+        NativeRs28Coder(k, m, len).encode(data.data(), nativeParity.data());
+        OpenFecRs28Coder(k, m, len).encode(data.data(), openFecParity.data());
+        EXPECT_EQ(nativeParity, openFecParity);
+
+        // parity produced by the native coder is recovered by OpenFEC
+        std::vector<unsigned char> received(data), rList(k+m, FEC_RLIST_SYMREADY);
+        int nErasedData = erase(received, rList, k, len, m);
+        std::vector<unsigned char> nativeReceived(received), nativeRList(rList);
+
+        // both backends return number of repaired source symbols, mark them
+        // as repaired and leave flags of missing repair symbols unchanged
+        std::vector<unsigned char> expectedRList(rList);
+        for (unsigned int i = 0; i < k; ++i)
+            if (expectedRList[i] != FEC_RLIST_SYMREADY)
+                expectedRList[i] = FEC_RLIST_SYMREPAIRED;
+
+        EXPECT_EQ(nErasedData, OpenFecRs28Coder(k, m, len).decode(received.data(), nativeParity.data(), rList.data()));
+        EXPECT_EQ(data, received);
+        EXPECT_EQ(expectedRList, rList);
+
+        EXPECT_EQ(nErasedData, NativeRs28Coder(k, m, len).decode(nativeReceived.data(), nativeParity.data(), nativeRList.data()));
+        EXPECT_EQ(data, nativeReceived);
+        EXPECT_EQ(expectedRList, nativeRList);
+    }
+}
+
+TEST(TestFec, TestCoderCache)
+{
+    BackendScope scope(Backend::Native);
+
+    std::shared_ptr<FecCoder> c1 = getCoder(10, 3, 1000);
+    EXPECT_EQ(c1, getCoder(10, 3, 1000));
+    EXPECT_NE(c1, getCoder(10, 4, 1000));
+    EXPECT_NE(c1, getCoder(10, 3, 1001));
+    EXPECT_TRUE(std::dynamic_pointer_cast<NativeRs28Coder>(c1).get());
+
+    setBackend(Backend::OpenFec);
+    std::shared_ptr<FecCoder> c2 = getCoder(10, 3, 1000);
+    EXPECT_NE(c1, c2);
+    EXPECT_TRUE(std::dynamic_pointer_cast<OpenFecRs28Coder>(c2).get());
+
+    // evicting old coders
+    for (unsigned int len = 1; len < 100; ++len)
+        getCoder(10, 3, len);
+    EXPECT_NE(c2, getCoder(10, 3, 1000));
+}
+
+TEST(TestFec, TestPerformance)
+{
+    unsigned int k = 20, m = 4, len = 1000, nFrames = 5000;
+    std::vector<unsigned char> data(k*len), parity(m*len);
+    fillRandom(data);
+
+    GT_PRINTF("native coder kernel: %s\n", NativeRs28Coder::getKernelName());
+
+    for (auto backend : {Backend::OpenFec, Backend::Native})
+    {
+        BackendScope scope(backend);
+        boost::chrono::high_resolution_clock::time_point start = boost::chrono::high_resolution_clock::now();
+
+        for (unsigned int i = 0; i < nFrames; ++i)
+        {
+            std::vector<unsigned char> rList(k+m, FEC_RLIST_SYMREADY);
+
+            Rs28Encoder(k, m, len).encode(data.data(), parity.data());
+            rList[i%k] = FEC_RLIST_SYMEMPTY;
+            Rs28Decoder(k, m, len).decode(data.data(), parity.data(), rList.data());
+        }
+
+        boost::chrono::duration<double, boost::micro> elapsed = boost::chrono::high_resolution_clock::now() - start;
+        GT_PRINTF("%s: %.2f usec per frame (encode + decode, %u+%u symbols of %u bytes)\n",
+                  (backend == Backend::Native ? "native" : "openfec"),
+                  elapsed.count()/nFrames, k, m, len);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -549,6 +549,45 @@ TEST(TestVideoFrameSlot, TestAsembleVideoFrame)
 	EXPECT_EQ(1249, videoSlot.readSegmentHeader(slot).pairedSequenceNo_);
 }
 
+TEST(TestVideoFrameSlot, TestAssembleLastSegmentFirst)
+{
+	std::string frameName = "/ndn/edu/ucla/remap/peter/ndncon/instance1/ndnrtc/%FD%03/video/camera/%FC%00%00%01c_%27%DE%D6/hi/d/%FE%07";
+	VideoFramePacket vp = getVideoFramePacket(20000);
+	std::vector<VideoFrameSegment> segments = sliceFrame(vp);
+	std::vector<boost::shared_ptr<ndn::Data>> dataObjects = dataFromSegments(frameName, segments);
+	std::vector<boost::shared_ptr<Interest>> interests = getInterests(frameName, 0, dataObjects.size());
+	BufferSlot slot;
+	VideoFrameSlot videoSlot;
+	boost::shared_ptr<ImmutableVideoFramePacket> videoPacket;
+
+	// last segment is shorter and arrives before payload size is known
+	std::reverse(dataObjects.begin(), dataObjects.end());
+	std::reverse(interests.begin(), interests.end());
+
+	for (int i = 0; i < 2; ++i)
+	{
+		slot.segmentsRequested(makeInterestsConst(interests));
+
+		int idx = 0;
+		for (auto d:dataObjects)
+			ASSERT_NO_THROW(slot.segmentReceived(
+				boost::make_shared<WireData<VideoFrameSegmentHeader>>(d, interests[idx++])));
+
+		bool recovered = false;
+		boost::shared_ptr<ImmutableVideoFramePacket> p = videoSlot.readPacket(slot, recovered);
+		ASSERT_TRUE(p.get());
+		EXPECT_FALSE(recovered);
+		EXPECT_TRUE(checkVideoFrame(p->getFrame()));
+
+		if (videoPacket)
+			EXPECT_NE(videoPacket->getData(), p->getData());
+		// packet read before slot is reused must remain intact
+		videoPacket = p;
+		slot.clear();
+		EXPECT_TRUE(checkVideoFrame(videoPacket->getFrame()));
+	}
+}
+
 TEST(TestVideoFrameSlot, TestFailedAssembleNotEnoughData)
 {
 	std::string frameName = "/ndn/edu/ucla/remap/peter/ndncon/instance1/ndnrtc/%FD%03/video/camera/%FC%00%00%01c_%27%DE%D6/hi/d/%FE%07";
@@ -752,6 +791,94 @@ TEST(TestAudioBundleSlot, TestAssembleAudioBundle)
     }
 }
 
+TEST(TestSampleIndex, TestSampleKey)
+{
+	std::string prefix = "/ndn/edu/ucla/remap/peter/ndncon/instance1/ndnrtc/%FD%03/video/camera/%FC%00%00%01c_%27%DE%D6/";
+	NamespaceInfo seg0, seg1, parity, otherSample, key, otherThread, otherStream;
+
+	ASSERT_TRUE(NameComponents::extractInfo(Name(prefix+"hi/d/%FE%07/%00%00"), seg0));
+	ASSERT_TRUE(NameComponents::extractInfo(Name(prefix+"hi/d/%FE%07/%00%01"), seg1));
+	ASSERT_TRUE(NameComponents::extractInfo(Name(prefix+"hi/d/%FE%07/_parity/%00%00"), parity));
+	ASSERT_TRUE(NameComponents::extractInfo(Name(prefix+"hi/d/%FE%08/%00%00"), otherSample));
+	ASSERT_TRUE(NameComponents::extractInfo(Name(prefix+"hi/k/%FE%07/%00%00"), key));
+	ASSERT_TRUE(NameComponents::extractInfo(Name(prefix+"low/d/%FE%07/%00%00"), otherThread));
+	ASSERT_TRUE(NameComponents::extractInfo(Name("/ndn/edu/ucla/remap/peter/ndncon/instance1/ndnrtc/%FD%03/video/desktop/%FC%00%00%01c_%27%DE%D6/hi/d/%FE%07/%00%00"), otherStream));
+
+	// segments of one sample share the key
+	EXPECT_EQ(SampleKey(seg0), SampleKey(seg1));
+	EXPECT_EQ(SampleKey(seg0), SampleKey(parity));
+	EXPECT_EQ(SampleKey(seg0).hash(), SampleKey(parity).hash());
+
+	EXPECT_NE(SampleKey(seg0), SampleKey(otherSample));
+	EXPECT_NE(SampleKey(seg0), SampleKey(key));
+	EXPECT_NE(SampleKey(seg0), SampleKey(otherThread));
+	EXPECT_NE(SampleKey(seg0), SampleKey(otherStream));
+	EXPECT_EQ(SampleKey(seg0).getStreamId(), SampleKey(otherThread).getStreamId());
+	EXPECT_NE(SampleKey(seg0).getStreamId(), SampleKey(otherStream).getStreamId());
+
+	// keys built from parsed name handles match keys built from full info
+	for (auto info:{seg0, parity, key, otherThread, otherStream})
+	{
+		NameHandle handle;
+		ASSERT_TRUE(NameComponents::extractHandle(info.getPrefix(), handle));
+		EXPECT_EQ(SampleKey(info), SampleKey(handle));
+		EXPECT_EQ(SampleKey(info).hash(), SampleKey(handle).hash());
+	}
+}
+
+TEST(TestSampleIndex, TestInsertFindErase)
+{
+	std::string prefix = "/ndn/edu/ucla/remap/peter/ndncon/instance1/ndnrtc/%FD%03/video/camera/%FC%00%00%01c_%27%DE%D6/hi/d/";
+	int nSamples = 100;
+	std::vector<SampleKey> keys;
+
+	for (int i = 0; i < nSamples; ++i)
+	{
+		NamespaceInfo info;
+		ASSERT_TRUE(NameComponents::extractInfo(Name(prefix).appendSequenceNumber(i).appendSegment(0), info));
+		keys.push_back(SampleKey(info));
+	}
+
+	SampleIndex<int> index(nSamples);
+	size_t capacity = index.capacity();
+
+	for (int i = 0; i < nSamples; ++i)
+		EXPECT_TRUE(index.insert(keys[i], i));
+	EXPECT_FALSE(index.insert(keys[0], 100));
+	EXPECT_EQ(nSamples, index.size());
+	// index was sized upfront, no rehashing expected
+	EXPECT_EQ(capacity, index.capacity());
+
+	for (int i = 0; i < nSamples; ++i)
+	{
+		ASSERT_TRUE(index.find(keys[i]));
+		EXPECT_EQ(i, *index.find(keys[i]));
+	}
+
+	// remove every other sample and make sure the rest is still reachable
+	for (int i = 0; i < nSamples; i += 2)
+		EXPECT_TRUE(index.erase(keys[i]));
+	EXPECT_FALSE(index.erase(keys[0]));
+	EXPECT_EQ(nSamples/2, index.size());
+
+	for (int i = 0; i < nSamples; ++i)
+		if (i%2)
+		{
+			ASSERT_TRUE(index.find(keys[i]));
+			EXPECT_EQ(i, *index.find(keys[i]));
+		}
+		else
+			EXPECT_FALSE(index.find(keys[i]));
+
+	int sum = 0;
+	index.forEach([&sum](const SampleKey&, const int& v){ sum += v; });
+	EXPECT_EQ(nSamples*nSamples/4, sum);
+
+	index.clear();
+	EXPECT_TRUE(index.empty());
+	EXPECT_FALSE(index.find(keys[1]));
+}
+
 TEST(TestSlotPool, TestPopPush)
 {
 	SlotPool pool(10);
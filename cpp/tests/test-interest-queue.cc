@@ -158,6 +158,127 @@ TEST(TestInterestQueue, TestNacks)
 	EXPECT_EQ(0, nTimeouts);
 }
 
+TEST(TestInterestQueue, TestDeadlineOrderAndBatching)
+{
+	ASSERT_TRUE(checkNfd()) << "Apparently, local NFD is not running. Aborting test.";
+
+	boost::asio::io_service io;
+	boost::shared_ptr<boost::asio::io_service::work> work(boost::make_shared<boost::asio::io_service::work>(io));
+	boost::shared_ptr<ndn::ThreadsafeFace> face(boost::make_shared<ndn::ThreadsafeFace>(io));
+	boost::shared_ptr<statistics::StatisticsStorage> storage(StatisticsStorage::createConsumerStatistics());
+
+	int nThreads = 4, n = 50;
+	MockInterestQueueObserver o;
+	InterestQueue iq(io, face, storage);
+	iq.registerObserver(&o);
+
+	OnData onData = [](const boost::shared_ptr<const ndn::Interest>&,
+                                    const boost::shared_ptr<ndn::Data>&){};
+	OnTimeout onTimeout = [](const boost::shared_ptr<const ndn::Interest>&){};
+
+	std::vector<int> deadlines;
+	EXPECT_CALL(o, onInterestIssued(_))
+		.Times(nThreads*n)
+		.WillRepeatedly(Invoke([&deadlines](const boost::shared_ptr<const ndn::Interest>& i){
+			deadlines.push_back((int)i->getName()[-2].toNumber());
+		}));
+
+	// face thread is not running yet - Interests enqueued from several
+	// threads must end up in one batch, expressed in deadline order
+	std::vector<boost::thread> threads;
+	for (int t = 0; t < nThreads; ++t)
+		threads.push_back(boost::thread([&iq, t, n, onData, onTimeout](){
+			for (int i = 0; i < n; ++i)
+			{
+				int deadline = std::rand()%300;
+				boost::shared_ptr<Interest> interest(boost::make_shared<Interest>(
+					Name("/deadline").appendNumber(deadline).appendSequenceNumber(t*1000+i), 1000));
+				iq.enqueueInterest(interest, DeadlinePriority::fromNow(deadline), onData, onTimeout);
+			}
+		}));
+	for (auto &t:threads) t.join();
+
+	EXPECT_EQ(nThreads*n, iq.size());
+
+	boost::thread t([&io](){
+		io.run();
+	});
+
+	while (iq.size()) 
+		boost::this_thread::sleep_for(boost::chrono::milliseconds(100));
+
+	ASSERT_EQ(nThreads*n, deadlines.size());
+	for (int i = 1; i < deadlines.size(); ++i)
+		// wheel buckets are 1ms wide and Interests may be enqueued few ms apart
+		if (deadlines[i] < 255 || deadlines[i-1] < 255)
+			EXPECT_LE(deadlines[i-1], deadlines[i]+10);
+
+	EXPECT_EQ(nThreads*n, (*storage)[Indicator::InterestsSentNum]);
+	EXPECT_EQ(nThreads*n, iq.getIssueDelayHistogram().getTotal());
+
+	work.reset();
+	io.stop();
+	t.join();
+}
+
+TEST(TestInterestQueue, TestOverflowAndReset)
+{
+	ASSERT_TRUE(checkNfd()) << "Apparently, local NFD is not running. Aborting test.";
+
+	boost::asio::io_service io;
+	boost::shared_ptr<boost::asio::io_service::work> work(boost::make_shared<boost::asio::io_service::work>(io));
+	boost::shared_ptr<ndn::ThreadsafeFace> face(boost::make_shared<ndn::ThreadsafeFace>(io));
+	boost::shared_ptr<statistics::StatisticsStorage> storage(StatisticsStorage::createConsumerStatistics());
+
+	int capacity = 10;
+	MockInterestQueueObserver o;
+	InterestQueue iq(io, face, storage, capacity);
+	iq.registerObserver(&o);
+
+	OnData onData = [](const boost::shared_ptr<const ndn::Interest>&,
+                                    const boost::shared_ptr<ndn::Data>&){};
+	int nTimeouts = 0;
+	OnTimeout onTimeout = [&nTimeouts](const boost::shared_ptr<const ndn::Interest>&){
+		nTimeouts++;
+	};
+
+	EXPECT_CALL(o, onInterestIssued(_))
+		.Times(capacity);
+
+	for (int i = 0; i < capacity + 5; ++i)
+		iq.enqueueInterest(boost::make_shared<Interest>(Name("/overflow").appendSequenceNumber(i), 500),
+			DeadlinePriority::fromNow(0), onData, onTimeout);
+
+	EXPECT_EQ(capacity, iq.size());
+	EXPECT_EQ(5, (*storage)[Indicator::InterestsDroppedNum]);
+
+	{ // queued Interests must be discarded on reset
+		iq.reset();
+		io.poll();
+		EXPECT_EQ(0, iq.size());
+		// dropped Interests time out immediately
+		EXPECT_EQ(5, nTimeouts);
+	}
+
+	for (int i = 0; i < capacity; ++i)
+		iq.enqueueInterest(boost::make_shared<Interest>(Name("/overflow").appendSequenceNumber(i), 500),
+			DeadlinePriority::fromNow(0), onData, onTimeout);
+
+	boost::thread t([&io](){
+		io.run();
+	});
+
+	while (iq.size()) 
+		boost::this_thread::sleep_for(boost::chrono::milliseconds(100));
+	boost::this_thread::sleep_for(boost::chrono::milliseconds(1000));
+
+	work.reset();
+	io.stop();
+	t.join();
+
+	EXPECT_EQ(5 + capacity, nTimeouts);
+}
+
 int main(int argc, char **argv) {
 	::testing::InitGoogleTest(&argc, argv);
 	return RUN_ALL_TESTS();
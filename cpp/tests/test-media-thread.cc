@@ -16,6 +16,7 @@
 #include "tests-helpers.hpp"
 #include "frame-data.hpp"
 #include "src/video-thread.hpp"
+#include "src/encoder-worker.hpp"
 #include "src/audio-thread.hpp"
 #include "mock-objects/audio-thread-callback-mock.hpp"
 
@@ -200,6 +201,118 @@ TEST(TestVideoThread, TestEncodeMultipleThreads)
 }
 #endif
 
+TEST(TestEncoderWorker, TestEncode)
+{
+	int nFrames = 30;
+	int width = 640, height = 480;
+	std::vector<WebRtcVideoFrame> frames = getFrameSequence(width, height, nFrames);
+
+	VideoCoderParams vcp(sampleVideoCoderParams());
+	vcp.encodeWidth_ = width;
+	vcp.encodeHeight_ = height;
+
+	EncoderWorkerSettings ews;
+	ews.queueSize_ = (unsigned int)nFrames;
+	EncoderWorker worker(vcp, ews);
+
+	boost::mutex m;
+	boost::condition_variable isDone;
+	int nEncoded = 0, nDropped = 0;
+	PacketNumber lastPlaybackNo = -1;
+
+	worker.start([&](const std::shared_ptr<VideoFramePacket> &fp, PacketNumber playbackNo,
+					 double encodeMs, unsigned char gopPos) {
+		boost::lock_guard<boost::mutex> lock(m);
+		EXPECT_TRUE(fp.get());
+		EXPECT_LT(lastPlaybackNo, playbackNo);
+		EXPECT_LE(0, encodeMs);
+		lastPlaybackNo = playbackNo;
+		nEncoded++;
+		isDone.notify_one();
+	}, [&](PacketNumber) {
+		boost::lock_guard<boost::mutex> lock(m);
+		nDropped++;
+		isDone.notify_one();
+	});
+
+	for (int i = 0; i < nFrames; ++i)
+		EXPECT_TRUE(worker.enqueue(frames[i], i));
+
+	{
+		boost::unique_lock<boost::mutex> lock(m);
+		isDone.wait_for(lock, boost::chrono::seconds(10), [&]() { return nEncoded + nDropped == nFrames; });
+	}
+
+	worker.stop();
+	EXPECT_EQ(nFrames, nEncoded + nDropped);
+	EXPECT_LT(0, nEncoded);
+	EXPECT_EQ(0, worker.getQueueDepth());
+	EXPECT_FALSE(worker.enqueue(frames[0], nFrames));
+}
+
+TEST(TestEncoderWorker, TestDropPolicy)
+{
+	int nFrames = 10;
+	int width = 1280, height = 720;
+	std::vector<WebRtcVideoFrame> frames = getFrameSequence(width, height, nFrames);
+
+	VideoCoderParams vcp(sampleVideoCoderParams());
+	vcp.encodeWidth_ = width;
+	vcp.encodeHeight_ = height;
+
+	{ // drop newest: enqueue must reject frames once queue is full
+		EncoderWorkerSettings ews;
+		ews.queueSize_ = 1;
+		ews.dropPolicy_ = EncoderWorkerSettings::DropNewest;
+		EncoderWorker worker(vcp, ews);
+		boost::atomic<int> nDropped(0);
+
+		worker.start([](const std::shared_ptr<VideoFramePacket> &, PacketNumber, double, unsigned char) {
+			boost::this_thread::sleep_for(boost::chrono::milliseconds(50));
+		}, [&nDropped](PacketNumber) { nDropped++; });
+
+		int nRejected = 0;
+		for (int i = 0; i < nFrames; ++i)
+			if (!worker.enqueue(frames[i], i))
+				nRejected++;
+
+		EXPECT_LT(0, nRejected);
+		EXPECT_GE(nDropped, nRejected);
+		EXPECT_GE(1, worker.getQueueDepth());
+		worker.stop();
+	}
+	{ // drop oldest: enqueue always succeeds, queue never exceeds its size
+		EncoderWorkerSettings ews;
+		ews.queueSize_ = 2;
+		ews.dropPolicy_ = EncoderWorkerSettings::DropOldest;
+		EncoderWorker worker(vcp, ews);
+		boost::atomic<int> nDropped(0);
+		std::vector<PacketNumber> encoded;
+		boost::mutex m;
+
+		worker.start([&](const std::shared_ptr<VideoFramePacket> &, PacketNumber playbackNo, double, unsigned char) {
+			boost::lock_guard<boost::mutex> lock(m);
+			encoded.push_back(playbackNo);
+			boost::this_thread::sleep_for(boost::chrono::milliseconds(50));
+		}, [&nDropped](PacketNumber) { nDropped++; });
+
+		for (int i = 0; i < nFrames; ++i)
+		{
+			EXPECT_TRUE(worker.enqueue(frames[i], i));
+			EXPECT_GE(2, worker.getQueueDepth());
+		}
+
+		boost::this_thread::sleep_for(boost::chrono::milliseconds(500));
+		worker.stop();
+
+		EXPECT_LT(0, nDropped);
+		boost::lock_guard<boost::mutex> lock(m);
+		ASSERT_LT(0, encoded.size());
+		// latest frame must not be dropped
+		EXPECT_EQ(nFrames - 1, encoded.back());
+	}
+}
+
 TEST(TestAudioThread, TestRunOpusThread)
 {
 	MockAudioThreadCallback callback;
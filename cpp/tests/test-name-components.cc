@@ -7,6 +7,7 @@
 
 #include <stdlib.h>
 #include <boost/regex.hpp>
+#include <ndn-cpp/interest.hpp>
 
 #include "gtest/gtest.h"
 #include "include/name-components.hpp"
@@ -349,6 +350,132 @@ TEST(TestNameComponents, TestPrefixFiltering)
 		EXPECT_EQ(Name("/ndn/edu/ucla/remap/peter/ndncon/instance1/ndnrtc/%FD%02") , info.getPrefix(Library));
 	}
 }
+TEST(TestNameComponents, TestNameHandle)
+{
+	std::vector<std::string> names = {
+		"/ndn/edu/ucla/remap/peter/ndncon/instance1/ndnrtc/%FD%02/video/camera/%FC%00%00%01c_%27%DE%D6/hi/d/%FE%07/%00%00",
+		"/ndn/edu/ucla/remap/peter/ndncon/instance1/ndnrtc/%FD%02/video/camera/%FC%00%00%01c_%27%DE%D6/hi/k/%FE%07/_parity/%00%01",
+		"/ndn/edu/ucla/remap/peter/ndncon/instance1/ndnrtc/%FD%02/video/camera/%FC%00%00%01c_%27%DE%D6/hi/d/%FE%07/_manifest",
+		"/ndn/edu/ucla/remap/peter/ndncon/instance1/ndnrtc/%FD%02/video/camera/%FC%00%00%01c_%27%DE%D6/hi/_meta/%FD%05/%00%00",
+		"/ndn/edu/ucla/remap/peter/ndncon/instance1/ndnrtc/%FD%02/video/camera/_meta/%FD%05/%00%00",
+		"/ndn/edu/ucla/remap/peter/ndncon/instance1/ndnrtc/%FD%02/audio/mic/%FC%00%00%01c_%27%DE%D6/hd/%FE%07/%00%02",
+		"/ndn/edu/ucla/remap/peter/ndncon/instance1/ndnrtc/%FD%02/audio/mic/%FC%00%00%01c_%27%DE%D6/hd/_meta/%FD%05/%00%00",
+		"/ndn/edu/ucla/remap/peter/ndncon/instance1/ndnrtc/%FD%02/audio/mic/_meta/%FD%05/%00%00"
+	};
+
+	for (auto n:names)
+	{
+		NamespaceInfo info;
+		NameHandle handle;
+
+		ASSERT_TRUE(NameComponents::extractHandle(Name(n), handle));
+		ASSERT_TRUE(NameComponents::extractInfo(Name(n), info));
+		EXPECT_TRUE(handle.isValid());
+		EXPECT_EQ(info.basePrefix_, handle.getBasePrefix());
+		EXPECT_EQ(info.streamName_, handle.getStreamName());
+		EXPECT_EQ(info.threadName_, handle.getThreadName());
+		EXPECT_EQ(info.sampleNo_, handle.sampleNo_);
+		EXPECT_EQ(info.segNo_, handle.segNo_);
+		EXPECT_EQ(info.segmentClass_, handle.segmentClass_);
+		EXPECT_EQ(info.getPrefix(), handle.getPrefix());
+		EXPECT_EQ(info.getSuffix(suffix_filter::Library), handle.getSuffix(suffix_filter::Library));
+		// handle restored from info is the same handle
+		EXPECT_EQ(handle.streamId_, NameHandle(info).streamId_);
+		EXPECT_EQ(handle.threadId_, NameHandle(info).threadId_);
+	}
+
+	{ // names of one stream share interned ids
+		NameHandle hi, hiParity, low, otherStream;
+		ASSERT_TRUE(NameComponents::extractHandle(Name(names[0]), hi));
+		ASSERT_TRUE(NameComponents::extractHandle(Name(names[1]), hiParity));
+		ASSERT_TRUE(NameComponents::extractHandle(Name("/ndn/edu/ucla/remap/peter/ndncon/instance1/ndnrtc/%FD%02/video/camera/%FC%00%00%01c_%27%DE%D6/low/d/%FE%07/%00%00"), low));
+		ASSERT_TRUE(NameComponents::extractHandle(Name("/ndn/edu/ucla/remap/peter/ndncon/instance1/ndnrtc/%FD%02/video/desktop/%FC%00%00%01c_%27%DE%D6/hi/d/%FE%07/%00%00"), otherStream));
+
+		EXPECT_EQ(hi.streamId_, hiParity.streamId_);
+		EXPECT_EQ(hi.threadId_, hiParity.threadId_);
+		EXPECT_EQ(hi.streamId_, low.streamId_);
+		EXPECT_NE(hi.threadId_, low.threadId_);
+		EXPECT_NE(hi.streamId_, otherStream.streamId_);
+		EXPECT_EQ(hi.threadId_, otherStream.threadId_);
+		EXPECT_TRUE(hiParity.isParity_);
+		EXPECT_FALSE(hiParity.isDelta_);
+		EXPECT_EQ(1, hiParity.segNo_);
+	}
+	{
+		NameHandle handle;
+		EXPECT_FALSE(handle.isValid());
+		EXPECT_FALSE(NameComponents::extractHandle("/ndn/edu/ucla/remap/peter/ndncon/instance1/ndnrtc/%FD%02/video/camera", handle));
+		EXPECT_FALSE(NameComponents::extractHandle("/ndn/edu/ucla/remap/peter/ndncon/instance1/ndnrtc/%FD%02/video/camera/%FC%00%00%01c_%27%DE%D6/hi/d/%FD%07/%00%00", handle));
+		EXPECT_FALSE(NameComponents::extractHandle("/ndn/edu/ucla/remap/peter/ndncon/instance1/ndnrtc/%FD%02/video/camera/hi/d/%FE%07/%00%00", handle));
+		EXPECT_FALSE(NameComponents::extractHandle("/ndn/edu/ucla/remap/peter/ndncon/instance1/ndnrtc/%FD%02/audio/mic/%FC%00%00%01c_%27%DE%D6", handle));
+		EXPECT_FALSE(handle.isValid());
+	}
+}
+
+TEST(TestNameComponents, TestNameHandleNoIntern)
+{
+	// names of streams and threads not seen before
+	std::vector<std::string> names = {
+		"/ndn/edu/ucla/remap/peter/ndncon/instance1/ndnrtc/%FD%02/video/no-intern-camera/%FC%00%00%01c_%27%DE%D6/no-intern-hi/d/%FE%07/%00%00",
+		"/ndn/edu/ucla/remap/peter/ndncon/instance1/ndnrtc/%FD%02/audio/no-intern-mic/%FC%00%00%01c_%27%DE%D6/no-intern-hd/%FE%07/%00%02",
+		"/ndn/edu/ucla/remap/peter/ndncon/instance1/ndnrtc/%FD%02/video/no-intern-camera2/_meta/%FD%05/%00%00"
+	};
+
+	for (auto n:names)
+	{
+		NameHandle lookedUp, interned;
+
+		ASSERT_TRUE(NameComponents::extractHandle(Name(n), lookedUp, false));
+		// stream and thread are not interned, but keys are the same
+		EXPECT_FALSE(lookedUp.isValid());
+		EXPECT_EQ(0, lookedUp.threadId_);
+		EXPECT_EQ("", lookedUp.getStreamName());
+		ASSERT_TRUE(NameComponents::extractHandle(Name(n), interned));
+		EXPECT_TRUE(interned.isValid());
+		EXPECT_EQ(interned.streamKey_, lookedUp.streamKey_);
+		EXPECT_EQ(interned.threadKey_, lookedUp.threadKey_);
+		EXPECT_EQ(interned.sampleNo_, lookedUp.sampleNo_);
+		EXPECT_EQ(interned.segNo_, lookedUp.segNo_);
+		EXPECT_EQ(interned.segmentClass_, lookedUp.segmentClass_);
+
+		// once interned, lookup finds it
+		ASSERT_TRUE(NameComponents::extractHandle(Name(n), lookedUp, false));
+		EXPECT_EQ(interned.streamId_, lookedUp.streamId_);
+		EXPECT_EQ(interned.threadId_, lookedUp.threadId_);
+	}
+}
+
+TEST(TestNameComponents, TestAudioManifestBundleNo)
+{
+	unsigned int w = NameComponents::AudioManifestWindow;
+
+	EXPECT_EQ(w-1, NameComponents::audioManifestBundleNo(0));
+	EXPECT_EQ(w-1, NameComponents::audioManifestBundleNo(w-1));
+	EXPECT_EQ(2*w-1, NameComponents::audioManifestBundleNo(w));
+	EXPECT_EQ(2*w-1, NameComponents::audioManifestBundleNo(2*w-2));
+	EXPECT_EQ(101*w-1, NameComponents::audioManifestBundleNo(100*w+3));
+}
+
+TEST(TestNameComponents, TestRetransmissionMarker)
+{
+	Interest interest(Name("/ndn/edu/ucla/remap/peter/ndncon/instance1/ndnrtc/%FD%02/video/camera/hi/d/%FE%07/%00%00"), 1000);
+	uint8_t nonce[4] = {0x01, 0x02, 0x03, 0x04};
+	interest.setNonce(Blob(nonce, sizeof(nonce)));
+
+	EXPECT_FALSE(NameComponents::isRetransmission(interest));
+	EXPECT_FALSE(NameComponents::isRetransmission(Interest(interest.getName())));
+
+	std::shared_ptr<Interest> rtx1 = NameComponents::retransmission(interest);
+	std::shared_ptr<Interest> rtx2 = NameComponents::retransmission(*rtx1);
+
+	EXPECT_EQ(interest.getName(), rtx1->getName());
+	EXPECT_EQ(interest.getInterestLifetimeMilliseconds(), rtx1->getInterestLifetimeMilliseconds());
+	EXPECT_TRUE(NameComponents::isRetransmission(*rtx1));
+	EXPECT_TRUE(NameComponents::isRetransmission(*rtx2));
+	EXPECT_FALSE(rtx1->getNonce().equals(interest.getNonce()));
+	EXPECT_FALSE(rtx1->getNonce().equals(rtx2->getNonce()));
+}
+
 #if 1
 TEST(TestNameComponents, TestSuffixFiltering)
 {
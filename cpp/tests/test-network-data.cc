@@ -677,6 +677,44 @@ TEST(TestAudioBundle, TestMoveAndReuse)
     }
 }
 
+TEST(TestAudioBundle, TestAppend)
+{
+    int data_len = 247;
+    std::vector<uint8_t> rtpData;
+    for (int i = 0; i < data_len; ++i)
+        rtpData.push_back((uint8_t)i);
+
+    int wire_len = 1000;
+    AudioBundlePacket bundlePacket(wire_len), blobBundle(wire_len);
+    AudioBundlePacket::AudioSampleBlob sample({true}, rtpData.begin(), rtpData.end());
+
+    while (bundlePacket.hasSpace(data_len))
+    {
+        bundlePacket.append({true}, rtpData.data(), data_len);
+        blobBundle << sample;
+    }
+
+    EXPECT_ANY_THROW(bundlePacket.append({true}, rtpData.data(), data_len));
+    ASSERT_EQ(AudioBundlePacket::wireLength(wire_len, data_len) / AudioBundlePacket::AudioSampleBlob::wireLength(data_len),
+              bundlePacket.getSamplesNum());
+    ASSERT_EQ(blobBundle.getLength(), bundlePacket.getLength());
+    EXPECT_EQ(0, memcmp(blobBundle.getData(), bundlePacket.getData(), bundlePacket.getLength()));
+    for (int i = 0; i < bundlePacket.getSamplesNum(); ++i)
+    {
+        EXPECT_TRUE(bundlePacket[i].getHeader().isRtcp_);
+        EXPECT_EQ(data_len, bundlePacket[i].payloadLength());
+        for (int k = 0; k < data_len; ++k)
+            EXPECT_EQ(rtpData[k], bundlePacket[i].data()[k]);
+    }
+
+    // memory is reused after clearing
+    const uint8_t *mem = bundlePacket.getData();
+    bundlePacket.clear();
+    while (bundlePacket.hasSpace(data_len))
+        bundlePacket.append({false}, rtpData.data(), data_len);
+    EXPECT_EQ(mem, bundlePacket.getData());
+    EXPECT_FALSE(bundlePacket[0].getHeader().isRtcp_);
+}
 TEST(TestDataSegment, TestSlice)
 {
     int data_len = 6472;
@@ -746,6 +784,41 @@ TEST(TestDataSegment, TestSlice)
     }
 }
 
+TEST(TestDataSegment, TestWriteWire)
+{
+    int data_len = 6472;
+    std::vector<uint8_t> data;
+
+    for (int i = 0; i < data_len; ++i)
+        data.push_back((uint8_t)i);
+
+    NetworkData nd((const std::vector<uint8_t>)data);
+    std::vector<VideoFrameSegment> segments = VideoFrameSegment::slice(nd, 1000);
+
+    VideoFrameSegmentHeader header;
+    header.interestNonce_ = 0x1234;
+    header.interestArrivalMs_ = 1460399362;
+    header.generationDelayMs_ = 200;
+    header.totalSegmentsNum_ = segments.size();
+    header.playbackNo_ = 7;
+    header.pairedSequenceNo_ = 1;
+    header.paritySegmentsNum_ = 2;
+
+    for (auto &s : segments)
+    {
+        s.setHeader(header);
+
+        std::vector<uint8_t> wire(s.size());
+        EXPECT_EQ(s.size(), s.writeWire(wire.data()));
+        EXPECT_EQ(s.getNetworkData()->data(), wire);
+
+        ImmutableHeaderPacket<VideoFrameSegmentHeader> seg(std::make_shared<std::vector<uint8_t>>(wire));
+        EXPECT_TRUE(seg.isValid());
+        EXPECT_EQ(header.playbackNo_, seg.getHeader().playbackNo_);
+        EXPECT_EQ(header.interestNonce_, seg.getHeader().interestNonce_);
+    }
+}
+
 TEST(TestVideoFramePacket, TestCreate)
 {
     size_t frameLen = 4300;
@@ -1064,7 +1137,7 @@ TEST(TestVideoThreadMeta, TestCreate)
 {
     FrameSegmentsInfo segInfo({5.6, 2.3, 54.3, 12.3});
     VideoCoderParams coder = sampleVideoCoderParams();
-    VideoThreadMeta meta(27, 465, 15, 14, segInfo, coder);
+    VideoThreadMeta meta(27, 465, 15, 14, segInfo, coder, std::make_pair(0.05, 0.4));
 
     EXPECT_TRUE(meta.isValid());
     EXPECT_EQ(27, meta.getRate());
@@ -1072,6 +1145,8 @@ TEST(TestVideoThreadMeta, TestCreate)
     EXPECT_EQ(15, meta.getSeqNo().second);
     EXPECT_EQ(14, meta.getGopPos());
     EXPECT_EQ(segInfo, meta.getSegInfo());
+    EXPECT_EQ(0.05, meta.getParityRatio().first);
+    EXPECT_EQ(0.4, meta.getParityRatio().second);
     {
         VideoCoderParams c = meta.getCoderParams();
         EXPECT_EQ(coder.gop_, c.gop_);
@@ -1090,6 +1165,8 @@ TEST(TestVideoThreadMeta, TestCreate)
     EXPECT_EQ(15, meta2.getSeqNo().second);
     EXPECT_EQ(14, meta2.getGopPos());
     EXPECT_EQ(segInfo, meta2.getSegInfo());
+    EXPECT_EQ(0.05, meta2.getParityRatio().first);
+    EXPECT_EQ(0.4, meta2.getParityRatio().second);
     {
         VideoCoderParams c = meta.getCoderParams();
         EXPECT_EQ(coder.gop_, c.gop_);
@@ -6,6 +6,8 @@
 //
 
 #include <stdlib.h>
+#include <set>
+#include <map>
 #include <webrtc/common_video/libyuv/include/webrtc_libyuv.h>
 #include <boost/assign.hpp>
 #include <boost/asio.hpp>
@@ -58,7 +60,7 @@ TEST(TestPacketPublisher, TestPublishVideoFrame)
     int wireLength = 1000;
     int freshness = 1000;
     settings.keyChain_ = &keyChain;
-    settings.memoryCache_ = &memoryCache;
+    settings.contentStore_ = &memoryCache;
     settings.segmentWireLength_ = wireLength;
     settings.freshnessPeriodMs_ = freshness;
     settings.statStorage_ = StatisticsStorage::createProducerStatistics();
@@ -286,7 +288,7 @@ TEST(TestPacketPublisher, TestPublishVideoParity)
     int wireLength = 1000;
     int freshness = 1000;
     settings.keyChain_ = &keyChain;
-    settings.memoryCache_ = &memoryCache;
+    settings.contentStore_ = &memoryCache;
     settings.segmentWireLength_ = wireLength;
     settings.freshnessPeriodMs_ = freshness;
     settings.statStorage_ = StatisticsStorage::createProducerStatistics();
@@ -432,7 +434,7 @@ TEST(TestPacketPublisher, TestPublishAudioBundle)
     int freshness = 1000;
     int data_len = 247;
     settings.keyChain_ = &keyChain;
-    settings.memoryCache_ = &memoryCache;
+    settings.contentStore_ = &memoryCache;
     settings.segmentWireLength_ = wireLength;
     settings.freshnessPeriodMs_ = freshness;
     settings.statStorage_ = StatisticsStorage::createProducerStatistics();
@@ -563,7 +565,7 @@ TEST(TestPacketPublisher, TestPitDeepClean)
     int wireLength = 1000;
     int freshness = 1000;
     settings.keyChain_ = &keyChain;
-    settings.memoryCache_ = &memoryCache;
+    settings.contentStore_ = &memoryCache;
     settings.segmentWireLength_ = wireLength;
     settings.freshnessPeriodMs_ = freshness;
     settings.statStorage_ = StatisticsStorage::createProducerStatistics();
@@ -706,14 +708,15 @@ TEST(TestPacketPublisher, TestBenchmarkSigningSegment1000)
     boost::shared_ptr<MemoryPrivateKeyStorage> privateKeyStorage(boost::make_shared<MemoryPrivateKeyStorage>());
     std::string appPrefix = "/ndn/edu/ucla/remap/peter/app";
     boost::shared_ptr<KeyChain> keyChain = memoryKeyChain(appPrefix);
-    boost::shared_ptr<MemoryContentCache> memCache = boost::make_shared<MemoryContentCache>(&face);
+    boost::asio::io_service io;
+    boost::shared_ptr<ContentStore> memCache = boost::make_shared<ContentStore>(&face, io);
 
     PublisherSettings settings;
 
     int wireLength = 1000;
     int freshness = 1000;
     settings.keyChain_ = keyChain.get();
-    settings.memoryCache_ = memCache.get();
+    settings.contentStore_ = memCache.get();
     settings.segmentWireLength_ = wireLength;
     settings.freshnessPeriodMs_ = freshness;
     settings.statStorage_ = StatisticsStorage::createProducerStatistics();
@@ -780,14 +783,15 @@ TEST(TestPacketPublisher, TestBenchmarkSigningSegment8000)
     boost::shared_ptr<MemoryPrivateKeyStorage> privateKeyStorage(boost::make_shared<MemoryPrivateKeyStorage>());
     std::string appPrefix = "/ndn/edu/ucla/remap/peter/app";
     boost::shared_ptr<KeyChain> keyChain = memoryKeyChain(appPrefix);
-    boost::shared_ptr<MemoryContentCache> memCache = boost::make_shared<MemoryContentCache>(&face);
+    boost::asio::io_service io;
+    boost::shared_ptr<ContentStore> memCache = boost::make_shared<ContentStore>(&face, io);
 
     PublisherSettings settings;
 
     int wireLength = 8000;
     int freshness = 1000;
     settings.keyChain_ = keyChain.get();
-    settings.memoryCache_ = memCache.get();
+    settings.contentStore_ = memCache.get();
     settings.segmentWireLength_ = wireLength;
     settings.freshnessPeriodMs_ = freshness;
     settings.statStorage_ = StatisticsStorage::createProducerStatistics();
@@ -854,14 +858,15 @@ TEST(TestPacketPublisher, TestBenchmarkNoSigning)
     boost::shared_ptr<MemoryPrivateKeyStorage> privateKeyStorage(boost::make_shared<MemoryPrivateKeyStorage>());
     std::string appPrefix = "/ndn/edu/ucla/remap/peter/app";
     boost::shared_ptr<KeyChain> keyChain = memoryKeyChain(appPrefix);
-    boost::shared_ptr<MemoryContentCache> memCache = boost::make_shared<MemoryContentCache>(&face);
+    boost::asio::io_service io;
+    boost::shared_ptr<ContentStore> memCache = boost::make_shared<ContentStore>(&face, io);
 
     PublisherSettings settings;
 
     int wireLength = 1000;
     int freshness = 1000;
     settings.keyChain_ = keyChain.get();
-    settings.memoryCache_ = memCache.get();
+    settings.contentStore_ = memCache.get();
     settings.segmentWireLength_ = wireLength;
     settings.freshnessPeriodMs_ = freshness;
     settings.statStorage_ = StatisticsStorage::createProducerStatistics();
@@ -922,6 +927,175 @@ TEST(TestPacketPublisher, TestBenchmarkNoSigning)
     }
 }
 
+TEST(TestPacketPublisher, TestPitStatsRetransmissions)
+{
+    Face face("aleph.ndn.ucla.edu");
+    MockNdnKeyChain keyChain;
+    MockNdnMemoryCache memoryCache;
+    MockSettings settings;
+    Name packetName("/test/1");
+    PendingInterests pendingInterests;
+
+    settings.keyChain_ = &keyChain;
+    settings.contentStore_ = &memoryCache;
+    settings.segmentWireLength_ = 1000;
+    settings.freshnessPeriodMs_ = 1000;
+    settings.statStorage_ = StatisticsStorage::createProducerStatistics();
+
+    // three consumers requested the only segment, one of them retransmitted
+    std::shared_ptr<Interest> interest = std::make_shared<Interest>(Name(packetName).appendSegment(0), 1000);
+    for (int i = 0; i < 3; ++i)
+        pendingInterests.push_back(boost::make_shared<MemoryContentCache::PendingInterest>(std::make_shared<Interest>(*interest), face));
+    pendingInterests.push_back(boost::make_shared<MemoryContentCache::PendingInterest>(NameComponents::retransmission(*interest), face));
+
+    EXPECT_CALL(keyChain, sign(_))
+        .Times(AtLeast(1));
+    EXPECT_CALL(memoryCache, getPendingInterestsForName(_, _))
+        .WillRepeatedly(Invoke([&pendingInterests](const Name &name, PendingInterests &interests) {
+            interests.clear();
+            for (auto p : pendingInterests)
+                if (p->getInterest()->matchesName(name))
+                    interests.push_back(p);
+        }));
+    EXPECT_CALL(memoryCache, getPendingInterestsWithPrefix(_, _))
+        .Times(AtLeast(0));
+    EXPECT_CALL(memoryCache, add(_))
+        .Times(AtLeast(1));
+
+    PacketPublisher<VideoFrameSegment, MockSettings> publisher(settings);
+    VideoFramePacket vp = getVideoFramePacket(500);
+    VideoFrameSegmentHeader segHdr;
+
+    PublishedDataPtrVector segments = publisher.publish(packetName, vp, segHdr, 1000);
+
+    EXPECT_EQ(1, segments.size());
+    EXPECT_EQ(1, publisher.getLastPitStats().nHits_);
+    EXPECT_EQ(4, publisher.getLastPitStats().nInterests_);
+    EXPECT_EQ(1, publisher.getLastPitStats().getRetransmissionsNum());
+}
+
+TEST(TestPacketPublisher, TestSigningPool)
+{
+    MockNdnKeyChain keyChain;
+    MockNdnMemoryCache memoryCache;
+    MockSettings settings;
+
+    boost::mutex m;
+    std::set<boost::thread::id> signingThreads;
+    std::map<MockNdnKeyChain *, std::set<boost::thread::id>> keyChainThreads;
+    int nSigned = 0;
+    size_t nCached = 0;
+
+    auto expectSign = [&m, &signingThreads, &keyChainThreads, &nSigned](MockNdnKeyChain &kc) {
+        MockNdnKeyChain *kcPtr = &kc;
+        EXPECT_CALL(kc, sign(_))
+            .WillRepeatedly(Invoke([&m, &signingThreads, &keyChainThreads, &nSigned, kcPtr](Data &) {
+                boost::lock_guard<boost::mutex> lock(m);
+                signingThreads.insert(boost::this_thread::get_id());
+                keyChainThreads[kcPtr].insert(boost::this_thread::get_id());
+                nSigned++;
+                boost::this_thread::sleep_for(boost::chrono::milliseconds(1));
+            }));
+    };
+
+    expectSign(keyChain);
+    SigningPoolT<MockNdnKeyChain> pool(3, [&expectSign]() {
+        std::shared_ptr<MockNdnKeyChain> kc = std::make_shared<MockNdnKeyChain>();
+        expectSign(*kc);
+        return kc;
+    });
+
+    settings.keyChain_ = &keyChain;
+    settings.contentStore_ = &memoryCache;
+    settings.segmentWireLength_ = 1000;
+    settings.freshnessPeriodMs_ = 1000;
+    settings.statStorage_ = StatisticsStorage::createProducerStatistics();
+    settings.signingPool_ = &pool;
+    settings.signDelayIndicator_ = Indicator::MetaSignDelay;
+
+    EXPECT_CALL(memoryCache, getPendingInterestsForName(_, _))
+        .Times(AtLeast(1));
+    EXPECT_CALL(memoryCache, getPendingInterestsWithPrefix(_, _))
+        .Times(AtLeast(1));
+    EXPECT_CALL(memoryCache, add(_))
+        .WillRepeatedly(Invoke([&nSigned, &nCached](const Data &) {
+            // segments are cached only after the whole batch is signed
+            EXPECT_LT(nCached, nSigned);
+            nCached++;
+        }));
+
+    PacketPublisher<VideoFrameSegment, MockSettings> publisher(settings);
+    VideoFramePacket vp = getVideoFramePacket(20000);
+    VideoFrameSegmentHeader segHdr;
+    Name packetName("/test/1");
+
+    PublishedDataPtrVector segments = publisher.publish(packetName, vp, segHdr, 1000, false, true);
+
+    EXPECT_EQ(VideoFrameSegment::numSlices(vp, 1000), segments.size());
+    EXPECT_EQ(segments.size(), nSigned);
+    EXPECT_EQ(segments.size(), nCached);
+    EXPECT_LT(1, signingThreads.size());
+    EXPECT_GE(4, signingThreads.size());
+    // every key chain is used by one thread only
+    EXPECT_EQ(4, keyChainThreads.size());
+    for (auto &it : keyChainThreads)
+        EXPECT_EQ(1, it.second.size());
+    EXPECT_EQ(segments.size(), (*settings.statStorage_)[Indicator::SignNum]);
+    EXPECT_LT(0, (*settings.statStorage_)[Indicator::MetaSignDelay]);
+    EXPECT_EQ(0, (*settings.statStorage_)[Indicator::SignDelay]);
+}
+
+TEST(TestPacketPublisher, TestBenchmarkSigningPool)
+{
+    Face face("aleph.ndn.ucla.edu");
+    std::string appPrefix = "/ndn/edu/ucla/remap/peter/app";
+    boost::shared_ptr<KeyChain> keyChain = memoryKeyChain(appPrefix);
+    boost::asio::io_service io;
+    boost::shared_ptr<ContentStore> memCache = boost::make_shared<ContentStore>(&face, io);
+    Name packetName("/test/1");
+    int wireLength = 1000;
+    int frameLen = 30000;
+    int nFrames = 50;
+
+    for (unsigned int poolSize = 0; poolSize <= 4; poolSize += 2)
+    {
+        // every worker signs with its own key chain holding the same key
+        std::shared_ptr<SigningPool> pool(poolSize ? std::make_shared<SigningPool>(poolSize, [appPrefix]() {
+            boost::shared_ptr<KeyChain> kc = memoryKeyChain(appPrefix);
+            return std::shared_ptr<KeyChain>(kc.get(), [kc](KeyChain *) {});
+        })
+                                                   : nullptr);
+        PublisherSettings settings;
+        settings.keyChain_ = keyChain.get();
+        settings.contentStore_ = memCache.get();
+        settings.segmentWireLength_ = wireLength;
+        settings.freshnessPeriodMs_ = 1000;
+        settings.statStorage_ = StatisticsStorage::createProducerStatistics();
+        settings.signingPool_ = pool.get();
+
+        VideoPacketPublisher publisher(settings);
+        unsigned int publishDuration = 0;
+
+        for (int i = 0; i < nFrames; ++i)
+        {
+            VideoFramePacket vp = getVideoFramePacket(frameLen);
+            VideoFrameSegmentHeader segHdr;
+
+            boost::chrono::high_resolution_clock::time_point t1 = boost::chrono::high_resolution_clock::now();
+            PublishedDataPtrVector segments = publisher.publish(packetName, vp, segHdr, 1000);
+            boost::chrono::high_resolution_clock::time_point t2 = boost::chrono::high_resolution_clock::now();
+            publishDuration += boost::chrono::duration_cast<boost::chrono::milliseconds>(t2 - t1).count();
+
+            for (auto &s : segments)
+                EXPECT_TRUE(s->getSignature()->getSignature().size());
+        }
+
+        GT_PRINTF("Signing pool of %d threads: average publishing time %.2fms, sign delay %.2fms\n",
+                  poolSize, (double)publishDuration / (double)nFrames,
+                  (*settings.statStorage_)[Indicator::SignDelay]);
+    }
+}
+
 int main(int argc, char **argv)
 {
     ::testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,88 @@
+//
+// test-parity-control.cc
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include <stdlib.h>
+
+#include "gtest/gtest.h"
+#include "src/parity-control.hpp"
+
+using namespace ndnrtc;
+
+TEST(TestParityControl, TestInitialRatio)
+{
+    ParityControl pc;
+
+    EXPECT_EQ(ParityControlSettings().initialRatio_, pc.getRatio(false));
+    EXPECT_EQ(ParityControlSettings().initialRatio_, pc.getRatio(true));
+
+    // ratio stays until enough observations were made
+    for (unsigned int i = 0; i < ParityControlSettings().minObservations_ - 1; ++i)
+        pc.interestsReceived(false, 10, 0);
+    EXPECT_EQ(ParityControlSettings().initialRatio_, pc.getRatio(false));
+
+    // frames without pending interests are not counted
+    pc.interestsReceived(false, 0, 0);
+    EXPECT_EQ(ParityControlSettings().initialRatio_, pc.getRatio(false));
+}
+
+TEST(TestParityControl, TestCleanLink)
+{
+    ParityControlSettings s;
+    ParityControl pc(s);
+
+    for (int i = 0; i < 100; ++i)
+    {
+        pc.interestsReceived(false, 10, 0);
+        pc.interestsReceived(true, 30, 0);
+    }
+
+    EXPECT_EQ(s.minDeltaRatio_, pc.getRatio(false));
+    EXPECT_EQ(s.minKeyRatio_, pc.getRatio(true));
+    EXPECT_EQ(0, pc.getLossEstimate(false));
+}
+
+TEST(TestParityControl, TestLossyLink)
+{
+    ParityControlSettings s;
+    ParityControl pc(s);
+
+    // 10% of interests are retransmissions
+    for (int i = 0; i < 500; ++i)
+    {
+        pc.interestsReceived(false, 10, 1);
+        pc.interestsReceived(true, 30, 3);
+    }
+
+    EXPECT_NEAR(0.1, pc.getLossEstimate(false), 0.001);
+    EXPECT_NEAR(0.1, pc.getLossEstimate(true), 0.001);
+    EXPECT_NEAR(s.deltaProtection_ * 0.1 / 0.9, pc.getRatio(false), 0.01);
+    EXPECT_NEAR(s.keyProtection_ * 0.1 / 0.9, pc.getRatio(true), 0.01);
+    // key frames get more protection
+    EXPECT_GT(pc.getRatio(true), pc.getRatio(false));
+
+    // heavy losses
+    for (int i = 0; i < 500; ++i)
+    {
+        pc.interestsReceived(false, 10, 8);
+        pc.interestsReceived(true, 30, 30);
+    }
+
+    EXPECT_EQ(s.maxDeltaRatio_, pc.getRatio(false));
+    EXPECT_EQ(s.maxKeyRatio_, pc.getRatio(true));
+
+    // link recovers
+    for (int i = 0; i < 500; ++i)
+        pc.interestsReceived(false, 10, 0);
+
+    EXPECT_NEAR(s.minDeltaRatio_, pc.getRatio(false), 0.001);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
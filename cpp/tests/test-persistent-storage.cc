@@ -112,7 +112,8 @@ TEST(TestPeristentStorage, TestBenchmarkSegment8000)
     boost::shared_ptr<MemoryPrivateKeyStorage> privateKeyStorage(boost::make_shared<MemoryPrivateKeyStorage>());
     std::string appPrefix = "/ndn/edu/ucla/remap/peter/app";
     boost::shared_ptr<KeyChain> keyChain = memoryKeyChain(appPrefix);
-    boost::shared_ptr<MemoryContentCache> memCache = boost::make_shared<MemoryContentCache>(&face);
+    boost::asio::io_service io;
+    boost::shared_ptr<ContentStore> memCache = boost::make_shared<ContentStore>(&face, io);
 
     PublisherSettings settings;
 
@@ -122,7 +123,7 @@ TEST(TestPeristentStorage, TestBenchmarkSegment8000)
     int freshness = 1000;
     settings.sign_ = false;
     settings.keyChain_ = keyChain.get();
-    settings.memoryCache_ = memCache.get();
+    settings.contentStore_ = memCache.get();
     settings.segmentWireLength_ = wireLength;
     settings.freshnessPeriodMs_ = freshness;
     settings.statStorage_ = StatisticsStorage::createProducerStatistics();
@@ -413,7 +414,7 @@ TEST(TestPersistentStorage, TestBenchmarkVideoPublishing)
     boost::shared_ptr<KeyChain> keyChain = memoryKeyChain(appPrefix);
     
     publisherFace->setCommandSigningInfo(*keyChain, certName(keyName(appPrefix)));
-    boost::shared_ptr<MemoryContentCache> memCache = boost::make_shared<MemoryContentCache>(publisherFace.get());
+    boost::shared_ptr<ContentStore> memCache = boost::make_shared<ContentStore>(publisherFace.get(), io_source);
 
     PublisherSettings settings;
 
@@ -424,7 +425,7 @@ TEST(TestPersistentStorage, TestBenchmarkVideoPublishing)
     int wireLength = 8000;
     int freshness = 1000;
     settings.keyChain_ = keyChain.get();
-    settings.memoryCache_ = memCache.get();
+    settings.contentStore_ = memCache.get();
     settings.segmentWireLength_ = wireLength;
     settings.freshnessPeriodMs_ = freshness;
     settings.statStorage_ = StatisticsStorage::createProducerStatistics();
@@ -634,7 +635,8 @@ TEST(TestPeristentStorage, TestStorageEngine)
     boost::shared_ptr<MemoryPrivateKeyStorage> privateKeyStorage(boost::make_shared<MemoryPrivateKeyStorage>());
     std::string appPrefix = "/ndn/edu/ucla/remap/peter/app";
     boost::shared_ptr<KeyChain> keyChain = memoryKeyChain(appPrefix);
-    boost::shared_ptr<MemoryContentCache> memCache = boost::make_shared<MemoryContentCache>(&face);
+    boost::asio::io_service io;
+    boost::shared_ptr<ContentStore> memCache = boost::make_shared<ContentStore>(&face, io);
 
     PublisherSettings settings;
     std::set<std::string> insertedData;
@@ -645,7 +647,7 @@ TEST(TestPeristentStorage, TestStorageEngine)
     int freshness = 1000;
     settings.sign_ = false;
     settings.keyChain_ = keyChain.get();
-    settings.memoryCache_ = memCache.get();
+    settings.contentStore_ = memCache.get();
     settings.segmentWireLength_ = wireLength;
     settings.freshnessPeriodMs_ = freshness;
     settings.statStorage_ = StatisticsStorage::createProducerStatistics();
@@ -817,7 +819,7 @@ TEST(TestPersistentStorage, TestFrameFetchingTask)
     boost::shared_ptr<KeyChain> keyChain = memoryKeyChain(appPrefix);
     
     publisherFace->setCommandSigningInfo(*keyChain, certName(keyName(appPrefix)));
-    boost::shared_ptr<MemoryContentCache> memCache = boost::make_shared<MemoryContentCache>(publisherFace.get());
+    boost::shared_ptr<ContentStore> memCache = boost::make_shared<ContentStore>(publisherFace.get(), io_source);
 
     PublisherSettings settings;
 
@@ -828,7 +830,7 @@ TEST(TestPersistentStorage, TestFrameFetchingTask)
     int wireLength = 8000;
     int freshness = 1000;
     settings.keyChain_ = keyChain.get();
-    settings.memoryCache_ = memCache.get();
+    settings.contentStore_ = memCache.get();
     settings.segmentWireLength_ = wireLength;
     settings.freshnessPeriodMs_ = freshness;
     settings.statStorage_ = StatisticsStorage::createProducerStatistics();
@@ -1060,14 +1062,14 @@ TEST(TestPersistentStorage, TestFrameFetcher)
     boost::shared_ptr<KeyChain> keyChain = memoryKeyChain(appPrefix);
     
     publisherFace->setCommandSigningInfo(*keyChain, certName(keyName(appPrefix)));
-    boost::shared_ptr<MemoryContentCache> memCache = boost::make_shared<MemoryContentCache>(publisherFace.get());
+    boost::shared_ptr<ContentStore> memCache = boost::make_shared<ContentStore>(publisherFace.get(), io_source);
 
     PublisherSettings settings;
 
     int wireLength = 8000;
     int freshness = 1000;
     settings.keyChain_ = keyChain.get();
-    settings.memoryCache_ = memCache.get();
+    settings.contentStore_ = memCache.get();
     settings.segmentWireLength_ = wireLength;
     settings.freshnessPeriodMs_ = freshness;
     settings.statStorage_ = StatisticsStorage::createProducerStatistics();
@@ -1418,6 +1420,353 @@ TEST(TestPersistentStorage, TestFrameFetcherWithLocalStream)
 }
 #endif
 
+TEST(TestPersistentStorage, TestStorageEngineAsyncWrites)
+{
+#ifndef __ANDROID__
+    std::string dbPath("/tmp/testdb-async");
+#else
+    std::string dbPath("/data/local/tmp/testdb-async");
+#endif
+
+    int nFrames = 100, nSegments = 10;
+    std::shared_ptr<StatisticsStorage> statStorage(StatisticsStorage::createProducerStatistics());
+    Name prefix("/ndn/edu/ucla/remap/peter/app/video/camera/%FC%00%00%01c_%27%DE%D6/tiny/d");
+
+    {
+        StorageEngine storage(dbPath, statStorage);
+        uint8_t content[1000];
+        memset(content, 7, sizeof(content));
+
+        for (int i = 0; i < nFrames; ++i)
+        {
+            std::vector<std::shared_ptr<const ndn::Data>> frame;
+            for (int seg = 0; seg < nSegments; ++seg)
+            {
+                std::shared_ptr<Data> d(std::make_shared<Data>(Name(prefix).appendSequenceNumber(i).appendSegment(seg)));
+                d->setContent(content, sizeof(content));
+                frame.push_back(d);
+            }
+            EXPECT_TRUE(storage.put(frame));
+        }
+
+        // data is available whether it's written already or not
+        for (int i = 0; i < nFrames; ++i)
+            EXPECT_TRUE(storage.get(Name(prefix).appendSequenceNumber(i).appendSegment(0)).get());
+
+        storage.flush();
+
+        EXPECT_EQ(0, (*statStorage)[Indicator::StorageBacklogSize]);
+        EXPECT_EQ(nFrames*nSegments, (*statStorage)[Indicator::StorageWrittenNum]);
+        EXPECT_EQ(0, (*statStorage)[Indicator::StorageDroppedNum]);
+    }
+
+    { // re-open
+        StorageEngine storage(dbPath);
+
+        for (int i = 0; i < nFrames; ++i)
+            for (int seg = 0; seg < nSegments; ++seg)
+            {
+                std::shared_ptr<Data> d = storage.get(Name(prefix).appendSequenceNumber(i).appendSegment(seg));
+                ASSERT_TRUE(d.get());
+                EXPECT_EQ(1000, d->getContent().size());
+            }
+
+        EXPECT_FALSE(storage.get(Name(prefix).appendSequenceNumber(nFrames)).get());
+    }
+
+    db_namespace::Options options;
+    db_namespace::DestroyDB(dbPath, options);
+}
+
+namespace {
+    std::shared_ptr<Data> videoSegment(const Name& threadPrefix, bool isKey, PacketNumber seqNo,
+                                       PacketNumber pairedSeqNo, int segNo = 0, int nSegments = 1)
+    {
+        NetworkData nd(std::vector<uint8_t>(500, 7));
+        std::vector<VideoFrameSegment> segments = VideoFrameSegment::slice(nd, 1000);
+
+        VideoFrameSegmentHeader header;
+        header.totalSegmentsNum_ = nSegments;
+        header.pairedSequenceNo_ = pairedSeqNo;
+        segments[0].setHeader(header);
+
+        std::shared_ptr<Data> d(std::make_shared<Data>(Name(threadPrefix)
+            .append(isKey ? NameComponents::NameComponentKey : NameComponents::NameComponentDelta)
+            .appendSequenceNumber(seqNo).appendSegment(segNo)));
+        d->setContent(segments[0].getNetworkData()->data());
+
+        return d;
+    }
+}
+
+TEST(TestPersistentStorage, TestStorageEngineGopIndex)
+{
+#ifndef __ANDROID__
+    std::string dbPath("/tmp/testdb-gop");
+#else
+    std::string dbPath("/data/local/tmp/testdb-gop");
+#endif
+
+    Name thread("/ndn/edu/ucla/remap/peter/app/ndnrtc/%FD%03/video/camera/%FC%00%00%01c_%27%DE%D6/tiny");
+    PacketNumber keyNo, firstDeltaNo;
+
+    {
+        StorageEngine storage(dbPath);
+
+        // 3 GOPs, 30 deltas each
+        for (int gop = 0; gop < 3; ++gop)
+        {
+            std::vector<std::shared_ptr<const ndn::Data>> frame;
+            for (int seg = 0; seg < 2; ++seg)
+                frame.push_back(videoSegment(thread, true, gop, gop*30, seg, 2));
+            EXPECT_TRUE(storage.put(frame));
+
+            for (int delta = gop*30; delta < (gop+1)*30; ++delta)
+                storage.put(videoSegment(thread, false, delta, gop));
+        }
+
+        storage.flush();
+
+        ASSERT_TRUE(storage.getGop(thread, 0, keyNo, firstDeltaNo));
+        EXPECT_EQ(0, keyNo);
+        EXPECT_EQ(0, firstDeltaNo);
+        ASSERT_TRUE(storage.getGop(thread, 29, keyNo, firstDeltaNo));
+        EXPECT_EQ(0, keyNo);
+        ASSERT_TRUE(storage.getGop(thread, 30, keyNo, firstDeltaNo));
+        EXPECT_EQ(1, keyNo);
+        EXPECT_EQ(30, firstDeltaNo);
+        ASSERT_TRUE(storage.getGop(thread, 75, keyNo, firstDeltaNo));
+        EXPECT_EQ(2, keyNo);
+        EXPECT_EQ(60, firstDeltaNo);
+        EXPECT_FALSE(storage.getGop(Name(thread).getPrefix(-1).append("hi"), 10, keyNo, firstDeltaNo));
+
+        // batch retrieval
+        std::vector<Name> names;
+        for (int delta = 25; delta < 35; ++delta)
+            names.push_back(Name(thread).append(NameComponents::NameComponentDelta)
+                                        .appendSequenceNumber(delta).appendSegment(0));
+        names.push_back(Name(thread).append(NameComponents::NameComponentDelta)
+                                    .appendSequenceNumber(1000).appendSegment(0));
+
+        std::vector<std::shared_ptr<Data>> batch = storage.get(names);
+        ASSERT_EQ(names.size(), batch.size());
+        for (int i = 0; i < 10; ++i)
+        {
+            ASSERT_TRUE(batch[i].get());
+            EXPECT_EQ(names[i], batch[i]->getName());
+        }
+        EXPECT_FALSE(batch.back().get());
+    }
+
+    { // malformed index entries
+        db_namespace::DB* db;
+        db_namespace::Options options;
+        ASSERT_TRUE(db_namespace::DB::Open(options, dbPath, &db).ok());
+
+        std::string indexKey = std::string("\0gop", 4) + thread.toUri() + "/";
+        db->Put(db_namespace::WriteOptions(), indexKey + "3", "abc");
+        db->Put(db_namespace::WriteOptions(), indexKey + "4x", "120");
+        db->Put(db_namespace::WriteOptions(), indexKey + "99999999999", "150");
+        db->Put(db_namespace::WriteOptions(), indexKey + "-5", "180");
+        delete db;
+    }
+
+    { // index is loaded on re-open, malformed entries are skipped
+        std::shared_ptr<StorageEngine> storage;
+        ASSERT_NO_THROW(storage = std::make_shared<StorageEngine>(dbPath));
+
+        ASSERT_TRUE(storage->getGop(thread, 45, keyNo, firstDeltaNo));
+        EXPECT_EQ(1, keyNo);
+        EXPECT_EQ(30, firstDeltaNo);
+        ASSERT_TRUE(storage->getGop(thread, 200, keyNo, firstDeltaNo));
+        EXPECT_EQ(2, keyNo);
+        EXPECT_EQ(60, firstDeltaNo);
+    }
+
+    db_namespace::Options options;
+    db_namespace::DestroyDB(dbPath, options);
+}
+
+TEST(TestPersistentStorage, TestStorageEngineFormat)
+{
+#ifndef __ANDROID__
+    std::string dbPath("/tmp/testdb-format");
+#else
+    std::string dbPath("/data/local/tmp/testdb-format");
+#endif
+
+    Name thread("/ndn/edu/ucla/remap/peter/app/ndnrtc/%FD%03/video/camera/%FC%00%00%01c_%27%DE%D6/tiny");
+    std::shared_ptr<const Data> d = videoSegment(thread, false, 1, 0);
+    db_namespace::Options options;
+    options.create_if_missing = true;
+
+    { // storage recorded by earlier versions - data keyed by name URIs
+        db_namespace::DB* db;
+        ASSERT_TRUE(db_namespace::DB::Open(options, dbPath, &db).ok());
+        db->Put(db_namespace::WriteOptions(), d->getName().toUri(),
+                db_namespace::Slice((const char*)d->wireEncode().buf(), d->wireEncode().size()));
+        delete db;
+    }
+
+    {
+        StorageEngine storage(dbPath);
+        std::shared_ptr<Data> data = storage.get(d->getName());
+        ASSERT_TRUE(data.get());
+        EXPECT_EQ(d->getName(), data->getName());
+
+        // new data is written in the same format
+        std::shared_ptr<const Data> d2 = videoSegment(thread, false, 2, 0);
+        storage.put(d2);
+        storage.flush();
+        EXPECT_TRUE(storage.get(d2->getName()).get());
+    }
+
+    {
+        db_namespace::DB* db;
+        ASSERT_TRUE(db_namespace::DB::Open(options, dbPath, &db).ok());
+        std::string value;
+        EXPECT_TRUE(db->Get(db_namespace::ReadOptions(),
+                            videoSegment(thread, false, 2, 0)->getName().toUri(), &value).ok());
+        delete db;
+    }
+    db_namespace::DestroyDB(dbPath, options);
+
+    { // new storage
+        StorageEngine storage(dbPath);
+        storage.put(d);
+        storage.flush();
+        EXPECT_TRUE(storage.get(d->getName()).get());
+    }
+
+    { // storage of unknown version is not opened
+        db_namespace::DB* db;
+        ASSERT_TRUE(db_namespace::DB::Open(options, dbPath, &db).ok());
+        db->Put(db_namespace::WriteOptions(), std::string("\0version", 8), "100");
+        delete db;
+
+        StorageEngine storage(dbPath);
+        EXPECT_ANY_THROW(storage.get(d->getName()));
+    }
+
+    db_namespace::DestroyDB(dbPath, options);
+}
+
+TEST(TestPersistentStorage, TestFrameFetcherScrubbing)
+{
+#ifndef __ANDROID__
+    std::string dbPath("/tmp/testdb-scrub");
+#else
+    std::string dbPath("/data/local/tmp/testdb-scrub");
+#endif
+
+    boost::asio::io_service io_source;
+    boost::shared_ptr<boost::asio::io_service::work> work_source(boost::make_shared<boost::asio::io_service::work>(io_source));
+    boost::thread t_source([&io_source](){
+        io_source.run();
+    });
+
+    int runTime = 3*1000;
+    int width = 320, height = 240;
+    std::shared_ptr<RawFrame> frame(std::make_shared<ArgbFrame>(width,height));
+    std::string testVideoSource = resources_path+"/test-source-320x240.argb";
+    VideoSource source(io_source, std::make_shared<FileFrameSource>(testVideoSource), frame);
+    MockExternalCapturer capturer;
+    source.addCapturer(&capturer);
+
+    std::string appPrefix = "/ndn/edu/ucla/remap/peter/app";
+    std::shared_ptr<Face> publisherFace(std::make_shared<ThreadsafeFace>(io_source));
+    std::shared_ptr<KeyChain> keyChain = memoryKeyChain(appPrefix);
+    publisherFace->setCommandSigningInfo(*keyChain, certName(keyName(appPrefix)));
+
+    MediaStreamSettings settings(io_source, getSampleVideoParams());
+    settings.face_ = publisherFace.get();
+    settings.keyChain_ = keyChain.get();
+    settings.storagePath_ = dbPath;
+    
+    LocalVideoStream localStream(appPrefix, settings);
+
+    boost::function<int(const unsigned int,const unsigned int, unsigned char*, unsigned int)>
+      incomingRawFrame =[&localStream](const unsigned int w,const unsigned int h, unsigned char* data, unsigned int size){
+          EXPECT_NO_THROW(localStream.incomingArgbFrame(w, h, data, size));
+          return 0;
+      };
+    EXPECT_CALL(capturer, incomingArgbFrame(320, 240, _, _))
+        .WillRepeatedly(Invoke(incomingRawFrame));
+
+    source.start(30);
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(runTime));
+    work_source.reset();
+    io_source.stop();
+    t_source.join();
+
+    std::shared_ptr<StorageEngine> storage = localStream.getStorage();
+    storage->flush();
+
+    Name threadPrefix(localStream.getPrefix());
+    threadPrefix.append(localStream.getThreads()[0]);
+    PacketNumber keyNo, firstDeltaNo, nextKeyNo, nextFirstDeltaNo;
+    ASSERT_TRUE(storage->getGop(threadPrefix, 10, keyNo, firstDeltaNo));
+
+    // pick two consecutive deltas of the same GOP
+    PacketNumber deltaNo = firstDeltaNo;
+    ASSERT_TRUE(storage->getGop(threadPrefix, deltaNo+1, nextKeyNo, nextFirstDeltaNo));
+    ASSERT_EQ(keyNo, nextKeyNo);
+
+    std::shared_ptr<FrameFetcherCache> cache(std::make_shared<FrameFetcherCache>());
+    std::vector<uint8_t> frameBuffer;
+    int nFetched = 0, nFramesFetched = -1;
+    Name fetchedFrameName;
+
+    OnBufferAllocate onBufferAllocate = 
+        [&frameBuffer](const std::shared_ptr<IFrameFetcher>& fetcher, int width, int height)->uint8_t*
+        {
+            frameBuffer.resize(width*height*4);
+            return frameBuffer.data();
+        };
+    OnFrameFetched onFrameFetched = 
+        [&nFetched, &nFramesFetched, &fetchedFrameName](const std::shared_ptr<IFrameFetcher>& fetcher, 
+                                      const FrameInfo fi, int nFetchedFrames,
+                                      int width, int height, const uint8_t* buffer)
+        {
+            EXPECT_EQ(fetchedFrameName.toUri(), fi.ndnName_);
+            nFramesFetched = nFetchedFrames;
+            nFetched++;
+        };
+    OnFetchFailure onFetchFailure = 
+        [](const std::shared_ptr<IFrameFetcher>& ff, std::string reason)
+        {
+            FAIL() << "Frame fetching failed: " << reason;
+        };
+
+    auto fetch = [&](PacketNumber seqNo){
+        fetchedFrameName = Name(threadPrefix).append(NameComponents::NameComponentDelta)
+                                             .appendSequenceNumber(seqNo);
+        std::shared_ptr<FrameFetcher> fetcher = std::make_shared<FrameFetcher>(storage, cache);
+        fetcher->fetch(fetchedFrameName, onBufferAllocate, onFrameFetched, onFetchFailure);
+    };
+
+    // first frame of GOP requires key frame
+    fetch(deltaNo);
+    EXPECT_EQ(1, nFetched);
+    EXPECT_EQ(2, nFramesFetched);
+    EXPECT_EQ(2, cache->getFramesNum());
+    EXPECT_EQ(1, cache->getGopsNum());
+
+    // next frame is decoded by the same decoder
+    fetch(deltaNo+1);
+    EXPECT_EQ(2, nFetched);
+    EXPECT_EQ(1, nFramesFetched);
+
+    // frames decoded before are not fetched again
+    fetch(deltaNo);
+    EXPECT_EQ(3, nFetched);
+    EXPECT_EQ(0, nFramesFetched);
+    EXPECT_EQ(3, cache->getFramesNum());
+
+    db_namespace::Options options;
+    db_namespace::DestroyDB(dbPath, options);
+}
+
 void handler(int sig) {
   void *array[10];
   size_t size;
@@ -374,8 +374,8 @@ TEST(TestPipelineControlStateMachine, TestBootstrapTimeout)
 
     Name fName(threadPrefix);
     fName.append(NameComponents::NameComponentDelta).appendSequenceNumber(7).appendSegment(0);
-    NamespaceInfo ninfo;
-    ASSERT_TRUE(NameComponents::extractInfo(fName, ninfo));
+    NameHandle ninfo;
+    ASSERT_TRUE(NameComponents::extractHandle(fName, ninfo));
 
     sm.dispatch(boost::make_shared<EventTimeout>(ninfo));
     EXPECT_EQ(kStateBootstrapping, sm.getState());
@@ -0,0 +1,177 @@
+//
+// test-pipeline-stage.cc
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include <stdlib.h>
+
+#include <boost/thread.hpp>
+#include <boost/chrono.hpp>
+#include <boost/atomic.hpp>
+
+#include "gtest/gtest.h"
+#include "src/pipeline-stage.hpp"
+
+using namespace ndnrtc;
+
+TEST(TestStageQueue, TestDropNewest)
+{
+	StageQueue<int> q(3, StageOverflow::DropNewest);
+	std::vector<int> dropped;
+
+	for (int i = 0; i < 5; ++i)
+		EXPECT_EQ(i < 3, q.push(i, [&dropped](const int &v) { dropped.push_back(v); }));
+
+	EXPECT_EQ(3, q.size());
+	ASSERT_EQ(2, dropped.size());
+	EXPECT_EQ(3, dropped[0]);
+	EXPECT_EQ(4, dropped[1]);
+
+	int v;
+	int64_t ts;
+	for (int i = 0; i < 3; ++i)
+	{
+		EXPECT_TRUE(q.pop(v, ts));
+		EXPECT_EQ(i, v);
+	}
+	EXPECT_FALSE(q.pop(v, ts));
+	EXPECT_TRUE(q.empty());
+}
+
+TEST(TestStageQueue, TestDropOldest)
+{
+	StageQueue<int> q(3, StageOverflow::DropOldest);
+	std::vector<int> dropped;
+
+	for (int i = 0; i < 5; ++i)
+		EXPECT_TRUE(q.push(i, [&dropped](const int &v) { dropped.push_back(v); }));
+
+	EXPECT_EQ(3, q.size());
+	ASSERT_EQ(2, dropped.size());
+	EXPECT_EQ(0, dropped[0]);
+	EXPECT_EQ(1, dropped[1]);
+
+	int v;
+	int64_t ts;
+	EXPECT_TRUE(q.pop(v, ts));
+	EXPECT_EQ(2, v);
+}
+
+TEST(TestStageQueue, TestClose)
+{
+	StageQueue<int> q(1, StageOverflow::Wait);
+	EXPECT_TRUE(q.push(0));
+
+	boost::atomic<bool> pushed(true);
+	boost::thread t([&q, &pushed]() { pushed = q.push(1); });
+
+	boost::this_thread::sleep_for(boost::chrono::milliseconds(50));
+	// producer must be waiting for the room in the queue
+	EXPECT_EQ(1, q.size());
+
+	q.close();
+	t.join();
+
+	EXPECT_FALSE(pushed);
+	EXPECT_TRUE(q.empty());
+	EXPECT_FALSE(q.push(2));
+}
+
+TEST(TestStageQueue, TestWait)
+{
+	StageQueue<int> q(1, StageOverflow::Wait);
+	EXPECT_TRUE(q.push(0));
+
+	boost::atomic<bool> pushed(false);
+	boost::thread t([&q, &pushed]() { pushed = q.push(1); });
+
+	boost::this_thread::sleep_for(boost::chrono::milliseconds(50));
+	EXPECT_FALSE(pushed);
+
+	// popping makes room for waiting producer
+	int v;
+	int64_t ts;
+	EXPECT_TRUE(q.pop(v, ts));
+	EXPECT_EQ(0, v);
+	t.join();
+
+	EXPECT_TRUE(pushed);
+	EXPECT_EQ(1, q.size());
+	EXPECT_TRUE(q.pop(v, ts));
+	EXPECT_EQ(1, v);
+	EXPECT_TRUE(q.empty());
+}
+
+TEST(TestPipelineStage, TestOrderAndLatency)
+{
+	int nItems = 1000;
+	PipelineStage<int> stage(4, StageOverflow::Wait);
+	std::vector<int> processed;
+	boost::mutex m;
+	boost::condition_variable isDone;
+
+	stage.start([&](const int &v) {
+		boost::lock_guard<boost::mutex> lock(m);
+		processed.push_back(v);
+		isDone.notify_one();
+	});
+
+	for (int i = 0; i < nItems; ++i)
+	{
+		EXPECT_TRUE(stage.push(i));
+		EXPECT_GE(stage.getCapacity(), stage.getOccupancy());
+	}
+
+	{
+		boost::unique_lock<boost::mutex> lock(m);
+		isDone.wait_for(lock, boost::chrono::seconds(5),
+						[&]() { return (int)processed.size() == nItems; });
+	}
+	stage.stop();
+
+	ASSERT_EQ(nItems, processed.size());
+	for (int i = 0; i < nItems; ++i)
+		EXPECT_EQ(i, processed[i]);
+
+	EXPECT_LT(0, stage.getLatency());
+	EXPECT_EQ(0, stage.getOccupancy());
+	EXPECT_FALSE(stage.push(nItems));
+}
+
+TEST(TestPipelineStage, TestStagesChain)
+{
+	// two stages: second one is slower, first one must wait for it
+	int nItems = 50;
+	PipelineStage<int> first(2, StageOverflow::DropOldest), second(2, StageOverflow::Wait);
+	boost::atomic<int> nProcessed(0), nDropped(0), sum(0);
+
+	second.start([&](const int &v) {
+		boost::this_thread::sleep_for(boost::chrono::milliseconds(1));
+		sum += v;
+		nProcessed++;
+	});
+	first.start([&](const int &v) { second.push(v); },
+				[&](const int &) { nDropped++; });
+
+	for (int i = 0; i < nItems; ++i)
+	{
+		first.push(i);
+		boost::this_thread::sleep_for(boost::chrono::microseconds(100));
+	}
+
+	boost::this_thread::sleep_for(boost::chrono::milliseconds(500));
+	first.stop();
+	second.stop();
+
+	EXPECT_EQ(nItems, nProcessed + nDropped);
+	EXPECT_LT(0, nProcessed);
+	EXPECT_LT(second.getLatency(), 500);
+}
+
+int main(int argc, char **argv)
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,143 @@
+//
+// test-rate-adaptation.cc
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include <stdlib.h>
+
+#include "gtest/gtest.h"
+#include "src/rate-adaptation-module.hpp"
+
+using namespace ndnrtc;
+
+namespace {
+    // feeds module with data at given rate (Kbit/s) for durationMs, calling
+    // getInterestRate every 50ms; returns the last recommended stream
+    unsigned int feed(RateAdaptationModule& module, int64_t& now,
+                      int64_t durationMs, double kbps, double lossRatio = 0,
+                      double rttMs = 50)
+    {
+        unsigned int streamId = 0;
+        double interestRate = 0, nSegments = 0, nLost = 0;
+        unsigned int segSize = 1000;
+
+        for (int64_t t = 0; t < durationMs; t += 50, now += 50)
+        {
+            nSegments += kbps*50/8/segSize;
+            nLost += kbps*50/8/segSize*lossRatio;
+
+            for (; nSegments >= 1; nSegments -= 1)
+                module.dataReceived("", streamId, segSize, rttMs, 0);
+            for (; nLost >= 1; nLost -= 1)
+                module.interestTimeout("", streamId);
+
+            module.getInterestRate(now, interestRate, streamId);
+        }
+        return streamId;
+    }
+
+    StreamEntry streams[] = {{0, 2500, 0.2}, {1, 300, 0.2}, {2, 1000, 0.2}};
+}
+
+TEST(TestRateAdaptation, TestInitialize)
+{
+    RateAdaptationModule module;
+    double interestRate;
+    unsigned int streamId = 100;
+
+    EXPECT_GT(0, module.initialize(CodecModeSVC, 3, streams));
+    EXPECT_GT(0, module.initialize(CodecModeNormal, 0, streams));
+    EXPECT_EQ(0, module.initialize(CodecModeNormal, 3, streams));
+
+    // starts from the lowest bitrate
+    module.getInterestRate(1000, interestRate, streamId);
+    EXPECT_EQ(1, streamId);
+    EXPECT_EQ(0, module.getBandwidthEstimation());
+
+    module.setStreamId(0);
+    module.getInterestRate(1050, interestRate, streamId);
+    EXPECT_EQ(0, streamId);
+}
+
+TEST(TestRateAdaptation, TestEstimation)
+{
+    RateAdaptationModule module;
+    int64_t now = 1000;
+
+    module.initialize(CodecModeNormal, 3, streams);
+    module.setStreamId(2);
+
+    EXPECT_EQ(2, feed(module, now, 3000, 1200));
+    EXPECT_NEAR(1200, module.getBandwidthEstimation(), 50);
+    EXPECT_FALSE(module.isCongested());
+}
+
+TEST(TestRateAdaptation, TestStepDown)
+{
+    RateAdaptationModule module;
+    int64_t now = 1000;
+
+    module.initialize(CodecModeNormal, 3, streams);
+    module.setStreamId(0);
+
+    // 1200Kbit/s with losses is not enough for 1000Kbit/s thread with
+    // 20% parity, so module steps down to the lowest
+    EXPECT_EQ(0, feed(module, now, 500, 2500, 0.1));
+    EXPECT_EQ(1, feed(module, now, 2500, 1200, 0.1));
+
+    { // RTT growth is a congestion too
+        RateAdaptationModule module;
+        module.initialize(CodecModeNormal, 3, streams);
+        module.setStreamId(0);
+
+        EXPECT_EQ(0, feed(module, now, 3000, 3500, 0, 50));
+        EXPECT_NE(0, feed(module, now, 1500, 3500, 0, 500));
+        EXPECT_TRUE(module.isCongested());
+    }
+}
+
+TEST(TestRateAdaptation, TestStepUp)
+{
+    RateAdaptationModule module;
+    int64_t now = 1000;
+    const RateAdaptationModule::Settings& s = RateAdaptationModule::DefaultSettings;
+
+    module.initialize(CodecModeNormal, 3, streams);
+
+    // probes one thread up after congestion-free hold period
+    EXPECT_EQ(1, feed(module, now, s.upHoldMs_ - 100, 400));
+    EXPECT_EQ(2, feed(module, now, 200, 400));
+    EXPECT_EQ(2, feed(module, now, s.upHoldMs_ - 200, 1300));
+    EXPECT_EQ(0, feed(module, now, 200, 1300));
+    // nothing higher
+    EXPECT_EQ(0, feed(module, now, 3*s.upHoldMs_, 3000));
+}
+
+TEST(TestRateAdaptation, TestProbeBackoff)
+{
+    RateAdaptationModule module;
+    int64_t now = 1000;
+    const RateAdaptationModule::Settings& s = RateAdaptationModule::DefaultSettings;
+
+    module.initialize(CodecModeNormal, 3, streams);
+    module.setStreamId(2);
+
+    EXPECT_EQ(2, feed(module, now, s.upHoldMs_ - 100, 1600));
+    EXPECT_EQ(0, feed(module, now, 200, 1600));
+
+    // probe fails - module steps back down once losses pile up
+    EXPECT_EQ(2, feed(module, now, s.downHoldMs_, 1600, 0.2));
+    EXPECT_EQ(2, feed(module, now, s.windowMs_, 1600));
+
+    // now it takes twice as long to probe again
+    EXPECT_EQ(2, feed(module, now, s.upHoldMs_ + 100, 1600));
+    EXPECT_EQ(0, feed(module, now, s.upHoldMs_, 1600));
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -6,11 +6,13 @@
 //
 
 #include <stdlib.h>
+#include <algorithm>
 #include <boost/asio.hpp>
 
 #include "tests-helpers.hpp"
 #include "gtest/gtest.h"
 #include "client/src/renderer.hpp"
+#include "client/src/yuv-converter.hpp"
 
 using namespace std;
 
@@ -171,6 +173,90 @@ TEST(TestRenderer, TestFrameCorrectness)
 	remove("/tmp/client1-camera.640x480");
 }
 
+TEST(TestRenderer, TestI420Sink)
+{
+    boost::asio::io_service io;
+	std::string sinkName = "/tmp/client1-camera";
+	RendererInternal r(sinkName, createNewSink, io, false, SinkFormat::I420);
+	unsigned int width = 640, height = 480, stride = 704;
+
+	// planes with padding, as they come from decoder
+	std::vector<uint8_t> y(stride*height, 1), u(stride/2*height/2, 2), v(stride/2*height/2, 3);
+    ndnrtc::FrameInfo phony;
+	r.renderI420Frame(phony, width, height, stride, stride/2, stride/2, y.data(), u.data(), v.data());
+
+	FILE *f = fopen("/tmp/client1-camera.640x480.i420", "rb");
+	ASSERT_TRUE(f);
+	std::vector<uint8_t> buf(yuv::i420Size(width, height)+1);
+	ASSERT_EQ(yuv::i420Size(width, height), fread(buf.data(), 1, buf.size(), f));
+	fclose(f);
+
+	EXPECT_EQ(width*height, std::count(buf.begin(), buf.end(), 1));
+	EXPECT_EQ(width*height/4, std::count(buf.begin(), buf.end(), 2));
+	EXPECT_EQ(width*height/4, std::count(buf.begin(), buf.end(), 3));
+	EXPECT_EQ(2, buf[width*height]);
+	EXPECT_EQ(3, buf[width*height*5/4]);
+
+	remove("/tmp/client1-camera.640x480.i420");
+}
+
+TEST(TestRenderer, TestNv12Conversion)
+{
+	unsigned int width = 6, height = 4;
+	std::vector<uint8_t> y(width*height, 100), u(width*height/4), v(width*height/4), nv12(yuv::i420Size(width, height));
+
+	for (int i = 0; i < u.size(); ++i) { u[i] = 10+i; v[i] = 20+i; }
+	yuv::i420ToNv12(width, height, y.data(), width, u.data(), width/2, v.data(), width/2, nv12.data());
+
+	for (int i = 0; i < u.size(); ++i)
+	{
+		EXPECT_EQ(u[i], nv12[width*height+2*i]);
+		EXPECT_EQ(v[i], nv12[width*height+2*i+1]);
+	}
+}
+
+TEST(TestRenderer, TestBgraConversion)
+{
+	GT_PRINTF("BGRA conversion kernel: %s\n", yuv::getBgraKernelName());
+
+	// odd width to cover both vector and scalar code
+	unsigned int width = 37, height = 3;
+	unsigned int cw = (width+1)/2, ch = (height+1)/2;
+	std::vector<uint8_t> y(width*height), u(cw*ch, 128), v(cw*ch, 128), bgra(width*height*4);
+
+	// black, white and gray
+	for (int i = 0; i < width; ++i)
+	{
+		y[i] = 16;
+		y[width+i] = 235;
+		y[2*width+i] = 126;
+	}
+	yuv::i420ToBgra(width, height, y.data(), width, u.data(), cw, v.data(), cw, bgra.data());
+
+	for (int i = 0; i < width; ++i)
+		for (int c = 0; c < 3; ++c)
+		{
+			EXPECT_EQ(0, bgra[4*i+c]);
+			EXPECT_EQ(255, bgra[4*(width+i)+c]);
+			EXPECT_EQ(128, bgra[4*(2*width+i)+c]);
+		}
+	for (int i = 0; i < width*height; ++i)
+		EXPECT_EQ(255, bgra[4*i+3]);
+
+	// saturated red: Y=81, U=90, V=240
+	std::fill(y.begin(), y.end(), 81);
+	std::fill(u.begin(), u.end(), 90);
+	std::fill(v.begin(), v.end(), 240);
+	yuv::i420ToBgra(width, height, y.data(), width, u.data(), cw, v.data(), cw, bgra.data());
+
+	for (int i = 0; i < width*height; ++i)
+	{
+		EXPECT_GE(2, bgra[4*i]);
+		EXPECT_GE(2, bgra[4*i+1]);
+		EXPECT_LE(253, bgra[4*i+2]);
+	}
+}
+
 //******************************************************************************
 int main(int argc, char **argv) {
 	::testing::InitGoogleTest(&argc, argv);
@@ -1,4 +1,4 @@
-// 
+//
 // test-rtx-controller.cc
 //
 //  Created by Peter Gusev on 23 August 2017.
@@ -9,19 +9,20 @@
 #include <algorithm>
 #include <ctime>
 
+#include <boost/asio.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <ndn-cpp/interest.hpp>
 #include <ndn-cpp/name.hpp>
-#include <boost/shared_ptr.hpp>
 
 #include "gtest/gtest.h"
 #include "tests-helpers.hpp"
 
 #include "mock-objects/rtx-observer-mock.hpp"
-#include "mock-objects/buffer-mock.hpp"
 #include "mock-objects/playback-queue-mock.hpp"
 
 #include "statistics.hpp"
-#include "src/frame-data.hpp"
+#include "src/clock.hpp"
+#include "src/drd-estimator.hpp"
 #include "src/frame-buffer.hpp"
 #include "src/rtx-controller.hpp"
 
@@ -30,102 +31,127 @@ using namespace ndnrtc::statistics;
 using namespace ndn;
 using namespace testing;
 
-#define ENABLE_LOGGING
-#if 0
-TEST(TestRtxController, TestRtx){
-#ifdef ENABLE_LOGGING
-    ndnlog::new_api::Logger::initAsyncLogging();
-    ndnlog::new_api::Logger::getLogger("").setLogLevel(ndnlog::NdnLoggerDetailLevelAll);
-#endif
-
-	boost::shared_ptr<StatisticsStorage> storage(StatisticsStorage::createConsumerStatistics());
-	boost::shared_ptr<MockPlaybackQueue> playbackQueue(boost::make_shared<MockPlaybackQueue>());
-
-	MockRtxObserver rtxObserverMock;
-	RetransmissionController rtx(storage, playbackQueue);
-	rtx.attach(&rtxObserverMock);
-
-#ifdef ENABLE_LOGGING
-	rtx.setLogger(ndnlog::new_api::Logger::getLoggerPtr(""));
-#endif
-
-	int nPackets = 12;
-	std::string frameName = "/ndn/edu/ucla/remap/peter/ndncon/instance1/ndnrtc/%FD%02/video/camera/hi/d";
-	IBufferObserver *bufferObserver = &rtx;
-
-	std::set<Name> rtxInterestNames;
-	EXPECT_CALL(rtxObserverMock, onRetransmissionRequired(_))
-		.Times(AtLeast(nPackets/3))
-		.WillRepeatedly(Invoke([&rtxInterestNames](const std::vector<boost::shared_ptr<const ndn::Interest>> interests){
-			GT_PRINTF("RTX for %d interests\n", interests.size());
-
-			for (auto i:interests)
-			{
-				GT_PRINTF(" > %s\n", i->getName().toUri().c_str());
-
-				if (rtxInterestNames.find(i->getName()) != rtxInterestNames.end())
-					FAIL() << "RTX for already retransmitted interest";
-				rtxInterestNames.insert(i->getName());
-				EXPECT_GE(i->getName()[-1].toSegment(), 5);
-			}
-		}));
-
-
-	std::vector<boost::shared_ptr<BufferSlot>> slots;
-	for (int i = 0; i < nPackets; ++i)
-	{
-		std::vector<boost::shared_ptr<const Interest>> interests;
-		int nInterests = i+1; //std::rand()%30+10;
-		for (int j = 0; j < nInterests; ++j)
-		{
-			boost::shared_ptr<Interest> interest(boost::make_shared<Interest>(Name(frameName).appendSequenceNumber(i).appendSegment(j), 1000));
-			int nonce = 0x1234+i*10+j;
-			interest->setNonce(Blob((uint8_t*)&nonce, sizeof(int)));
-			interests.push_back(interest);
-		}
-
-		boost::shared_ptr<BufferSlot> slot = boost::make_shared<BufferSlot>();
-		slots.push_back(slot);
-		slot->segmentsRequested(interests);
-
-		EXPECT_CALL(*playbackQueue, size())
-			.Times(AtLeast(1))
-			.WillRepeatedly(Invoke([](){ return 100; }));
-		EXPECT_CALL(*playbackQueue, pendingSize())
-			.Times(AtLeast(1))
-			.WillRepeatedly(Invoke([](){ return 100; }));
-
-		bufferObserver->onNewRequest(slot);
-
-		// add some data - some interests will require RTX
-		VideoFramePacket vp = getVideoFramePacket();
-		std::vector<VideoFrameSegment> segments = sliceFrame(vp);
-	
-		Name n(frameName);
-		n.appendSequenceNumber(i);
-		std::vector<boost::shared_ptr<ndn::Data>> dataObjects = dataFromSegments(n.toUri(), segments);
-
-		for (auto o:dataObjects)
-		{
-			boost::shared_ptr<const Interest> interest;
-			for (auto i:interests)
-				if (i->getName() == o->getName())
-				{
-					interest = i;
-					break;
-				}
-			if (interest)
-			{
-				o->getMetaInfo().setFinalBlockId(ndn::Name::Component::fromSegment(i));
-				boost::shared_ptr<WireSegment> segment = boost::make_shared<WireSegment>(o, interest);
-				bufferObserver->onNewData({slot, slot->segmentReceived(segment)});
-			}
-		}
-
-		usleep(33000);
-	}
+namespace {
+    std::string frameName = "/ndn/edu/ucla/remap/peter/ndncon/instance1/ndnrtc/%FD%03/video/camera/%FC%00%00%01c_%27%DE%D6/hi/d";
+
+    std::vector<std::shared_ptr<const Interest>>
+    sampleInterests(PacketNumber seqNo, size_t nSeg)
+    {
+        std::vector<std::shared_ptr<const Interest>> interests;
+        for (size_t i = 0; i < nSeg; ++i)
+        {
+            std::shared_ptr<Interest> interest(std::make_shared<Interest>(Name(frameName).appendSequenceNumber(seqNo).appendSegment(i), 1000));
+            int nonce = 0x1234+seqNo*10+i;
+            interest->setNonce(Blob((uint8_t*)&nonce, sizeof(int)));
+            interests.push_back(interest);
+        }
+        return interests;
+    }
+
+    void runFor(boost::asio::io_service& io, int ms)
+    {
+        boost::asio::steady_timer timer(io);
+        timer.expires_from_now(std::chrono::milliseconds(ms));
+        timer.async_wait([&io](const boost::system::error_code&){ io.stop(); });
+        io.run();
+        io.reset();
+    }
+}
+
+TEST(TestRtxController, TestRtxAtDeadline)
+{
+    boost::asio::io_service io;
+    std::shared_ptr<StatisticsStorage> storage(StatisticsStorage::createConsumerStatistics());
+    std::shared_ptr<MockPlaybackQueue> playbackQueue(std::make_shared<MockPlaybackQueue>());
+    std::shared_ptr<DrdEstimator> drdEstimator(std::make_shared<DrdEstimator>(50));
+    MockRtxObserver rtxObserverMock;
+
+    EXPECT_CALL(*playbackQueue, size()).WillRepeatedly(Return(100));
+    EXPECT_CALL(*playbackQueue, pendingSize()).WillRepeatedly(Return(0));
+
+    RetransmissionController rtx(io, storage, playbackQueue, drdEstimator);
+    rtx.attach(&rtxObserverMock);
+    rtx.setEnabled(true);
+    IBufferObserver *bufferObserver = &rtx;
+
+    std::shared_ptr<BufferSlot> slot(std::make_shared<BufferSlot>());
+    slot->segmentsRequested(sampleInterests(1, 5));
+
+    // playback deadline is 100ms away, DRD is 50ms - rtx is due in 50ms;
+    // if sample is still incomplete, next rtx is one DRD later
+    int64_t requestTs = clock::millisecondTimestamp();
+    std::vector<int64_t> rtxTs;
+    EXPECT_CALL(rtxObserverMock, onRetransmissionRequired(SizeIs(5)))
+        .Times(RetransmissionController::MaxSegmentRtx)
+        .WillRepeatedly(Invoke([&rtxTs, slot](const std::vector<std::shared_ptr<const ndn::Interest>>& interests){
+            rtxTs.push_back(clock::millisecondTimestamp());
+            // the way buffer counts re-expressed Interests
+            slot->segmentsRequested(interests);
+        }));
+
+    bufferObserver->onNewRequest(slot);
+    runFor(io, 300);
+
+    ASSERT_EQ(RetransmissionController::MaxSegmentRtx, rtxTs.size());
+    EXPECT_LE(45, rtxTs[0]-requestTs);
+    EXPECT_GT(100, rtxTs[0]-requestTs);
+    for (size_t i = 1; i < rtxTs.size(); ++i)
+        EXPECT_LE(45, rtxTs[i]-rtxTs[i-1]);
+    EXPECT_EQ(5*RetransmissionController::MaxSegmentRtx, (*storage)[Indicator::RtxNum]);
 }
-#endif
+
+TEST(TestRtxController, TestSkipInactiveSlots)
+{
+    boost::asio::io_service io;
+    std::shared_ptr<StatisticsStorage> storage(StatisticsStorage::createConsumerStatistics());
+    std::shared_ptr<MockPlaybackQueue> playbackQueue(std::make_shared<MockPlaybackQueue>());
+    std::shared_ptr<DrdEstimator> drdEstimator(std::make_shared<DrdEstimator>(50));
+    MockRtxObserver rtxObserverMock;
+
+    EXPECT_CALL(*playbackQueue, size()).WillRepeatedly(Return(100));
+    EXPECT_CALL(*playbackQueue, pendingSize()).WillRepeatedly(Return(0));
+
+    RetransmissionController rtx(io, storage, playbackQueue, drdEstimator);
+    rtx.attach(&rtxObserverMock);
+    rtx.setEnabled(true);
+    IBufferObserver *bufferObserver = &rtx;
+
+    // slot is released and re-used for another sample before the deadline
+    std::shared_ptr<BufferSlot> reusedSlot(std::make_shared<BufferSlot>());
+    reusedSlot->segmentsRequested(sampleInterests(1, 5));
+    bufferObserver->onNewRequest(reusedSlot);
+    reusedSlot->clear();
+    reusedSlot->segmentsRequested(sampleInterests(2, 3));
+    bufferObserver->onNewRequest(reusedSlot);
+
+    // released slot
+    std::shared_ptr<BufferSlot> freeSlot(std::make_shared<BufferSlot>());
+    freeSlot->segmentsRequested(sampleInterests(3, 4));
+    bufferObserver->onNewRequest(freeSlot);
+    freeSlot->clear();
+
+    // all segments were retransmitted MaxSegmentRtx times already
+    std::shared_ptr<BufferSlot> rtxSlot(std::make_shared<BufferSlot>());
+    for (unsigned int i = 0; i <= RetransmissionController::MaxSegmentRtx; ++i)
+        rtxSlot->segmentsRequested(sampleInterests(4, 6));
+    bufferObserver->onNewRequest(rtxSlot);
+
+    EXPECT_CALL(rtxObserverMock, onRetransmissionRequired(SizeIs(3)))
+        .Times(RetransmissionController::MaxSegmentRtx);
+
+    runFor(io, 300);
+
+    // reset drops everything
+    std::shared_ptr<BufferSlot> slot(std::make_shared<BufferSlot>());
+    slot->segmentsRequested(sampleInterests(5, 2));
+    bufferObserver->onNewRequest(slot);
+    bufferObserver->onReset();
+
+    EXPECT_CALL(rtxObserverMock, onRetransmissionRequired(_))
+        .Times(0);
+    runFor(io, 150);
+}
+
 //******************************************************************************
 int main(int argc, char **argv) {
 	::testing::InitGoogleTest(&argc, argv);
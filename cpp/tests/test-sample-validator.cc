@@ -0,0 +1,241 @@
+//
+// test-sample-validator.cc
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include <stdlib.h>
+
+#include <ndn-cpp/data.hpp>
+#include <ndn-cpp/digest-sha256-signature.hpp>
+#include <ndn-cpp/interest.hpp>
+#include <ndn-cpp/name.hpp>
+#include <ndn-cpp/security/key-chain.hpp>
+
+#include "gtest/gtest.h"
+#include "tests-helpers.hpp"
+
+#include "statistics.hpp"
+#include "src/audio-manifest-window.hpp"
+#include "src/frame-buffer.hpp"
+#include "src/frame-data.hpp"
+#include "src/sample-validator.hpp"
+
+using namespace ndnrtc;
+using namespace ndnrtc::statistics;
+using namespace ndn;
+
+namespace {
+    std::string threadPrefix = "/ndn/edu/ucla/remap/peter/ndncon/instance1/ndnrtc/%FD%02/audio/mic/%FC%00%00%01c_%27%DE%D6/hd";
+
+    // single-segment audio bundle with dummy digest signature, as published
+    // by AudioStreamImpl
+    std::shared_ptr<Data> bundleSegment(PacketNumber bundleNo, uint8_t fill)
+    {
+        std::vector<uint8_t> rtpData(100, fill);
+        AudioBundlePacket bundlePacket(1000);
+        AudioBundlePacket::AudioSampleBlob sample({false}, rtpData.begin(), rtpData.end());
+        bundlePacket << sample;
+
+        CommonHeader hdr;
+        hdr.sampleRate_ = 50;
+        hdr.publishTimestampMs_ = 488589553;
+        hdr.publishUnixTimestamp_ = 1460488589;
+        bundlePacket.setHeader(hdr);
+
+        std::vector<CommonSegment> segments = CommonSegment::slice(bundlePacket, 1000);
+        std::shared_ptr<Data> data(std::make_shared<Data>(Name(threadPrefix).appendSequenceNumber(bundleNo).appendSegment(0)));
+        data->getMetaInfo().setFinalBlockId(Name::Component::fromSegment(0));
+        data->setContent(segments.front().getNetworkData()->data());
+
+        uint8_t digest[ndn_SHA256_DIGEST_SIZE] = {0};
+        data->setSignature(DigestSha256Signature());
+        ((DigestSha256Signature *)data->getSignature())->setSignature(Blob(digest, sizeof(digest)));
+
+        return data;
+    }
+
+    // collects manifests published for windows
+    struct Manifests {
+        AudioManifestWindow::OnWindow onWindow()
+        {
+            return [this](PacketNumber lastBundleNo, const PublishedDataPtrVector &segments) {
+                lastBundleNos_.push_back(lastBundleNo);
+                manifests_.push_back(std::make_shared<Manifest>(segments));
+            };
+        }
+
+        std::vector<PacketNumber> lastBundleNos_;
+        std::vector<std::shared_ptr<Manifest>> manifests_;
+    };
+
+    // validator which does not fetch manifests from the network
+    class TestAudioManifestValidator : public AudioManifestValidator
+    {
+      public:
+        TestAudioManifestValidator(const std::shared_ptr<StatisticsStorage> &statStorage)
+            : AudioManifestValidator(std::shared_ptr<Face>(), std::shared_ptr<KeyChain>(), statStorage) {}
+
+        using AudioManifestValidator::onManifest;
+        using AudioManifestValidator::onManifestFailure;
+
+        std::vector<PacketNumber> fetched_;
+
+      private:
+        void fetchManifest(const Name &threadPrefix, PacketNumber lastBundleNo) override
+        {
+            fetched_.push_back(lastBundleNo);
+        }
+    };
+
+    // requests and receives bundle into a new slot
+    std::shared_ptr<BufferSlot> receiveBundle(IBufferObserver *observer, const std::shared_ptr<Data> &data)
+    {
+        std::shared_ptr<Interest> interest(std::make_shared<Interest>(data->getName(), 1000));
+        int nonce = 0x1234;
+        interest->setNonce(Blob((uint8_t*)&nonce, sizeof(int)));
+
+        std::shared_ptr<BufferSlot> slot(std::make_shared<BufferSlot>());
+        slot->segmentsRequested({interest});
+        observer->onNewRequest(slot);
+
+        BufferReceipt receipt;
+        receipt.oldState_ = slot->getState();
+        receipt.segment_ = slot->segmentReceived(std::make_shared<WireData<DataSegmentHeader>>(data, interest));
+        receipt.slot_ = slot;
+        observer->onNewData(receipt);
+
+        return slot;
+    }
+}
+
+TEST(TestAudioManifestWindow, TestWindows)
+{
+    Manifests m;
+    AudioManifestWindow window;
+
+    for (PacketNumber bundleNo = 0; bundleNo < 13; ++bundleNo)
+        window.add(bundleNo, {bundleSegment(bundleNo, 0)}, m.onWindow());
+
+    ASSERT_EQ(1, m.manifests_.size());
+    EXPECT_EQ(9, m.lastBundleNos_[0]);
+    EXPECT_EQ(10, m.manifests_[0]->size());
+    EXPECT_EQ(3, window.getSegmentsNum());
+
+    // incomplete window is published under its last bundle's name
+    window.flush(m.onWindow());
+    ASSERT_EQ(2, m.manifests_.size());
+    EXPECT_EQ(19, m.lastBundleNos_[1]);
+    EXPECT_EQ(3, m.manifests_[1]->size());
+    EXPECT_EQ(0, window.getSegmentsNum());
+
+    window.flush(m.onWindow());
+    EXPECT_EQ(2, m.manifests_.size());
+}
+
+TEST(TestAudioManifestWindow, TestNumberingStartsOver)
+{
+    Manifests m;
+    AudioManifestWindow window;
+
+    for (PacketNumber bundleNo = 20; bundleNo < 25; ++bundleNo)
+        window.add(bundleNo, {bundleSegment(bundleNo, 0)}, m.onWindow());
+    EXPECT_EQ(0, m.manifests_.size());
+
+    // thread was restarted
+    window.add(0, {bundleSegment(0, 0)}, m.onWindow());
+    ASSERT_EQ(1, m.manifests_.size());
+    EXPECT_EQ(29, m.lastBundleNos_[0]);
+    EXPECT_EQ(5, m.manifests_[0]->size());
+    EXPECT_EQ(1, window.getSegmentsNum());
+}
+
+TEST(TestAudioManifestValidator, TestVerifyReleasedSlots)
+{
+    std::shared_ptr<StatisticsStorage> storage(StatisticsStorage::createConsumerStatistics());
+    std::shared_ptr<TestAudioManifestValidator> validator(std::make_shared<TestAudioManifestValidator>(storage));
+    Manifests m;
+    AudioManifestWindow window;
+    std::vector<std::shared_ptr<BufferSlot>> slots;
+
+    for (PacketNumber bundleNo = 0; bundleNo < 10; ++bundleNo)
+    {
+        std::shared_ptr<Data> data = bundleSegment(bundleNo, (uint8_t)bundleNo);
+        window.add(bundleNo, {data}, m.onWindow());
+        slots.push_back(receiveBundle(validator.get(), data));
+    }
+    ASSERT_EQ(1, m.manifests_.size());
+    ASSERT_EQ(std::vector<PacketNumber>({9}), validator->fetched_);
+
+    // manifest arrives after first bundles were played
+    for (int i = 0; i < 8; ++i)
+        slots[i]->clear();
+    validator->onManifest(9, m.manifests_[0]);
+
+    EXPECT_EQ(10, (*storage)[Indicator::VerifySuccess]);
+    EXPECT_EQ(0, (*storage)[Indicator::VerifyFailure]);
+    EXPECT_EQ(BufferSlot::Verification::Verified, slots[8]->getVerificationStatus());
+    EXPECT_EQ(BufferSlot::Verification::Verified, slots[9]->getVerificationStatus());
+
+    // slots requested after manifest arrival get it right away
+    std::shared_ptr<BufferSlot> slot = receiveBundle(validator.get(), bundleSegment(9, 9));
+    EXPECT_EQ(BufferSlot::Verification::Verified, slot->getVerificationStatus());
+    EXPECT_EQ(11, (*storage)[Indicator::VerifySuccess]);
+    EXPECT_EQ(1, validator->fetched_.size());
+}
+
+TEST(TestAudioManifestValidator, TestVerificationFailure)
+{
+    std::shared_ptr<StatisticsStorage> storage(StatisticsStorage::createConsumerStatistics());
+    std::shared_ptr<TestAudioManifestValidator> validator(std::make_shared<TestAudioManifestValidator>(storage));
+    Manifests m;
+    AudioManifestWindow window;
+    std::vector<std::shared_ptr<BufferSlot>> slots;
+
+    for (PacketNumber bundleNo = 10; bundleNo < 20; ++bundleNo)
+    {
+        window.add(bundleNo, {bundleSegment(bundleNo, 0)}, m.onWindow());
+        // consumer gets different data for bundles 13 and 19
+        bool forged = (bundleNo == 13 || bundleNo == 19);
+        slots.push_back(receiveBundle(validator.get(), bundleSegment(bundleNo, (forged ? 1 : 0))));
+    }
+    ASSERT_EQ(1, m.manifests_.size());
+
+    for (int i = 0; i < 9; ++i)
+        slots[i]->clear();
+    validator->onManifest(19, m.manifests_[0]);
+
+    EXPECT_EQ(8, (*storage)[Indicator::VerifySuccess]);
+    EXPECT_EQ(2, (*storage)[Indicator::VerifyFailure]);
+    EXPECT_EQ(BufferSlot::Verification::Failed, slots[9]->getVerificationStatus());
+}
+
+TEST(TestAudioManifestValidator, TestManifestFailure)
+{
+    std::shared_ptr<StatisticsStorage> storage(StatisticsStorage::createConsumerStatistics());
+    std::shared_ptr<TestAudioManifestValidator> validator(std::make_shared<TestAudioManifestValidator>(storage));
+    std::vector<std::shared_ptr<BufferSlot>> slots;
+
+    for (PacketNumber bundleNo = 0; bundleNo < 5; ++bundleNo)
+        slots.push_back(receiveBundle(validator.get(), bundleSegment(bundleNo, 0)));
+    slots[0]->clear();
+
+    validator->onManifestFailure(9);
+
+    EXPECT_EQ(0, (*storage)[Indicator::VerifySuccess]);
+    EXPECT_EQ(1, (*storage)[Indicator::VerifyFailure]);
+    for (int i = 1; i < 5; ++i)
+        EXPECT_EQ(BufferSlot::Verification::Failed, slots[i]->getVerificationStatus());
+
+    // the rest of the window fails right away
+    std::shared_ptr<BufferSlot> slot = receiveBundle(validator.get(), bundleSegment(5, 0));
+    EXPECT_EQ(BufferSlot::Verification::Failed, slot->getVerificationStatus());
+    EXPECT_EQ(1, validator->fetched_.size());
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -162,8 +162,8 @@ TEST(TestSegmentController, TestOnTimeout)
 	MockSegmentControllerObserver o;
 	controller.attach(&o);
 
-	boost::function<void(const NamespaceInfo&, const boost::shared_ptr<const ndn::Interest> &)> checkTimeout = [i]
-		(const NamespaceInfo& info, const boost::shared_ptr<const ndn::Interest> &)
+	boost::function<void(const NameHandle&, const boost::shared_ptr<const ndn::Interest> &)> checkTimeout = [i]
+		(const NameHandle& info, const boost::shared_ptr<const ndn::Interest> &)
 		{
 			EXPECT_EQ(info.getPrefix(), i->getName());
 		};
@@ -202,8 +202,8 @@ TEST(TestSegmentController, TestOnNack)
 	MockSegmentControllerObserver o;
 	controller.attach(&o);
 
-	boost::function<void(const NamespaceInfo&, int reason, const boost::shared_ptr<const ndn::Interest> &)> checkNack = [i]
-		(const NamespaceInfo& info, int reason, const boost::shared_ptr<const ndn::Interest> &)
+	boost::function<void(const NameHandle&, int reason, const boost::shared_ptr<const ndn::Interest> &)> checkNack = [i]
+		(const NameHandle& info, int reason, const boost::shared_ptr<const ndn::Interest> &)
 		{
 			EXPECT_EQ(info.getPrefix(), i->getName());
 		};
@@ -6,6 +6,8 @@
 //
 
 #include <stdlib.h>
+#include <stddef.h>
+#include <fstream>
 #include <boost/asio.hpp>
 #include <boost/assign.hpp>
 #include <boost/make_shared.hpp>
@@ -239,6 +241,114 @@ TEST(TestFileStatWriter, TestJsonOuput)
 	remove(fileName.c_str());
 }
 
+TEST(TestStatRecorder, TestRecordAndRead)
+{
+	string fileName = "tests/test.nstat";
+	std::vector<Indicator> columns = {Indicator::Timestamp, Indicator::BufferPlayableSize, 
+		Indicator::RtxNum};
+
+	{
+		StatRecorder recorder(fileName, columns, 10);
+		StatRecordReader reader(fileName);
+
+		EXPECT_EQ(std::vector<std::string>({"timestamp", "jitterPlay", "rtxNum"}), reader.getColumns());
+		EXPECT_EQ(0, reader.getSamplesNum());
+
+		StatisticsStorage::Snapshot snapshot;
+		snapshot.fill(0);
+		for (int i = 0; i < 5; ++i)
+		{
+			snapshot[(size_t)Indicator::Timestamp] = 1457733705984+i;
+			snapshot[(size_t)Indicator::BufferPlayableSize] = i;
+			snapshot[(size_t)Indicator::DrdCachedEstimation] = 200;
+			recorder.record(snapshot);
+		}
+
+		// reader sees samples recorded after it was opened
+		ASSERT_EQ(5, reader.getSamplesNum());
+		std::vector<double> sample;
+		EXPECT_TRUE(reader.getSample(4, sample));
+		EXPECT_EQ(std::vector<double>({1457733705988, 4, 0}), sample);
+		EXPECT_ANY_THROW(reader.getSample(5, sample));
+	}
+
+	StatRecordReader reader(fileName);
+	EXPECT_EQ(5, reader.getSamplesNum());
+	remove(fileName.c_str());
+}
+
+TEST(TestStatRecorder, TestRing)
+{
+	string fileName = "tests/test.nstat";
+	std::vector<Indicator> columns = {Indicator::Timestamp, Indicator::PlayedNum};
+	StatRecorder recorder(fileName, columns, 10);
+	StatisticsStorage::Snapshot snapshot;
+
+	snapshot.fill(0);
+	for (int i = 0; i < 25; ++i)
+	{
+		snapshot[(size_t)Indicator::Timestamp] = i;
+		snapshot[(size_t)Indicator::PlayedNum] = 2*i;
+		recorder.record(snapshot);
+	}
+	EXPECT_EQ(25, recorder.getRecordedNum());
+
+	// only latest 10 samples are kept, oldest first
+	StatRecordReader reader(fileName);
+	std::vector<double> sample;
+
+	ASSERT_EQ(10, reader.getSamplesNum());
+	for (int i = 0; i < 10; ++i)
+	{
+		EXPECT_TRUE(reader.getSample(i, sample));
+		EXPECT_EQ(std::vector<double>({(double)(15+i), (double)(30+2*i)}), sample);
+	}
+	remove(fileName.c_str());
+}
+
+TEST(TestStatRecorder, TestTornSample)
+{
+	string fileName = "tests/test.nstat";
+	std::vector<Indicator> columns = {Indicator::Timestamp};
+	StatRecorder recorder(fileName, columns, 10);
+	StatisticsStorage::Snapshot snapshot;
+
+	snapshot.fill(0);
+	for (int i = 0; i < 10; ++i)
+	{
+		snapshot[(size_t)Indicator::Timestamp] = i;
+		recorder.record(snapshot);
+	}
+
+	// pretend writer has started 11th sample, which overwrites the oldest one
+	{
+		uint64_t nStarted = 11;
+		std::fstream f(fileName.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+		f.seekp(offsetof(StatRecordHeader, nStarted_));
+		f.write((const char*)&nStarted, sizeof(nStarted));
+	}
+
+	StatRecordReader reader(fileName);
+	std::vector<double> sample;
+
+	ASSERT_EQ(10, reader.getSamplesNum());
+	EXPECT_FALSE(reader.getSample(0, sample));
+	EXPECT_TRUE(reader.getSample(1, sample));
+	EXPECT_EQ(std::vector<double>({1}), sample);
+	remove(fileName.c_str());
+}
+
+TEST(TestStatRecorder, TestBadFile)
+{
+	string fileName = "tests/test.stat";
+	std::ofstream(fileName.c_str()) << "timestamp\tjitterPlay" << std::endl;
+
+	EXPECT_ANY_THROW(StatRecordReader reader(fileName));
+	EXPECT_ANY_THROW(StatRecordReader reader("tests/no-such-file.nstat"));
+	EXPECT_ANY_THROW(StatRecorder recorder("tests/test.nstat", {}, 10));
+	remove(fileName.c_str());
+}
+
 TEST(TestStatCollector, TestCreate)
 {
 	io_service io;
@@ -0,0 +1,116 @@
+//
+// test-statistics.cc
+//
+//  Copyright 2013-2018 Regents of the University of California
+//  For licensing details see the LICENSE file.
+//
+
+#include <stdlib.h>
+
+#include <boost/thread.hpp>
+#include <boost/atomic.hpp>
+
+#include "gtest/gtest.h"
+#include "statistics.hpp"
+
+using namespace ndnrtc::statistics;
+
+TEST(TestStatisticsStorage, TestUpdate)
+{
+	std::shared_ptr<StatisticsStorage> storage(StatisticsStorage::createConsumerStatistics());
+
+	(*storage)[Indicator::AcquiredNum]++;
+	++(*storage)[Indicator::AcquiredNum];
+	(*storage)[Indicator::AcquiredNum] += 3;
+	(*storage)[Indicator::AcquiredNum] -= 1;
+	EXPECT_EQ(4, (*storage)[Indicator::AcquiredNum]);
+
+	(*storage)[Indicator::BufferTargetSize] = 150;
+	(*storage)[Indicator::BufferTargetSize] = 200;
+	EXPECT_EQ(200, (*storage)[Indicator::BufferTargetSize]);
+
+	// assignment overrides accumulated increments
+	(*storage)[Indicator::AcquiredNum] = 1;
+	EXPECT_EQ(1, (*storage)[Indicator::AcquiredNum]);
+
+	storage->updateIndicator(Indicator::Darr, 10.5);
+	double darr = (*storage)[Indicator::Darr];
+	EXPECT_EQ(10.5, darr);
+
+	// producer indicators are not present in consumer storage
+	EXPECT_FALSE(storage->hasIndicator(Indicator::PublishedNum));
+	EXPECT_THROW((*storage)[Indicator::PublishedNum]++, std::out_of_range);
+	EXPECT_THROW(storage->updateIndicator(Indicator::PublishedNum, 1), std::out_of_range);
+}
+
+TEST(TestStatisticsStorage, TestCopyAndSnapshot)
+{
+	std::shared_ptr<StatisticsStorage> storage(StatisticsStorage::createProducerStatistics());
+
+	(*storage)[Indicator::PublishedNum] += 10;
+	(*storage)[Indicator::EncodingDelay] = 3.5;
+
+	StatisticsStorage copy(*storage);
+	(*storage)[Indicator::PublishedNum]++;
+
+	EXPECT_EQ(10, copy[Indicator::PublishedNum]);
+	EXPECT_EQ(3.5, copy[Indicator::EncodingDelay]);
+	EXPECT_EQ(11, (*storage)[Indicator::PublishedNum]);
+
+	StatisticsStorage::StatRepo repo = storage->getIndicators();
+	EXPECT_EQ(11, repo[Indicator::PublishedNum]);
+	EXPECT_EQ(repo.end(), repo.find(Indicator::AcquiredNum));
+
+	StatisticsStorage::Snapshot snapshot;
+	storage->snapshot(snapshot);
+	EXPECT_EQ(11, snapshot[(size_t)Indicator::PublishedNum]);
+	EXPECT_EQ(3.5, snapshot[(size_t)Indicator::EncodingDelay]);
+	EXPECT_EQ(0, snapshot[(size_t)Indicator::AcquiredNum]);
+
+	for (auto &it : repo)
+		EXPECT_EQ(it.second, snapshot[(size_t)it.first]);
+}
+
+TEST(TestStatisticsStorage, TestConcurrentUpdates)
+{
+	std::shared_ptr<StatisticsStorage> storage(StatisticsStorage::createConsumerStatistics());
+	int nThreads = 16, nIncrements = 100000;
+	boost::atomic<bool> done(false);
+	std::vector<boost::thread> threads;
+
+	// poll statistics while counters are being updated
+	boost::thread poller([storage, &done]() {
+		double last = 0;
+		StatisticsStorage::Snapshot snapshot;
+
+		while (!done)
+		{
+			storage->snapshot(snapshot);
+			EXPECT_LE(last, snapshot[(size_t)Indicator::SegmentsReceivedNum]);
+			last = snapshot[(size_t)Indicator::SegmentsReceivedNum];
+		}
+	});
+
+	for (int i = 0; i < nThreads; ++i)
+		threads.push_back(boost::thread([storage, nIncrements]() {
+			for (int j = 0; j < nIncrements; ++j)
+			{
+				(*storage)[Indicator::SegmentsReceivedNum]++;
+				(*storage)[Indicator::BytesReceived] += 2;
+			}
+		}));
+
+	for (auto &t : threads)
+		t.join();
+	done = true;
+	poller.join();
+
+	EXPECT_EQ(nThreads * nIncrements, (*storage)[Indicator::SegmentsReceivedNum]);
+	EXPECT_EQ(2 * nThreads * nIncrements, (*storage)[Indicator::BytesReceived]);
+}
+
+int main(int argc, char **argv)
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -68,6 +68,60 @@ TEST(TestDecoder, TestEncodeDecode2K)
 	EXPECT_EQ(nEncoded, nDecoded);
 }
 
+TEST(TestDecoder, TestAsyncDecode)
+{
+	int nFrames = 30*3;
+	int width = 1280;
+	int height = 720;
+	std::vector<WebRtcVideoFrame> frames = getFrameSequence(width, height, nFrames);
+
+	VideoCoderParams vcp(sampleVideoCoderParams());
+	vcp.startBitrate_ = 2000;
+	vcp.maxBitrate_ = 2000;
+	vcp.encodeWidth_ = width;
+	vcp.encodeHeight_ = height;
+	vcp.dropFramesOn_ = false;
+	MockEncoderDelegate coderDelegate;
+	coderDelegate.setDefaults();
+	VideoCoder vc(vcp, &coderDelegate);
+
+	std::shared_ptr<statistics::StatisticsStorage> storage(statistics::StatisticsStorage::createConsumerStatistics());
+	boost::atomic<int> nDecoded(0);
+	boost::thread::id callerThread = boost::this_thread::get_id();
+	int nEncoded = 0, lastPlaybackNo = -1;
+	std::shared_ptr<AsyncDecoder> decoder = std::make_shared<AsyncDecoder>(vcp, 
+		[&nDecoded, &lastPlaybackNo, callerThread](const FrameInfo& fi, const WebRtcVideoFrame &f){
+			// frames are decoded in order, off the caller's thread
+			EXPECT_NE(callerThread, boost::this_thread::get_id());
+			EXPECT_EQ(lastPlaybackNo+1, fi.playbackNo_);
+			lastPlaybackNo = fi.playbackNo_;
+			nDecoded++;
+		},
+		storage, DecoderPool::getSharedPool(), nFrames);
+
+	EXPECT_CALL(coderDelegate, onEncodedFrame(_))
+		.Times(AtLeast(1))
+		.WillRepeatedly(Invoke([decoder, &nEncoded](const webrtc::EncodedImage& img){
+			FrameInfo fi = { 0, nEncoded++, "/phony/name" };
+			decoder->processFrame(fi, img);
+		}));
+	EXPECT_CALL(coderDelegate, onEncodingStarted())
+		.Times(nFrames);
+	EXPECT_CALL(coderDelegate, onDroppedFrame())
+		.Times(AtLeast(0));
+
+	for (auto& f:frames) vc.onRawFrame(f);
+
+	for (int i = 0; i < 100 && nDecoded < nEncoded; ++i)
+		boost::this_thread::sleep_for(boost::chrono::milliseconds(50));
+	decoder->stop();
+
+	EXPECT_EQ(nEncoded, nDecoded);
+	EXPECT_EQ(0, (*storage)[statistics::Indicator::DecodeDroppedNum]);
+	EXPECT_EQ(0, (*storage)[statistics::Indicator::DecodeQueueSize]);
+	EXPECT_LT(0, (*storage)[statistics::Indicator::DecodingTime]);
+}
+
 int main(int argc, char **argv) {
 	::testing::InitGoogleTest(&argc, argv);
 	return RUN_ALL_TESTS();